@@ -0,0 +1,137 @@
+#include "BufferedWriter.h"
+#include <cstring>
+
+bool FileSink::Write(const char* data, size_t length) {
+    return fwrite(data, 1, length, m_file) == length;
+}
+
+bool StringSink::Write(const char* data, size_t length) {
+    m_text.append(data, length);
+    return true;
+}
+
+BufferedWriter::BufferedWriter(ByteSink& sink, size_t capacity)
+    : m_sink(sink)
+    , m_buffer(capacity < 64 ? 64 : capacity)
+{
+}
+
+BufferedWriter::~BufferedWriter() {
+    Flush();
+}
+
+bool BufferedWriter::Flush() {
+    if (m_used > 0) {
+        if (!m_failed && !m_sink.Write(m_buffer.data(), m_used)) {
+            m_failed = true;
+        }
+        m_flushed += m_used;
+        m_used = 0;
+    }
+    return !m_failed;
+}
+
+char* BufferedWriter::Reserve(size_t length) {
+    // Only used for short encodings, always well under the buffer size
+    if (m_buffer.size() - m_used < length) Flush();
+    char* out = m_buffer.data() + m_used;
+    m_used += length;
+    return out;
+}
+
+void BufferedWriter::Put(const char* data, size_t length) {
+    while (length > 0) {
+        if (m_used == m_buffer.size()) Flush();
+        size_t chunk = m_buffer.size() - m_used;
+        if (chunk > length) chunk = length;
+        memcpy(m_buffer.data() + m_used, data, chunk);
+        m_used += chunk;
+        data += chunk;
+        length -= chunk;
+    }
+}
+
+void BufferedWriter::PutUtf8(const wchar_t* text, size_t length) {
+    for (size_t i = 0; i < length; i++) {
+        uint32_t c = static_cast<uint32_t>(text[i]);
+        if (c < 0x80) {
+            Put(static_cast<char>(c));
+            continue;
+        }
+
+        if (sizeof(wchar_t) == 2 && c >= 0xD800 && c <= 0xDFFF) {
+            // Combine a surrogate pair, or replace a lone surrogate
+            uint32_t low = i + 1 < length ? static_cast<uint32_t>(text[i + 1]) : 0;
+            if (c <= 0xDBFF && low >= 0xDC00 && low <= 0xDFFF) {
+                c = 0x10000 + ((c - 0xD800) << 10) + (low - 0xDC00);
+                i++;
+            } else {
+                c = 0xFFFD;
+            }
+        } else if (c > 0x10FFFF || (c >= 0xD800 && c <= 0xDFFF)) {
+            c = 0xFFFD;
+        }
+
+        if (c < 0x800) {
+            char* out = Reserve(2);
+            out[0] = static_cast<char>(0xC0 | (c >> 6));
+            out[1] = static_cast<char>(0x80 | (c & 0x3F));
+        } else if (c < 0x10000) {
+            char* out = Reserve(3);
+            out[0] = static_cast<char>(0xE0 | (c >> 12));
+            out[1] = static_cast<char>(0x80 | ((c >> 6) & 0x3F));
+            out[2] = static_cast<char>(0x80 | (c & 0x3F));
+        } else {
+            char* out = Reserve(4);
+            out[0] = static_cast<char>(0xF0 | (c >> 18));
+            out[1] = static_cast<char>(0x80 | ((c >> 12) & 0x3F));
+            out[2] = static_cast<char>(0x80 | ((c >> 6) & 0x3F));
+            out[3] = static_cast<char>(0x80 | (c & 0x3F));
+        }
+    }
+}
+
+void BufferedWriter::PutUnsigned(uint64_t value) {
+    char digits[20];
+    size_t count = 0;
+    do {
+        digits[count++] = static_cast<char>('0' + value % 10);
+        value /= 10;
+    } while (value != 0);
+
+    char* out = Reserve(count);
+    for (size_t i = 0; i < count; i++) {
+        out[i] = digits[count - 1 - i];
+    }
+}
+
+void BufferedWriter::PutSigned(int64_t value) {
+    if (value < 0) {
+        Put('-');
+        PutUnsigned(0 - static_cast<uint64_t>(value));
+    } else {
+        PutUnsigned(static_cast<uint64_t>(value));
+    }
+}
+
+void BufferedWriter::PutHex(uint64_t value, int minDigits) {
+    static const char hexDigits[] = "0123456789ABCDEF";
+
+    char digits[16];
+    int count = 0;
+    do {
+        digits[count++] = hexDigits[value & 0xF];
+        value >>= 4;
+    } while (value != 0);
+
+    if (minDigits > 16) minDigits = 16;
+    int padding = minDigits > count ? minDigits - count : 0;
+
+    char* out = Reserve(static_cast<size_t>(padding + count));
+    for (int i = 0; i < padding; i++) {
+        out[i] = '0';
+    }
+    for (int i = 0; i < count; i++) {
+        out[padding + i] = digits[count - 1 - i];
+    }
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+// Destination for BufferedWriter output
+class ByteSink {
+public:
+    virtual ~ByteSink() = default;
+    virtual bool Write(const char* data, size_t length) = 0;
+};
+
+// Writes to an already open stdio stream; the caller owns the stream
+class FileSink : public ByteSink {
+public:
+    explicit FileSink(FILE* file) : m_file(file) {}
+    bool Write(const char* data, size_t length) override;
+
+private:
+    FILE* m_file;
+};
+
+// Appends to a string, for tests and in-memory consumers
+class StringSink : public ByteSink {
+public:
+    explicit StringSink(std::string& text) : m_text(text) {}
+    bool Write(const char* data, size_t length) override;
+
+private:
+    std::string& m_text;
+};
+
+// UTF-8 output through one fixed buffer that is handed to the sink whenever
+// it fills. Integers and UTF-16 text are encoded straight into the buffer, so
+// steady-state writing does not allocate. After a sink failure all further
+// output is dropped and Failed() reports it.
+class BufferedWriter {
+public:
+    explicit BufferedWriter(ByteSink& sink, size_t capacity = 64 * 1024);
+    ~BufferedWriter();
+
+    void Put(char c) {
+        if (m_used == m_buffer.size()) Flush();
+        m_buffer[m_used++] = c;
+    }
+    void Put(const char* data, size_t length);
+    template <size_t N>
+    void PutLiteral(const char (&text)[N]) { Put(text, N - 1); }
+
+    // UTF-16 to UTF-8; unpaired surrogates become U+FFFD
+    void PutUtf8(const wchar_t* text, size_t length);
+    void PutUnsigned(uint64_t value);
+    void PutSigned(int64_t value);
+    // Uppercase hex, zero-padded to at least minDigits
+    void PutHex(uint64_t value, int minDigits = 1);
+
+    bool Flush();
+    bool Failed() const { return m_failed; }
+    // Bytes accepted so far, flushed or not
+    uint64_t BytesWritten() const { return m_flushed + m_used; }
+
+private:
+    char* Reserve(size_t length);
+
+    ByteSink& m_sink;
+    std::vector<char> m_buffer;
+    size_t m_used = 0;
+    uint64_t m_flushed = 0;
+    bool m_failed = false;
+};
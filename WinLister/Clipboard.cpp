@@ -0,0 +1,52 @@
+#include "Clipboard.h"
+#include <cstring>
+
+bool Clipboard::SetText(HWND owner, const std::wstring& text) {
+    HGLOBAL hMem = GlobalAlloc(GMEM_MOVEABLE, (text.length() + 1) * sizeof(wchar_t));
+    if (!hMem) return false;
+
+    wchar_t* pMem = static_cast<wchar_t*>(GlobalLock(hMem));
+    if (!pMem) {
+        GlobalFree(hMem);
+        return false;
+    }
+    memcpy(pMem, text.c_str(), (text.length() + 1) * sizeof(wchar_t));
+    GlobalUnlock(hMem);
+
+    return Publish(owner, hMem);
+}
+
+bool Clipboard::SetExport(HWND owner, const PropertyModel& model, PropertyExportFormat format,
+    bool finalLineBreak) {
+    size_t length = PropertyExporter::Measure(model, format, finalLineBreak);
+
+    HGLOBAL hMem = GlobalAlloc(GMEM_MOVEABLE, (length + 1) * sizeof(wchar_t));
+    if (!hMem) return false;
+
+    wchar_t* pMem = static_cast<wchar_t*>(GlobalLock(hMem));
+    if (!pMem) {
+        GlobalFree(hMem);
+        return false;
+    }
+    PropertyExporter::Write(model, format, pMem, finalLineBreak);
+    GlobalUnlock(hMem);
+
+    return Publish(owner, hMem);
+}
+
+bool Clipboard::Publish(HWND owner, HGLOBAL hMem) {
+    if (!OpenClipboard(owner)) {
+        GlobalFree(hMem);
+        return false;
+    }
+
+    EmptyClipboard();
+    bool ok = SetClipboardData(CF_UNICODETEXT, hMem) != nullptr;
+    CloseClipboard();
+
+    // The clipboard owns the memory only once SetClipboardData succeeds
+    if (!ok) {
+        GlobalFree(hMem);
+    }
+    return ok;
+}
@@ -0,0 +1,19 @@
+#pragma once
+
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <Windows.h>
+#include <string>
+#include "PropertyExport.h"
+
+// CF_UNICODETEXT clipboard writes. The clipboard memory is allocated at its
+// final size and filled directly, before the clipboard is opened.
+class Clipboard {
+public:
+    static bool SetText(HWND owner, const std::wstring& text);
+    static bool SetExport(HWND owner, const PropertyModel& model, PropertyExportFormat format,
+        bool finalLineBreak = true);
+
+private:
+    static bool Publish(HWND owner, HGLOBAL hMem);
+};
@@ -0,0 +1,210 @@
+#include "CommandLine.h"
+
+namespace {
+
+bool ParseNumber(const std::wstring& text, uint64_t& value) {
+    if (text.empty()) return false;
+    value = 0;
+    for (wchar_t c : text) {
+        if (c < L'0' || c > L'9') return false;
+        uint64_t digit = static_cast<uint64_t>(c - L'0');
+        if (value > (UINT64_MAX - digit) / 10) return false;
+        value = value * 10 + digit;
+    }
+    return true;
+}
+
+} // namespace
+
+std::vector<std::wstring> CommandLine::Split(const wchar_t* text) {
+    std::vector<std::wstring> args;
+    if (!text) return args;
+
+    const wchar_t* p = text;
+    for (;;) {
+        while (*p == L' ' || *p == L'\t' || *p == L'\r' || *p == L'\n') p++;
+        if (!*p) break;
+
+        std::wstring arg;
+        bool inQuotes = false;
+        while (*p && (inQuotes || (*p != L' ' && *p != L'\t' && *p != L'\r' && *p != L'\n'))) {
+            if (*p == L'\\') {
+                size_t slashes = 0;
+                while (*p == L'\\') {
+                    slashes++;
+                    p++;
+                }
+                if (*p == L'"') {
+                    // 2n backslashes + quote: n backslashes, quote toggles;
+                    // 2n+1: n backslashes and a literal quote
+                    arg.append(slashes / 2, L'\\');
+                    if (slashes % 2) {
+                        arg.push_back(L'"');
+                        p++;
+                    }
+                } else {
+                    arg.append(slashes, L'\\');
+                }
+            } else if (*p == L'"') {
+                inQuotes = !inQuotes;
+                p++;
+            } else {
+                arg.push_back(*p++);
+            }
+        }
+        args.push_back(arg);
+    }
+    return args;
+}
+
+bool CommandLine::Parse(const std::vector<std::wstring>& args, HeadlessOptions& options, std::wstring& error) {
+    options = HeadlessOptions();
+
+    for (size_t i = 0; i < args.size(); i++) {
+        std::wstring name = args[i];
+        std::wstring value;
+        bool hasValue = false;
+        size_t eq = name.find(L'=');
+        if (name.compare(0, 2, L"--") == 0 && eq != std::wstring::npos) {
+            value = name.substr(eq + 1);
+            name.resize(eq);
+            hasValue = true;
+        }
+
+        auto takeValue = [&]() {
+            if (hasValue) return true;
+            if (i + 1 >= args.size()) {
+                error = name + L" needs a value";
+                return false;
+            }
+            value = args[++i];
+            return true;
+        };
+        // Switches take no value, so "--initial=no" is not silently read as on
+        auto noValue = [&]() {
+            if (!hasValue) return true;
+            error = name + L" takes no value";
+            return false;
+        };
+
+        if (name == L"--help" || name == L"-h" || name == L"-?" || name == L"/?") {
+            if (!noValue()) return false;
+            options.command = HEADLESS_HELP;
+        } else if (name == L"--dump" || name == L"--watch") {
+            if (!noValue()) return false;
+            int command = name == L"--dump" ? HEADLESS_DUMP : HEADLESS_WATCH;
+            if (options.command != HEADLESS_NONE && options.command != HEADLESS_HELP && options.command != command) {
+                error = L"Use either --dump or --watch";
+                return false;
+            }
+            if (options.command == HEADLESS_NONE) options.command = command;
+        } else if (name == L"--format") {
+            if (!takeValue()) return false;
+            if (!SnapshotExporter::ParseFormat(value, options.format)) {
+                error = L"Unknown format '" + value + L"' (expected csv, json or ndjson)";
+                return false;
+            }
+        } else if (name == L"--query") {
+            if (!takeValue()) return false;
+            // Repeated queries must all match
+            if (!options.query.empty()) options.query.push_back(L' ');
+            options.query += value;
+        } else if (name == L"--sort") {
+            if (!takeValue()) return false;
+            if (!SortSpec::Parse(value, options.sort)) {
+                error = L"Bad sort spec '" + value + L"'";
+                return false;
+            }
+        } else if (name == L"--hide-hidden") {
+            if (!noValue()) return false;
+            options.hideHidden = true;
+        } else if (name == L"--hide-system") {
+            if (!noValue()) return false;
+            options.hideSystem = true;
+        } else if (name == L"--input") {
+            if (!takeValue()) return false;
+            options.input = value;
+        } else if (name == L"--at") {
+            if (!takeValue()) return false;
+            if (!ParseNumber(value, options.time)) {
+                error = L"Expected milliseconds since 1970 for --at, got '" + value + L"'";
+                return false;
+            }
+            options.hasTime = true;
+        } else if (name == L"--fields") {
+            if (!takeValue()) return false;
+            if (!WindowWatcher::ParseFields(value, options.watchFields, error)) return false;
+        } else if (name == L"--interval") {
+            if (!takeValue()) return false;
+            uint64_t interval;
+            if (!ParseNumber(value, interval) || interval < 1 || interval > 3600000) {
+                error = L"Expected 1 to 3600000 milliseconds for --interval, got '" + value + L"'";
+                return false;
+            }
+            options.watchInterval = static_cast<uint32_t>(interval);
+        } else if (name == L"--initial") {
+            if (!noValue()) return false;
+            options.watchInitial = true;
+        } else {
+            error = L"Unknown option '" + name + L"'";
+            return false;
+        }
+    }
+
+    if (options.command == HEADLESS_NONE) {
+        error = L"No command given; use --dump, --watch or --help";
+        return false;
+    }
+    if (options.command == HEADLESS_WATCH) {
+        if (options.format != SNAPSHOT_NDJSON) {
+            error = L"--watch writes NDJSON only";
+            return false;
+        }
+        if (!options.sort.IsEmpty()) {
+            error = L"--sort does not apply to --watch";
+            return false;
+        }
+    }
+    // Raised times come from comparing refreshes; a dump is one snapshot
+    if (options.command == HEADLESS_DUMP && options.sort.Find(COLUMN_RAISED)) {
+        error = L"--sort raised does not apply to --dump; it needs the window list followed over time";
+        return false;
+    }
+    return true;
+}
+
+const char* CommandLine::Usage() {
+    return
+        "Usage: WinLister --dump [options]\n"
+        "       WinLister --watch [options]\n"
+        "\n"
+        "  --dump                    Write the window list to stdout and exit\n"
+        "  --watch                   Write one NDJSON line per window change until\n"
+        "                            stopped (Ctrl+C), or to the end of an --input\n"
+        "                            recording\n"
+        "  --format csv|json|ndjson  Output format (default ndjson)\n"
+        "  --query TEXT              Only windows matching the query, e.g.\n"
+        "                            \"class:Chrome* -visible:no\"; terms are words,\n"
+        "                            title: class: process: path: (globs), pid: tid:\n"
+        "                            hwnd: z: (numbers, <, >), and visible: enabled:\n"
+        "                            minimized: maximized: topmost: layered: cloaked:\n"
+        "                            hung: uwp: hidden: system: (yes/no)\n"
+        "  --sort SPEC               Sort keys, e.g. \"process,-pid\" (default z-order)\n"
+        "  --hide-hidden             Leave out hidden windows\n"
+        "  --hide-system             Leave out system windows\n"
+        "  --input FILE              Read a .wls snapshot or .wlr recording instead\n"
+        "                            of the live windows\n"
+        "  --at MS                   Recording frame in effect at this time (ms since\n"
+        "                            1970); default the last frame, or the first for\n"
+        "                            --watch\n"
+        "  --fields LIST             Changes to watch: created destroyed rect client\n"
+        "                            dwm title style exstyle visible enabled minimized\n"
+        "                            maximized topmost layered transparent cloaked\n"
+        "                            hung alpha zorder parent owner, or the events\n"
+        "                            moved retitled state restacked reparented all;\n"
+        "                            \"-name\" removes (default all)\n"
+        "  --interval MS             Longest wait between live watch snapshots\n"
+        "                            (default 250); window events cut it short\n"
+        "  --initial                 Report the windows already open as created\n"
+        "  --help                    Show this help\n";
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "SnapshotExport.h"
+#include "WindowSort.h"
+#include "WindowWatch.h"
+
+enum HeadlessCommand {
+    HEADLESS_NONE = 0,      // no headless switch: start the GUI
+    HEADLESS_HELP,
+    HEADLESS_DUMP,
+    HEADLESS_WATCH
+};
+
+struct HeadlessOptions {
+    int command = HEADLESS_NONE;
+    SnapshotFormat format = SNAPSHOT_NDJSON;
+    std::wstring query;
+    SortSpec sort;
+    bool hideHidden = false;
+    bool hideSystem = false;
+    std::wstring input;             // .wls snapshot or .wlr recording; empty = live windows
+    bool hasTime = false;
+    uint64_t time = 0;              // recording frame time (ms since the Unix epoch)
+    uint32_t watchFields = WindowWatcher::DEFAULT_FIELDS;
+    uint32_t watchInterval = 250;   // longest wait between live snapshots (ms)
+    bool watchInitial = false;      // report the windows already open as created
+};
+
+// Command-line parsing for the headless modes. Options take their value as
+// the next argument or after '=': "--format ndjson" or "--format=ndjson".
+class CommandLine {
+public:
+    // Splits a command line with the Windows rules: whitespace separates
+    // arguments, double quotes group, and backslashes escape quotes only
+    static std::vector<std::wstring> Split(const wchar_t* text);
+    // Parses arguments without the program name. Returns false with an error
+    // message for unknown options or bad values.
+    static bool Parse(const std::vector<std::wstring>& args, HeadlessOptions& options, std::wstring& error);
+    static const char* Usage();
+};
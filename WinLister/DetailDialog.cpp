@@ -1,11 +1,11 @@
 #include "DetailDialog.h"
 #include "resource.h"
-#include <sstream>
-#include <iomanip>
+#include "Clipboard.h"
 
-DetailDialog::DetailDialog(HWND hwndParent, const WindowInfo& windowInfo)
+DetailDialog::DetailDialog(HWND hwndParent, const WindowInfo& windowInfo, WindowAnimator& animator)
     : m_hwndParent(hwndParent)
     , m_windowInfo(windowInfo)
+    , m_animator(animator)
 {
 }
 
@@ -45,7 +45,7 @@ INT_PTR DetailDialog::HandleMessage(HWND hwnd, UINT msg, WPARAM wParam, LPARAM l
     case WM_COMMAND:
         switch (LOWORD(wParam)) {
         case IDC_BTN_COPY:
-            CopyToClipboard(hwnd);
+            CopyToClipboard(hwnd, EXPORT_TSV);
             return TRUE;
 
         case IDC_BTN_CLOSE:
@@ -89,12 +89,19 @@ INT_PTR DetailDialog::HandleMessage(HWND hwnd, UINT msg, WPARAM wParam, LPARAM l
         case IDC_DETAIL_AUTO_REFRESH:
             m_autoRefresh = (SendMessageW(m_hCheckAutoRefresh, BM_GETCHECK, 0, 0) == BST_CHECKED);
             if (m_autoRefresh) {
-                SetTimer(hwnd, TIMER_REFRESH, m_refreshInterval, nullptr);
+                RestartRefreshTimer(hwnd);
             } else {
                 KillTimer(hwnd, TIMER_REFRESH);
             }
             return TRUE;
 
+        case IDC_DETAIL_FAST_REFRESH:
+            m_fastRefresh = (SendMessageW(m_hCheckFastRefresh, BM_GETCHECK, 0, 0) == BST_CHECKED);
+            if (m_autoRefresh) {
+                RestartRefreshTimer(hwnd);
+            }
+            return TRUE;
+
         case IDC_DETAIL_REFRESH_TIME:
             if (HIWORD(wParam) == EN_CHANGE) {
                 wchar_t buffer[16] = {};
@@ -103,8 +110,7 @@ INT_PTR DetailDialog::HandleMessage(HWND hwnd, UINT msg, WPARAM wParam, LPARAM l
                 if (interval >= 100) {  // Minimum 100ms
                     m_refreshInterval = interval;
                     if (m_autoRefresh) {
-                        KillTimer(hwnd, TIMER_REFRESH);
-                        SetTimer(hwnd, TIMER_REFRESH, m_refreshInterval, nullptr);
+                        RestartRefreshTimer(hwnd);
                     }
                 }
             }
@@ -115,7 +121,12 @@ INT_PTR DetailDialog::HandleMessage(HWND hwnd, UINT msg, WPARAM wParam, LPARAM l
     case WM_TIMER:
         if (wParam == TIMER_REFRESH) {
             if (IsTargetWindowValid()) {
-                RefreshWindowInfo(hwnd);
+                RefreshKind kind = m_fastRefresh ? m_cadence.Poll(GetTickCount64()) : REFRESH_FULL;
+                if (kind == REFRESH_FULL) {
+                    RefreshWindowInfo(hwnd);
+                } else if (kind == REFRESH_VOLATILE) {
+                    RefreshVolatileInfo(hwnd);
+                }
             } else {
                 KillTimer(hwnd, TIMER_REFRESH);
                 SendMessageW(m_hCheckAutoRefresh, BM_SETCHECK, BST_UNCHECKED, 0);
@@ -168,8 +179,11 @@ INT_PTR DetailDialog::HandleMessage(HWND hwnd, UINT msg, WPARAM wParam, LPARAM l
         if (m_hStaticMs) {
             MoveWindow(m_hStaticMs, 165, y + 6, 25, 20, TRUE);
         }
+        if (m_hCheckFastRefresh) {
+            MoveWindow(m_hCheckFastRefresh, 195, y + 3, 50, 24, TRUE);
+        }
         if (m_hBtnRefresh) {
-            MoveWindow(m_hBtnRefresh, 195, y, 80, 28, TRUE);
+            MoveWindow(m_hBtnRefresh, 250, y, 80, 28, TRUE);
         }
 
         // Bottom toolbar - right side: Copy, Close buttons
@@ -211,13 +225,7 @@ INT_PTR DetailDialog::HandleMessage(HWND hwnd, UINT msg, WPARAM wParam, LPARAM l
 
 void DetailDialog::OnInitDialog(HWND hwnd) {
     // Set dialog title
-    std::wstring title = L"Window Details: ";
-    if (!m_windowInfo.title.empty()) {
-        title += m_windowInfo.title;
-    } else {
-        title += L"(no title)";
-    }
-    SetWindowTextW(hwnd, title.c_str());
+    UpdateDialogTitle(hwnd);
 
     // Center dialog
     RECT rcParent, rcDialog;
@@ -283,6 +291,19 @@ void DetailDialog::CreateTabControl(HWND hwnd) {
         // Move ListView to tab content area
         MoveWindow(m_hListView, tabRect.left, tabRect.top,
             tabRect.right - tabRect.left, tabRect.bottom - tabRect.top, TRUE);
+
+        ListView_SetExtendedListViewStyle(m_hListView,
+            LVS_EX_FULLROWSELECT | LVS_EX_GRIDLINES | LVS_EX_DOUBLEBUFFER);
+
+        LVCOLUMNW col = {};
+        col.mask = LVCF_TEXT | LVCF_WIDTH;
+        col.cx = 200;
+        col.pszText = const_cast<wchar_t*>(L"Property");
+        ListView_InsertColumn(m_hListView, 0, &col);
+
+        col.cx = 450;
+        col.pszText = const_cast<wchar_t*>(L"Value");
+        ListView_InsertColumn(m_hListView, 1, &col);
     }
 
     // Get existing buttons
@@ -315,17 +336,24 @@ void DetailDialog::CreateTabControl(HWND hwnd) {
         hwnd, nullptr, hInst, nullptr);
     SendMessageW(m_hStaticMs, WM_SETFONT, reinterpret_cast<WPARAM>(hFont), TRUE);
 
+    m_hCheckFastRefresh = CreateWindowExW(
+        0, L"BUTTON", L"Fast",
+        WS_CHILD | WS_VISIBLE | BS_AUTOCHECKBOX,
+        195, rc.bottom - 40, 50, 24,
+        hwnd, reinterpret_cast<HMENU>(IDC_DETAIL_FAST_REFRESH), hInst, nullptr);
+    SendMessageW(m_hCheckFastRefresh, WM_SETFONT, reinterpret_cast<WPARAM>(hFont), TRUE);
+
     m_hBtnRefresh = CreateWindowExW(
         0, L"BUTTON", L"Refresh",
         WS_CHILD | WS_VISIBLE | BS_PUSHBUTTON,
-        195, rc.bottom - 40, 80, 28,
+        250, rc.bottom - 40, 80, 28,
         hwnd, reinterpret_cast<HMENU>(IDC_BTN_REFRESH_INFO), hInst, nullptr);
     SendMessageW(m_hBtnRefresh, WM_SETFONT, reinterpret_cast<WPARAM>(hFont), TRUE);
 
     // Enable auto-refresh by default
     m_autoRefresh = true;
     SendMessageW(m_hCheckAutoRefresh, BM_SETCHECK, BST_CHECKED, 0);
-    SetTimer(hwnd, TIMER_REFRESH, m_refreshInterval, nullptr);
+    RestartRefreshTimer(hwnd);
 }
 
 void DetailDialog::CreateModifyControls(HWND hwnd) {
@@ -536,125 +564,181 @@ void DetailDialog::CreateModifyControls(HWND hwnd) {
 void DetailDialog::PopulateDetails(HWND hwnd) {
     if (!m_hListView) return;
 
-    ListView_DeleteAllItems(m_hListView);
-
-    ListView_SetExtendedListViewStyle(m_hListView,
-        LVS_EX_FULLROWSELECT | LVS_EX_GRIDLINES | LVS_EX_DOUBLEBUFFER);
-
-    // Add columns if not already added
-    if (ListView_GetItemCount(m_hListView) == 0) {
-        LVCOLUMNW col = {};
-        col.mask = LVCF_TEXT | LVCF_WIDTH;
-        col.cx = 200;
-        col.pszText = const_cast<wchar_t*>(L"Property");
-        ListView_InsertColumn(m_hListView, 0, &col);
-
-        col.cx = 450;
-        col.pszText = const_cast<wchar_t*>(L"Value");
-        ListView_InsertColumn(m_hListView, 1, &col);
-    }
+    m_properties.Begin();
 
     // Basic info
-    wchar_t buffer[512];
-
-    swprintf_s(buffer, L"0x%p", m_windowInfo.hwnd);
-    AddDetailItem(m_hListView, L"HWND", buffer);
-
-    swprintf_s(buffer, L"0x%p", m_windowInfo.hwndParent);
-    AddDetailItem(m_hListView, L"Parent HWND", buffer);
+    m_properties.Add(L"HWND", FormatPointer(DETAIL_HWND, m_windowInfo.hwnd));
+    m_properties.Add(L"Parent HWND", FormatPointer(DETAIL_PARENT, m_windowInfo.hwndParent));
+    m_properties.Add(L"Owner HWND", FormatPointer(DETAIL_OWNER, m_windowInfo.hwndOwner));
 
-    swprintf_s(buffer, L"0x%p", m_windowInfo.hwndOwner);
-    AddDetailItem(m_hListView, L"Owner HWND", buffer);
-
-    AddDetailItem(m_hListView, L"Title", m_windowInfo.title.empty() ? L"(empty)" : m_windowInfo.title.c_str());
-    AddDetailItem(m_hListView, L"Class", m_windowInfo.className.c_str());
+    m_properties.Add(L"Title", m_windowInfo.title.empty() ? L"(empty)" : m_windowInfo.title.c_str());
+    m_properties.Add(L"Class", m_windowInfo.className.c_str());
 
     // Process info
-    AddDetailItem(m_hListView, L"", L"--- Process Information ---");
-
-    swprintf_s(buffer, L"%u", m_windowInfo.processId);
-    AddDetailItem(m_hListView, L"Process ID (PID)", buffer);
+    m_properties.AddSection(L"--- Process Information ---");
 
-    swprintf_s(buffer, L"%u", m_windowInfo.threadId);
-    AddDetailItem(m_hListView, L"Thread ID", buffer);
+    m_properties.Add(L"Process ID (PID)", FormatNumber(DETAIL_PID, m_windowInfo.processId));
+    m_properties.Add(L"Thread ID", FormatNumber(DETAIL_TID, m_windowInfo.threadId));
 
-    AddDetailItem(m_hListView, L"Process Name", m_windowInfo.processName.empty() ? L"(unknown)" : m_windowInfo.processName.c_str());
-    AddDetailItem(m_hListView, L"Process Path", m_windowInfo.processPath.empty() ? L"(unknown)" : m_windowInfo.processPath.c_str());
+    m_properties.Add(L"Process Name", m_windowInfo.processName.empty() ? L"(unknown)" : m_windowInfo.processName.c_str());
+    m_properties.Add(L"Process Path", m_windowInfo.processPath.empty() ? L"(unknown)" : m_windowInfo.processPath.c_str());
 
     // Position and size
-    AddDetailItem(m_hListView, L"", L"--- Position and Size ---");
-
-    swprintf_s(buffer, L"Left: %d, Top: %d, Right: %d, Bottom: %d",
-        m_windowInfo.rect.left, m_windowInfo.rect.top,
-        m_windowInfo.rect.right, m_windowInfo.rect.bottom);
-    AddDetailItem(m_hListView, L"Window Rectangle", buffer);
-
-    swprintf_s(buffer, L"%d x %d",
-        m_windowInfo.rect.right - m_windowInfo.rect.left,
-        m_windowInfo.rect.bottom - m_windowInfo.rect.top);
-    AddDetailItem(m_hListView, L"Window Size", buffer);
-
-    swprintf_s(buffer, L"Width: %d, Height: %d",
-        m_windowInfo.clientRect.right - m_windowInfo.clientRect.left,
-        m_windowInfo.clientRect.bottom - m_windowInfo.clientRect.top);
-    AddDetailItem(m_hListView, L"Client Area", buffer);
+    m_properties.AddSection(L"--- Position and Size ---");
+
+    m_properties.Add(L"Window Rectangle", FormatRect(DETAIL_RECT, m_windowInfo.rect));
+
+    LONG width = m_windowInfo.rect.right - m_windowInfo.rect.left;
+    LONG height = m_windowInfo.rect.bottom - m_windowInfo.rect.top;
+    m_properties.Add(L"Window Size",
+        m_detailText[DETAIL_SIZE].Get(TextFormat::PackPair(width, height), [&](std::wstring& text) {
+            TextFormat::AppendSigned(text, width);
+            text += L" x ";
+            TextFormat::AppendSigned(text, height);
+        }).c_str());
+
+    LONG clientWidth = m_windowInfo.clientRect.right - m_windowInfo.clientRect.left;
+    LONG clientHeight = m_windowInfo.clientRect.bottom - m_windowInfo.clientRect.top;
+    m_properties.Add(L"Client Area",
+        m_detailText[DETAIL_CLIENT].Get(TextFormat::PackPair(clientWidth, clientHeight), [&](std::wstring& text) {
+            text += L"Width: ";
+            TextFormat::AppendSigned(text, clientWidth);
+            text += L", Height: ";
+            TextFormat::AppendSigned(text, clientHeight);
+        }).c_str());
 
     if (m_windowInfo.hasDwmFrame) {
-        swprintf_s(buffer, L"Left: %d, Top: %d, Right: %d, Bottom: %d",
-            m_windowInfo.dwmExtendedFrame.left, m_windowInfo.dwmExtendedFrame.top,
-            m_windowInfo.dwmExtendedFrame.right, m_windowInfo.dwmExtendedFrame.bottom);
-        AddDetailItem(m_hListView, L"DWM Extended Frame", buffer);
+        m_properties.Add(L"DWM Extended Frame", FormatRect(DETAIL_DWM_FRAME, m_windowInfo.dwmExtendedFrame));
     }
 
     // State
-    AddDetailItem(m_hListView, L"", L"--- State ---");
+    m_properties.AddSection(L"--- State ---");
 
-    AddDetailItem(m_hListView, L"Visible", m_windowInfo.isVisible ? L"Yes" : L"No");
-    AddDetailItem(m_hListView, L"Enabled", m_windowInfo.isEnabled ? L"Yes" : L"No");
-    AddDetailItem(m_hListView, L"Minimized", m_windowInfo.isMinimized ? L"Yes" : L"No");
-    AddDetailItem(m_hListView, L"Maximized", m_windowInfo.isMaximized ? L"Yes" : L"No");
-    AddDetailItem(m_hListView, L"Topmost", m_windowInfo.isTopMost ? L"Yes" : L"No");
-    AddDetailItem(m_hListView, L"Cloaked (hidden)", m_windowInfo.isCloaked ? L"Yes" : L"No");
-    AddDetailItem(m_hListView, L"UWP App", m_windowInfo.isUWP ? L"Yes" : L"No");
-    AddDetailItem(m_hListView, L"Hung", m_windowInfo.isHung ? L"Yes" : L"No");
+    m_properties.Add(L"Visible", m_windowInfo.isVisible ? L"Yes" : L"No");
+    m_properties.Add(L"Enabled", m_windowInfo.isEnabled ? L"Yes" : L"No");
+    m_properties.Add(L"Minimized", m_windowInfo.isMinimized ? L"Yes" : L"No");
+    m_properties.Add(L"Maximized", m_windowInfo.isMaximized ? L"Yes" : L"No");
+    m_properties.Add(L"Topmost", m_windowInfo.isTopMost ? L"Yes" : L"No");
+    m_properties.Add(L"Cloaked (hidden)", m_windowInfo.isCloaked ? L"Yes" : L"No");
+    m_properties.Add(L"UWP App", m_windowInfo.isUWP ? L"Yes" : L"No");
+    m_properties.Add(L"Hung", m_windowInfo.isHung ? L"Yes" : L"No");
 
-    swprintf_s(buffer, L"%d", m_windowInfo.zOrder);
-    AddDetailItem(m_hListView, L"Z-Order", buffer);
+    m_properties.Add(L"Z-Order", FormatNumber(DETAIL_ZORDER, m_windowInfo.zOrder));
 
     // Layered window info
     if (m_windowInfo.isLayered) {
-        AddDetailItem(m_hListView, L"", L"--- Transparency ---");
-        AddDetailItem(m_hListView, L"Layered", L"Yes");
-
-        swprintf_s(buffer, L"%d (%.1f%%)", m_windowInfo.alpha, (m_windowInfo.alpha / 255.0f) * 100.0f);
-        AddDetailItem(m_hListView, L"Alpha", buffer);
-
-        AddDetailItem(m_hListView, L"Transparent (mouse clicks)", m_windowInfo.isTransparent ? L"Yes" : L"No");
+        m_properties.AddSection(L"--- Transparency ---");
+        m_properties.Add(L"Layered", L"Yes");
+
+        BYTE alpha = m_windowInfo.alpha;
+        m_properties.Add(L"Alpha",
+            m_detailText[DETAIL_ALPHA].Get(alpha, [alpha](std::wstring& text) {
+                // Percentage to one decimal, rounded (never a tie for n/255)
+                unsigned tenths = (alpha * 1000u + 127u) / 255u;
+                TextFormat::AppendUnsigned(text, alpha);
+                text += L" (";
+                TextFormat::AppendUnsigned(text, tenths / 10);
+                text += L'.';
+                TextFormat::AppendUnsigned(text, tenths % 10);
+                text += L"%)";
+            }).c_str());
+
+        m_properties.Add(L"Transparent (mouse clicks)", m_windowInfo.isTransparent ? L"Yes" : L"No");
     }
 
     // Styles
-    AddDetailItem(m_hListView, L"", L"--- Styles ---");
+    m_properties.AddSection(L"--- Styles ---");
 
-    swprintf_s(buffer, L"0x%08X", m_windowInfo.style);
-    AddDetailItem(m_hListView, L"Style (hex)", buffer);
+    m_properties.Add(L"Style (hex)", FormatStyle(DETAIL_STYLE_HEX, m_windowInfo.style));
 
-    std::wstring styleStr = m_windowInfo.GetStyleString();
+    const std::wstring& styleStr = m_detailText[DETAIL_STYLE_FLAGS].Get(m_windowInfo.style,
+        [this](std::wstring& text) { text = m_windowInfo.GetStyleString(); });
     if (!styleStr.empty()) {
-        AddDetailItem(m_hListView, L"Style (Flags)", styleStr.c_str());
+        m_properties.Add(L"Style (Flags)", styleStr.c_str());
     }
 
-    swprintf_s(buffer, L"0x%08X", m_windowInfo.exStyle);
-    AddDetailItem(m_hListView, L"ExStyle (hex)", buffer);
+    m_properties.Add(L"ExStyle (hex)", FormatStyle(DETAIL_EXSTYLE_HEX, m_windowInfo.exStyle));
 
-    std::wstring exStyleStr = m_windowInfo.GetExStyleString();
+    const std::wstring& exStyleStr = m_detailText[DETAIL_EXSTYLE_FLAGS].Get(m_windowInfo.exStyle,
+        [this](std::wstring& text) { text = m_windowInfo.GetExStyleString(); });
     if (!exStyleStr.empty()) {
-        AddDetailItem(m_hListView, L"ExStyle (Flags)", exStyleStr.c_str());
+        m_properties.Add(L"ExStyle (Flags)", exStyleStr.c_str());
     }
 
     // Classification
-    AddDetailItem(m_hListView, L"", L"--- Classification ---");
-    AddDetailItem(m_hListView, L"System Window", m_windowInfo.IsSystemWindow() ? L"Yes" : L"No");
-    AddDetailItem(m_hListView, L"Hidden Window", m_windowInfo.IsHiddenWindow() ? L"Yes" : L"No");
+    m_properties.AddSection(L"--- Classification ---");
+    m_properties.Add(L"System Window", m_windowInfo.IsSystemWindow() ? L"Yes" : L"No");
+    m_properties.Add(L"Hidden Window", m_windowInfo.IsHiddenWindow() ? L"Yes" : L"No");
+
+    m_properties.End();
+    ApplyDetailEdits();
+
+    // Only touch the value cells that changed, so scroll position, selection
+    // and focus are left alone
+    for (size_t row : m_properties.ChangedRows()) {
+        ListView_SetItemText(m_hListView, static_cast<int>(row), 1,
+            const_cast<wchar_t*>(m_properties.Row(row).value.c_str()));
+    }
+}
+
+void DetailDialog::ApplyDetailEdits() {
+    // Rows that appeared or went away (the first fill, or a conditional
+    // section such as Transparency or DWM) are inserted and deleted where
+    // they are; every other item, and with it the scroll position and
+    // selection, stays as it was
+    const std::vector<PropertyEdit>& edits = m_properties.Edits();
+    if (edits.empty()) {
+        return;
+    }
+
+    SendMessageW(m_hListView, WM_SETREDRAW, FALSE, 0);
+    for (const PropertyEdit& edit : edits) {
+        int index = static_cast<int>(edit.index);
+        if (edit.kind == PropertyEdit::INSERT) {
+            const PropertyRow& row = m_properties.Row(edit.index);
+            InsertDetailItem(m_hListView, index, row.name.c_str(), row.value.c_str());
+        } else {
+            ListView_DeleteItem(m_hListView, index);
+        }
+    }
+    SendMessageW(m_hListView, WM_SETREDRAW, TRUE, 0);
+}
+
+const wchar_t* DetailDialog::FormatPointer(int field, const void* value) {
+    uint64_t source = static_cast<uint64_t>(reinterpret_cast<uintptr_t>(value));
+    return m_detailText[field].Get(source, [source](std::wstring& text) {
+        text += L"0x";
+        TextFormat::AppendHex(text, source, static_cast<int>(sizeof(void*) * 2));
+    }).c_str();
+}
+
+const wchar_t* DetailDialog::FormatNumber(int field, int64_t value) {
+    return m_detailText[field].Get(static_cast<uint64_t>(value), [value](std::wstring& text) {
+        TextFormat::AppendSigned(text, value);
+    }).c_str();
+}
+
+const wchar_t* DetailDialog::FormatStyle(int field, DWORD style) {
+    return m_detailText[field].Get(style, [style](std::wstring& text) {
+        text += L"0x";
+        TextFormat::AppendHex(text, style, 8);
+    }).c_str();
+}
+
+const wchar_t* DetailDialog::FormatRect(int field, const RECT& rc) {
+    // All four coordinates are the source, so no two rectangles share text
+    uint64_t topLeft = TextFormat::PackPair(rc.left, rc.top);
+    uint64_t bottomRight = TextFormat::PackPair(rc.right, rc.bottom);
+    return m_detailText[field].Get(topLeft, bottomRight, [&rc](std::wstring& text) {
+        text += L"Left: ";
+        TextFormat::AppendSigned(text, rc.left);
+        text += L", Top: ";
+        TextFormat::AppendSigned(text, rc.top);
+        text += L", Right: ";
+        TextFormat::AppendSigned(text, rc.right);
+        text += L", Bottom: ";
+        TextFormat::AppendSigned(text, rc.bottom);
+    }).c_str();
 }
 
 void DetailDialog::PopulateModifyTab(HWND hwnd) {
@@ -663,16 +747,16 @@ void DetailDialog::PopulateModifyTab(HWND hwnd) {
 
     // Set position/size
     wchar_t buffer[32];
-    swprintf_s(buffer, L"%d", m_windowInfo.rect.left);
+    TextFormat::Signed(buffer, m_windowInfo.rect.left);
     SetWindowTextW(m_hEditLeft, buffer);
 
-    swprintf_s(buffer, L"%d", m_windowInfo.rect.top);
+    TextFormat::Signed(buffer, m_windowInfo.rect.top);
     SetWindowTextW(m_hEditTop, buffer);
 
-    swprintf_s(buffer, L"%d", m_windowInfo.rect.right - m_windowInfo.rect.left);
+    TextFormat::Signed(buffer, m_windowInfo.rect.right - m_windowInfo.rect.left);
     SetWindowTextW(m_hEditWidth, buffer);
 
-    swprintf_s(buffer, L"%d", m_windowInfo.rect.bottom - m_windowInfo.rect.top);
+    TextFormat::Signed(buffer, m_windowInfo.rect.bottom - m_windowInfo.rect.top);
     SetWindowTextW(m_hEditHeight, buffer);
 
     // Set state checkboxes
@@ -683,13 +767,11 @@ void DetailDialog::PopulateModifyTab(HWND hwnd) {
     // Set alpha
     BYTE alpha = m_windowInfo.isLayered ? m_windowInfo.alpha : 255;
     SendMessageW(m_hSliderAlpha, TBM_SETPOS, TRUE, alpha);
-    swprintf_s(buffer, L"%d", alpha);
+    TextFormat::Signed(buffer, alpha);
     SetWindowTextW(m_hEditAlpha, buffer);
 }
 
-void DetailDialog::AddDetailItem(HWND hListView, const wchar_t* property, const wchar_t* value) {
-    int index = ListView_GetItemCount(hListView);
-
+void DetailDialog::InsertDetailItem(HWND hListView, int index, const wchar_t* property, const wchar_t* value) {
     LVITEMW item = {};
     item.mask = LVIF_TEXT;
     item.iItem = index;
@@ -865,19 +947,12 @@ void DetailDialog::SetWindowAlpha(HWND hwnd) {
     if (alpha < 0) alpha = 0;
     if (alpha > 255) alpha = 255;
 
-    // Get current extended style
-    LONG_PTR exStyle = GetWindowLongPtrW(m_windowInfo.hwnd, GWL_EXSTYLE);
-
+    // Fades from the current alpha; the animator makes the window layered on
+    // the way down and removes the layered style once it is fully opaque
+    m_animator.FadeTo(m_windowInfo, static_cast<BYTE>(alpha), ALPHA_FADE_DURATION);
     if (alpha == 255) {
-        // Remove layered style if fully opaque
-        SetWindowLongPtrW(m_windowInfo.hwnd, GWL_EXSTYLE, exStyle & ~WS_EX_LAYERED);
         m_windowInfo.isLayered = false;
     } else {
-        // Add layered style and set alpha
-        if (!(exStyle & WS_EX_LAYERED)) {
-            SetWindowLongPtrW(m_windowInfo.hwnd, GWL_EXSTYLE, exStyle | WS_EX_LAYERED);
-        }
-        SetLayeredWindowAttributes(m_windowInfo.hwnd, 0, static_cast<BYTE>(alpha), LWA_ALPHA);
         m_windowInfo.isLayered = true;
         m_windowInfo.alpha = static_cast<BYTE>(alpha);
     }
@@ -924,33 +999,51 @@ void DetailDialog::RefreshWindowInfo(HWND hwnd) {
         return;
     }
 
-    // Save scroll position and selection
-    int topIndex = ListView_GetTopIndex(m_hListView);
-    int selectedItem = ListView_GetNextItem(m_hListView, -1, LVNI_SELECTED);
-
     // Re-gather window information
     m_windowInfo = WindowEnumerator::GetWindowDetails(m_windowInfo.hwnd);
 
     // Update dialog title
+    UpdateDialogTitle(hwnd);
+
+    // Update both tabs
+    PopulateDetails(hwnd);
+    PopulateModifyTab(hwnd);
+
+    m_cadence.Reset(GetTickCount64());
+}
+
+void DetailDialog::RefreshVolatileInfo(HWND hwnd) {
+    // Fast path for tracking a window that is being moved or resized: the
+    // process, class and icon are left as they were at the last full refresh.
+    // The Modify tab is left alone so its edits are not overwritten mid-typing.
+    WindowEnumerator::RefreshVolatileDetails(m_windowInfo);
+
+    UpdateDialogTitle(hwnd);
+    PopulateDetails(hwnd);
+}
+
+void DetailDialog::UpdateDialogTitle(HWND hwnd) {
     std::wstring title = L"Window Details: ";
     if (!m_windowInfo.title.empty()) {
         title += m_windowInfo.title;
     } else {
         title += L"(no title)";
     }
-    SetWindowTextW(hwnd, title.c_str());
-
-    // Update both tabs
-    PopulateDetails(hwnd);
-    PopulateModifyTab(hwnd);
 
-    // Restore scroll position and selection
-    if (topIndex > 0) {
-        ListView_EnsureVisible(m_hListView, ListView_GetItemCount(m_hListView) - 1, FALSE);
-        ListView_EnsureVisible(m_hListView, topIndex, FALSE);
+    if (title != m_dialogTitle) {
+        SetWindowTextW(hwnd, title.c_str());
+        m_dialogTitle = std::move(title);
     }
-    if (selectedItem >= 0 && selectedItem < ListView_GetItemCount(m_hListView)) {
-        ListView_SetItemState(m_hListView, selectedItem, LVIS_SELECTED | LVIS_FOCUSED, LVIS_SELECTED | LVIS_FOCUSED);
+}
+
+void DetailDialog::RestartRefreshTimer(HWND hwnd) {
+    KillTimer(hwnd, TIMER_REFRESH);
+    if (m_fastRefresh) {
+        m_cadence.SetIntervals(FAST_REFRESH_INTERVAL, static_cast<uint32_t>(m_refreshInterval));
+        m_cadence.Reset(GetTickCount64());
+        SetTimer(hwnd, TIMER_REFRESH, FAST_REFRESH_INTERVAL, nullptr);
+    } else {
+        SetTimer(hwnd, TIMER_REFRESH, m_refreshInterval, nullptr);
     }
 }
 
@@ -961,42 +1054,12 @@ void DetailDialog::OnAlphaSliderChanged(HWND hwnd) {
     SetWindowTextW(m_hEditAlpha, buffer);
 }
 
-void DetailDialog::CopyToClipboard(HWND hwnd) {
+void DetailDialog::CopyToClipboard(HWND hwnd, PropertyExportFormat format) {
     if (!m_hListView) return;
 
-    std::wstringstream ss;
-    int count = ListView_GetItemCount(m_hListView);
-
-    for (int i = 0; i < count; i++) {
-        wchar_t prop[256] = {};
-        wchar_t val[512] = {};
-
-        ListView_GetItemText(m_hListView, i, 0, prop, 256);
-        ListView_GetItemText(m_hListView, i, 1, val, 512);
-
-        if (prop[0] != L'\0' || val[0] != L'\0') {
-            ss << prop << L"\t" << val << L"\r\n";
-        }
-    }
-
-    std::wstring text = ss.str();
-
-    if (OpenClipboard(hwnd)) {
-        EmptyClipboard();
-
-        size_t size = (text.length() + 1) * sizeof(wchar_t);
-        HGLOBAL hMem = GlobalAlloc(GMEM_MOVEABLE, size);
-        if (hMem) {
-            wchar_t* pMem = static_cast<wchar_t*>(GlobalLock(hMem));
-            if (pMem) {
-                wcscpy_s(pMem, text.length() + 1, text.c_str());
-                GlobalUnlock(hMem);
-                SetClipboardData(CF_UNICODETEXT, hMem);
-            }
-        }
-
-        CloseClipboard();
-
+    // Exported from the property model rather than read back from the list
+    // view, so nothing is truncated
+    if (Clipboard::SetExport(hwnd, m_properties, format)) {
         MessageBoxW(hwnd, L"Details have been copied to clipboard.",
             L"Copied", MB_OK | MB_ICONINFORMATION);
     }
@@ -1006,53 +1069,48 @@ void DetailDialog::ShowContextMenu(HWND hwnd, int x, int y) {
     if (!m_hListView) return;
 
     int sel = ListView_GetNextItem(m_hListView, -1, LVNI_SELECTED);
-    if (sel < 0) return;
-
-    wchar_t prop[256] = {};
-    wchar_t val[512] = {};
-    ListView_GetItemText(m_hListView, sel, 0, prop, 256);
-    ListView_GetItemText(m_hListView, sel, 1, val, 512);
+    bool hasRow = sel >= 0 && static_cast<size_t>(sel) < m_properties.Count();
+    UINT rowFlags = MF_STRING | (hasRow ? 0 : MF_GRAYED);
 
     HMENU hMenu = CreatePopupMenu();
-    AppendMenuW(hMenu, MF_STRING, IDM_DETAIL_COPY_PROP, L"Copy Property");
-    AppendMenuW(hMenu, MF_STRING, IDM_DETAIL_COPY_VALUE, L"Copy Value");
-    AppendMenuW(hMenu, MF_STRING, IDM_DETAIL_COPY_BOTH, L"Copy Both");
+    AppendMenuW(hMenu, rowFlags, IDM_DETAIL_COPY_PROP, L"Copy Property");
+    AppendMenuW(hMenu, rowFlags, IDM_DETAIL_COPY_VALUE, L"Copy Value");
+    AppendMenuW(hMenu, rowFlags, IDM_DETAIL_COPY_BOTH, L"Copy Both");
+    AppendMenuW(hMenu, MF_SEPARATOR, 0, nullptr);
+    AppendMenuW(hMenu, MF_STRING, IDM_DETAIL_COPY_TSV, L"Copy All as Text");
+    AppendMenuW(hMenu, MF_STRING, IDM_DETAIL_COPY_JSON, L"Copy All as JSON");
+    AppendMenuW(hMenu, MF_STRING, IDM_DETAIL_COPY_MARKDOWN, L"Copy All as Markdown");
 
     int cmd = TrackPopupMenu(hMenu, TPM_RETURNCMD | TPM_NONOTIFY, x, y, 0, hwnd, nullptr);
     DestroyMenu(hMenu);
 
     switch (cmd) {
     case IDM_DETAIL_COPY_PROP:
-        CopyTextToClipboard(hwnd, prop);
+        CopyTextToClipboard(hwnd, m_properties.Row(sel).name);
         break;
     case IDM_DETAIL_COPY_VALUE:
-        CopyTextToClipboard(hwnd, val);
+        CopyTextToClipboard(hwnd, m_properties.Row(sel).value);
         break;
     case IDM_DETAIL_COPY_BOTH: {
-        std::wstring both = prop;
+        const PropertyRow& row = m_properties.Row(sel);
+        std::wstring both = row.name;
         both += L"\t";
-        both += val;
+        both += row.value;
         CopyTextToClipboard(hwnd, both);
         break;
     }
+    case IDM_DETAIL_COPY_TSV:
+        CopyToClipboard(hwnd, EXPORT_TSV);
+        break;
+    case IDM_DETAIL_COPY_JSON:
+        CopyToClipboard(hwnd, EXPORT_JSON);
+        break;
+    case IDM_DETAIL_COPY_MARKDOWN:
+        CopyToClipboard(hwnd, EXPORT_MARKDOWN);
+        break;
     }
 }
 
 void DetailDialog::CopyTextToClipboard(HWND hwnd, const std::wstring& text) {
-    if (OpenClipboard(hwnd)) {
-        EmptyClipboard();
-
-        size_t size = (text.length() + 1) * sizeof(wchar_t);
-        HGLOBAL hMem = GlobalAlloc(GMEM_MOVEABLE, size);
-        if (hMem) {
-            wchar_t* pMem = static_cast<wchar_t*>(GlobalLock(hMem));
-            if (pMem) {
-                wcscpy_s(pMem, text.length() + 1, text.c_str());
-                GlobalUnlock(hMem);
-                SetClipboardData(CF_UNICODETEXT, hMem);
-            }
-        }
-
-        CloseClipboard();
-    }
+    Clipboard::SetText(hwnd, text);
 }
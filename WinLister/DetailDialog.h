@@ -5,10 +5,15 @@
 #include <Windows.h>
 #include <CommCtrl.h>
 #include "WindowInfo.h"
+#include "TextFormat.h"
+#include "PropertyExport.h"
+#include "RefreshCadence.h"
+#include "WindowAnimation.h"
 
 class DetailDialog {
 public:
-    DetailDialog(HWND hwndParent, const WindowInfo& windowInfo);
+    // Alpha changes fade in through the owner's animator
+    DetailDialog(HWND hwndParent, const WindowInfo& windowInfo, WindowAnimator& animator);
     void Show();
 
 private:
@@ -19,9 +24,16 @@ private:
     void CreateTabControl(HWND hwnd);
     void CreateModifyControls(HWND hwnd);
     void PopulateDetails(HWND hwnd);
+    void ApplyDetailEdits();
     void PopulateModifyTab(HWND hwnd);
-    void AddDetailItem(HWND hListView, const wchar_t* property, const wchar_t* value);
-    void CopyToClipboard(HWND hwnd);
+    void InsertDetailItem(HWND hListView, int index, const wchar_t* property, const wchar_t* value);
+
+    // Cached detail value formatting, re-formatted only when the value changes
+    const wchar_t* FormatPointer(int field, const void* value);
+    const wchar_t* FormatNumber(int field, int64_t value);
+    const wchar_t* FormatStyle(int field, DWORD style);
+    const wchar_t* FormatRect(int field, const RECT& rc);
+    void CopyToClipboard(HWND hwnd, PropertyExportFormat format);
     void ShowContextMenu(HWND hwnd, int x, int y);
     void CopyTextToClipboard(HWND hwnd, const std::wstring& text);
 
@@ -39,12 +51,37 @@ private:
     void MaximizeWindow(HWND hwnd);
     void RestoreWindow(HWND hwnd);
     void RefreshWindowInfo(HWND hwnd);
+    void RefreshVolatileInfo(HWND hwnd);
+    void UpdateDialogTitle(HWND hwnd);
+    void RestartRefreshTimer(HWND hwnd);
     void OnAlphaSliderChanged(HWND hwnd);
 
     bool IsTargetWindowValid();
 
+    enum DetailText {
+        DETAIL_HWND,
+        DETAIL_PARENT,
+        DETAIL_OWNER,
+        DETAIL_PID,
+        DETAIL_TID,
+        DETAIL_RECT,
+        DETAIL_SIZE,
+        DETAIL_CLIENT,
+        DETAIL_DWM_FRAME,
+        DETAIL_ZORDER,
+        DETAIL_ALPHA,
+        DETAIL_STYLE_HEX,
+        DETAIL_STYLE_FLAGS,
+        DETAIL_EXSTYLE_HEX,
+        DETAIL_EXSTYLE_FLAGS,
+        DETAIL_TEXT_COUNT
+    };
+
     HWND m_hwndParent;
     WindowInfo m_windowInfo;
+    WindowAnimator& m_animator;
+    CachedText m_detailText[DETAIL_TEXT_COUNT];
+    PropertyModel m_properties;
 
     // Tab control
     HWND m_hTabControl = nullptr;
@@ -79,8 +116,17 @@ private:
     HWND m_hCheckAutoRefresh = nullptr;
     HWND m_hEditRefreshTime = nullptr;
     HWND m_hStaticMs = nullptr;
+    HWND m_hCheckFastRefresh = nullptr;
     bool m_autoRefresh = false;
     int m_refreshInterval = 1000;
 
+    // Fast mode polls volatile properties every FAST_REFRESH_INTERVAL ms and
+    // does a full refresh every m_refreshInterval ms
+    bool m_fastRefresh = false;
+    RefreshCadence m_cadence{ FAST_REFRESH_INTERVAL, 1000 };
+    std::wstring m_dialogTitle;
+
     static const UINT_PTR TIMER_REFRESH = 1;
+    static const UINT FAST_REFRESH_INTERVAL = 33;
+    static const uint32_t ALPHA_FADE_DURATION = 250;    // ms
 };
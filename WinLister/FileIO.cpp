@@ -0,0 +1,236 @@
+#include "FileIO.h"
+#include <cstring>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <Windows.h>
+#else
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+FILE* FileIO::Open(const std::wstring& path, const char* mode) {
+#ifdef _WIN32
+    std::wstring wideMode(mode, mode + strlen(mode));
+    FILE* file = nullptr;
+    if (_wfopen_s(&file, path.c_str(), wideMode.c_str()) != 0) {
+        return nullptr;
+    }
+    return file;
+#else
+    return fopen(ToUtf8(path).c_str(), mode);
+#endif
+}
+
+bool FileIO::Remove(const std::wstring& path) {
+#ifdef _WIN32
+    return DeleteFileW(path.c_str()) != FALSE;
+#else
+    return unlink(ToUtf8(path).c_str()) == 0;
+#endif
+}
+
+bool FileIO::Exists(const std::wstring& path) {
+#ifdef _WIN32
+    return GetFileAttributesW(path.c_str()) != INVALID_FILE_ATTRIBUTES;
+#else
+    struct stat st = {};
+    return stat(ToUtf8(path).c_str(), &st) == 0;
+#endif
+}
+
+std::vector<std::wstring> FileIO::ListFiles(const std::wstring& directory) {
+    std::vector<std::wstring> names;
+#ifdef _WIN32
+    WIN32_FIND_DATAW data = {};
+    HANDLE find = FindFirstFileW((directory + L"\\*").c_str(), &data);
+    if (find == INVALID_HANDLE_VALUE) {
+        return names;
+    }
+    do {
+        if (!(data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY)) {
+            names.push_back(data.cFileName);
+        }
+    } while (FindNextFileW(find, &data));
+    FindClose(find);
+#else
+    std::string path = ToUtf8(directory);
+    DIR* dir = opendir(path.c_str());
+    if (!dir) {
+        return names;
+    }
+    while (const dirent* entry = readdir(dir)) {
+        struct stat st = {};
+        std::string full = path + "/" + entry->d_name;
+        if (stat(full.c_str(), &st) == 0 && S_ISREG(st.st_mode)) {
+            names.push_back(FromUtf8(entry->d_name, strlen(entry->d_name)));
+        }
+    }
+    closedir(dir);
+#endif
+    return names;
+}
+
+std::string FileIO::ToUtf8(const std::wstring& text) {
+    std::string result;
+    result.reserve(text.size());
+    for (size_t i = 0; i < text.size(); i++) {
+        uint32_t cp = static_cast<uint32_t>(text[i]);
+        if (cp >= 0xD800 && cp <= 0xDBFF && i + 1 < text.size()) {
+            uint32_t low = static_cast<uint32_t>(text[i + 1]);
+            if (low >= 0xDC00 && low <= 0xDFFF) {
+                cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+                i++;
+            }
+        }
+        if (cp >= 0xD800 && cp <= 0xDFFF) {
+            cp = 0xFFFD;
+        }
+
+        if (cp < 0x80) {
+            result.push_back(static_cast<char>(cp));
+        } else if (cp < 0x800) {
+            result.push_back(static_cast<char>(0xC0 | (cp >> 6)));
+            result.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+        } else if (cp < 0x10000) {
+            result.push_back(static_cast<char>(0xE0 | (cp >> 12)));
+            result.push_back(static_cast<char>(0x80 | ((cp >> 6) & 0x3F)));
+            result.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+        } else {
+            result.push_back(static_cast<char>(0xF0 | (cp >> 18)));
+            result.push_back(static_cast<char>(0x80 | ((cp >> 12) & 0x3F)));
+            result.push_back(static_cast<char>(0x80 | ((cp >> 6) & 0x3F)));
+            result.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+        }
+    }
+    return result;
+}
+
+std::wstring FileIO::FromUtf8(const char* text, size_t length) {
+    const uint8_t* data = reinterpret_cast<const uint8_t*>(text);
+    std::wstring result;
+    result.reserve(length);
+    size_t i = 0;
+    while (i < length) {
+        uint32_t b = data[i];
+        uint32_t cp;
+        size_t extra;
+        if (b < 0x80) {
+            cp = b;
+            extra = 0;
+        } else if ((b & 0xE0) == 0xC0) {
+            cp = b & 0x1F;
+            extra = 1;
+        } else if ((b & 0xF0) == 0xE0) {
+            cp = b & 0x0F;
+            extra = 2;
+        } else if ((b & 0xF8) == 0xF0) {
+            cp = b & 0x07;
+            extra = 3;
+        } else {
+            result.push_back(static_cast<wchar_t>(0xFFFD));
+            i++;
+            continue;
+        }
+
+        size_t n = 1;
+        while (n <= extra && i + n < length && (data[i + n] & 0xC0) == 0x80) {
+            cp = (cp << 6) | (data[i + n] & 0x3F);
+            n++;
+        }
+        i += n;
+        if (n <= extra || cp > 0x10FFFF || (cp >= 0xD800 && cp <= 0xDFFF)) {
+            result.push_back(static_cast<wchar_t>(0xFFFD));
+        } else if (cp >= 0x10000 && sizeof(wchar_t) == 2) {
+            cp -= 0x10000;
+            result.push_back(static_cast<wchar_t>(0xD800 + (cp >> 10)));
+            result.push_back(static_cast<wchar_t>(0xDC00 + (cp & 0x3FF)));
+        } else {
+            result.push_back(static_cast<wchar_t>(cp));
+        }
+    }
+    return result;
+}
+
+MappedFile::~MappedFile() {
+    Close();
+}
+
+bool MappedFile::Open(const std::wstring& path) {
+    Close();
+
+#ifdef _WIN32
+    HANDLE hFile = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr,
+        OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (hFile == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+
+    LARGE_INTEGER fileSize = {};
+    if (!GetFileSizeEx(hFile, &fileSize) || fileSize.QuadPart == 0 ||
+        static_cast<uint64_t>(fileSize.QuadPart) > SIZE_MAX) {
+        CloseHandle(hFile);
+        return false;
+    }
+
+    HANDLE hMapping = CreateFileMappingW(hFile, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!hMapping) {
+        CloseHandle(hFile);
+        return false;
+    }
+
+    const void* view = MapViewOfFile(hMapping, FILE_MAP_READ, 0, 0, 0);
+    if (!view) {
+        CloseHandle(hMapping);
+        CloseHandle(hFile);
+        return false;
+    }
+
+    m_file = hFile;
+    m_mapping = hMapping;
+    m_data = static_cast<const uint8_t*>(view);
+    m_size = static_cast<size_t>(fileSize.QuadPart);
+#else
+    int fd = open(FileIO::ToUtf8(path).c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+
+    struct stat st = {};
+    if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+        close(fd);
+        return false;
+    }
+
+    void* view = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (view == MAP_FAILED) {
+        return false;
+    }
+
+    m_data = static_cast<const uint8_t*>(view);
+    m_size = static_cast<size_t>(st.st_size);
+#endif
+    return true;
+}
+
+void MappedFile::Close() {
+    if (m_data) {
+#ifdef _WIN32
+        UnmapViewOfFile(m_data);
+        CloseHandle(static_cast<HANDLE>(m_mapping));
+        CloseHandle(static_cast<HANDLE>(m_file));
+#else
+        munmap(const_cast<uint8_t*>(m_data), m_size);
+#endif
+    }
+
+    m_data = nullptr;
+    m_size = 0;
+    m_file = nullptr;
+    m_mapping = nullptr;
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+// File helpers shared by the snapshot and recording code, which also builds
+// on POSIX for offline tools. Paths are UTF-16 everywhere; on POSIX they are
+// converted to UTF-8.
+class FileIO {
+public:
+    // fopen with a wide path; returns nullptr on failure
+    static FILE* Open(const std::wstring& path, const char* mode);
+    static bool Remove(const std::wstring& path);
+    static bool Exists(const std::wstring& path);
+    // Names of the files directly in a directory; empty if it cannot be read
+    static std::vector<std::wstring> ListFiles(const std::wstring& directory);
+    static std::string ToUtf8(const std::wstring& text);
+    // Malformed sequences become U+FFFD
+    static std::wstring FromUtf8(const char* text, size_t length);
+};
+
+// Read-only memory mapping of a whole file
+class MappedFile {
+public:
+    MappedFile() = default;
+    ~MappedFile();
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    // Fails for missing or empty files
+    bool Open(const std::wstring& path);
+    void Close();
+
+    bool IsOpen() const { return m_data != nullptr; }
+    const uint8_t* Data() const { return m_data; }
+    size_t Size() const { return m_size; }
+
+private:
+    const uint8_t* m_data = nullptr;
+    size_t m_size = 0;
+
+    // Platform handles: file and mapping on Windows, unused on POSIX
+    void* m_file = nullptr;
+    void* m_mapping = nullptr;
+};
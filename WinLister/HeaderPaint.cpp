@@ -0,0 +1,38 @@
+#include "HeaderPaint.h"
+
+bool HeaderPaintState::Update(int width, int height, std::vector<HeaderItemState>&& items) {
+    if (m_valid && width == m_width && height == m_height && items == m_items) {
+        return false;
+    }
+    m_width = width;
+    m_height = height;
+    m_items = std::move(items);
+    m_valid = true;
+    return true;
+}
+
+HeaderItemGeometry HeaderPaintState::Layout(const HeaderItemState& item) {
+    HeaderItemGeometry geometry = {};
+
+    // Text inset, leaving room for the sort arrow on the right
+    geometry.textLeft = item.left + 6;
+    geometry.textTop = item.top;
+    geometry.textRight = item.right - 12;
+    geometry.textBottom = item.bottom;
+
+    if (item.sortDirection != 0) {
+        int cx = item.right - 12;
+        int cy = item.top + (item.bottom - item.top) / 2;
+        int tip = item.sortDirection > 0 ? -3 : 3;
+        int base = item.sortDirection > 0 ? 2 : -2;
+
+        geometry.hasArrow = true;
+        geometry.arrowX[0] = cx;
+        geometry.arrowY[0] = cy + tip;
+        geometry.arrowX[1] = cx + 4;
+        geometry.arrowY[1] = cy + base;
+        geometry.arrowX[2] = cx - 4;
+        geometry.arrowY[2] = cy + base;
+    }
+    return geometry;
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+// Layout and change tracking for the dark-mode list view header. The header is
+// rendered into a cached bitmap; this decides when that bitmap is stale and
+// where each item's text and sort arrow go.
+struct HeaderItemState {
+    int left;
+    int top;
+    int right;
+    int bottom;
+    int sortDirection;  // 0 = none, 1 = ascending, -1 = descending
+    std::wstring text;
+
+    bool operator==(const HeaderItemState& other) const {
+        return left == other.left && top == other.top && right == other.right &&
+               bottom == other.bottom && sortDirection == other.sortDirection &&
+               text == other.text;
+    }
+    bool operator!=(const HeaderItemState& other) const { return !(*this == other); }
+};
+
+struct HeaderItemGeometry {
+    int textLeft;
+    int textTop;
+    int textRight;
+    int textBottom;
+    bool hasArrow;
+    int arrowX[3];
+    int arrowY[3];
+};
+
+class HeaderPaintState {
+public:
+    // Records the header's current size and items. Returns true when they
+    // differ from what was last rendered (or after Invalidate), i.e. when the
+    // cached bitmap must be redrawn.
+    bool Update(int width, int height, std::vector<HeaderItemState>&& items);
+    void Invalidate() { m_valid = false; }
+
+    int Width() const { return m_width; }
+    int Height() const { return m_height; }
+    const std::vector<HeaderItemState>& Items() const { return m_items; }
+
+    static HeaderItemGeometry Layout(const HeaderItemState& item);
+
+private:
+    std::vector<HeaderItemState> m_items;
+    int m_width = 0;
+    int m_height = 0;
+    bool m_valid = false;
+};
@@ -0,0 +1,237 @@
+#include "HeadlessMode.h"
+#include "WindowFilter.h"
+#include "WindowWatch.h"
+#include "SnapshotFile.h"
+#include "SnapshotRecording.h"
+#include "WindowOcclusion.h"
+#include <chrono>
+#include <cstring>
+
+namespace {
+
+uint64_t UnixTimeMs() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count());
+}
+
+WindowFilter MakeFilter(const HeadlessOptions& options) {
+    WindowFilterOptions filterOptions;
+    filterOptions.hideHidden = options.hideHidden;
+    filterOptions.hideSystem = options.hideSystem;
+    return WindowFilter(filterOptions);
+}
+
+} // namespace
+
+int HeadlessRunner::Run(const std::vector<std::wstring>& args, WindowSource* live, ByteSink& out, ByteSink& err) {
+    HeadlessOptions options;
+    std::wstring error;
+    if (!CommandLine::Parse(args, options, error)) {
+        WriteError(err, error);
+        const char* usage = CommandLine::Usage();
+        err.Write(usage, strlen(usage));
+        return EXIT_USAGE;
+    }
+    return Run(options, live, out, err);
+}
+
+int HeadlessRunner::Run(const HeadlessOptions& options, WindowSource* live, ByteSink& out, ByteSink& err) {
+    if (options.command == HEADLESS_HELP) {
+        const char* usage = CommandLine::Usage();
+        return out.Write(usage, strlen(usage)) ? EXIT_OK : EXIT_FAILED;
+    }
+
+    // Parse the query before loading so typos fail fast
+    WindowQuery query;
+    std::wstring error;
+    if (!WindowQuery::Parse(options.query, query, error)) {
+        WriteError(err, error);
+        return EXIT_USAGE;
+    }
+    if (options.command == HEADLESS_WATCH) {
+        return Watch(options, query, live, out, err);
+    }
+
+    // A snapshot file is selected on its columns, so only matches are built;
+    // each window's monitor depends only on its own frame, so it is placed
+    // after selecting
+    std::vector<WindowInfo> windows;
+    if (!options.input.empty() && SelectSnapshotRows(options, query, windows)) {
+        if (!PlaceOnMonitors(windows, options, live, error)) {
+            WriteError(err, error);
+            return EXIT_FAILED;
+        }
+        if (!WriteSorted(windows, options, out)) {
+            WriteError(err, L"Writing the output failed");
+            return EXIT_FAILED;
+        }
+        return EXIT_OK;
+    }
+
+    if (!options.input.empty()) {
+        if (!LoadInput(options, windows, error)) {
+            WriteError(err, error);
+            return EXIT_FAILED;
+        }
+    } else if (!live) {
+        WriteError(err, L"Live windows are not available here; use --input");
+        return EXIT_FAILED;
+    } else if (!live->Load(windows, error)) {
+        WriteError(err, error);
+        return EXIT_FAILED;
+    }
+    if (!PlaceOnMonitors(windows, options, live, error)) {
+        WriteError(err, error);
+        return EXIT_FAILED;
+    }
+
+    if (!WriteSelection(windows, options, query, out)) {
+        WriteError(err, L"Writing the output failed");
+        return EXIT_FAILED;
+    }
+    return EXIT_OK;
+}
+
+bool HeadlessRunner::WriteSelection(const std::vector<WindowInfo>& windows, const HeadlessOptions& options,
+    const WindowQuery& query, ByteSink& out) {
+    // Exposure depends on every window above, so it is measured before
+    // selecting, and only when it is sorted on
+    std::vector<WindowInfo> measured;
+    const std::vector<WindowInfo>* source = &windows;
+    if (options.sort.Find(COLUMN_EXPOSED)) {
+        measured = windows;
+        OcclusionEngine::Compute(measured);
+        source = &measured;
+    }
+
+    // Copy out the matches, keeping z-order, then sort what is left
+    WindowFilter filter = MakeFilter(options);
+    std::vector<WindowInfo> selected;
+    for (const WindowInfo& win : *source) {
+        if (filter.Matches(win) && query.Matches(win)) {
+            selected.push_back(win);
+        }
+    }
+    return WriteSorted(selected, options, out);
+}
+
+bool HeadlessRunner::SelectSnapshotRows(const HeadlessOptions& options, const WindowQuery& query,
+    std::vector<WindowInfo>& selected) {
+    WindowFilter filter = MakeFilter(options);
+    if (options.sort.Find(COLUMN_EXPOSED) || filter.NeedsAnalysis()) {
+        return false;
+    }
+    SnapshotFileReader snapshot;
+    if (!snapshot.Open(options.input)) {
+        return false;
+    }
+
+    selected.clear();
+    for (size_t row = 0; row < snapshot.RowCount(); row++) {
+        if (filter.Matches(snapshot, row) && query.Matches(snapshot, row)) {
+            selected.push_back(snapshot.Row(row));
+        }
+    }
+    return true;
+}
+
+bool HeadlessRunner::WriteSorted(std::vector<WindowInfo>& selected, const HeadlessOptions& options, ByteSink& out) {
+    if (!options.sort.IsEmpty()) {
+        WindowSorter::Sort(selected, options.sort);
+    }
+    return SnapshotExporter::Write(selected, options.format, out);
+}
+
+bool HeadlessRunner::PlaceOnMonitors(std::vector<WindowInfo>& windows, const HeadlessOptions& options,
+    WindowSource* live, std::wstring& error) {
+    if (!options.sort.Find(COLUMN_MONITOR)) {
+        return true;
+    }
+    // Snapshots and recordings are placed on the monitors attached now, as
+    // in the GUI
+    MonitorSource* monitors = live ? live->Monitors() : nullptr;
+    MonitorLayout layout;
+    if (!monitors || !layout.Load(*monitors)) {
+        error = L"--sort monitor needs the attached monitors, which are not available here";
+        return false;
+    }
+    layout.Assign(windows);
+    return true;
+}
+
+int HeadlessRunner::Watch(const HeadlessOptions& options, const WindowQuery& query, WindowSource* live, ByteSink& out, ByteSink& err) {
+    WindowWatcher watcher(options.watchFields, MakeFilter(options), query);
+    watcher.SetReportInitial(options.watchInitial);
+    // Events are batched in the writer and handed over once per snapshot
+    BufferedWriter writer(out);
+    std::vector<WindowInfo> windows;
+    std::wstring error;
+
+    if (!options.input.empty()) {
+        SnapshotReplay replay;
+        if (!replay.Open(options.input)) {
+            WriteError(err, L"Cannot read '" + options.input + L"' as a WinLister recording");
+            return EXIT_FAILED;
+        }
+        size_t first = options.hasTime ? replay.FindFrame(options.time) : 0;
+        for (size_t frame = first; frame < replay.FrameCount() && !writer.Failed(); frame++) {
+            if (!replay.SeekFrame(frame)) {
+                writer.Flush();
+                WriteError(err, L"The recording is damaged at frame " + std::to_wstring(frame));
+                return EXIT_FAILED;
+            }
+            windows = replay.Windows();
+            watcher.Update(windows, replay.FrameTime(frame), writer);
+        }
+    } else if (!live) {
+        WriteError(err, L"Live windows are not available here; use --input");
+        return EXIT_FAILED;
+    } else {
+        do {
+            if (!live->Load(windows, error)) {
+                writer.Flush();
+                WriteError(err, error);
+                return EXIT_FAILED;
+            }
+            watcher.Update(windows, UnixTimeMs(), writer);
+            // Stop once the reader has gone away
+            if (!writer.Flush()) break;
+        } while (live->WaitForChange(options.watchInterval));
+    }
+
+    if (!writer.Flush()) {
+        WriteError(err, L"Writing the output failed");
+        return EXIT_FAILED;
+    }
+    return EXIT_OK;
+}
+
+bool HeadlessRunner::LoadInput(const HeadlessOptions& options, std::vector<WindowInfo>& windows, std::wstring& error) {
+    SnapshotFileReader snapshot;
+    if (snapshot.Open(options.input)) {
+        snapshot.Materialize(windows);
+        return true;
+    }
+
+    SnapshotReplay replay;
+    if (replay.Open(options.input)) {
+        size_t frame = options.hasTime ? replay.FindFrame(options.time) : replay.FrameCount() - 1;
+        if (!replay.SeekFrame(frame)) {
+            error = L"The recording is damaged at the requested time";
+            return false;
+        }
+        windows = replay.Windows();
+        return true;
+    }
+
+    error = L"Cannot read '" + options.input + L"' as a WinLister snapshot or recording";
+    return false;
+}
+
+void HeadlessRunner::WriteError(ByteSink& err, const std::wstring& message) {
+    BufferedWriter writer(err, 512);
+    writer.PutLiteral("WinLister: ");
+    writer.PutUtf8(message.c_str(), message.size());
+    writer.Put('\n');
+    writer.Flush();
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "WindowInfo.h"
+#include "WindowMonitor.h"
+#include "BufferedWriter.h"
+#include "CommandLine.h"
+#include "WindowQuery.h"
+
+// Supplies the live window list to the headless pipeline; the Win32 entry
+// point enumerates, other builds have no live source
+class WindowSource {
+public:
+    virtual ~WindowSource() = default;
+    virtual bool Load(std::vector<WindowInfo>& windows, std::wstring& error) = 0;
+    // Blocks until the next watch snapshot is due: something changed or
+    // intervalMs passed. Returns false to end the watch.
+    virtual bool WaitForChange(uint32_t intervalMs) = 0;
+    // The attached monitors, for placing windows on them; null when the
+    // source has no display
+    virtual MonitorSource* Monitors() { return nullptr; }
+};
+
+// The headless pipeline: load (live, snapshot file or recording frame),
+// query, filter and sort with the GUI's engines, then stream the result in
+// the requested format. A watch diffs successive live snapshots, or every
+// frame of a recording, into a change feed. Returns the process exit code: 0 on success, 1 when
+// the source or output fails, 2 for usage errors.
+class HeadlessRunner {
+public:
+    static int Run(const std::vector<std::wstring>& args, WindowSource* live, ByteSink& out, ByteSink& err);
+    static int Run(const HeadlessOptions& options, WindowSource* live, ByteSink& out, ByteSink& err);
+
+    // Writes the windows that pass the options' filter and the query, sorted
+    // and in the options' format; shared with the query server, whose
+    // published windows are already placed on monitors
+    static bool WriteSelection(const std::vector<WindowInfo>& windows, const HeadlessOptions& options,
+        const WindowQuery& query, ByteSink& out);
+
+    // Reads a .wls snapshot, or the frame of a .wlr recording in effect at
+    // options.time (the last frame without one)
+    static bool LoadInput(const HeadlessOptions& options, std::vector<WindowInfo>& windows, std::wstring& error);
+
+    static const int EXIT_OK = 0;
+    static const int EXIT_FAILED = 1;
+    static const int EXIT_USAGE = 2;
+
+    // "WinLister: message" and a newline
+    static void WriteError(ByteSink& err, const std::wstring& message);
+
+private:
+    // Builds WindowInfo values only for the rows of a .wls snapshot that pass
+    // the filter and the query, testing them on the file's columns in place.
+    // False when the input is not a snapshot file or the selection needs
+    // every window (exposure, occlusion).
+    static bool SelectSnapshotRows(const HeadlessOptions& options, const WindowQuery& query,
+        std::vector<WindowInfo>& selected);
+    static bool WriteSorted(std::vector<WindowInfo>& selected, const HeadlessOptions& options, ByteSink& out);
+    // Places the windows on the live source's monitors when the sort reads
+    // them; false when there are none to place them on
+    static bool PlaceOnMonitors(std::vector<WindowInfo>& windows, const HeadlessOptions& options,
+        WindowSource* live, std::wstring& error);
+    static int Watch(const HeadlessOptions& options, const WindowQuery& query, WindowSource* live, ByteSink& out, ByteSink& err);
+};
@@ -0,0 +1,100 @@
+#include "IconRegistry.h"
+#include <algorithm>
+
+IconRegistry::IconRegistry(size_t maxSlots)
+    : m_maxSlots(maxSlots)
+{
+}
+
+void IconRegistry::AddReference(int slot) {
+    Slot& entry = m_slots[slot];
+    if (entry.refCount++ == 0) {
+        m_unreferenced.erase(entry.lruPos);
+        entry.lruPos = m_unreferenced.end();
+    }
+}
+
+int IconRegistry::AcquireHandle(uint64_t handle) {
+    auto it = m_byHandle.find(handle);
+    if (it == m_byHandle.end()) {
+        return -1;
+    }
+    AddReference(it->second);
+    return it->second;
+}
+
+int IconRegistry::Acquire(uint64_t handle, uint64_t contentHash, bool& needsImage) {
+    needsImage = false;
+
+    auto it = m_byContent.find(contentHash);
+    if (it != m_byContent.end()) {
+        int slot = it->second;
+        MapHandle(handle, slot);
+        AddReference(slot);
+        return slot;
+    }
+
+    int slot = AllocateSlot();
+    Slot& entry = m_slots[slot];
+    entry.contentHash = contentHash;
+    entry.handles.clear();
+    entry.refCount = 1;
+    entry.lruPos = m_unreferenced.end();
+    MapHandle(handle, slot);
+    m_byContent[contentHash] = slot;
+
+    needsImage = true;
+    return slot;
+}
+
+void IconRegistry::MapHandle(uint64_t handle, int slot) {
+    auto it = m_byHandle.find(handle);
+    if (it != m_byHandle.end()) {
+        if (it->second == slot) {
+            return;
+        }
+        // A recycled handle value now shows different content
+        auto& handles = m_slots[it->second].handles;
+        handles.erase(std::find(handles.begin(), handles.end(), handle));
+        it->second = slot;
+    } else {
+        m_byHandle.emplace(handle, slot);
+    }
+    m_slots[slot].handles.push_back(handle);
+}
+
+void IconRegistry::ForgetHandles(Slot& entry) {
+    for (uint64_t handle : entry.handles) {
+        m_byHandle.erase(handle);
+    }
+    entry.handles.clear();
+}
+
+int IconRegistry::AllocateSlot() {
+    if (m_slots.size() < m_maxSlots || m_unreferenced.empty()) {
+        m_slots.push_back(Slot());
+        return static_cast<int>(m_slots.size() - 1);
+    }
+
+    // Evict the least recently released slot and hand out its index
+    int slot = m_unreferenced.front();
+    m_unreferenced.pop_front();
+
+    Slot& entry = m_slots[slot];
+    ForgetHandles(entry);
+    m_byContent.erase(entry.contentHash);
+    return slot;
+}
+
+void IconRegistry::Release(int slot) {
+    if (slot < 0 || slot >= static_cast<int>(m_slots.size())) {
+        return;
+    }
+    Slot& entry = m_slots[slot];
+    if (entry.refCount > 0 && --entry.refCount == 0) {
+        entry.lruPos = m_unreferenced.insert(m_unreferenced.end(), slot);
+        // The icons may be destroyed now and their handle values reused;
+        // the content stays cached for the next icon with the same pixels
+        ForgetHandles(entry);
+    }
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <unordered_map>
+#include <vector>
+
+// Maps window icons to stable image-list slots across refreshes. An icon is
+// identified by its pixel-content hash, so different handles showing the same
+// picture share a slot; handles of icons in use are resolved without hashing.
+// Each row using a slot holds a reference. Unreferenced slots stay cached by
+// content and are reused least-recently-released first once the registry is
+// full; their handles are forgotten, since a freed HICON value can come back
+// as a different icon.
+class IconRegistry {
+public:
+    explicit IconRegistry(size_t maxSlots = 512);
+
+    // Adds a reference to the slot of a handle in use, or returns -1
+    int AcquireHandle(uint64_t handle);
+
+    // Adds a reference to the slot for an icon, allocating or recycling one if
+    // the content is new. needsImage is set when the caller must (re)load the
+    // icon image into the returned slot.
+    int Acquire(uint64_t handle, uint64_t contentHash, bool& needsImage);
+
+    void Release(int slot);
+
+    size_t SlotCount() const { return m_slots.size(); }
+    size_t ReferencedSlotCount() const { return m_slots.size() - m_unreferenced.size(); }
+
+private:
+    struct Slot {
+        uint64_t contentHash;
+        std::vector<uint64_t> handles;
+        int refCount;
+        std::list<int>::iterator lruPos;
+    };
+
+    int AllocateSlot();
+    void AddReference(int slot);
+    void MapHandle(uint64_t handle, int slot);
+    void ForgetHandles(Slot& entry);
+
+    size_t m_maxSlots;
+    std::vector<Slot> m_slots;
+    std::unordered_map<uint64_t, int> m_byHandle;
+    std::unordered_map<uint64_t, int> m_byContent;
+    std::list<int> m_unreferenced;  // Oldest release first
+};
@@ -0,0 +1,397 @@
+#include "LocalChannel.h"
+#include "FileIO.h"
+#include <cstring>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <Windows.h>
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+#endif
+
+#ifdef _WIN32
+
+namespace {
+
+const DWORD PIPE_BUFFER_SIZE = 64 * 1024;
+const DWORD MAX_TRANSFER = 1u << 30;
+
+HANDLE CreateInstance(const std::wstring& name, bool first) {
+    HANDLE pipe = CreateNamedPipeW(name.c_str(),
+        PIPE_ACCESS_DUPLEX | FILE_FLAG_OVERLAPPED | (first ? FILE_FLAG_FIRST_PIPE_INSTANCE : 0),
+        PIPE_TYPE_BYTE | PIPE_READMODE_BYTE | PIPE_WAIT | PIPE_REJECT_REMOTE_CLIENTS,
+        PIPE_UNLIMITED_INSTANCES, PIPE_BUFFER_SIZE, PIPE_BUFFER_SIZE, 0, nullptr);
+    return pipe == INVALID_HANDLE_VALUE ? nullptr : pipe;
+}
+
+// Waits for a pending operation or the cancel event. A cancelled operation
+// is aborted and drained before returning, so the OVERLAPPED can go.
+bool WaitOverlapped(HANDLE handle, HANDLE cancelEvent, OVERLAPPED& ov, DWORD& transferred) {
+    HANDLE events[2] = { ov.hEvent, cancelEvent };
+    DWORD result = WaitForMultipleObjects(2, events, FALSE, INFINITE);
+    if (result != WAIT_OBJECT_0) {
+        CancelIoEx(handle, &ov);
+        GetOverlappedResult(handle, &ov, &transferred, TRUE);
+        return false;
+    }
+    return GetOverlappedResult(handle, &ov, &transferred, FALSE) != FALSE;
+}
+
+} // namespace
+
+LocalStream::~LocalStream() {
+    Close();
+}
+
+bool LocalStream::Connect(const std::wstring& endpoint, unsigned timeoutMs) {
+    Close();
+    ULONGLONG deadline = GetTickCount64() + timeoutMs;
+    for (;;) {
+        // Identification only: the server cannot act as this client
+        HANDLE pipe = CreateFileW(endpoint.c_str(), GENERIC_READ | GENERIC_WRITE, 0, nullptr, OPEN_EXISTING,
+            FILE_FLAG_OVERLAPPED | SECURITY_SQOS_PRESENT | SECURITY_IDENTIFICATION, nullptr);
+        if (pipe != INVALID_HANDLE_VALUE) {
+            return Attach(pipe);
+        }
+        if (GetLastError() != ERROR_PIPE_BUSY) {
+            return false;
+        }
+        ULONGLONG now = GetTickCount64();
+        if (now >= deadline) {
+            return false;
+        }
+        WaitNamedPipeW(endpoint.c_str(), static_cast<DWORD>(deadline - now));
+    }
+}
+
+bool LocalStream::Attach(void* handle) {
+    m_handle = handle;
+    m_ioEvent = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+    m_cancelEvent = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+    if (!m_ioEvent || !m_cancelEvent) {
+        Close();
+        return false;
+    }
+    return true;
+}
+
+size_t LocalStream::Read(void* buffer, size_t capacity) {
+    if (!m_handle) {
+        return 0;
+    }
+    OVERLAPPED ov = {};
+    ov.hEvent = m_ioEvent;
+    DWORD transferred = 0;
+    DWORD request = static_cast<DWORD>(capacity < MAX_TRANSFER ? capacity : MAX_TRANSFER);
+    if (!ReadFile(m_handle, buffer, request, &transferred, &ov)) {
+        // A closed client shows up here as ERROR_BROKEN_PIPE
+        if (GetLastError() != ERROR_IO_PENDING || !WaitOverlapped(m_handle, m_cancelEvent, ov, transferred)) {
+            return 0;
+        }
+    }
+    return transferred;
+}
+
+bool LocalStream::Write(const void* data, size_t length) {
+    if (!m_handle) {
+        return false;
+    }
+    const char* p = static_cast<const char*>(data);
+    while (length > 0) {
+        OVERLAPPED ov = {};
+        ov.hEvent = m_ioEvent;
+        DWORD transferred = 0;
+        DWORD request = static_cast<DWORD>(length < MAX_TRANSFER ? length : MAX_TRANSFER);
+        if (!WriteFile(m_handle, p, request, &transferred, &ov)) {
+            if (GetLastError() != ERROR_IO_PENDING || !WaitOverlapped(m_handle, m_cancelEvent, ov, transferred)) {
+                return false;
+            }
+        }
+        if (transferred == 0) {
+            return false;
+        }
+        p += transferred;
+        length -= transferred;
+    }
+    return true;
+}
+
+void LocalStream::Cancel() {
+    if (m_cancelEvent) {
+        SetEvent(m_cancelEvent);
+    }
+}
+
+void LocalStream::Close() {
+    if (m_handle) {
+        CloseHandle(m_handle);
+        m_handle = nullptr;
+    }
+    if (m_ioEvent) {
+        CloseHandle(m_ioEvent);
+        m_ioEvent = nullptr;
+    }
+    if (m_cancelEvent) {
+        CloseHandle(m_cancelEvent);
+        m_cancelEvent = nullptr;
+    }
+}
+
+bool LocalStream::IsOpen() const {
+    return m_handle != nullptr;
+}
+
+LocalListener::~LocalListener() {
+    Close();
+}
+
+bool LocalListener::Open(const std::wstring& endpoint) {
+    Close();
+    m_endpoint = endpoint;
+    m_cancelled = false;
+    m_cancelEvent = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+    // The first instance claims the name, so no other process can squat on it
+    m_pending = CreateInstance(endpoint, true);
+    if (!m_cancelEvent || !m_pending) {
+        Close();
+        return false;
+    }
+    return true;
+}
+
+bool LocalListener::Accept(LocalStream& stream) {
+    stream.Close();
+    for (;;) {
+        if (m_cancelled) {
+            return false;
+        }
+        if (!m_pending) {
+            // Making the next instance failed after the last client; this
+            // retry is the one that reports it
+            m_pending = CreateInstance(m_endpoint, false);
+            if (!m_pending) {
+                return false;
+            }
+        }
+        HANDLE pipe = m_pending;
+        OVERLAPPED ov = {};
+        ov.hEvent = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+        if (!ov.hEvent) {
+            return false;
+        }
+        bool connected = ConnectNamedPipe(pipe, &ov) != FALSE;
+        DWORD error = connected ? ERROR_SUCCESS : GetLastError();
+        if (error == ERROR_PIPE_CONNECTED) {
+            connected = true;
+        } else if (error == ERROR_IO_PENDING) {
+            DWORD transferred = 0;
+            connected = WaitOverlapped(pipe, m_cancelEvent, ov, transferred);
+        }
+        CloseHandle(ov.hEvent);
+
+        if (connected) {
+            // Keep an instance waiting so the next client does not see a busy
+            // pipe; if that fails, the next Accept tries again
+            m_pending = CreateInstance(m_endpoint, false);
+            return stream.Attach(pipe);
+        }
+        if (m_cancelled || error != ERROR_NO_DATA) {
+            return false;
+        }
+        // The client left before it was accepted; reuse the instance
+        DisconnectNamedPipe(pipe);
+    }
+}
+
+void LocalListener::Cancel() {
+    m_cancelled = true;
+    if (m_cancelEvent) {
+        SetEvent(m_cancelEvent);
+    }
+}
+
+void LocalListener::Close() {
+    if (m_pending) {
+        CloseHandle(m_pending);
+        m_pending = nullptr;
+    }
+    if (m_cancelEvent) {
+        CloseHandle(m_cancelEvent);
+        m_cancelEvent = nullptr;
+    }
+}
+
+#else
+
+namespace {
+
+bool MakeAddress(const std::wstring& endpoint, sockaddr_un& address) {
+    std::string path = FileIO::ToUtf8(endpoint);
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (path.empty() || path.size() >= sizeof(address.sun_path)) {
+        return false;
+    }
+    memcpy(address.sun_path, path.c_str(), path.size() + 1);
+    return true;
+}
+
+int OpenSocket() {
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd >= 0) {
+        fcntl(fd, F_SETFD, FD_CLOEXEC);
+    }
+    return fd;
+}
+
+} // namespace
+
+LocalStream::~LocalStream() {
+    Close();
+}
+
+bool LocalStream::Connect(const std::wstring& endpoint, unsigned timeoutMs) {
+    (void)timeoutMs;
+    Close();
+    sockaddr_un address;
+    if (!MakeAddress(endpoint, address)) {
+        return false;
+    }
+    int fd = OpenSocket();
+    if (fd < 0) {
+        return false;
+    }
+    if (connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+        close(fd);
+        return false;
+    }
+    m_socket = fd;
+    return true;
+}
+
+size_t LocalStream::Read(void* buffer, size_t capacity) {
+    if (m_socket < 0) {
+        return 0;
+    }
+    for (;;) {
+        ssize_t n = recv(m_socket, buffer, capacity, 0);
+        if (n >= 0) {
+            return static_cast<size_t>(n);
+        }
+        if (errno != EINTR) {
+            return 0;
+        }
+    }
+}
+
+bool LocalStream::Write(const void* data, size_t length) {
+    if (m_socket < 0) {
+        return false;
+    }
+    const char* p = static_cast<const char*>(data);
+    while (length > 0) {
+        ssize_t n = send(m_socket, p, length, MSG_NOSIGNAL);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        p += n;
+        length -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+void LocalStream::Cancel() {
+    if (m_socket >= 0) {
+        shutdown(m_socket, SHUT_RDWR);
+    }
+}
+
+void LocalStream::Close() {
+    if (m_socket >= 0) {
+        close(m_socket);
+        m_socket = -1;
+    }
+}
+
+bool LocalStream::IsOpen() const {
+    return m_socket >= 0;
+}
+
+LocalListener::~LocalListener() {
+    Close();
+}
+
+bool LocalListener::Open(const std::wstring& endpoint) {
+    Close();
+    sockaddr_un address;
+    if (!MakeAddress(endpoint, address)) {
+        return false;
+    }
+
+    // A socket file left by a server that is gone is replaced; a live one is not
+    LocalStream probe;
+    if (probe.Connect(endpoint, 0)) {
+        return false;
+    }
+    unlink(address.sun_path);
+
+    int fd = OpenSocket();
+    if (fd < 0) {
+        return false;
+    }
+    if (bind(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 ||
+        chmod(address.sun_path, 0600) != 0 || listen(fd, SOMAXCONN) != 0) {
+        close(fd);
+        return false;
+    }
+    m_socket = fd;
+    m_endpoint = endpoint;
+    m_cancelled = false;
+    return true;
+}
+
+bool LocalListener::Accept(LocalStream& stream) {
+    stream.Close();
+    for (;;) {
+        if (m_socket < 0 || m_cancelled) {
+            return false;
+        }
+        int fd = accept(m_socket, nullptr, nullptr);
+        if (fd >= 0) {
+            fcntl(fd, F_SETFD, FD_CLOEXEC);
+            stream.m_socket = fd;
+            return true;
+        }
+        if (errno != EINTR && errno != ECONNABORTED) {
+            return false;
+        }
+    }
+}
+
+void LocalListener::Cancel() {
+    // Shutting the listening socket down wakes a blocked accept()
+    m_cancelled = true;
+    if (m_socket >= 0) {
+        shutdown(m_socket, SHUT_RDWR);
+    }
+}
+
+void LocalListener::Close() {
+    if (m_socket >= 0) {
+        close(m_socket);
+        m_socket = -1;
+        unlink(FileIO::ToUtf8(m_endpoint).c_str());
+    }
+}
+
+#endif
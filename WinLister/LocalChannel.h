@@ -0,0 +1,60 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <string>
+
+// Byte streams between processes on this machine: named pipes on Windows,
+// Unix domain sockets elsewhere. Endpoints are pipe names
+// ("\\.\pipe\name") or socket paths. Read and Write block; Cancel() may be
+// called from another thread to wake them, after which they fail.
+class LocalStream {
+public:
+    LocalStream() = default;
+    ~LocalStream();
+    LocalStream(const LocalStream&) = delete;
+    LocalStream& operator=(const LocalStream&) = delete;
+
+    // Client side; waits up to timeoutMs for a busy pipe
+    bool Connect(const std::wstring& endpoint, unsigned timeoutMs = 2000);
+    // Bytes read, or 0 at end of stream, on error or after Cancel()
+    size_t Read(void* buffer, size_t capacity);
+    bool Write(const void* data, size_t length);
+    void Cancel();
+    void Close();
+    bool IsOpen() const;
+
+private:
+    friend class LocalListener;
+    bool Attach(void* handle);
+
+    // Pipe handle and I/O and cancel events on Windows; socket elsewhere
+    void* m_handle = nullptr;
+    void* m_ioEvent = nullptr;
+    void* m_cancelEvent = nullptr;
+    int m_socket = -1;
+};
+
+class LocalListener {
+public:
+    LocalListener() = default;
+    ~LocalListener();
+    LocalListener(const LocalListener&) = delete;
+    LocalListener& operator=(const LocalListener&) = delete;
+
+    // Fails when another process already serves the endpoint
+    bool Open(const std::wstring& endpoint);
+    // Waits for the next client; false after Cancel() or on error
+    bool Accept(LocalStream& stream);
+    void Cancel();
+    void Close();
+
+private:
+    std::wstring m_endpoint;
+    std::atomic<bool> m_cancelled{ false };
+
+    // Waiting pipe instance and cancel event on Windows; socket elsewhere
+    void* m_pending = nullptr;
+    void* m_cancelEvent = nullptr;
+    int m_socket = -1;
+};
@@ -1,21 +1,36 @@
 #include "MainWindow.h"
 #include "DetailDialog.h"
 #include "resource.h"
+#include "Clipboard.h"
+#include "SnapshotExport.h"
+#include "WindowFilter.h"
+#include "SnapshotFile.h"
+#include "WindowBatch.h"
+#include "WindowRules.h"
+#include "WindowOcclusion.h"
 #include <windowsx.h>
 #include <sstream>
 #include <algorithm>
 #include <cctype>
 #include <dwmapi.h>
 #include <uxtheme.h>
+#include <commdlg.h>
+#include <cstdio>
+#include <chrono>
+#include <unordered_set>
 
 #pragma comment(lib, "comctl32.lib")
 #pragma comment(lib, "uxtheme.lib")
+#pragma comment(lib, "comdlg32.lib")
 
 // Dark mode colors
 static const COLORREF DARK_BG = RGB(32, 32, 32);
 static const COLORREF DARK_TEXT = RGB(255, 255, 255);
 static const COLORREF DARK_LISTVIEW_BG = RGB(45, 45, 45);
 static const COLORREF DARK_EDIT_BG = RGB(50, 50, 50);
+static const COLORREF DARK_HEADER_BG = RGB(50, 50, 50);
+static const COLORREF DARK_HEADER_BORDER = RGB(70, 70, 70);
+static const COLORREF DARK_CHECK_BORDER = RGB(150, 150, 150);
 
 // Undocumented dark mode APIs
 enum IMMERSIVE_HC_CACHE_MODE { IHCM_USE_CACHED_VALUE, IHCM_REFRESH };
@@ -35,6 +50,7 @@ name='Microsoft.Windows.Common-Controls' version='6.0.0.0' \
 processorArchitecture='*' publicKeyToken='6595b64144ccf1df' language='*'\"")
 
 const wchar_t* MainWindow::CLASS_NAME = L"WinListerMainWindow";
+const wchar_t* MainWindow::WINDOW_TITLE = L"WinLister - Window Information Tool";
 
 MainWindow::MainWindow()
     : m_hwnd(nullptr)
@@ -42,6 +58,9 @@ MainWindow::MainWindow()
     , m_hCheckHideHidden(nullptr)
     , m_hCheckHideSystem(nullptr)
     , m_hBtnRefresh(nullptr)
+    , m_hBtnExport(nullptr)
+    , m_hBtnPick(nullptr)
+    , m_hReplaySlider(nullptr)
     , m_hStaticCount(nullptr)
     , m_hEditSearch(nullptr)
     , m_hCheckAutoRefresh(nullptr)
@@ -52,10 +71,15 @@ MainWindow::MainWindow()
     , m_hImageList(nullptr)
     , m_hideHidden(true)
     , m_hideSystem(true)
-    , m_sortColumn(-1)
-    , m_sortState(0)
+    , m_occludedOnly(false)
+    , m_offScreenOnly(false)
+    , m_groupByMonitor(false)
+    , m_groupByProcess(false)
+    , m_sortValid(false)
     , m_autoRefresh(true)
     , m_refreshInterval(1000)
+    , m_spatialValid(false)
+    , m_picking(false)
     , m_darkMode(false)
     , m_hDarkBrush(nullptr)
 {
@@ -83,6 +107,7 @@ MainWindow::MainWindow()
 }
 
 MainWindow::~MainWindow() {
+    DestroyPaintCache();
     if (m_hImageList) {
         ImageList_Destroy(m_hImageList);
     }
@@ -117,10 +142,10 @@ bool MainWindow::Create(HINSTANCE hInstance) {
     m_hwnd = CreateWindowExW(
         0,
         CLASS_NAME,
-        L"WinLister - Window Information Tool",
+        WINDOW_TITLE,
         WS_OVERLAPPEDWINDOW,
         CW_USEDEFAULT, CW_USEDEFAULT,
-        1200, 700,
+        1280, 700,
         nullptr, nullptr, hInstance, this
     );
 
@@ -167,86 +192,18 @@ LRESULT CALLBACK MainWindow::HeaderProc(HWND hwnd, UINT msg, WPARAM wParam, LPAR
         PAINTSTRUCT ps;
         HDC hdc = BeginPaint(hwnd, &ps);
 
-        // Get header info
-        int itemCount = Header_GetItemCount(hwnd);
-
-        // Fill entire header background
+        // Header is drawn into a cached bitmap that is only re-rendered when
+        // the layout or sort indicators change; a paint is then just a blit
         RECT rcHeader;
         GetClientRect(hwnd, &rcHeader);
-        HBRUSH hBgBrush = CreateSolidBrush(RGB(50, 50, 50));
-        FillRect(hdc, &rcHeader, hBgBrush);
-        DeleteObject(hBgBrush);
-
-        // Draw each header item
-        for (int i = 0; i < itemCount; i++) {
-            RECT rcItem;
-            Header_GetItemRect(hwnd, i, &rcItem);
-
-            // Get item text and format
-            wchar_t text[256] = {};
-            HDITEMW hdi = {};
-            hdi.mask = HDI_TEXT | HDI_FORMAT;
-            hdi.pszText = text;
-            hdi.cchTextMax = 256;
-            Header_GetItem(hwnd, i, &hdi);
-
-            // Draw item background
-            HBRUSH hItemBrush = CreateSolidBrush(RGB(50, 50, 50));
-            FillRect(hdc, &rcItem, hItemBrush);
-            DeleteObject(hItemBrush);
-
-            // Draw right border
-            HPEN hPen = CreatePen(PS_SOLID, 1, RGB(70, 70, 70));
-            HPEN hOldPen = (HPEN)SelectObject(hdc, hPen);
-            MoveToEx(hdc, rcItem.right - 1, rcItem.top, nullptr);
-            LineTo(hdc, rcItem.right - 1, rcItem.bottom);
-            SelectObject(hdc, hOldPen);
-            DeleteObject(hPen);
-
-            // Draw bottom border
-            HPEN hBottomPen = CreatePen(PS_SOLID, 1, RGB(70, 70, 70));
-            hOldPen = (HPEN)SelectObject(hdc, hBottomPen);
-            MoveToEx(hdc, rcItem.left, rcItem.bottom - 1, nullptr);
-            LineTo(hdc, rcItem.right, rcItem.bottom - 1);
-            SelectObject(hdc, hOldPen);
-            DeleteObject(hBottomPen);
+        pThis->RenderHeader(hwnd, hdc, rcHeader.right, rcHeader.bottom);
 
-            // Draw text
-            SetBkMode(hdc, TRANSPARENT);
-            SetTextColor(hdc, DARK_TEXT);
-            RECT textRect = rcItem;
-            textRect.left += 6;
-            textRect.right -= 12;
-            DrawTextW(hdc, text, -1, &textRect, DT_LEFT | DT_VCENTER | DT_SINGLELINE | DT_END_ELLIPSIS);
-
-            // Draw sort arrow if present
-            if (hdi.fmt & HDF_SORTUP) {
-                int cx = rcItem.right - 12;
-                int cy = rcItem.top + (rcItem.bottom - rcItem.top) / 2;
-                POINT pts[3] = { {cx, cy - 3}, {cx + 4, cy + 2}, {cx - 4, cy + 2} };
-                HPEN hArrowPen = CreatePen(PS_SOLID, 1, DARK_TEXT);
-                HBRUSH hArrowBrush = CreateSolidBrush(DARK_TEXT);
-                HPEN hOldPen2 = (HPEN)SelectObject(hdc, hArrowPen);
-                HBRUSH hOldBrush = (HBRUSH)SelectObject(hdc, hArrowBrush);
-                Polygon(hdc, pts, 3);
-                SelectObject(hdc, hOldPen2);
-                SelectObject(hdc, hOldBrush);
-                DeleteObject(hArrowPen);
-                DeleteObject(hArrowBrush);
-            } else if (hdi.fmt & HDF_SORTDOWN) {
-                int cx = rcItem.right - 12;
-                int cy = rcItem.top + (rcItem.bottom - rcItem.top) / 2;
-                POINT pts[3] = { {cx, cy + 3}, {cx + 4, cy - 2}, {cx - 4, cy - 2} };
-                HPEN hArrowPen = CreatePen(PS_SOLID, 1, DARK_TEXT);
-                HBRUSH hArrowBrush = CreateSolidBrush(DARK_TEXT);
-                HPEN hOldPen2 = (HPEN)SelectObject(hdc, hArrowPen);
-                HBRUSH hOldBrush = (HBRUSH)SelectObject(hdc, hArrowBrush);
-                Polygon(hdc, pts, 3);
-                SelectObject(hdc, hOldPen2);
-                SelectObject(hdc, hOldBrush);
-                DeleteObject(hArrowPen);
-                DeleteObject(hArrowBrush);
-            }
+        if (pThis->m_paintCache.headerDC) {
+            BitBlt(hdc, ps.rcPaint.left, ps.rcPaint.top,
+                ps.rcPaint.right - ps.rcPaint.left, ps.rcPaint.bottom - ps.rcPaint.top,
+                pThis->m_paintCache.headerDC, ps.rcPaint.left, ps.rcPaint.top, SRCCOPY);
+        } else {
+            FillRect(hdc, &rcHeader, pThis->m_paintCache.headerBrush);
         }
 
         EndPaint(hwnd, &ps);
@@ -254,18 +211,140 @@ LRESULT CALLBACK MainWindow::HeaderProc(HWND hwnd, UINT msg, WPARAM wParam, LPAR
     }
 
     if (msg == WM_ERASEBKGND && pThis->m_darkMode) {
-        HDC hdc = (HDC)wParam;
-        RECT rc;
-        GetClientRect(hwnd, &rc);
-        HBRUSH hBrush = CreateSolidBrush(RGB(50, 50, 50));
-        FillRect(hdc, &rc, hBrush);
-        DeleteObject(hBrush);
+        // WM_PAINT covers the whole header, so there is nothing to erase
         return 1;
     }
 
     return DefSubclassProc(hwnd, msg, wParam, lParam);
 }
 
+void MainWindow::CreatePaintCache() {
+    m_paintCache.headerBrush = CreateSolidBrush(DARK_HEADER_BG);
+    m_paintCache.editBrush = CreateSolidBrush(DARK_EDIT_BG);
+    m_paintCache.arrowBrush = CreateSolidBrush(DARK_TEXT);
+    m_paintCache.borderPen = CreatePen(PS_SOLID, 1, DARK_HEADER_BORDER);
+    m_paintCache.arrowPen = CreatePen(PS_SOLID, 1, DARK_TEXT);
+    m_paintCache.checkBorderPen = CreatePen(PS_SOLID, 1, DARK_CHECK_BORDER);
+    m_paintCache.checkMarkPen = CreatePen(PS_SOLID, 2, DARK_TEXT);
+}
+
+void MainWindow::DestroyPaintCache() {
+    if (m_paintCache.headerDC) {
+        SelectObject(m_paintCache.headerDC, m_paintCache.hOldHeaderBitmap);
+        DeleteDC(m_paintCache.headerDC);
+    }
+    if (m_paintCache.headerBitmap) DeleteObject(m_paintCache.headerBitmap);
+    if (m_paintCache.headerBrush) DeleteObject(m_paintCache.headerBrush);
+    if (m_paintCache.editBrush) DeleteObject(m_paintCache.editBrush);
+    if (m_paintCache.arrowBrush) DeleteObject(m_paintCache.arrowBrush);
+    if (m_paintCache.borderPen) DeleteObject(m_paintCache.borderPen);
+    if (m_paintCache.arrowPen) DeleteObject(m_paintCache.arrowPen);
+    if (m_paintCache.checkBorderPen) DeleteObject(m_paintCache.checkBorderPen);
+    if (m_paintCache.checkMarkPen) DeleteObject(m_paintCache.checkMarkPen);
+
+    m_paintCache = ThemedPaintCache();
+    m_headerPaint.Invalidate();
+}
+
+void MainWindow::RenderHeader(HWND hHeader, HDC hdc, int width, int height) {
+    if (width <= 0 || height <= 0) {
+        return;
+    }
+
+    // Snapshot the header layout
+    int itemCount = Header_GetItemCount(hHeader);
+    std::vector<HeaderItemState> items(itemCount > 0 ? itemCount : 0);
+    for (int i = 0; i < itemCount; i++) {
+        RECT rcItem;
+        Header_GetItemRect(hHeader, i, &rcItem);
+
+        wchar_t text[256] = {};
+        HDITEMW hdi = {};
+        hdi.mask = HDI_TEXT | HDI_FORMAT;
+        hdi.pszText = text;
+        hdi.cchTextMax = 256;
+        Header_GetItem(hHeader, i, &hdi);
+
+        items[i].left = rcItem.left;
+        items[i].top = rcItem.top;
+        items[i].right = rcItem.right;
+        items[i].bottom = rcItem.bottom;
+        items[i].sortDirection = (hdi.fmt & HDF_SORTUP) ? 1 : (hdi.fmt & HDF_SORTDOWN) ? -1 : 0;
+        items[i].text = text;
+    }
+
+    if (!m_headerPaint.Update(width, height, std::move(items))) {
+        return;
+    }
+
+    // (Re)create the back buffer when the header size changes
+    if (!m_paintCache.headerDC || m_paintCache.headerWidth != width || m_paintCache.headerHeight != height) {
+        if (m_paintCache.headerDC) {
+            SelectObject(m_paintCache.headerDC, m_paintCache.hOldHeaderBitmap);
+            DeleteDC(m_paintCache.headerDC);
+            m_paintCache.headerDC = nullptr;
+        }
+        if (m_paintCache.headerBitmap) {
+            DeleteObject(m_paintCache.headerBitmap);
+            m_paintCache.headerBitmap = nullptr;
+        }
+
+        m_paintCache.headerDC = CreateCompatibleDC(hdc);
+        m_paintCache.headerBitmap = CreateCompatibleBitmap(hdc, width, height);
+        if (!m_paintCache.headerDC || !m_paintCache.headerBitmap) {
+            if (m_paintCache.headerDC) DeleteDC(m_paintCache.headerDC);
+            if (m_paintCache.headerBitmap) DeleteObject(m_paintCache.headerBitmap);
+            m_paintCache.headerDC = nullptr;
+            m_paintCache.headerBitmap = nullptr;
+            m_headerPaint.Invalidate();
+            return;
+        }
+        m_paintCache.hOldHeaderBitmap = static_cast<HBITMAP>(SelectObject(m_paintCache.headerDC, m_paintCache.headerBitmap));
+        m_paintCache.headerWidth = width;
+        m_paintCache.headerHeight = height;
+    }
+
+    HDC memDC = m_paintCache.headerDC;
+
+    // Fill entire header background
+    RECT rcHeader = { 0, 0, width, height };
+    FillRect(memDC, &rcHeader, m_paintCache.headerBrush);
+
+    SetBkMode(memDC, TRANSPARENT);
+    SetTextColor(memDC, DARK_TEXT);
+    HPEN hOldPen = static_cast<HPEN>(SelectObject(memDC, m_paintCache.borderPen));
+    HBRUSH hOldBrush = static_cast<HBRUSH>(SelectObject(memDC, m_paintCache.arrowBrush));
+
+    for (const auto& item : m_headerPaint.Items()) {
+        // Right and bottom borders
+        SelectObject(memDC, m_paintCache.borderPen);
+        MoveToEx(memDC, item.right - 1, item.top, nullptr);
+        LineTo(memDC, item.right - 1, item.bottom);
+        MoveToEx(memDC, item.left, item.bottom - 1, nullptr);
+        LineTo(memDC, item.right, item.bottom - 1);
+
+        HeaderItemGeometry geometry = HeaderPaintState::Layout(item);
+
+        // Text
+        RECT textRect = { geometry.textLeft, geometry.textTop, geometry.textRight, geometry.textBottom };
+        DrawTextW(memDC, item.text.c_str(), -1, &textRect, DT_LEFT | DT_VCENTER | DT_SINGLELINE | DT_END_ELLIPSIS);
+
+        // Sort arrow
+        if (geometry.hasArrow) {
+            POINT pts[3];
+            for (int i = 0; i < 3; i++) {
+                pts[i].x = geometry.arrowX[i];
+                pts[i].y = geometry.arrowY[i];
+            }
+            SelectObject(memDC, m_paintCache.arrowPen);
+            Polygon(memDC, pts, 3);
+        }
+    }
+
+    SelectObject(memDC, hOldPen);
+    SelectObject(memDC, hOldBrush);
+}
+
 LRESULT MainWindow::HandleMessage(UINT msg, WPARAM wParam, LPARAM lParam) {
     switch (msg) {
     case WM_CREATE:
@@ -292,17 +371,55 @@ LRESULT MainWindow::HandleMessage(UINT msg, WPARAM wParam, LPARAM lParam) {
 
     case WM_GETMINMAXINFO: {
         MINMAXINFO* mmi = reinterpret_cast<MINMAXINFO*>(lParam);
-        mmi->ptMinTrackSize.x = 1000;
+        // Wide enough for every toolbar control and the status count
+        // after them
+        RECT frame = { 0, 0, TOOLBAR_RIGHT + STATUS_MIN_WIDTH + 10, 400 };
+        AdjustWindowRectEx(&frame, WS_OVERLAPPEDWINDOW, FALSE, 0);
+        mmi->ptMinTrackSize.x = frame.right - frame.left;
         mmi->ptMinTrackSize.y = 400;
         return 0;
     }
 
+    case WM_HSCROLL:
+        if (reinterpret_cast<HWND>(lParam) == m_hReplaySlider && m_replay.IsOpen()) {
+            ShowReplayFrame(static_cast<size_t>(SendMessageW(m_hReplaySlider, TBM_GETPOS, 0, 0)));
+        }
+        return 0;
+
     case WM_TIMER:
         if (wParam == TIMER_REFRESH) {
             OnTimer();
         }
         return 0;
 
+    // While picking, the mouse is captured: moving selects the window under
+    // the cursor, a left click keeps it and a right click cancels
+    case WM_MOUSEMOVE:
+    case WM_LBUTTONDOWN:
+    case WM_RBUTTONDOWN:
+        if (m_picking) {
+            POINT pt;
+            GetCursorPos(&pt);
+            if (msg != WM_RBUTTONDOWN) {
+                PickAt(pt);
+            }
+            if (msg != WM_MOUSEMOVE) {
+                StopPicking(msg == WM_LBUTTONDOWN);
+            }
+            return 0;
+        }
+        break;
+
+    case WM_CAPTURECHANGED:
+        if (m_picking) {
+            StopPicking(false);
+        }
+        return 0;
+
+    case WM_ANIMATION_FRAME:
+        m_animator.OnFrame();
+        return 0;
+
     case WM_SETTINGCHANGE:
         OnSettingChange(wParam, lParam);
         return 0;
@@ -313,7 +430,7 @@ LRESULT MainWindow::HandleMessage(UINT msg, WPARAM wParam, LPARAM lParam) {
             SetTextColor(hdc, DARK_TEXT);
             SetBkColor(hdc, DARK_EDIT_BG);
             SetBkMode(hdc, OPAQUE);
-            return reinterpret_cast<LRESULT>(CreateSolidBrush(DARK_EDIT_BG));
+            return reinterpret_cast<LRESULT>(m_paintCache.editBrush);
         }
         break;
 
@@ -355,13 +472,11 @@ LRESULT MainWindow::HandleMessage(UINT msg, WPARAM wParam, LPARAM lParam) {
             checkRect.bottom = checkRect.top + 14;
 
             // Draw checkbox border
-            HPEN hPen = CreatePen(PS_SOLID, 1, RGB(150, 150, 150));
-            HPEN hOldPen = (HPEN)SelectObject(dis->hDC, hPen);
+            HPEN hOldPen = (HPEN)SelectObject(dis->hDC, m_paintCache.checkBorderPen);
             HBRUSH hOldBrush = (HBRUSH)SelectObject(dis->hDC, GetStockObject(NULL_BRUSH));
             Rectangle(dis->hDC, checkRect.left, checkRect.top, checkRect.right, checkRect.bottom);
             SelectObject(dis->hDC, hOldBrush);
             SelectObject(dis->hDC, hOldPen);
-            DeleteObject(hPen);
 
             // Check if this checkbox is checked based on control ID
             bool isChecked = false;
@@ -372,13 +487,11 @@ LRESULT MainWindow::HandleMessage(UINT msg, WPARAM wParam, LPARAM lParam) {
 
             // Draw checkmark if checked
             if (isChecked) {
-                HPEN hCheckPen = CreatePen(PS_SOLID, 2, DARK_TEXT);
-                HPEN hOldPen2 = (HPEN)SelectObject(dis->hDC, hCheckPen);
+                HPEN hOldPen2 = (HPEN)SelectObject(dis->hDC, m_paintCache.checkMarkPen);
                 MoveToEx(dis->hDC, checkRect.left + 3, checkRect.top + 7, nullptr);
                 LineTo(dis->hDC, checkRect.left + 5, checkRect.top + 10);
                 LineTo(dis->hDC, checkRect.left + 11, checkRect.top + 3);
                 SelectObject(dis->hDC, hOldPen2);
-                DeleteObject(hCheckPen);
             }
 
             // Draw text
@@ -399,10 +512,16 @@ LRESULT MainWindow::HandleMessage(UINT msg, WPARAM wParam, LPARAM lParam) {
 
 void MainWindow::OnCreate() {
     m_hDarkBrush = CreateSolidBrush(DARK_BG);
+    CreatePaintCache();
     m_darkMode = IsDarkModeEnabled();
 
     CreateControls();
     ApplyDarkMode();
+
+    // Another process may already own the endpoint; the GUI works without it
+    m_queryServer.Start(QueryServer::DefaultEndpoint());
+    m_sharedSnapshot.Open(SharedSnapshotWriter::DefaultName());
+    m_animator.Attach(m_hwnd, WM_ANIMATION_FRAME);
     RefreshWindowList();
 }
 
@@ -487,14 +606,38 @@ void MainWindow::CreateControls() {
         m_hwnd, reinterpret_cast<HMENU>(IDC_BTN_REFRESH), m_hInstance, nullptr
     );
 
+    // Export button
+    m_hBtnExport = CreateWindowExW(
+        0, L"BUTTON", L"Export...",
+        WS_CHILD | WS_VISIBLE | BS_PUSHBUTTON,
+        885, 8, 80, 28,
+        m_hwnd, reinterpret_cast<HMENU>(IDC_BTN_EXPORT), m_hInstance, nullptr
+    );
+
+    // Pick button: click, then click any window to select it in the list
+    m_hBtnPick = CreateWindowExW(
+        0, L"BUTTON", L"Pick",
+        WS_CHILD | WS_VISIBLE | BS_PUSHBUTTON,
+        975, 8, 60, 28,
+        m_hwnd, reinterpret_cast<HMENU>(IDC_BTN_PICK), m_hInstance, nullptr
+    );
+
     // Status count
     m_hStaticCount = CreateWindowExW(
         0, L"STATIC", L"0 windows",
         WS_CHILD | WS_VISIBLE | SS_RIGHT,
-        885, 12, 120, 20,
+        TOOLBAR_RIGHT, 12, STATUS_MIN_WIDTH, 20,
         m_hwnd, reinterpret_cast<HMENU>(IDC_STATIC_COUNT), m_hInstance, nullptr
     );
 
+    // Replay slider, shown while a recording is open
+    m_hReplaySlider = CreateWindowExW(
+        0, TRACKBAR_CLASSW, L"",
+        WS_CHILD | TBS_HORZ | TBS_NOTICKS,
+        10, 0, 100, REPLAY_SLIDER_HEIGHT,
+        m_hwnd, reinterpret_cast<HMENU>(IDC_REPLAY_SLIDER), m_hInstance, nullptr
+    );
+
     // Apply font
     SendMessage(m_hStaticSearch, WM_SETFONT, reinterpret_cast<WPARAM>(hFont), TRUE);
     SendMessage(m_hEditSearch, WM_SETFONT, reinterpret_cast<WPARAM>(hFont), TRUE);
@@ -504,6 +647,8 @@ void MainWindow::CreateControls() {
     SendMessage(m_hEditRefreshTime, WM_SETFONT, reinterpret_cast<WPARAM>(hFont), TRUE);
     SendMessage(m_hStaticMs, WM_SETFONT, reinterpret_cast<WPARAM>(hFont), TRUE);
     SendMessage(m_hBtnRefresh, WM_SETFONT, reinterpret_cast<WPARAM>(hFont), TRUE);
+    SendMessage(m_hBtnExport, WM_SETFONT, reinterpret_cast<WPARAM>(hFont), TRUE);
+    SendMessage(m_hBtnPick, WM_SETFONT, reinterpret_cast<WPARAM>(hFont), TRUE);
     SendMessage(m_hStaticCount, WM_SETFONT, reinterpret_cast<WPARAM>(hFont), TRUE);
 
     CreateListView();
@@ -519,7 +664,7 @@ void MainWindow::CreateListView() {
         WS_EX_CLIENTEDGE,
         WC_LISTVIEWW,
         L"",
-        WS_CHILD | WS_VISIBLE | LVS_REPORT | LVS_SINGLESEL | LVS_SHOWSELALWAYS,
+        WS_CHILD | WS_VISIBLE | LVS_REPORT | LVS_SHOWSELALWAYS | LVS_OWNERDATA,
         10, 45, 780, 400,
         m_hwnd,
         reinterpret_cast<HMENU>(IDC_LISTVIEW),
@@ -548,7 +693,10 @@ void MainWindow::CreateListView() {
         { L"PID", 60 },
         { L"Visible", 70 },
         { L"Position", 150 },
-        { L"Size", 100 }
+        { L"Size", 100 },
+        { L"Exposed", 80 },
+        { L"Raised", 80 },
+        { L"Monitor", 110 }
     };
 
     for (int i = 0; i < _countof(columns); i++) {
@@ -566,11 +714,16 @@ void MainWindow::CreateListView() {
 }
 
 void MainWindow::OnSize(int width, int height) {
+    int sliderHeight = m_replay.IsOpen() ? REPLAY_SLIDER_HEIGHT + 5 : 0;
     if (m_hListView) {
-        MoveWindow(m_hListView, 10, 45, width - 20, height - 55, TRUE);
+        MoveWindow(m_hListView, 10, 45, width - 20, height - 55 - sliderHeight, TRUE);
+    }
+    if (m_hReplaySlider) {
+        MoveWindow(m_hReplaySlider, 10, height - 5 - REPLAY_SLIDER_HEIGHT, width - 20, REPLAY_SLIDER_HEIGHT, TRUE);
     }
     if (m_hStaticCount) {
-        MoveWindow(m_hStaticCount, width - 160, 12, 150, 20, TRUE);
+        // Right-aligned in the space after the last button, never over it
+        MoveWindow(m_hStaticCount, TOOLBAR_RIGHT, 12, std::max(width - 10 - TOOLBAR_RIGHT, 0), 20, TRUE);
     }
 }
 
@@ -580,6 +733,14 @@ void MainWindow::OnCommand(WORD id, WORD notifyCode) {
         RefreshWindowList();
         break;
 
+    case IDC_BTN_EXPORT:
+        ShowExportMenu();
+        break;
+
+    case IDC_BTN_PICK:
+        StartPicking();
+        break;
+
     case IDC_CHECK_HIDE_HIDDEN:
         if (m_darkMode) {
             // Owner-draw mode: toggle manually
@@ -641,7 +802,11 @@ LRESULT MainWindow::OnNotify(NMHDR* pnmhdr) {
         case NM_DBLCLK: {
             NMITEMACTIVATE* pnmia = reinterpret_cast<NMITEMACTIVATE*>(pnmhdr);
             if (pnmia->iItem >= 0) {
-                ShowWindowDetails(pnmia->iItem);
+                if (RowWindow(pnmia->iItem)) {
+                    ShowWindowDetails(pnmia->iItem);
+                } else {
+                    ExpandGroup(pnmia->iItem, -1);
+                }
             }
             break;
         }
@@ -656,19 +821,35 @@ LRESULT MainWindow::OnNotify(NMHDR* pnmhdr) {
         }
         case LVN_KEYDOWN: {
             NMLVKEYDOWN* pnkd = reinterpret_cast<NMLVKEYDOWN*>(pnmhdr);
+            int sel = ListView_GetNextItem(m_hListView, -1, LVNI_SELECTED);
+            if (sel < 0) {
+                break;
+            }
             if (pnkd->wVKey == VK_RETURN) {
-                int sel = ListView_GetNextItem(m_hListView, -1, LVNI_SELECTED);
-                if (sel >= 0) {
+                if (RowWindow(sel)) {
                     ShowWindowDetails(sel);
+                } else {
+                    ExpandGroup(sel, -1);
                 }
+            } else if (m_groupByProcess && (pnkd->wVKey == VK_RIGHT || pnkd->wVKey == VK_LEFT)) {
+                ExpandGroup(sel, pnkd->wVKey == VK_RIGHT ? 1 : 0);
             }
             break;
         }
         case LVN_COLUMNCLICK: {
             NMLISTVIEW* pnmlv = reinterpret_cast<NMLISTVIEW*>(pnmhdr);
-            OnColumnClick(pnmlv->iSubItem);
+            OnColumnClick(pnmlv->iSubItem, GetKeyState(VK_SHIFT) < 0);
+            break;
+        }
+        case LVN_GETDISPINFO: {
+            NMLVDISPINFO* pdi = reinterpret_cast<NMLVDISPINFO*>(pnmhdr);
+            OnGetDispInfo(pdi->item);
             break;
         }
+        case LVN_ODFINDITEM: {
+            NMLVFINDITEM* pfi = reinterpret_cast<NMLVFINDITEM*>(pnmhdr);
+            return FindListItem(pfi->iStart, pfi->lvfi);
+        }
         }
     }
 
@@ -677,145 +858,274 @@ LRESULT MainWindow::OnNotify(NMHDR* pnmhdr) {
 
 void MainWindow::OnDestroy() {
     KillTimer(m_hwnd, TIMER_REFRESH);
+    m_recorder.Stop();
+    m_queryServer.Stop();
+    m_sharedSnapshot.Close();
+    m_animator.Detach();
     PostQuitMessage(0);
 }
 
-void MainWindow::RefreshWindowList() {
-    m_allWindows = WindowEnumerator::EnumerateAllWindows();
-    ApplyFilter();
+// Wall-clock time as stored in snapshots and recordings
+static uint64_t UnixTimeMs() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count());
 }
 
-void MainWindow::ApplyFilter() {
-    m_filteredWindows.clear();
-
-    std::wstring searchLower = m_searchText;
-    std::transform(searchLower.begin(), searchLower.end(), searchLower.begin(), ::towlower);
-
-    for (const auto& win : m_allWindows) {
-        // Filter hidden windows
-        if (m_hideHidden && win.IsHiddenWindow()) {
-            continue;
-        }
-
-        // Filter system windows
-        if (m_hideSystem && win.IsSystemWindow()) {
-            continue;
-        }
+// Local "yyyy-mm-dd hh:mm:ss" for a Unix time in milliseconds
+static void FormatLocalTime(uint64_t unixMs, wchar_t* buffer, size_t count) {
+    // FILETIME counts 100 ns intervals since 1601
+    ULONGLONG ticks = (unixMs + 11644473600000ULL) * 10000ULL;
+    FILETIME ft = { static_cast<DWORD>(ticks), static_cast<DWORD>(ticks >> 32) };
+    SYSTEMTIME utc = {};
+    SYSTEMTIME local = {};
+    FileTimeToSystemTime(&ft, &utc);
+    if (!SystemTimeToTzSpecificLocalTime(nullptr, &utc, &local)) {
+        local = utc;
+    }
+    swprintf_s(buffer, count, L"%04u-%02u-%02u %02u:%02u:%02u",
+        local.wYear, local.wMonth, local.wDay, local.wHour, local.wMinute, local.wSecond);
+}
 
-        // Search filter
-        if (!searchLower.empty()) {
-            std::wstring titleLower = win.title;
-            std::wstring classLower = win.className;
-            std::wstring processLower = win.processName;
+void MainWindow::RefreshWindowList() {
+    EnumerateLiveWindows();
+    ApplyFilter();
+}
 
-            std::transform(titleLower.begin(), titleLower.end(), titleLower.begin(), ::towlower);
-            std::transform(classLower.begin(), classLower.end(), classLower.begin(), ::towlower);
-            std::transform(processLower.begin(), processLower.end(), processLower.begin(), ::towlower);
+void MainWindow::EnumerateLiveWindows() {
+    if (!m_snapshotSource.empty()) {
+        // Leaving a captured snapshot or recording for live data
+        CloseReplay();
+        m_snapshotSource.clear();
+        m_sortValid = false;
+        m_zorder.Reset();
+        SetWindowTextW(m_hwnd, WINDOW_TITLE);
+    }
 
-            bool match = titleLower.find(searchLower) != std::wstring::npos ||
-                         classLower.find(searchLower) != std::wstring::npos ||
-                         processLower.find(searchLower) != std::wstring::npos;
+    m_allWindows = WindowEnumerator::EnumerateAllWindows();
+    uint64_t now = UnixTimeMs();
+    AnalyzeSnapshot(now);
 
-            if (!match) {
-                continue;
-            }
+    if (m_queryServer.IsRunning()) {
+        m_queryServer.Publish(m_allWindows, now);
+    }
+    if (m_sharedSnapshot.IsOpen()) {
+        m_sharedSnapshot.Publish(m_allWindows, now);
+    }
+    if (m_rules.RuleCount() > 0) {
+        // Only windows that are new or changed are tested against the rules
+        RuleEffects effects;
+        m_rules.SetWorkAreas(RuleActions::MonitorWorkAreas());
+        m_rules.Update(m_allWindows, effects);
+        if (effects.fired > 0) {
+            RuleActions::Apply(effects);
         }
-
-        m_filteredWindows.push_back(win);
     }
+    if (m_recorder.IsRecording() && !m_recorder.Record(m_allWindows, now)) {
+        MessageBoxW(m_hwnd, L"Writing the recording failed; recording has stopped.", L"Recording", MB_OK | MB_ICONERROR);
+    }
+}
 
+void MainWindow::ApplyFilter() {
+    WindowFilterOptions options;
+    options.hideHidden = m_hideHidden;
+    options.hideSystem = m_hideSystem;
+    options.occludedOnly = m_occludedOnly;
+    options.offScreenOnly = m_offScreenOnly;
+    options.search = m_searchText;
+
+    SortWindows(WindowFilter(options).Apply(m_allWindows));
+    LayoutRows();
     PopulateListView();
     UpdateStatusCount();
 }
 
-void MainWindow::PopulateListView() {
-    SetWindowRedraw(m_hListView, FALSE);
-    ListView_DeleteAllItems(m_hListView);
-    ImageList_RemoveAll(m_hImageList);
-
-    for (size_t i = 0; i < m_filteredWindows.size(); i++) {
-        const auto& win = m_filteredWindows[i];
+void MainWindow::AnalyzeSnapshot(uint64_t time) {
+    // Per-snapshot results derived from the whole list, whichever way it was
+    // loaded; the pick index is rebuilt only when next needed
+    OcclusionEngine::Compute(m_allWindows);
+    m_zorder.Update(m_allWindows, time);
+    // Captured snapshots are placed on the monitors attached now
+    Win32MonitorSource monitors;
+    m_monitors.Load(monitors);
+    m_monitors.Assign(m_allWindows);
+    if (m_groupByProcess) {
+        // Only the windows the z-order tracker found new, gone or changed
+        // move the group totals
+        m_groups.Update(m_allWindows, m_zorder.PreviousRows(), m_zorder.PreviousCount());
+    }
+    m_spatialValid = false;
+}
 
-        // Add icon
-        int imageIndex = -1;
-        if (win.hIcon) {
-            imageIndex = ImageList_AddIcon(m_hImageList, win.hIcon);
+void MainWindow::PopulateListView() {
+    // Owner-data list: rows are served from m_filteredWindows on demand, so a
+    // refresh only maps icons to image-list slots and resets the item count.
+    // New references are taken before the previous rows' are dropped, so
+    // icons still in use keep their slots and are never reloaded.
+    int count = RowCount();
+    std::vector<int> rowIcons(count, -1);
+    for (int i = 0; i < count; i++) {
+        if (const WindowInfo* win = RowWindow(i)) {
+            rowIcons[i] = AcquireIconSlot(win->hIcon);
         }
+    }
+    for (int slot : m_rowIcons) {
+        m_iconRegistry.Release(slot);
+    }
+    m_rowIcons.swap(rowIcons);
+    m_rowText.BeginSnapshot();
 
-        LVITEMW item = {};
-        item.mask = LVIF_TEXT | LVIF_IMAGE | LVIF_PARAM;
-        item.iItem = static_cast<int>(i);
-        item.iSubItem = 0;
-        item.lParam = reinterpret_cast<LPARAM>(win.hwnd);
-        item.iImage = imageIndex;
+    // Selection is kept by index, which no longer names the same window
+    ListView_SetItemState(m_hListView, -1, 0, LVIS_SELECTED | LVIS_FOCUSED);
+    ListView_SetItemCountEx(m_hListView, count, LVSICF_NOSCROLL | LVSICF_NOINVALIDATEALL);
+    InvalidateRect(m_hListView, nullptr, FALSE);
+}
 
-        // HWND
-        wchar_t hwndStr[32];
-        swprintf_s(hwndStr, L"%llX", reinterpret_cast<unsigned long long>(win.hwnd));
-        item.pszText = hwndStr;
-        ListView_InsertItem(m_hListView, &item);
+// FNV-1a hash of the icon as drawn at list view size, so copies of the same
+// picture under different handles share an image-list slot
+static uint64_t HashIconPixels(HICON hIcon) {
+    const int size = 16;
+    uint64_t hash = 0xcbf29ce484222325ULL;
+
+    BITMAPINFO bmi = {};
+    bmi.bmiHeader.biSize = sizeof(BITMAPINFOHEADER);
+    bmi.bmiHeader.biWidth = size;
+    bmi.bmiHeader.biHeight = -size;
+    bmi.bmiHeader.biPlanes = 1;
+    bmi.bmiHeader.biBitCount = 32;
+    bmi.bmiHeader.biCompression = BI_RGB;
+
+    HDC hdc = CreateCompatibleDC(nullptr);
+    void* bits = nullptr;
+    HBITMAP hBitmap = CreateDIBSection(hdc, &bmi, DIB_RGB_COLORS, &bits, nullptr, 0);
+    if (hdc && hBitmap && bits) {
+        HGDIOBJ hOld = SelectObject(hdc, hBitmap);
+        DrawIconEx(hdc, 0, 0, hIcon, size, size, 0, nullptr, DI_NORMAL);
+        GdiFlush();
+
+        const BYTE* pixels = static_cast<const BYTE*>(bits);
+        for (int i = 0; i < size * size * 4; i++) {
+            hash = (hash ^ pixels[i]) * 0x100000001b3ULL;
+        }
+        SelectObject(hdc, hOld);
+    } else {
+        // Can't render it; fall back to identifying the icon by handle
+        hash ^= static_cast<uint64_t>(reinterpret_cast<uintptr_t>(hIcon));
+    }
 
-        // Title
-        ListView_SetItemText(m_hListView, static_cast<int>(i), 1,
-            const_cast<wchar_t*>(win.title.empty() ? L"(no title)" : win.title.c_str()));
+    if (hBitmap) {
+        DeleteObject(hBitmap);
+    }
+    if (hdc) {
+        DeleteDC(hdc);
+    }
+    return hash;
+}
 
-        // Class
-        ListView_SetItemText(m_hListView, static_cast<int>(i), 2,
-            const_cast<wchar_t*>(win.className.c_str()));
+int MainWindow::AcquireIconSlot(HICON hIcon) {
+    if (!hIcon) {
+        return -1;
+    }
 
-        // Process
-        ListView_SetItemText(m_hListView, static_cast<int>(i), 3,
-            const_cast<wchar_t*>(win.processName.empty() ? L"(unknown)" : win.processName.c_str()));
+    uint64_t handle = static_cast<uint64_t>(reinterpret_cast<uintptr_t>(hIcon));
+    int slot = m_iconRegistry.AcquireHandle(handle);
+    if (slot >= 0) {
+        return slot;
+    }
 
-        // PID
-        wchar_t pidStr[16];
-        swprintf_s(pidStr, L"%u", win.processId);
-        ListView_SetItemText(m_hListView, static_cast<int>(i), 4, pidStr);
+    bool needsImage = false;
+    slot = m_iconRegistry.Acquire(handle, HashIconPixels(hIcon), needsImage);
+    if (needsImage) {
+        // Slots are dense, so a new slot is either recycled or the next index
+        if (slot < ImageList_GetImageCount(m_hImageList)) {
+            ImageList_ReplaceIcon(m_hImageList, slot, hIcon);
+        } else {
+            ImageList_AddIcon(m_hImageList, hIcon);
+        }
+    }
+    return slot;
+}
 
-        // Visible
-        ListView_SetItemText(m_hListView, static_cast<int>(i), 5,
-            const_cast<wchar_t*>(win.isVisible ? L"Yes" : L"No"));
+void MainWindow::OnGetDispInfo(LVITEMW& item) {
+    if (item.iItem < 0 || item.iItem >= RowCount()) {
+        return;
+    }
+    const WindowInfo* win = RowWindow(item.iItem);
+
+    if (item.mask & LVIF_TEXT) {
+        // The text points into the snapshot or the row-text cache; both stay
+        // valid until the next refresh, which resets the item count anyway.
+        // Group headers are formatted on each request.
+        item.pszText = const_cast<wchar_t*>(win
+            ? m_rowText.GetText(*win, item.iSubItem)
+            : GroupText(m_groups.Groups()[m_listRows[item.iItem].group], item.iSubItem));
+    }
 
-        // Position
-        wchar_t posStr[64];
-        swprintf_s(posStr, L"%d, %d", win.rect.left, win.rect.top);
-        ListView_SetItemText(m_hListView, static_cast<int>(i), 6, posStr);
+    if ((item.mask & LVIF_IMAGE) && item.iSubItem == 0) {
+        item.iImage = item.iItem < static_cast<int>(m_rowIcons.size()) ? m_rowIcons[item.iItem] : -1;
+    }
+}
 
-        // Size
-        wchar_t sizeStr[64];
-        swprintf_s(sizeStr, L"%d x %d",
-            win.rect.right - win.rect.left,
-            win.rect.bottom - win.rect.top);
-        ListView_SetItemText(m_hListView, static_cast<int>(i), 7, sizeStr);
+LRESULT MainWindow::FindListItem(int start, const LVFINDINFOW& find) {
+    // Type-ahead search on the first column, wrapping around the list
+    int count = RowCount();
+    if (!(find.flags & (LVFI_STRING | LVFI_PARTIAL)) || !find.psz || count == 0) {
+        return -1;
     }
 
-    SetWindowRedraw(m_hListView, TRUE);
-    InvalidateRect(m_hListView, nullptr, TRUE);
+    size_t length = wcslen(find.psz);
+    for (int n = 0; n < count; n++) {
+        int i = (start + n) % count;
+        if (i < 0) {
+            i += count;
+        }
+        const WindowInfo* win = RowWindow(i);
+        if (!win) {
+            continue;
+        }
+        const wchar_t* text = m_rowText.GetText(*win, COLUMN_HWND);
+        bool match = (find.flags & LVFI_PARTIAL)
+            ? _wcsnicmp(text, find.psz, length) == 0
+            : _wcsicmp(text, find.psz) == 0;
+        if (match) {
+            return i;
+        }
+    }
+    return -1;
 }
 
 void MainWindow::UpdateStatusCount() {
-    wchar_t buffer[128];
-    swprintf_s(buffer, L"%zu of %zu windows",
-        m_filteredWindows.size(), m_allWindows.size());
+    wchar_t buffer[160];
+    wchar_t rules[32] = L"";
+    if (m_rules.RuleCount() > 0) {
+        swprintf_s(rules, L" (%zu rules)", m_rules.RuleCount());
+    }
+    wchar_t groups[32] = L"";
+    if (m_groupByProcess) {
+        swprintf_s(groups, m_groups.ByThread() ? L" in %zu threads" : L" in %zu processes", m_groups.Groups().size());
+    }
+    swprintf_s(buffer, L"%zu of %zu windows%s%s%s",
+        m_filteredWindows.size(), m_allWindows.size(), groups, rules, m_recorder.IsRecording() ? L" (rec)" : L"");
     SetWindowTextW(m_hStaticCount, buffer);
 }
 
 void MainWindow::ShowWindowDetails(int index) {
-    if (index < 0 || index >= static_cast<int>(m_filteredWindows.size())) {
+    const WindowInfo* win = index >= 0 && index < RowCount() ? RowWindow(index) : nullptr;
+    if (!win) {
         return;
     }
 
-    DetailDialog dialog(m_hwnd, m_filteredWindows[index]);
+    DetailDialog dialog(m_hwnd, *win, m_animator);
     dialog.Show();
 }
 
 void MainWindow::ShowContextMenu(int x, int y) {
     int sel = ListView_GetNextItem(m_hListView, -1, LVNI_SELECTED);
-    if (sel < 0 || sel >= static_cast<int>(m_filteredWindows.size())) {
+    const WindowInfo* row = sel >= 0 && sel < RowCount() ? RowWindow(sel) : nullptr;
+    if (!row) {
         return;
     }
 
-    const auto& win = m_filteredWindows[sel];
+    const auto& win = *row;
 
     HMENU hMenu = CreatePopupMenu();
     AppendMenuW(hMenu, MF_STRING, IDM_COPY_HWND, L"Copy HWND");
@@ -826,13 +1136,34 @@ void MainWindow::ShowContextMenu(int x, int y) {
     AppendMenuW(hMenu, MF_SEPARATOR, 0, nullptr);
     AppendMenuW(hMenu, MF_STRING, IDM_COPY_ALL, L"Copy All");
 
+    // Arranging acts on every selected window; captured snapshots are read-only
+    UINT arrangeFlags = MF_STRING | (m_snapshotSource.empty() ? 0 : MF_GRAYED);
+    AppendMenuW(hMenu, MF_SEPARATOR, 0, nullptr);
+    AppendMenuW(hMenu, arrangeFlags, IDM_ARRANGE_TILE, L"Tile Selected");
+    AppendMenuW(hMenu, arrangeFlags, IDM_ARRANGE_CASCADE, L"Cascade Selected");
+    AppendMenuW(hMenu, arrangeFlags, IDM_ARRANGE_FRONT, L"Bring to Front");
+    AppendMenuW(hMenu, arrangeFlags, IDM_ARRANGE_BACK, L"Send to Back");
+    AppendMenuW(hMenu, arrangeFlags, IDM_ARRANGE_TOPMOST, L"Make Topmost");
+    AppendMenuW(hMenu, arrangeFlags, IDM_ARRANGE_NOTOPMOST, L"Clear Topmost");
+    AppendMenuW(hMenu, MF_SEPARATOR, 0, nullptr);
+    AppendMenuW(hMenu, arrangeFlags, IDM_FADE_HALF, L"Fade to 50%");
+    AppendMenuW(hMenu, arrangeFlags, IDM_FADE_OPAQUE, L"Fade to Opaque");
+
     int cmd = TrackPopupMenu(hMenu, TPM_RETURNCMD | TPM_NONOTIFY, x, y, 0, m_hwnd, nullptr);
     DestroyMenu(hMenu);
+    if (cmd >= IDM_ARRANGE_TILE && cmd <= IDM_ARRANGE_NOTOPMOST) {
+        ArrangeSelection(cmd);
+        return;
+    }
+    if (cmd == IDM_FADE_HALF || cmd == IDM_FADE_OPAQUE) {
+        FadeSelection(cmd == IDM_FADE_HALF ? 128 : 255);
+        return;
+    }
 
-    wchar_t buffer[1024];
+    wchar_t buffer[TextFormat::MAX_CHARS];
     switch (cmd) {
     case IDM_COPY_HWND:
-        swprintf_s(buffer, L"%llX", reinterpret_cast<unsigned long long>(win.hwnd));
+        TextFormat::Hex(buffer, reinterpret_cast<uintptr_t>(win.hwnd));
         CopyToClipboard(buffer);
         break;
     case IDM_COPY_TITLE:
@@ -845,146 +1176,706 @@ void MainWindow::ShowContextMenu(int x, int y) {
         CopyToClipboard(win.processName);
         break;
     case IDM_COPY_PID:
-        swprintf_s(buffer, L"%u", win.processId);
+        TextFormat::Unsigned(buffer, win.processId);
         CopyToClipboard(buffer);
         break;
-    case IDM_COPY_ALL:
-        swprintf_s(buffer, L"HWND: %llX\r\nTitle: %s\r\nClass: %s\r\nProcess: %s\r\nPID: %u",
-            reinterpret_cast<unsigned long long>(win.hwnd),
-            win.title.c_str(),
-            win.className.c_str(),
-            win.processName.c_str(),
-            win.processId);
-        CopyToClipboard(buffer);
+    case IDM_COPY_ALL: {
+        // Exported from the model, so long titles and paths are never cut off;
+        // like the old fixed-size copy, the last line has no line break
+        PropertyModel properties;
+        properties.Begin();
+        TextFormat::Hex(buffer, reinterpret_cast<uintptr_t>(win.hwnd));
+        properties.Add(L"HWND", buffer);
+        properties.Add(L"Title", win.title.c_str());
+        properties.Add(L"Class", win.className.c_str());
+        properties.Add(L"Process", win.processName.c_str());
+        TextFormat::Unsigned(buffer, win.processId);
+        properties.Add(L"PID", buffer);
+        properties.End();
+        Clipboard::SetExport(m_hwnd, properties, EXPORT_TEXT, false);
         break;
     }
+    }
 }
 
-void MainWindow::CopyToClipboard(const std::wstring& text) {
-    if (OpenClipboard(m_hwnd)) {
-        EmptyClipboard();
-
-        size_t size = (text.length() + 1) * sizeof(wchar_t);
-        HGLOBAL hMem = GlobalAlloc(GMEM_MOVEABLE, size);
-        if (hMem) {
-            wchar_t* pMem = static_cast<wchar_t*>(GlobalLock(hMem));
-            if (pMem) {
-                wcscpy_s(pMem, text.length() + 1, text.c_str());
-                GlobalUnlock(hMem);
-                SetClipboardData(CF_UNICODETEXT, hMem);
+void MainWindow::ArrangeSelection(int command) {
+    std::vector<HWND> handles = GetSelectedHandles();
+    std::unordered_set<HWND> selected(handles.begin(), handles.end());
+    std::vector<WindowInfo> windows;
+    for (const WindowInfo& win : m_filteredWindows) {
+        if (selected.count(win.hwnd)) {
+            windows.push_back(win);
+        }
+    }
+    if (windows.empty()) {
+        return;
+    }
+
+    // Tiling and cascading use the work area of the monitor under the top window
+    const WindowInfo& top = *std::min_element(windows.begin(), windows.end(),
+        [](const WindowInfo& a, const WindowInfo& b) { return a.zOrder < b.zOrder; });
+    MONITORINFO monitor = { sizeof(monitor) };
+    GetMonitorInfoW(MonitorFromWindow(top.hwnd, MONITOR_DEFAULTTONEAREST), &monitor);
+
+    PlacementPlan plan;
+    switch (command) {
+    case IDM_ARRANGE_TILE: PlacementPlanner::Tile(windows, monitor.rcWork, plan); break;
+    case IDM_ARRANGE_CASCADE: PlacementPlanner::Cascade(windows, monitor.rcWork, plan); break;
+    case IDM_ARRANGE_FRONT: PlacementPlanner::BringToFront(windows, plan); break;
+    case IDM_ARRANGE_BACK: PlacementPlanner::SendToBack(windows, plan); break;
+    case IDM_ARRANGE_TOPMOST: PlacementPlanner::SetTopmost(windows, true, plan); break;
+    case IDM_ARRANGE_NOTOPMOST: PlacementPlanner::SetTopmost(windows, false, plan); break;
+    }
+
+    // Windows shown at their normal size slide into their tile; minimized,
+    // maximized and hung ones are placed at once
+    if (command == IDM_ARRANGE_TILE || command == IDM_ARRANGE_CASCADE) {
+        PlacementPlan immediate;
+        for (const PlacementEntry& entry : plan.Entries()) {
+            const WindowInfo& win = *std::find_if(windows.begin(), windows.end(),
+                [&entry](const WindowInfo& w) { return w.hwnd == entry.hwnd; });
+            if (entry.restore || (entry.flags & SWP_ASYNCWINDOWPOS)) {
+                immediate.Move(win, entry.x, entry.y);
+                immediate.Resize(win, entry.cx, entry.cy);
+            } else {
+                RECT bounds = { entry.x, entry.y, entry.x + entry.cx, entry.y + entry.cy };
+                m_animator.MoveTo(win, bounds, ARRANGE_DURATION);
             }
         }
+        plan = std::move(immediate);
+    }
+
+    Win32PlacementBackend backend;
+    PlacementResult result;
+    PlacementTransaction::Apply(plan, backend, result);
+
+    RefreshWindowList();
+    RestoreSelection(handles);
+
+    if (!result.failed.empty()) {
+        wchar_t message[128];
+        swprintf_s(message, L"%zu of %zu windows could not be arranged.", result.failed.size(), windows.size());
+        MessageBoxW(m_hwnd, message, L"Arrange", MB_OK | MB_ICONWARNING);
+    }
+}
+
+void MainWindow::FadeSelection(BYTE alpha) {
+    std::vector<HWND> handles = GetSelectedHandles();
+    std::unordered_set<HWND> selected(handles.begin(), handles.end());
+    for (const WindowInfo& win : m_filteredWindows) {
+        if (selected.count(win.hwnd)) {
+            m_animator.FadeTo(win, alpha, FADE_DURATION);
+        }
+    }
+}
+
+void MainWindow::StartPicking() {
+    if (m_picking) {
+        return;
+    }
+    m_pickSelection = GetSelectedHandles();
+    m_picking = true;
+    SetCapture(m_hwnd);
+    SetCursor(LoadCursor(nullptr, IDC_CROSS));
+}
+
+void MainWindow::PickAt(POINT pt) {
+    // The index is rebuilt only when a new snapshot is picked from
+    if (!m_spatialValid) {
+        m_spatial.Build(m_allWindows, SPATIAL_SHOWN);
+        m_spatialValid = true;
+    }
+
+    // The top window under the cursor, looking through WinLister itself
+    std::vector<size_t> hits;
+    m_spatial.QueryPoint(pt, hits);
+    for (size_t index : hits) {
+        HWND hwnd = m_allWindows[index].hwnd;
+        if (hwnd == m_hwnd) {
+            continue;
+        }
+        ListView_SetItemState(m_hListView, -1, 0, LVIS_SELECTED);
+        RestoreSelection(std::vector<HWND>(1, hwnd));
+        return;
+    }
+}
 
-        CloseClipboard();
+void MainWindow::StopPicking(bool keep) {
+    m_picking = false;
+    if (GetCapture() == m_hwnd) {
+        ReleaseCapture();
+    }
+    if (!keep) {
+        ListView_SetItemState(m_hListView, -1, 0, LVIS_SELECTED);
+        RestoreSelection(m_pickSelection);
     }
+    m_pickSelection.clear();
 }
 
-void MainWindow::OnColumnClick(int column) {
-    if (m_sortColumn == column) {
+void MainWindow::ShowExportMenu() {
+    RECT rc;
+    GetWindowRect(m_hBtnExport, &rc);
+
+    HMENU hMenu = CreatePopupMenu();
+    AppendMenuW(hMenu, MF_STRING, IDM_EXPORT_CSV, L"Export Snapshot as CSV...");
+    AppendMenuW(hMenu, MF_STRING, IDM_EXPORT_JSON, L"Export Snapshot as JSON...");
+    AppendMenuW(hMenu, MF_STRING, IDM_EXPORT_NDJSON, L"Export Snapshot as NDJSON...");
+    AppendMenuW(hMenu, MF_SEPARATOR, 0, nullptr);
+    AppendMenuW(hMenu, MF_STRING, IDM_EXPORT_BINARY, L"Save Binary Snapshot...");
+    AppendMenuW(hMenu, MF_STRING, IDM_OPEN_SNAPSHOT, L"Open Snapshot...");
+    AppendMenuW(hMenu, MF_SEPARATOR, 0, nullptr);
+    if (m_recorder.IsRecording()) {
+        AppendMenuW(hMenu, MF_STRING, IDM_RECORD_STOP, L"Stop Recording");
+    } else {
+        AppendMenuW(hMenu, MF_STRING, IDM_RECORD_START, L"Start Recording...");
+    }
+    AppendMenuW(hMenu, MF_STRING, IDM_OPEN_RECORDING, L"Open Recording...");
+    AppendMenuW(hMenu, MF_SEPARATOR, 0, nullptr);
+    AppendMenuW(hMenu, MF_STRING, IDM_RULES_LOAD, L"Load Rules...");
+    AppendMenuW(hMenu, MF_STRING | (m_rules.RuleCount() > 0 ? 0 : MF_GRAYED), IDM_RULES_CLEAR, L"Clear Rules");
+    AppendMenuW(hMenu, MF_SEPARATOR, 0, nullptr);
+    AppendMenuW(hMenu, MF_STRING | (m_occludedOnly ? MF_CHECKED : 0), IDM_FILTER_OCCLUDED, L"Show Only Fully Occluded");
+    AppendMenuW(hMenu, MF_STRING | (m_offScreenOnly ? MF_CHECKED : 0), IDM_FILTER_OFFSCREEN, L"Show Only Off-Screen");
+    AppendMenuW(hMenu, MF_STRING | (m_groupByMonitor ? MF_CHECKED : 0), IDM_GROUP_MONITOR, L"Group by Monitor");
+    AppendMenuW(hMenu, MF_STRING | (m_groupByProcess && !m_groups.ByThread() ? MF_CHECKED : 0), IDM_GROUP_PROCESS, L"Group by Process");
+    AppendMenuW(hMenu, MF_STRING | (m_groupByProcess && m_groups.ByThread() ? MF_CHECKED : 0), IDM_GROUP_THREAD, L"Group by Thread");
+
+    int cmd = TrackPopupMenu(hMenu, TPM_RETURNCMD | TPM_NONOTIFY, rc.left, rc.bottom, 0, m_hwnd, nullptr);
+    DestroyMenu(hMenu);
+
+    switch (cmd) {
+    case IDM_EXPORT_CSV:
+        ExportSnapshot(SNAPSHOT_CSV);
+        break;
+    case IDM_EXPORT_JSON:
+        ExportSnapshot(SNAPSHOT_JSON);
+        break;
+    case IDM_EXPORT_NDJSON:
+        ExportSnapshot(SNAPSHOT_NDJSON);
+        break;
+    case IDM_EXPORT_BINARY:
+        SaveBinarySnapshot();
+        break;
+    case IDM_OPEN_SNAPSHOT:
+        OpenSnapshot();
+        break;
+    case IDM_RECORD_START:
+        StartRecording();
+        break;
+    case IDM_RECORD_STOP:
+        m_recorder.Stop();
+        UpdateStatusCount();
+        break;
+    case IDM_OPEN_RECORDING:
+        OpenRecording();
+        break;
+    case IDM_RULES_LOAD:
+        LoadRules();
+        break;
+    case IDM_RULES_CLEAR:
+        m_rules.SetRules(std::vector<WindowRule>());
+        UpdateStatusCount();
+        break;
+    case IDM_FILTER_OCCLUDED:
+        m_occludedOnly = !m_occludedOnly;
+        ApplyFilter();
+        break;
+    case IDM_FILTER_OFFSCREEN:
+        m_offScreenOnly = !m_offScreenOnly;
+        ApplyFilter();
+        break;
+    case IDM_GROUP_MONITOR:
+        m_groupByMonitor = !m_groupByMonitor;
+        m_sortValid = false;
+        ApplyFilter();
+        break;
+    case IDM_GROUP_PROCESS:
+        SetGrouping(!(m_groupByProcess && !m_groups.ByThread()), false);
+        break;
+    case IDM_GROUP_THREAD:
+        SetGrouping(!(m_groupByProcess && m_groups.ByThread()), true);
+        break;
+    }
+}
+
+void MainWindow::LoadRules() {
+    wchar_t path[MAX_PATH] = L"";
+    if (!PromptFilePath(L"txt", false, path)) {
+        return;
+    }
+
+    std::vector<WindowRule> rules;
+    std::wstring error;
+    if (!RuleParser::LoadRules(path, rules, error)) {
+        MessageBoxW(m_hwnd, error.c_str(), L"Load Rules", MB_OK | MB_ICONERROR);
+        return;
+    }
+
+    // Rules act on live windows; applied to every current window right away
+    m_rules.SetRules(std::move(rules));
+    RefreshWindowList();
+}
+
+bool MainWindow::PromptFilePath(const wchar_t* extension, bool save, wchar_t* path) {
+    // Filter is "<ext> files\0*.<ext>\0All files\0*.*\0\0"
+    std::wstring filter = extension;
+    filter += L" files";
+    filter.push_back(L'\0');
+    filter += L"*.";
+    filter += extension;
+    filter.push_back(L'\0');
+    filter += L"All files";
+    filter.push_back(L'\0');
+    filter += L"*.*";
+    filter.push_back(L'\0');
+
+    OPENFILENAMEW ofn = {};
+    ofn.lStructSize = sizeof(ofn);
+    ofn.hwndOwner = m_hwnd;
+    ofn.lpstrFilter = filter.c_str();
+    ofn.lpstrFile = path;
+    ofn.nMaxFile = MAX_PATH;
+    ofn.lpstrDefExt = extension;
+    if (save) {
+        ofn.Flags = OFN_OVERWRITEPROMPT | OFN_PATHMUSTEXIST;
+        return GetSaveFileNameW(&ofn) != FALSE;
+    }
+    ofn.Flags = OFN_FILEMUSTEXIST | OFN_PATHMUSTEXIST;
+    return GetOpenFileNameW(&ofn) != FALSE;
+}
+
+void MainWindow::ExportSnapshot(SnapshotFormat format) {
+    const wchar_t* extension = SnapshotExporter::FileExtension(format);
+
+    wchar_t path[MAX_PATH] = L"windows.";
+    wcscat_s(path, extension);
+    if (!PromptFilePath(extension, true, path)) {
+        return;
+    }
+
+    // Exports everything enumerated, in z-order, regardless of filter and sort
+    FILE* file = nullptr;
+    if (_wfopen_s(&file, path, L"wb") != 0 || !file) {
+        MessageBoxW(m_hwnd, L"Could not create the export file.", L"Export", MB_OK | MB_ICONERROR);
+        return;
+    }
+
+    FileSink sink(file);
+    bool ok = SnapshotExporter::Write(m_allWindows, format, sink);
+    if (fclose(file) != 0) {
+        ok = false;
+    }
+
+    if (!ok) {
+        MessageBoxW(m_hwnd, L"Writing the export file failed.", L"Export", MB_OK | MB_ICONERROR);
+    }
+}
+
+void MainWindow::SaveBinarySnapshot() {
+    wchar_t path[MAX_PATH] = L"windows.wls";
+    if (!PromptFilePath(L"wls", true, path)) {
+        return;
+    }
+
+    FILE* file = nullptr;
+    if (_wfopen_s(&file, path, L"wb") != 0 || !file) {
+        MessageBoxW(m_hwnd, L"Could not create the snapshot file.", L"Export", MB_OK | MB_ICONERROR);
+        return;
+    }
+
+    FileSink sink(file);
+    bool ok = SnapshotFileWriter::Write(m_allWindows, UnixTimeMs(), sink);
+    if (fclose(file) != 0) {
+        ok = false;
+    }
+
+    if (!ok) {
+        MessageBoxW(m_hwnd, L"Writing the snapshot file failed.", L"Export", MB_OK | MB_ICONERROR);
+    }
+}
+
+void MainWindow::OpenSnapshot() {
+    wchar_t path[MAX_PATH] = L"";
+    if (!PromptFilePath(L"wls", false, path)) {
+        return;
+    }
+
+    SnapshotFileReader reader;
+    if (!reader.Open(path)) {
+        MessageBoxW(m_hwnd, L"The file is not a valid WinLister snapshot.", L"Open Snapshot", MB_OK | MB_ICONERROR);
+        return;
+    }
+
+    StopAutoRefresh();
+    CloseReplay();
+
+    // Occlusion, z-order and monitor analysis read every window, and the
+    // filter changes while the file is shown, so all rows are built
+    reader.Materialize(m_allWindows);
+    m_zorder.Reset();
+    AnalyzeSnapshot(reader.CaptureTime());
+    m_sortValid = false;
+    m_snapshotSource = path;
+
+    std::wstring title = L"WinLister - Snapshot: ";
+    title += m_snapshotSource;
+    SetWindowTextW(m_hwnd, title.c_str());
+
+    ApplyFilter();
+}
+
+void MainWindow::StartRecording() {
+    wchar_t path[MAX_PATH] = L"windows.wlr";
+    if (!PromptFilePath(L"wlr", true, path)) {
+        return;
+    }
+
+    if (!m_recorder.Start(path)) {
+        MessageBoxW(m_hwnd, L"Could not create the recording file.", L"Recording", MB_OK | MB_ICONERROR);
+        return;
+    }
+
+    // Frames are recorded on each live refresh, starting with the current list
+    if (m_snapshotSource.empty()) {
+        m_recorder.Record(m_allWindows, UnixTimeMs());
+    }
+    UpdateStatusCount();
+}
+
+void MainWindow::OpenRecording() {
+    wchar_t path[MAX_PATH] = L"";
+    if (!PromptFilePath(L"wlr", false, path)) {
+        return;
+    }
+
+    // Opening maps every segment of the recording the file belongs to
+    SnapshotReplay replay;
+    if (!replay.Open(path)) {
+        MessageBoxW(m_hwnd, L"The file is not a valid WinLister recording.", L"Open Recording", MB_OK | MB_ICONERROR);
+        return;
+    }
+
+    StopAutoRefresh();
+    CloseReplay();
+    m_replay = std::move(replay);
+    m_zorder.Reset();
+    m_snapshotSource = path;
+
+    size_t lastFrame = m_replay.FrameCount() - 1;
+    SendMessageW(m_hReplaySlider, TBM_SETRANGEMIN, FALSE, 0);
+    SendMessageW(m_hReplaySlider, TBM_SETRANGEMAX, FALSE, static_cast<LPARAM>(lastFrame));
+    SendMessageW(m_hReplaySlider, TBM_SETPAGESIZE, 0, 10);
+    SendMessageW(m_hReplaySlider, TBM_SETPOS, TRUE, static_cast<LPARAM>(lastFrame));
+    ShowWindow(m_hReplaySlider, SW_SHOW);
+
+    RECT rc;
+    GetClientRect(m_hwnd, &rc);
+    OnSize(rc.right, rc.bottom);
+
+    m_sortValid = false;
+    ShowReplayFrame(lastFrame);
+}
+
+void MainWindow::ShowReplayFrame(size_t frame) {
+    if (frame == m_replay.CurrentFrame()) {
+        return;
+    }
+
+    // Windows count as raised since the frame shown before, going forward
+    if (frame < m_replay.CurrentFrame()) {
+        m_zorder.Reset();
+    }
+
+    // Scrubbing keeps the sort valid; consecutive frames differ by a few rows
+    if (!m_replay.SeekFrame(frame)) {
+        m_allWindows.clear();
+    } else {
+        m_allWindows = m_replay.Windows();
+    }
+    AnalyzeSnapshot(m_replay.FrameTime(frame));
+
+    wchar_t time[32];
+    FormatLocalTime(m_replay.FrameTime(frame), time, 32);
+    wchar_t title[MAX_PATH + 80];
+    swprintf_s(title, L"WinLister - Recording: %s @ %s (frame %zu of %zu)",
+        m_snapshotSource.c_str(), time, frame + 1, m_replay.FrameCount());
+    SetWindowTextW(m_hwnd, title);
+
+    ApplyFilter();
+}
+
+void MainWindow::CloseReplay() {
+    if (!m_replay.IsOpen()) {
+        return;
+    }
+
+    m_replay.Close();
+    ShowWindow(m_hReplaySlider, SW_HIDE);
+
+    RECT rc;
+    GetClientRect(m_hwnd, &rc);
+    OnSize(rc.right, rc.bottom);
+}
+
+void MainWindow::StopAutoRefresh() {
+    // Captured data is static: stop auto refresh until the list is refreshed
+    // again, which switches back to live windows
+    m_autoRefresh = false;
+    Button_SetCheck(m_hCheckAutoRefresh, BST_UNCHECKED);
+    InvalidateRect(m_hCheckAutoRefresh, nullptr, TRUE);
+    UpdateAutoRefresh();
+}
+
+void MainWindow::CopyToClipboard(const std::wstring& text) {
+    Clipboard::SetText(m_hwnd, text);
+}
+
+void MainWindow::OnColumnClick(int column, bool extend) {
+    auto it = std::find_if(m_sortSpec.keys.begin(), m_sortSpec.keys.end(),
+        [column](const SortKey& key) { return key.column == column; });
+
+    if (extend) {
+        // Shift-click: add the column as the next key, or cycle its direction
+        // (ascending, descending, removed) while keeping the other keys
+        if (it == m_sortSpec.keys.end()) {
+            m_sortSpec.keys.push_back({ column, true });
+        } else if (it->ascending) {
+            it->ascending = false;
+        } else {
+            m_sortSpec.keys.erase(it);
+        }
+    } else if (m_sortSpec.keys.size() == 1 && it != m_sortSpec.keys.end()) {
         // Same column clicked - cycle through states
-        m_sortState = (m_sortState + 1) % 3;
-        if (m_sortState == 0) {
-            m_sortColumn = -1;
+        if (it->ascending) {
+            it->ascending = false;
+        } else {
+            m_sortSpec.keys.clear();
         }
     } else {
-        // New column clicked
-        m_sortColumn = column;
-        m_sortState = 1; // Start with ascending
+        // New column clicked - start with ascending
+        m_sortSpec.keys.assign(1, { column, true });
     }
 
-    // Update header to show sort arrow
+    UpdateSortIndicators();
+
+    // The sort order changed, so the current list can't be updated in place
+    m_sortValid = false;
+    ApplyFilter();
+}
+
+void MainWindow::UpdateSortIndicators() {
+    // Update header to show sort arrows
     HWND hHeader = ListView_GetHeader(m_hListView);
-    for (int i = 0; i < 8; i++) {
+    for (int i = 0; i < COLUMN_COUNT; i++) {
         HDITEMW hdi = {};
         hdi.mask = HDI_FORMAT;
         Header_GetItem(hHeader, i, &hdi);
         hdi.fmt &= ~(HDF_SORTUP | HDF_SORTDOWN);
-        if (i == m_sortColumn && m_sortState != 0) {
-            hdi.fmt |= (m_sortState == 1) ? HDF_SORTUP : HDF_SORTDOWN;
+        if (const SortKey* key = m_sortSpec.Find(i)) {
+            hdi.fmt |= key->ascending ? HDF_SORTUP : HDF_SORTDOWN;
         }
         Header_SetItem(hHeader, i, &hdi);
     }
+}
+
+void MainWindow::SortWindows(std::vector<WindowInfo>&& filtered) {
+    // Grouping puts the monitor first unless the spec already sorts on it
+    SortSpec spec = m_sortSpec;
+    if (m_groupByMonitor && !spec.Find(COLUMN_MONITOR)) {
+        spec.keys.insert(spec.keys.begin(), { COLUMN_MONITOR, true });
+    }
+
+    if (spec.IsEmpty()) {
+        // No sorting - keep the z-order from ApplyFilter
+        m_filteredWindows = std::move(filtered);
+        m_sortValid = false;
+        return;
+    }
+
+    if (m_sortValid) {
+        // Only re-place windows that appeared or changed since the last pass
+        WindowSorter::Update(m_filteredWindows, std::move(filtered), spec);
+    } else {
+        m_filteredWindows = std::move(filtered);
+        WindowSorter::Sort(m_filteredWindows, spec);
+        m_sortValid = true;
+    }
+}
 
-    SortWindows();
+void MainWindow::SetGrouping(bool enabled, bool byThread) {
+    std::vector<HWND> selection = GetSelectedHandles();
+    m_groupByProcess = enabled;
+    if (enabled) {
+        // Expanded groups are kept unless switching between processes and
+        // threads, whose keys differ
+        if (m_groups.ByThread() != byThread) {
+            m_expandedGroups.clear();
+        }
+        m_groups.SetByThread(byThread);
+        m_groups.Build(m_allWindows);
+    } else {
+        m_groups.Clear();
+        m_listRows.clear();
+    }
+    LayoutRows();
     PopulateListView();
+    UpdateStatusCount();
+    RestoreSelection(selection);
 }
 
-void MainWindow::SortWindows() {
-    if (m_sortColumn < 0 || m_sortState == 0) {
-        // No sorting - restore original order from ApplyFilter
-        ApplyFilter();
-        return;
+void MainWindow::LayoutRows() {
+    if (m_groupByProcess) {
+        m_groups.Layout(m_filteredWindows, m_expandedGroups, m_listRows);
     }
+}
 
-    bool ascending = (m_sortState == 1);
+int MainWindow::RowCount() const {
+    return static_cast<int>(m_groupByProcess ? m_listRows.size() : m_filteredWindows.size());
+}
 
-    std::sort(m_filteredWindows.begin(), m_filteredWindows.end(),
-        [this, ascending](const WindowInfo& a, const WindowInfo& b) {
-            int cmp = 0;
+const WindowInfo* MainWindow::RowWindow(int row) const {
+    // nullptr for a group header
+    if (!m_groupByProcess) {
+        return &m_filteredWindows[row];
+    }
+    uint32_t window = m_listRows[row].window;
+    return window == GroupRow::HEADER ? nullptr : &m_filteredWindows[window];
+}
 
-            switch (m_sortColumn) {
-            case 0: // HWND
-                cmp = (reinterpret_cast<uintptr_t>(a.hwnd) < reinterpret_cast<uintptr_t>(b.hwnd)) ? -1 :
-                      (reinterpret_cast<uintptr_t>(a.hwnd) > reinterpret_cast<uintptr_t>(b.hwnd)) ? 1 : 0;
-                break;
-            case 1: // Title
-                cmp = _wcsicmp(a.title.c_str(), b.title.c_str());
-                break;
-            case 2: // Class
-                cmp = _wcsicmp(a.className.c_str(), b.className.c_str());
-                break;
-            case 3: // Process
-                cmp = _wcsicmp(a.processName.c_str(), b.processName.c_str());
-                break;
-            case 4: // PID
-                cmp = (a.processId < b.processId) ? -1 : (a.processId > b.processId) ? 1 : 0;
-                break;
-            case 5: // Visible
-                cmp = (a.isVisible == b.isVisible) ? 0 : (a.isVisible ? -1 : 1);
-                break;
-            case 6: // Position (sort by left, then top)
-                cmp = (a.rect.left < b.rect.left) ? -1 : (a.rect.left > b.rect.left) ? 1 :
-                      (a.rect.top < b.rect.top) ? -1 : (a.rect.top > b.rect.top) ? 1 : 0;
-                break;
-            case 7: { // Size (sort by total pixels)
-                int sizeA = (a.rect.right - a.rect.left) * (a.rect.bottom - a.rect.top);
-                int sizeB = (b.rect.right - b.rect.left) * (b.rect.bottom - b.rect.top);
-                cmp = (sizeA < sizeB) ? -1 : (sizeA > sizeB) ? 1 : 0;
-                break;
-            }
-            }
+const wchar_t* MainWindow::GroupText(const WindowGroup& group, int column) {
+    m_groupText.clear();
+    switch (column) {
+    case COLUMN_HWND:
+        m_groupText = m_expandedGroups.count(group.key) ? L"[-]" : L"[+]";
+        break;
+    case COLUMN_TITLE:
+        TextFormat::AppendUnsigned(m_groupText, group.windows);
+        m_groupText += L" windows, ";
+        TextFormat::AppendUnsigned(m_groupText, group.visible);
+        m_groupText += L" visible";
+        break;
+    case COLUMN_CLASS:
+        if (m_groups.ByThread()) {
+            m_groupText = L"Thread ";
+            TextFormat::AppendUnsigned(m_groupText, group.threadId);
+        }
+        break;
+    case COLUMN_PROCESS:
+        m_groupText = group.processName;
+        break;
+    case COLUMN_PID:
+        TextFormat::AppendUnsigned(m_groupText, group.processId);
+        break;
+    case COLUMN_SIZE:
+        TextFormat::AppendUnsigned(m_groupText, group.area);
+        m_groupText += L" px";
+        break;
+    }
+    return m_groupText.c_str();
+}
 
-            return ascending ? (cmp < 0) : (cmp > 0);
-        });
+void MainWindow::ExpandGroup(int row, int expand) {
+    // expand: 1 to expand, 0 to collapse, -1 to toggle. A window row acts on
+    // its group, and the group's header is selected afterwards.
+    if (!m_groupByProcess || row < 0 || row >= RowCount()) {
+        return;
+    }
+    while (m_listRows[row].window != GroupRow::HEADER) {
+        row--;
+    }
+    uint64_t key = m_groups.Groups()[m_listRows[row].group].key;
+    bool expanded = m_expandedGroups.count(key) != 0;
+    bool want = expand < 0 ? !expanded : expand != 0;
+    if (want == expanded) {
+        return;
+    }
+    if (want) {
+        m_expandedGroups.insert(key);
+    } else {
+        m_expandedGroups.erase(key);
+    }
+
+    // Rows above the header keep their places
+    LayoutRows();
+    PopulateListView();
+    ListView_SetItemState(m_hListView, row, LVIS_SELECTED | LVIS_FOCUSED, LVIS_SELECTED | LVIS_FOCUSED);
+    ListView_EnsureVisible(m_hListView, row, FALSE);
 }
 
 void MainWindow::OnTimer() {
-    // Save current selection
-    int sel = ListView_GetNextItem(m_hListView, -1, LVNI_SELECTED);
-    HWND selectedHwnd = nullptr;
-    if (sel >= 0 && sel < static_cast<int>(m_filteredWindows.size())) {
-        selectedHwnd = m_filteredWindows[sel].hwnd;
-    }
+    std::vector<HWND> selection = GetSelectedHandles();
+    std::vector<uint64_t> groups = GetSelectedGroups();
 
-    // Refresh window list
-    m_allWindows = WindowEnumerator::EnumerateAllWindows();
+    // Refresh window list (filters, keeps the sort order and populates once)
+    EnumerateLiveWindows();
     ApplyFilter();
 
-    // Re-apply sort if active
-    if (m_sortColumn >= 0 && m_sortState != 0) {
-        SortWindows();
-        PopulateListView();
+    RestoreSelection(selection, groups);
+}
+
+std::vector<HWND> MainWindow::GetSelectedHandles() const {
+    std::vector<HWND> handles;
+    int sel = -1;
+    while ((sel = ListView_GetNextItem(m_hListView, sel, LVNI_SELECTED)) >= 0) {
+        const WindowInfo* win = sel < RowCount() ? RowWindow(sel) : nullptr;
+        if (win) {
+            handles.push_back(win->hwnd);
+        }
     }
+    return handles;
+}
 
-    // Restore selection
-    if (selectedHwnd) {
-        for (int i = 0; i < static_cast<int>(m_filteredWindows.size()); i++) {
-            if (m_filteredWindows[i].hwnd == selectedHwnd) {
-                ListView_SetItemState(m_hListView, i, LVIS_SELECTED | LVIS_FOCUSED, LVIS_SELECTED | LVIS_FOCUSED);
-                ListView_EnsureVisible(m_hListView, i, FALSE);
-                break;
+std::vector<uint64_t> MainWindow::GetSelectedGroups() const {
+    std::vector<uint64_t> keys;
+    if (!m_groupByProcess) {
+        return keys;
+    }
+    int sel = -1;
+    while ((sel = ListView_GetNextItem(m_hListView, sel, LVNI_SELECTED)) >= 0) {
+        if (sel < RowCount() && m_listRows[sel].window == GroupRow::HEADER) {
+            keys.push_back(m_groups.Groups()[m_listRows[sel].group].key);
+        }
+    }
+    return keys;
+}
+
+void MainWindow::RestoreSelection(const std::vector<HWND>& handles, const std::vector<uint64_t>& groups) {
+    if (handles.empty() && groups.empty()) {
+        return;
+    }
+
+    std::unordered_set<HWND> selected(handles.begin(), handles.end());
+    std::unordered_set<uint64_t> selectedGroups(groups.begin(), groups.end());
+    if (m_groupByProcess && !selected.empty()) {
+        // A selected window in a collapsed group has no row; its group is
+        // expanded to show it
+        bool expanded = false;
+        for (const WindowInfo& win : m_filteredWindows) {
+            if (selected.count(win.hwnd) && m_expandedGroups.insert(m_groups.KeyOf(win)).second) {
+                expanded = true;
             }
         }
+        if (expanded) {
+            LayoutRows();
+            PopulateListView();
+        }
+    }
+
+    int first = -1;
+    int count = RowCount();
+    for (int i = 0; i < count; i++) {
+        const WindowInfo* win = RowWindow(i);
+        bool header = !win && selectedGroups.count(m_groups.Groups()[m_listRows[i].group].key);
+        if (header || (win && selected.count(win->hwnd))) {
+            ListView_SetItemState(m_hListView, i, LVIS_SELECTED, LVIS_SELECTED);
+            if (first < 0) {
+                first = i;
+            }
+        }
+    }
+    if (first >= 0) {
+        ListView_SetItemState(m_hListView, first, LVIS_FOCUSED, LVIS_FOCUSED);
+        ListView_EnsureVisible(m_hListView, first, FALSE);
     }
 }
 
@@ -1042,6 +1933,8 @@ void MainWindow::ApplyDarkMode() {
         SetWindowTheme(m_hCheckHideSystem, L"DarkMode_Explorer", nullptr);
         SetWindowTheme(m_hCheckAutoRefresh, L"DarkMode_Explorer", nullptr);
         SetWindowTheme(m_hBtnRefresh, L"DarkMode_Explorer", nullptr);
+        SetWindowTheme(m_hBtnExport, L"DarkMode_Explorer", nullptr);
+        SetWindowTheme(m_hBtnPick, L"DarkMode_Explorer", nullptr);
 
         // Apply dark theme to edit controls
         SetWindowTheme(m_hEditSearch, L"DarkMode_CFD", nullptr);
@@ -1053,6 +1946,8 @@ void MainWindow::ApplyDarkMode() {
             pAllowDarkModeForWindow(m_hCheckHideSystem, true);
             pAllowDarkModeForWindow(m_hCheckAutoRefresh, true);
             pAllowDarkModeForWindow(m_hBtnRefresh, true);
+            pAllowDarkModeForWindow(m_hBtnExport, true);
+            pAllowDarkModeForWindow(m_hBtnPick, true);
             pAllowDarkModeForWindow(m_hEditSearch, true);
             pAllowDarkModeForWindow(m_hEditRefreshTime, true);
         }
@@ -1070,6 +1965,8 @@ void MainWindow::ApplyDarkMode() {
         SetWindowTheme(m_hCheckHideSystem, nullptr, nullptr);
         SetWindowTheme(m_hCheckAutoRefresh, nullptr, nullptr);
         SetWindowTheme(m_hBtnRefresh, nullptr, nullptr);
+        SetWindowTheme(m_hBtnExport, nullptr, nullptr);
+        SetWindowTheme(m_hBtnPick, nullptr, nullptr);
         SetWindowTheme(m_hEditSearch, nullptr, nullptr);
         SetWindowTheme(m_hEditRefreshTime, nullptr, nullptr);
 
@@ -1078,6 +1975,8 @@ void MainWindow::ApplyDarkMode() {
             pAllowDarkModeForWindow(m_hCheckHideSystem, false);
             pAllowDarkModeForWindow(m_hCheckAutoRefresh, false);
             pAllowDarkModeForWindow(m_hBtnRefresh, false);
+            pAllowDarkModeForWindow(m_hBtnExport, false);
+            pAllowDarkModeForWindow(m_hBtnPick, false);
             pAllowDarkModeForWindow(m_hEditSearch, false);
             pAllowDarkModeForWindow(m_hEditRefreshTime, false);
         }
@@ -1099,6 +1998,9 @@ void MainWindow::OnSettingChange(WPARAM wParam, LPARAM lParam) {
     if (lParam) {
         const wchar_t* setting = reinterpret_cast<const wchar_t*>(lParam);
         if (wcscmp(setting, L"ImmersiveColorSet") == 0) {
+            // Theme changed: rebuild the cached brushes, pens and header bitmap
+            DestroyPaintCache();
+            CreatePaintCache();
             UpdateDarkMode();
         }
     }
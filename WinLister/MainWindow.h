@@ -6,7 +6,22 @@
 #include <CommCtrl.h>
 #include <vector>
 #include <string>
+#include <unordered_set>
 #include "WindowInfo.h"
+#include "WindowSort.h"
+#include "IconRegistry.h"
+#include "RowText.h"
+#include "HeaderPaint.h"
+#include "SnapshotExport.h"
+#include "SnapshotRecording.h"
+#include "QueryServer.h"
+#include "SharedSnapshot.h"
+#include "WindowRules.h"
+#include "WindowAnimation.h"
+#include "WindowSpatial.h"
+#include "WindowZOrder.h"
+#include "WindowMonitor.h"
+#include "WindowGroups.h"
 
 class MainWindow {
 public:
@@ -21,6 +36,9 @@ private:
     static LRESULT CALLBACK WndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam);
     static LRESULT CALLBACK HeaderProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam, UINT_PTR uIdSubclass, DWORD_PTR dwRefData);
     LRESULT HandleMessage(UINT msg, WPARAM wParam, LPARAM lParam);
+    void RenderHeader(HWND hHeader, HDC hdc, int width, int height);
+    void CreatePaintCache();
+    void DestroyPaintCache();
 
     void OnCreate();
     void OnSize(int width, int height);
@@ -31,14 +49,45 @@ private:
     void CreateControls();
     void CreateListView();
     void RefreshWindowList();
+    void EnumerateLiveWindows();
     void PopulateListView();
+    void OnGetDispInfo(LVITEMW& item);
+    int AcquireIconSlot(HICON hIcon);
+    LRESULT FindListItem(int start, const LVFINDINFOW& find);
     void UpdateStatusCount();
     void ShowWindowDetails(int index);
     void ApplyFilter();
+    void AnalyzeSnapshot(uint64_t time);
     void ShowContextMenu(int x, int y);
+    void ArrangeSelection(int command);
+    void FadeSelection(BYTE alpha);
+    void StartPicking();
+    void PickAt(POINT pt);
+    void StopPicking(bool keep);
+    std::vector<HWND> GetSelectedHandles() const;
+    std::vector<uint64_t> GetSelectedGroups() const;
+    void RestoreSelection(const std::vector<HWND>& handles, const std::vector<uint64_t>& groups = {});
     void CopyToClipboard(const std::wstring& text);
-    void OnColumnClick(int column);
-    void SortWindows();
+    void ShowExportMenu();
+    bool PromptFilePath(const wchar_t* extension, bool save, wchar_t* path);
+    void ExportSnapshot(SnapshotFormat format);
+    void SaveBinarySnapshot();
+    void OpenSnapshot();
+    void StartRecording();
+    void OpenRecording();
+    void LoadRules();
+    void ShowReplayFrame(size_t frame);
+    void CloseReplay();
+    void StopAutoRefresh();
+    void OnColumnClick(int column, bool extend);
+    void UpdateSortIndicators();
+    void SortWindows(std::vector<WindowInfo>&& filtered);
+    void SetGrouping(bool enabled, bool byThread);
+    void LayoutRows();
+    int RowCount() const;
+    const WindowInfo* RowWindow(int row) const;
+    const wchar_t* GroupText(const WindowGroup& group, int column);
+    void ExpandGroup(int row, int expand);
     void OnTimer();
     void UpdateAutoRefresh();
     void ApplyDarkMode();
@@ -52,24 +101,51 @@ private:
     HWND m_hCheckHideHidden;
     HWND m_hCheckHideSystem;
     HWND m_hBtnRefresh;
+    HWND m_hBtnExport;
+    HWND m_hBtnPick;
     HWND m_hStaticCount;
     HWND m_hEditSearch;
     HWND m_hCheckAutoRefresh;
     HWND m_hEditRefreshTime;
     HWND m_hStaticMs;
     HWND m_hStaticSearch;
+    HWND m_hReplaySlider;
     HINSTANCE m_hInstance;
     HIMAGELIST m_hImageList;
+    IconRegistry m_iconRegistry;
+    std::vector<int> m_rowIcons;       // Image-list slot per list row
+    RowTextProvider m_rowText;
 
     std::vector<WindowInfo> m_allWindows;
+    std::wstring m_snapshotSource;     // File m_allWindows was loaded from; empty when live
+    SnapshotRecorder m_recorder;       // Records each live refresh while running
+    SnapshotReplay m_replay;           // Open recording shown through the replay slider
+    QueryServer m_queryServer;         // Answers other processes from each live refresh
+    SharedSnapshotWriter m_sharedSnapshot;  // Publishes each live refresh to shared memory
+    RuleEngine m_rules;                // Applies loaded rules to new and changed windows
+    WindowAnimator m_animator;         // Fades and slides windows on the display refresh
+    SpatialIndex m_spatial;            // Shown m_allWindows by frame, for picking
+    bool m_spatialValid;               // m_spatial matches m_allWindows
+    ZOrderTracker m_zorder;            // Stamps windows raised since the previous m_allWindows
+    MonitorLayout m_monitors;          // Current monitors, for placing m_allWindows on them
+    WindowGroups m_groups;             // Per-process totals over m_allWindows, while grouping
+    std::unordered_set<uint64_t> m_expandedGroups;  // Group keys shown with their windows
+    std::vector<GroupRow> m_listRows;  // List rows while grouping: headers and m_filteredWindows
+    std::wstring m_groupText;          // Header cell last handed to the list
+    bool m_picking;                    // Mouse captured to pick the window under the cursor
+    std::vector<HWND> m_pickSelection; // Selection to go back to if picking is cancelled
     std::vector<WindowInfo> m_filteredWindows;
     std::wstring m_searchText;
 
     bool m_hideHidden;
     bool m_hideSystem;
+    bool m_occludedOnly;   // only shown windows that are fully covered
+    bool m_offScreenOnly;  // only shown windows on no monitor
+    bool m_groupByMonitor; // rows sorted by monitor ahead of the sort spec
+    bool m_groupByProcess; // rows under collapsible process (or thread) headers
 
-    int m_sortColumn;      // -1 = no sort, 0-7 = column index
-    int m_sortState;       // 0 = none, 1 = ascending, 2 = descending
+    SortSpec m_sortSpec;   // empty = z-order
+    bool m_sortValid;      // m_filteredWindows is ordered by the current sort
 
     bool m_autoRefresh;
     UINT m_refreshInterval;
@@ -77,6 +153,33 @@ private:
     bool m_darkMode;
     HBRUSH m_hDarkBrush;
 
+    // GDI objects for dark-mode painting, created once per theme
+    struct ThemedPaintCache {
+        HBRUSH headerBrush = nullptr;
+        HBRUSH editBrush = nullptr;
+        HBRUSH arrowBrush = nullptr;
+        HPEN borderPen = nullptr;
+        HPEN arrowPen = nullptr;
+        HPEN checkBorderPen = nullptr;
+        HPEN checkMarkPen = nullptr;
+
+        // Header back buffer
+        HDC headerDC = nullptr;
+        HBITMAP headerBitmap = nullptr;
+        HBITMAP hOldHeaderBitmap = nullptr;
+        int headerWidth = 0;
+        int headerHeight = 0;
+    };
+    ThemedPaintCache m_paintCache;
+    HeaderPaintState m_headerPaint;
+
     static const UINT_PTR TIMER_REFRESH = 1;
+    static const UINT WM_ANIMATION_FRAME = WM_APP + 1;
+    static const uint32_t FADE_DURATION = 250;       // ms
+    static const uint32_t ARRANGE_DURATION = 200;    // ms
+    static const int REPLAY_SLIDER_HEIGHT = 30;
+    static const int TOOLBAR_RIGHT = 1045;       // right of the Pick button, with a gap
+    static const int STATUS_MIN_WIDTH = 200;     // status count, at the narrowest
     static const wchar_t* CLASS_NAME;
+    static const wchar_t* WINDOW_TITLE;
 };
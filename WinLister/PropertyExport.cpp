@@ -0,0 +1,267 @@
+#include "PropertyExport.h"
+
+namespace {
+
+// Sinks for the two passes; Emit is written once against this interface
+struct CountSink {
+    size_t count = 0;
+
+    void Put(wchar_t) { count++; }
+    void Put(const wchar_t*, size_t length) { count += length; }
+};
+
+struct WriteSink {
+    wchar_t* out;
+
+    void Put(wchar_t c) { *out++ = c; }
+    void Put(const wchar_t* text, size_t length) {
+        for (size_t i = 0; i < length; i++) {
+            out[i] = text[i];
+        }
+        out += length;
+    }
+};
+
+template <size_t N, typename Sink>
+void PutLiteral(Sink& sink, const wchar_t (&text)[N]) {
+    sink.Put(text, N - 1);
+}
+
+// Holds back each line break until more text follows, so an export can end
+// without one
+template <typename Sink>
+struct LineSink {
+    Sink& out;
+    bool pending;
+
+    void Flush() {
+        if (pending) {
+            PutLiteral(out, L"\r\n");
+            pending = false;
+        }
+    }
+    void Put(wchar_t c) {
+        Flush();
+        out.Put(c);
+    }
+    void Put(const wchar_t* text, size_t length) {
+        Flush();
+        out.Put(text, length);
+    }
+    void Line() {
+        Flush();
+        pending = true;
+    }
+};
+
+template <typename Sink>
+void PutLine(Sink& sink) {
+    sink.Line();
+}
+
+// Section rows carry their title decorated as "--- Title ---"
+void SectionTitle(const std::wstring& value, size_t& start, size_t& length) {
+    size_t first = 0;
+    size_t last = value.size();
+    while (first < last && (value[first] == L'-' || value[first] == L' ')) first++;
+    while (last > first && (value[last - 1] == L'-' || value[last - 1] == L' ')) last--;
+    start = first;
+    length = last - first;
+}
+
+// Tabs and line breaks would split a TSV row; they become spaces
+template <typename Sink>
+void PutTsv(Sink& sink, const std::wstring& text) {
+    size_t runStart = 0;
+    for (size_t i = 0; i < text.size(); i++) {
+        wchar_t c = text[i];
+        if (c == L'\t' || c == L'\r' || c == L'\n') {
+            sink.Put(text.data() + runStart, i - runStart);
+            sink.Put(L' ');
+            runStart = i + 1;
+        }
+    }
+    sink.Put(text.data() + runStart, text.size() - runStart);
+}
+
+template <typename Sink>
+void PutJsonString(Sink& sink, const wchar_t* text, size_t length) {
+    static const wchar_t hexDigits[] = L"0123456789abcdef";
+
+    sink.Put(L'"');
+    size_t runStart = 0;
+    for (size_t i = 0; i < length; i++) {
+        wchar_t c = text[i];
+        if (c != L'"' && c != L'\\' && c >= 0x20) {
+            continue;
+        }
+        sink.Put(text + runStart, i - runStart);
+        runStart = i + 1;
+
+        switch (c) {
+        case L'"': PutLiteral(sink, L"\\\""); break;
+        case L'\\': PutLiteral(sink, L"\\\\"); break;
+        case L'\n': PutLiteral(sink, L"\\n"); break;
+        case L'\r': PutLiteral(sink, L"\\r"); break;
+        case L'\t': PutLiteral(sink, L"\\t"); break;
+        default:
+            PutLiteral(sink, L"\\u00");
+            sink.Put(hexDigits[(c >> 4) & 0xF]);
+            sink.Put(hexDigits[c & 0xF]);
+            break;
+        }
+    }
+    sink.Put(text + runStart, length - runStart);
+    sink.Put(L'"');
+}
+
+// Pipes would end a Markdown cell and line breaks the row
+template <typename Sink>
+void PutMarkdownCell(Sink& sink, const wchar_t* text, size_t length) {
+    size_t runStart = 0;
+    for (size_t i = 0; i < length; i++) {
+        wchar_t c = text[i];
+        if (c == L'|' || c == L'\r' || c == L'\n') {
+            sink.Put(text + runStart, i - runStart);
+            if (c == L'|') {
+                PutLiteral(sink, L"\\|");
+            } else {
+                sink.Put(L' ');
+            }
+            runStart = i + 1;
+        }
+    }
+    sink.Put(text + runStart, length - runStart);
+}
+
+} // namespace
+
+template <typename Sink>
+void PropertyExporter::Emit(const PropertyModel& model, PropertyExportFormat format, bool finalLineBreak, Sink& out) {
+    size_t count = model.Count();
+    LineSink<Sink> sink = { out, false };
+
+    switch (format) {
+    case EXPORT_TEXT:
+        for (size_t i = 0; i < count; i++) {
+            const PropertyRow& row = model.Row(i);
+            if (row.section) {
+                if (i > 0) PutLine(sink);
+                sink.Put(row.value.data(), row.value.size());
+            } else {
+                sink.Put(row.name.data(), row.name.size());
+                PutLiteral(sink, L": ");
+                sink.Put(row.value.data(), row.value.size());
+            }
+            PutLine(sink);
+        }
+        break;
+
+    case EXPORT_TSV:
+        for (size_t i = 0; i < count; i++) {
+            const PropertyRow& row = model.Row(i);
+            if (row.name.empty() && row.value.empty()) continue;
+            PutTsv(sink, row.name);
+            sink.Put(L'\t');
+            PutTsv(sink, row.value);
+            PutLine(sink);
+        }
+        break;
+
+    case EXPORT_JSON: {
+        sink.Put(L'{');
+        bool inSection = false;
+        bool needComma = false;
+        for (size_t i = 0; i < count; i++) {
+            const PropertyRow& row = model.Row(i);
+
+            if (row.section) {
+                if (inSection) {
+                    PutLine(sink);
+                    PutLiteral(sink, L"  }");
+                    needComma = true;
+                }
+                if (needComma) sink.Put(L',');
+                PutLine(sink);
+
+                size_t start, length;
+                SectionTitle(row.value, start, length);
+                PutLiteral(sink, L"  ");
+                PutJsonString(sink, row.value.data() + start, length);
+                PutLiteral(sink, L": {");
+                inSection = true;
+                needComma = false;
+                continue;
+            }
+
+            if (needComma) sink.Put(L',');
+            PutLine(sink);
+            sink.Put(L"    ", inSection ? 4 : 2);
+            PutJsonString(sink, row.name.data(), row.name.size());
+            PutLiteral(sink, L": ");
+            PutJsonString(sink, row.value.data(), row.value.size());
+            needComma = true;
+        }
+        if (inSection) {
+            PutLine(sink);
+            PutLiteral(sink, L"  }");
+        }
+        PutLine(sink);
+        sink.Put(L'}');
+        PutLine(sink);
+        break;
+    }
+
+    case EXPORT_MARKDOWN:
+        PutLiteral(sink, L"| Property | Value |");
+        PutLine(sink);
+        PutLiteral(sink, L"| --- | --- |");
+        PutLine(sink);
+        for (size_t i = 0; i < count; i++) {
+            const PropertyRow& row = model.Row(i);
+            PutLiteral(sink, L"| ");
+            if (row.section) {
+                size_t start, length;
+                SectionTitle(row.value, start, length);
+                PutLiteral(sink, L"**");
+                PutMarkdownCell(sink, row.value.data() + start, length);
+                PutLiteral(sink, L"** |  |");
+            } else {
+                PutMarkdownCell(sink, row.name.data(), row.name.size());
+                PutLiteral(sink, L" | ");
+                PutMarkdownCell(sink, row.value.data(), row.value.size());
+                PutLiteral(sink, L" |");
+            }
+            PutLine(sink);
+        }
+        break;
+    }
+
+    if (finalLineBreak) {
+        sink.Flush();
+    }
+}
+
+size_t PropertyExporter::Measure(const PropertyModel& model, PropertyExportFormat format, bool finalLineBreak) {
+    CountSink sink;
+    Emit(model, format, finalLineBreak, sink);
+    return sink.count;
+}
+
+size_t PropertyExporter::Write(const PropertyModel& model, PropertyExportFormat format, wchar_t* out,
+    bool finalLineBreak) {
+    WriteSink sink = { out };
+    Emit(model, format, finalLineBreak, sink);
+    *sink.out = L'\0';
+    return static_cast<size_t>(sink.out - out);
+}
+
+std::wstring PropertyExporter::ToString(const PropertyModel& model, PropertyExportFormat format,
+    bool finalLineBreak) {
+    std::wstring text(Measure(model, format, finalLineBreak), L'\0');
+    if (!text.empty()) {
+        WriteSink sink = { &text[0] };
+        Emit(model, format, finalLineBreak, sink);
+    }
+    return text;
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include "PropertyModel.h"
+
+enum PropertyExportFormat {
+    EXPORT_TEXT = 0,    // "Name: value" lines
+    EXPORT_TSV,         // name <tab> value lines
+    EXPORT_JSON,        // one object, sections as nested objects
+    EXPORT_MARKDOWN     // two-column table, sections as bold rows
+};
+
+// Renders a property model as text. Output is produced by one formatting pass
+// run twice: once to count characters and once to write them, so a caller
+// can size the destination (e.g. a clipboard HGLOBAL) exactly and have the
+// text written straight into it with no intermediate strings. Lines end in
+// CRLF; without finalLineBreak the last line has none.
+class PropertyExporter {
+public:
+    // Length of the export in characters, excluding the terminator
+    static size_t Measure(const PropertyModel& model, PropertyExportFormat format, bool finalLineBreak = true);
+    // Writes the export and a terminating null into out, which must hold
+    // Measure() + 1 characters. Returns the length written, excluding the null.
+    static size_t Write(const PropertyModel& model, PropertyExportFormat format, wchar_t* out,
+        bool finalLineBreak = true);
+    static std::wstring ToString(const PropertyModel& model, PropertyExportFormat format,
+        bool finalLineBreak = true);
+
+private:
+    template <typename Sink>
+    static void Emit(const PropertyModel& model, PropertyExportFormat format, bool finalLineBreak, Sink& out);
+};
@@ -0,0 +1,69 @@
+#include "PropertyModel.h"
+
+void PropertyModel::Begin() {
+    m_cursor = 0;
+    m_edits.clear();
+    m_changed.clear();
+}
+
+void PropertyModel::Add(const wchar_t* name, const wchar_t* value) {
+    Put(name, value, false);
+}
+
+void PropertyModel::AddSection(const wchar_t* title) {
+    Put(L"", title, true);
+}
+
+void PropertyModel::Put(const wchar_t* name, const wchar_t* value, bool section) {
+    // Assigning into the rows left from an earlier build reuses their buffers
+    if (m_cursor >= m_next.size()) {
+        m_next.emplace_back();
+    }
+    PropertyRow& row = m_next[m_cursor];
+    row.name = name;
+    row.value = value;
+    row.section = section;
+    m_cursor++;
+}
+
+bool PropertyModel::SameRow(const PropertyRow& a, const PropertyRow& b) {
+    return a.section == b.section && (a.section ? a.value == b.value : a.name == b.name);
+}
+
+bool PropertyModel::End() {
+    m_next.resize(m_cursor);
+
+    // Walk both builds in order. A new row found further down the old rows
+    // means the old rows before it went away; one not found at all appeared.
+    size_t oldRow = 0;
+    size_t newRow = 0;
+    while (newRow < m_next.size()) {
+        const PropertyRow& row = m_next[newRow];
+        if (oldRow < m_rows.size() && SameRow(m_rows[oldRow], row)) {
+            if (m_rows[oldRow].value != row.value) {
+                m_changed.push_back(newRow);
+            }
+            oldRow++;
+            newRow++;
+            continue;
+        }
+        size_t found = oldRow;
+        while (found < m_rows.size() && !SameRow(m_rows[found], row)) {
+            found++;
+        }
+        if (found < m_rows.size()) {
+            for (; oldRow < found; oldRow++) {
+                m_edits.push_back({ PropertyEdit::DELETE, newRow });
+            }
+            continue;
+        }
+        m_edits.push_back({ PropertyEdit::INSERT, newRow });
+        newRow++;
+    }
+    for (; oldRow < m_rows.size(); oldRow++) {
+        m_edits.push_back({ PropertyEdit::DELETE, newRow });
+    }
+
+    m_rows.swap(m_next);
+    return !m_edits.empty();
+}
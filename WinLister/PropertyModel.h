@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// One name/value row of the details view. Section rows have an empty name and
+// the section title as their value.
+struct PropertyRow {
+    std::wstring name;
+    std::wstring value;
+    bool section = false;
+};
+
+// A row inserted into or deleted from the view. Edits are applied in order;
+// the index is the view row at that point, which for an insert is also the
+// new row's index in the model.
+struct PropertyEdit {
+    enum Kind { INSERT, DELETE };
+    Kind kind;
+    size_t index;
+};
+
+// Ordered property list that is rebuilt every refresh and diffed against the
+// previous build. Rows are matched by name (or section title) in order, so a
+// conditional row or section that appears or goes away becomes a few inserts
+// and deletes and every other row keeps its place. Of the matched rows, only
+// those whose value text changed are reported, so the view can update just
+// those cells.
+class PropertyModel {
+public:
+    void Begin();
+    void Add(const wchar_t* name, const wchar_t* value);
+    void AddSection(const wchar_t* title);
+    // Finishes the build. Returns true when rows appeared or went away.
+    bool End();
+
+    const std::vector<PropertyEdit>& Edits() const { return m_edits; }
+    // Matched rows whose value changed, as indices after the edits
+    const std::vector<size_t>& ChangedRows() const { return m_changed; }
+    size_t Count() const { return m_rows.size(); }
+    const PropertyRow& Row(size_t index) const { return m_rows[index]; }
+
+private:
+    void Put(const wchar_t* name, const wchar_t* value, bool section);
+    static bool SameRow(const PropertyRow& a, const PropertyRow& b);
+
+    std::vector<PropertyRow> m_rows;
+    // The build in progress; keeps the previous rows' strings to reuse
+    std::vector<PropertyRow> m_next;
+    std::vector<PropertyEdit> m_edits;
+    std::vector<size_t> m_changed;
+    size_t m_cursor = 0;
+};
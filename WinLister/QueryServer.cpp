@@ -0,0 +1,262 @@
+#include "QueryServer.h"
+#include "HeadlessMode.h"
+#include "FileIO.h"
+#include <cstdlib>
+
+#ifndef _WIN32
+#include <unistd.h>
+#endif
+
+namespace {
+
+void AppendResponse(std::string& response, int status, uint64_t snapshotTime, const std::string& body) {
+    response += std::to_string(status);
+    response += ' ';
+    response += std::to_string(body.size());
+    response += ' ';
+    response += std::to_string(snapshotTime);
+    response += '\n';
+    response += body;
+}
+
+bool ParseUnsigned(const char*& p, const char* end, uint64_t& value) {
+    const char* start = p;
+    value = 0;
+    while (p < end && *p >= '0' && *p <= '9') {
+        value = value * 10 + static_cast<uint64_t>(*p - '0');
+        p++;
+    }
+    return p != start;
+}
+
+} // namespace
+
+QueryServer::~QueryServer() {
+    Stop();
+}
+
+bool QueryServer::Start(const std::wstring& endpoint) {
+    if (IsRunning() || !m_listener.Open(endpoint)) {
+        return false;
+    }
+    m_acceptThread = std::thread(&QueryServer::AcceptLoop, this);
+    return true;
+}
+
+void QueryServer::Stop() {
+    if (!m_acceptThread.joinable()) {
+        return;
+    }
+    m_listener.Cancel();
+    m_acceptThread.join();
+    ReapClients(true);
+    m_listener.Close();
+}
+
+void QueryServer::Publish(const std::vector<WindowInfo>& windows, uint64_t time) {
+    auto published = std::make_shared<PublishedSnapshot>();
+    published->windows = windows;
+    published->time = time;
+    std::shared_ptr<const PublishedSnapshot> snapshot = std::move(published);
+    {
+        std::lock_guard<std::mutex> lock(m_snapshotMutex);
+        m_snapshot.swap(snapshot);
+    }
+    // The previous list, if no request holds it, is freed here, outside the lock
+}
+
+std::shared_ptr<const PublishedSnapshot> QueryServer::Current() const {
+    std::lock_guard<std::mutex> lock(m_snapshotMutex);
+    return m_snapshot;
+}
+
+void QueryServer::AcceptLoop() {
+    for (;;) {
+        std::unique_ptr<Client> client(new Client());
+        if (!m_listener.Accept(client->stream)) {
+            break;
+        }
+        ReapClients(false);
+
+        std::lock_guard<std::mutex> lock(m_clientsMutex);
+        if (m_clients.size() >= MAX_CLIENTS) {
+            continue;   // dropping the client disconnects it
+        }
+        Client& accepted = *client;
+        m_clients.push_back(std::move(client));
+        accepted.thread = std::thread(&QueryServer::Serve, this, std::ref(accepted));
+    }
+}
+
+void QueryServer::ReapClients(bool all) {
+    std::list<std::unique_ptr<Client>> finished;
+    {
+        std::lock_guard<std::mutex> lock(m_clientsMutex);
+        for (auto it = m_clients.begin(); it != m_clients.end();) {
+            auto next = std::next(it);
+            if (all) {
+                (*it)->stream.Cancel();
+            }
+            if (all || (*it)->done) {
+                finished.splice(finished.end(), m_clients, it);
+            }
+            it = next;
+        }
+    }
+    for (auto& client : finished) {
+        client->thread.join();
+    }
+}
+
+void QueryServer::Serve(Client& client) {
+    std::string input;
+    std::string output;
+    char buffer[16 * 1024];
+    for (;;) {
+        size_t received = client.stream.Read(buffer, sizeof(buffer));
+        if (received == 0) {
+            break;
+        }
+        input.append(buffer, received);
+
+        // Answer every complete line against one snapshot; pipelined
+        // requests go back in a single write
+        std::shared_ptr<const PublishedSnapshot> snapshot;
+        size_t start = 0;
+        bool overlong = false;
+        for (;;) {
+            size_t end = input.find('\n', start);
+            if (end == std::string::npos || end - start > MAX_REQUEST) {
+                overlong = (end == std::string::npos ? input.size() : end) - start > MAX_REQUEST;
+                break;
+            }
+            size_t length = end - start;
+            if (length > 0 && input[end - 1] == '\r') {
+                length--;
+            }
+            if (!snapshot) {
+                snapshot = Current();
+            }
+            Answer(input.data() + start, length, snapshot.get(), output);
+            start = end + 1;
+        }
+        input.erase(0, start);
+
+        if (overlong) {
+            std::string body;
+            StringSink sink(body);
+            HeadlessRunner::WriteError(sink, L"Request line too long");
+            AppendResponse(output, HeadlessRunner::EXIT_USAGE, 0, body);
+        }
+        if (!output.empty() && !client.stream.Write(output.data(), output.size())) {
+            break;
+        }
+        output.clear();
+        if (overlong) {
+            break;
+        }
+    }
+
+    // Closed here, under the lock Stop() cancels under, so the client sees
+    // the end of the stream now rather than when the thread is reaped
+    std::lock_guard<std::mutex> lock(m_clientsMutex);
+    client.stream.Close();
+    client.done = true;
+}
+
+void QueryServer::Answer(const char* request, size_t length, const PublishedSnapshot* snapshot, std::string& response) {
+    std::string body;
+    StringSink sink(body);
+    std::wstring error;
+    int status = HeadlessRunner::EXIT_OK;
+
+    std::wstring line = FileIO::FromUtf8(request, length);
+    HeadlessOptions options;
+    WindowQuery query;
+    if (!CommandLine::Parse(CommandLine::Split(line.c_str()), options, error)) {
+        status = HeadlessRunner::EXIT_USAGE;
+    } else if (options.command == HEADLESS_HELP) {
+        body = CommandLine::Usage();
+    } else if (options.command != HEADLESS_DUMP || !options.input.empty()) {
+        status = HeadlessRunner::EXIT_USAGE;
+        error = L"Only --dump of the live windows is served";
+    } else if (!WindowQuery::Parse(options.query, query, error)) {
+        status = HeadlessRunner::EXIT_USAGE;
+    } else if (!snapshot) {
+        status = HeadlessRunner::EXIT_FAILED;
+        error = L"No window list has been published yet";
+    } else {
+        HeadlessRunner::WriteSelection(snapshot->windows, options, query, sink);
+    }
+
+    if (status != HeadlessRunner::EXIT_OK) {
+        HeadlessRunner::WriteError(sink, error);
+    }
+    AppendResponse(response, status, snapshot ? snapshot->time : 0, body);
+}
+
+std::wstring QueryServer::DefaultEndpoint() {
+#ifdef _WIN32
+    DWORD session = 0;
+    ProcessIdToSessionId(GetCurrentProcessId(), &session);
+    return L"\\\\.\\pipe\\WinLister_Query_" + std::to_wstring(session);
+#else
+    const char* runtime = getenv("XDG_RUNTIME_DIR");
+    std::string path = (runtime && *runtime)
+        ? std::string(runtime) + "/winlister-query.sock"
+        : "/tmp/winlister-query-" + std::to_string(getuid()) + ".sock";
+    return FileIO::FromUtf8(path.data(), path.size());
+#endif
+}
+
+bool QueryClient::Send(const std::string& request) {
+    std::string line = request;
+    line.push_back('\n');
+    return m_stream.Write(line.data(), line.size());
+}
+
+bool QueryClient::Fill() {
+    char buffer[64 * 1024];
+    size_t received = m_stream.Read(buffer, sizeof(buffer));
+    if (received == 0) {
+        return false;
+    }
+    m_buffer.append(buffer, received);
+    return true;
+}
+
+bool QueryClient::Receive(Response& response) {
+    // Drop consumed responses once they make up most of the buffer
+    if (m_start > 0 && m_start * 2 >= m_buffer.size()) {
+        m_buffer.erase(0, m_start);
+        m_start = 0;
+    }
+
+    size_t end;
+    while ((end = m_buffer.find('\n', m_start)) == std::string::npos) {
+        if (m_buffer.size() - m_start > 64 || !Fill()) {
+            return false;
+        }
+    }
+
+    const char* p = m_buffer.data() + m_start;
+    const char* headerEnd = m_buffer.data() + end;
+    uint64_t status, length, time;
+    if (!ParseUnsigned(p, headerEnd, status) || p == headerEnd || *p++ != ' ' ||
+        !ParseUnsigned(p, headerEnd, length) || p == headerEnd || *p++ != ' ' ||
+        !ParseUnsigned(p, headerEnd, time) || p != headerEnd) {
+        return false;
+    }
+
+    size_t bodyStart = end + 1;
+    while (m_buffer.size() - bodyStart < length) {
+        if (!Fill()) {
+            return false;
+        }
+    }
+    response.status = static_cast<int>(status);
+    response.snapshotTime = time;
+    response.body.assign(m_buffer, bodyStart, static_cast<size_t>(length));
+    m_start = bodyStart + static_cast<size_t>(length);
+    return true;
+}
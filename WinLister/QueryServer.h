@@ -0,0 +1,100 @@
+#pragma once
+
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "WindowInfo.h"
+#include "LocalChannel.h"
+
+// Query protocol, version 1. A request is one UTF-8 line holding headless
+// command-line arguments ("--dump --format ndjson --query class:Chrome*").
+// Each request gets one response, in order, so clients may pipeline:
+//
+//   <status> <length> <snapshot time>\n<length bytes of body>
+//
+// status is the headless exit code (0 ok, 1 failed, 2 usage); the body is
+// the output on success and the error text otherwise. The snapshot time is
+// when the answered window list was enumerated (ms since the Unix epoch).
+// Only --dump and --help are served; --input and --watch are refused.
+
+// A published window list; immutable once shared
+struct PublishedSnapshot {
+    std::vector<WindowInfo> windows;
+    uint64_t time = 0;
+};
+
+// Serves queries against the running instance's latest live refresh, with a
+// thread per client. Publishing copies the list and swaps it in under a
+// lock, so requests never wait for, or block, a refresh.
+class QueryServer {
+public:
+    QueryServer() = default;
+    ~QueryServer();
+    QueryServer(const QueryServer&) = delete;
+    QueryServer& operator=(const QueryServer&) = delete;
+
+    bool Start(const std::wstring& endpoint);
+    // Disconnects every client and waits for their threads
+    void Stop();
+    bool IsRunning() const { return m_acceptThread.joinable(); }
+
+    void Publish(const std::vector<WindowInfo>& windows, uint64_t time);
+
+    // Answers one request line (without the newline) from a snapshot, which
+    // may be null before the first publish; appends the framed response
+    static void Answer(const char* request, size_t length, const PublishedSnapshot* snapshot, std::string& response);
+
+    // Per-session pipe on Windows; a socket in the runtime directory elsewhere
+    static std::wstring DefaultEndpoint();
+
+    static const size_t MAX_CLIENTS = 64;
+    static const size_t MAX_REQUEST = 64 * 1024;
+
+private:
+    struct Client {
+        LocalStream stream;
+        std::thread thread;
+        bool done = false;  // guarded by m_clientsMutex
+    };
+
+    void AcceptLoop();
+    void Serve(Client& client);
+    void ReapClients(bool all);
+    std::shared_ptr<const PublishedSnapshot> Current() const;
+
+    LocalListener m_listener;
+    std::thread m_acceptThread;
+    std::mutex m_clientsMutex;
+    std::list<std::unique_ptr<Client>> m_clients;
+    mutable std::mutex m_snapshotMutex;
+    std::shared_ptr<const PublishedSnapshot> m_snapshot;
+};
+
+// Client side of the protocol. Send() may be called several times before
+// the matching Receive() calls.
+class QueryClient {
+public:
+    struct Response {
+        int status = 0;
+        uint64_t snapshotTime = 0;
+        std::string body;
+    };
+
+    bool Connect(const std::wstring& endpoint, unsigned timeoutMs = 2000) { return m_stream.Connect(endpoint, timeoutMs); }
+    void Close() { m_stream.Close(); }
+    // request is one line of arguments, without the newline
+    bool Send(const std::string& request);
+    bool Receive(Response& response);
+    bool Query(const std::string& request, Response& response) { return Send(request) && Receive(response); }
+
+private:
+    bool Fill();
+
+    LocalStream m_stream;
+    std::string m_buffer;
+    size_t m_start = 0;
+};
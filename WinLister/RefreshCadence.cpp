@@ -0,0 +1,44 @@
+#include "RefreshCadence.h"
+
+RefreshCadence::RefreshCadence(uint32_t volatileIntervalMs, uint32_t fullIntervalMs) {
+    SetIntervals(volatileIntervalMs, fullIntervalMs);
+}
+
+void RefreshCadence::SetIntervals(uint32_t volatileIntervalMs, uint32_t fullIntervalMs) {
+    m_volatileInterval = volatileIntervalMs > 0 ? volatileIntervalMs : 1;
+    m_fullInterval = fullIntervalMs > m_volatileInterval ? fullIntervalMs : m_volatileInterval;
+}
+
+void RefreshCadence::Reset(uint64_t nowMs) {
+    m_nextVolatile = nowMs + m_volatileInterval;
+    m_nextFull = nowMs + m_fullInterval;
+}
+
+RefreshKind RefreshCadence::Poll(uint64_t nowMs) {
+    if (IsDue(m_nextFull, nowMs)) {
+        m_nextFull = Advance(m_nextFull, m_fullInterval, nowMs);
+        m_nextVolatile = Advance(m_nextVolatile, m_volatileInterval, nowMs);
+        return REFRESH_FULL;
+    }
+    if (IsDue(m_nextVolatile, nowMs)) {
+        m_nextVolatile = Advance(m_nextVolatile, m_volatileInterval, nowMs);
+        return REFRESH_VOLATILE;
+    }
+    return REFRESH_NONE;
+}
+
+bool RefreshCadence::IsDue(uint64_t due, uint64_t nowMs) const {
+    // Timer ticks jitter by a few ms either way; a tick within half a fast
+    // interval of the deadline counts, otherwise it would slip a whole tick
+    return nowMs + m_volatileInterval / 2 >= due;
+}
+
+uint64_t RefreshCadence::Advance(uint64_t due, uint32_t interval, uint64_t nowMs) const {
+    uint64_t next = due + interval;
+    uint64_t horizon = nowMs + m_volatileInterval / 2;
+    if (next <= horizon) {
+        // Stalled past one or more deadlines: skip them, keeping the phase
+        next += ((horizon - next) / interval + 1) * interval;
+    }
+    return next;
+}
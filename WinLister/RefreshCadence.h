@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstdint>
+
+enum RefreshKind {
+    REFRESH_NONE = 0,
+    REFRESH_VOLATILE,   // rect, client rect, state flags, alpha, title, hung
+    REFRESH_FULL        // everything, including process identity and icon
+};
+
+// Decides which kind of refresh is due on each timer tick of a two-rate poll:
+// volatile properties on a fast cadence, the full property set on a slow one.
+// A full refresh also covers the volatile set. Deadlines keep their phase, and
+// ticks missed during a stall are dropped rather than replayed in a burst.
+// Time is passed in by the caller (milliseconds, any monotonic origin).
+class RefreshCadence {
+public:
+    RefreshCadence(uint32_t volatileIntervalMs, uint32_t fullIntervalMs);
+
+    void SetIntervals(uint32_t volatileIntervalMs, uint32_t fullIntervalMs);
+    uint32_t VolatileInterval() const { return m_volatileInterval; }
+    uint32_t FullInterval() const { return m_fullInterval; }
+
+    // A full refresh has just been done; restart both cadences from now
+    void Reset(uint64_t nowMs);
+    RefreshKind Poll(uint64_t nowMs);
+
+private:
+    bool IsDue(uint64_t due, uint64_t nowMs) const;
+    uint64_t Advance(uint64_t due, uint32_t interval, uint64_t nowMs) const;
+
+    uint32_t m_volatileInterval;
+    uint32_t m_fullInterval;
+    uint64_t m_nextVolatile = 0;
+    uint64_t m_nextFull = 0;
+};
@@ -0,0 +1,129 @@
+#include "RowText.h"
+#include "WindowSort.h"
+#include "WindowMonitor.h"
+#include <ctime>
+
+// Rows not displayed for this many refreshes are dropped from the cache
+static const uint32_t ROW_CACHE_AGE = 16;
+
+static void AppendTwoDigits(std::wstring& text, int value) {
+    text += static_cast<wchar_t>(L'0' + value / 10);
+    text += static_cast<wchar_t>(L'0' + value % 10);
+}
+
+void RowTextProvider::BeginSnapshot() {
+    m_generation++;
+    for (auto it = m_rows.begin(); it != m_rows.end();) {
+        if (m_generation - it->second.lastUsed > ROW_CACHE_AGE) {
+            it = m_rows.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+const std::wstring& RowTextProvider::GetCell(RowEntry& row, int cell, uint64_t source, const WindowInfo& win) {
+    m_lookups++;
+    return row.cells[cell].Get(source, [&](std::wstring& text) {
+        m_formats++;
+        switch (cell) {
+        case CELL_HWND:
+            TextFormat::AppendHex(text, source);
+            break;
+        case CELL_PID:
+            TextFormat::AppendUnsigned(text, source);
+            break;
+        case CELL_POSITION:
+            TextFormat::AppendSigned(text, win.rect.left);
+            text += L", ";
+            TextFormat::AppendSigned(text, win.rect.top);
+            break;
+        case CELL_EXPOSED:
+            // Hundredths of a percent, shown to one decimal
+            TextFormat::AppendUnsigned(text, source / 100);
+            text += L'.';
+            TextFormat::AppendUnsigned(text, source % 100 / 10);
+            text += L'%';
+            break;
+        case CELL_RAISED: {
+            // Local time of day; the time is in Unix milliseconds
+            time_t seconds = static_cast<time_t>(source / 1000);
+            tm local = {};
+#ifdef _WIN32
+            localtime_s(&local, &seconds);
+#else
+            localtime_r(&seconds, &local);
+#endif
+            AppendTwoDigits(text, local.tm_hour);
+            text += L':';
+            AppendTwoDigits(text, local.tm_min);
+            text += L':';
+            AppendTwoDigits(text, local.tm_sec);
+            break;
+        }
+        case CELL_MONITOR:
+            // Numbered from 1, with the logical position on the monitor
+            TextFormat::AppendSigned(text, win.monitor + 1);
+            text += L": ";
+            TextFormat::AppendSigned(text, win.logicalRect.left);
+            text += L", ";
+            TextFormat::AppendSigned(text, win.logicalRect.top);
+            break;
+        case CELL_SIZE:
+            TextFormat::AppendSigned(text, win.rect.right - win.rect.left);
+            text += L" x ";
+            TextFormat::AppendSigned(text, win.rect.bottom - win.rect.top);
+            break;
+        }
+    });
+}
+
+const wchar_t* RowTextProvider::GetText(const WindowInfo& win, int column) {
+    switch (column) {
+    case COLUMN_TITLE:
+        return win.title.empty() ? L"(no title)" : win.title.c_str();
+    case COLUMN_CLASS:
+        return win.className.c_str();
+    case COLUMN_PROCESS:
+        return win.processName.empty() ? L"(unknown)" : win.processName.c_str();
+    case COLUMN_VISIBLE:
+        return win.isVisible ? L"Yes" : L"No";
+    case COLUMN_EXPOSED:
+        if (win.exposed < 0) {
+            return L"";
+        }
+        break;
+    case COLUMN_RAISED:
+        if (win.raisedAt == 0) {
+            return L"";
+        }
+        break;
+    case COLUMN_MONITOR:
+        if (win.monitor < 0) {
+            return MonitorLayout::IsOffScreen(win) ? L"Off-screen" : L"";
+        }
+        break;
+    }
+
+    RowEntry& row = m_rows[win.hwnd];
+    row.lastUsed = m_generation;
+
+    switch (column) {
+    case COLUMN_HWND:
+        return GetCell(row, CELL_HWND, static_cast<uint64_t>(reinterpret_cast<uintptr_t>(win.hwnd)), win).c_str();
+    case COLUMN_PID:
+        return GetCell(row, CELL_PID, win.processId, win).c_str();
+    case COLUMN_POSITION:
+        return GetCell(row, CELL_POSITION, TextFormat::PackPair(win.rect.left, win.rect.top), win).c_str();
+    case COLUMN_SIZE:
+        return GetCell(row, CELL_SIZE,
+            TextFormat::PackPair(win.rect.right - win.rect.left, win.rect.bottom - win.rect.top), win).c_str();
+    case COLUMN_EXPOSED:
+        return GetCell(row, CELL_EXPOSED, static_cast<uint64_t>(win.exposed), win).c_str();
+    case COLUMN_RAISED:
+        return GetCell(row, CELL_RAISED, win.raisedAt, win).c_str();
+    case COLUMN_MONITOR:
+        return GetCell(row, CELL_MONITOR, WindowSorter::NumericKey(win, COLUMN_MONITOR), win).c_str();
+    }
+    return L"";
+}
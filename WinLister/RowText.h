@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstdint>
+#include <unordered_map>
+#include "WindowInfo.h"
+#include "TextFormat.h"
+
+// Produces the main list view's cell text straight from a snapshot row, so the
+// list view can run in owner-data mode and only format rows it displays.
+// Numeric cells are cached per window together with the value they show and
+// are only re-formatted when that value changes.
+class RowTextProvider {
+public:
+    // Call once per refresh; drops cached rows that have not been shown lately
+    void BeginSnapshot();
+
+    // Returns the text for a cell. String columns point into the row itself,
+    // numeric columns into the cache; either stays valid until the next
+    // BeginSnapshot (and for as long as the row is alive).
+    const wchar_t* GetText(const WindowInfo& win, int column);
+
+    uint64_t LookupCount() const { return m_lookups; }
+    uint64_t FormatCount() const { return m_formats; }
+
+private:
+    enum CachedCell {
+        CELL_HWND,
+        CELL_PID,
+        CELL_POSITION,
+        CELL_SIZE,
+        CELL_EXPOSED,
+        CELL_RAISED,
+        CELL_MONITOR,
+        CELL_COUNT
+    };
+
+    struct RowEntry {
+        CachedText cells[CELL_COUNT];
+        uint32_t lastUsed = 0;
+    };
+
+    const std::wstring& GetCell(RowEntry& row, int cell, uint64_t source, const WindowInfo& win);
+
+    std::unordered_map<HWND, RowEntry> m_rows;
+    uint32_t m_generation = 0;
+    uint64_t m_lookups = 0;
+    uint64_t m_formats = 0;
+};
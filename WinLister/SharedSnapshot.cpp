@@ -0,0 +1,365 @@
+#include "SharedSnapshot.h"
+#include "FileIO.h"
+#include <atomic>
+#include <cstring>
+#include <new>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <Windows.h>
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+const char REGION_MAGIC[8] = { 'W', 'L', 'S', 'H', 'M', 'E', 'M', 0 };
+const uint32_t REGION_VERSION = 1;
+const uint32_t SLOT_COUNT = 2;
+const size_t HEADER_SIZE = 64;
+const size_t SLOT_HEADER_SIZE = 64;
+const size_t DATA_OFFSET = HEADER_SIZE + SLOT_COUNT * SLOT_HEADER_SIZE;
+const int MAX_READ_ATTEMPTS = 16;
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "shared counters must be lock-free");
+
+struct RegionHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t slotCount;
+    uint64_t slotCapacity;
+    std::atomic<uint64_t> sequence;
+    std::atomic<uint64_t> overflow;
+};
+
+struct SlotHeader {
+    std::atomic<uint64_t> sequence;
+    uint64_t size;
+    uint64_t captureTime;
+};
+
+static_assert(sizeof(RegionHeader) <= HEADER_SIZE, "region header too large");
+static_assert(sizeof(SlotHeader) <= SLOT_HEADER_SIZE, "slot header too large");
+
+// Writes straight into a slot. Output past the capacity is counted but
+// dropped, so a failed publish still reports the size it needed.
+class SlotSink : public ByteSink {
+public:
+    SlotSink(uint8_t* data, size_t capacity) : m_data(data), m_capacity(capacity) {}
+
+    bool Write(const char* data, size_t length) override {
+        if (m_used <= m_capacity && length <= m_capacity - m_used) {
+            memcpy(m_data + m_used, data, length);
+        }
+        m_used += length;
+        return true;
+    }
+
+    uint64_t Used() const { return m_used; }
+    bool Overflowed() const { return m_used > m_capacity; }
+
+private:
+    uint8_t* m_data;
+    size_t m_capacity;
+    uint64_t m_used = 0;
+};
+
+size_t RegionSize(size_t slotCapacity) {
+    return DATA_OFFSET + SLOT_COUNT * slotCapacity;
+}
+
+uint64_t RoundUp64(uint64_t value) {
+    return (value + 63) & ~static_cast<uint64_t>(63);
+}
+
+} // namespace
+
+SharedSnapshotWriter::~SharedSnapshotWriter() {
+    Close();
+}
+
+bool SharedSnapshotWriter::Open(const std::wstring& name, size_t slotCapacity) {
+    Close();
+    slotCapacity = static_cast<size_t>(RoundUp64(slotCapacity));
+    if (slotCapacity == 0 || slotCapacity > (SIZE_MAX - DATA_OFFSET) / SLOT_COUNT) {
+        return false;
+    }
+    size_t size = RegionSize(slotCapacity);
+
+#ifdef _WIN32
+    uint64_t size64 = size;
+    HANDLE hMapping = CreateFileMappingW(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE,
+        static_cast<DWORD>(size64 >> 32), static_cast<DWORD>(size64), name.c_str());
+    if (!hMapping) {
+        return false;
+    }
+    if (GetLastError() == ERROR_ALREADY_EXISTS) {
+        CloseHandle(hMapping);
+        return false;
+    }
+
+    void* view = MapViewOfFile(hMapping, FILE_MAP_WRITE, 0, 0, size);
+    if (!view) {
+        CloseHandle(hMapping);
+        return false;
+    }
+    m_mapping = hMapping;
+#else
+    // Nothing tells a crashed writer's region from a live one, so the newest
+    // writer takes the name; readers of the old one see it stop advancing
+    std::string path = FileIO::ToUtf8(name);
+    int fd = shm_open(path.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+    if (fd < 0 && errno == EEXIST) {
+        shm_unlink(path.c_str());
+        fd = shm_open(path.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+    }
+    if (fd < 0) {
+        return false;
+    }
+    if (ftruncate(fd, static_cast<off_t>(size)) != 0) {
+        close(fd);
+        shm_unlink(path.c_str());
+        return false;
+    }
+
+    void* view = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (view == MAP_FAILED) {
+        shm_unlink(path.c_str());
+        return false;
+    }
+#endif
+
+    m_base = static_cast<uint8_t*>(view);
+    m_size = size;
+    m_slotCapacity = slotCapacity;
+    m_sequence = 0;
+    m_name = name;
+
+    // The region starts zeroed; the magic goes in last so readers never
+    // accept a half-written header
+    RegionHeader* header = new (m_base) RegionHeader();
+    header->version = REGION_VERSION;
+    header->slotCount = SLOT_COUNT;
+    header->slotCapacity = slotCapacity;
+    header->sequence.store(0, std::memory_order_relaxed);
+    header->overflow.store(0, std::memory_order_relaxed);
+    for (uint32_t i = 0; i < SLOT_COUNT; i++) {
+        new (m_base + HEADER_SIZE + i * SLOT_HEADER_SIZE) SlotHeader();
+    }
+    std::atomic_thread_fence(std::memory_order_release);
+    memcpy(header->magic, REGION_MAGIC, sizeof(REGION_MAGIC));
+    return true;
+}
+
+void SharedSnapshotWriter::Close() {
+    if (m_base) {
+#ifdef _WIN32
+        UnmapViewOfFile(m_base);
+        CloseHandle(static_cast<HANDLE>(m_mapping));
+#else
+        munmap(m_base, m_size);
+        shm_unlink(FileIO::ToUtf8(m_name).c_str());
+#endif
+    }
+
+    m_base = nullptr;
+    m_size = 0;
+    m_slotCapacity = 0;
+    m_sequence = 0;
+    m_name.clear();
+    m_mapping = nullptr;
+}
+
+bool SharedSnapshotWriter::Publish(const std::vector<WindowInfo>& windows, uint64_t captureTime) {
+    if (!m_base) {
+        return false;
+    }
+
+    uint64_t next = m_sequence + 1;
+    uint32_t index = static_cast<uint32_t>(next % SLOT_COUNT);
+    RegionHeader* header = reinterpret_cast<RegionHeader*>(m_base);
+    SlotHeader* slot = reinterpret_cast<SlotHeader*>(m_base + HEADER_SIZE + index * SLOT_HEADER_SIZE);
+
+    // Readers still on this slot's previous contents fail validation from here
+    slot->sequence.store(next * 2 + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    SlotSink sink(m_base + DATA_OFFSET + index * m_slotCapacity, m_slotCapacity);
+    if (!SnapshotFileWriter::Write(windows, captureTime, sink)) {
+        return false;
+    }
+    if (sink.Overflowed()) {
+        // The slot stays marked as being written and the older snapshot in
+        // the other slot remains the newest
+        header->overflow.store(RoundUp64(sink.Used()), std::memory_order_relaxed);
+        return false;
+    }
+
+    slot->size = sink.Used();
+    slot->captureTime = captureTime;
+    slot->sequence.store(next * 2 + 2, std::memory_order_release);
+    header->overflow.store(0, std::memory_order_relaxed);
+    header->sequence.store(next, std::memory_order_release);
+    m_sequence = next;
+    return true;
+}
+
+std::wstring SharedSnapshotWriter::DefaultName() {
+#ifdef _WIN32
+    return L"Local\\WinLister_Snapshot";
+#else
+    return L"/winlister-snapshot-" + std::to_wstring(getuid());
+#endif
+}
+
+SharedSnapshotReader::~SharedSnapshotReader() {
+    Close();
+}
+
+bool SharedSnapshotReader::Open(const std::wstring& name) {
+    Close();
+
+    const void* view = nullptr;
+    size_t size = 0;
+#ifdef _WIN32
+    HANDLE hMapping = OpenFileMappingW(FILE_MAP_READ, FALSE, name.c_str());
+    if (!hMapping) {
+        return false;
+    }
+    view = MapViewOfFile(hMapping, FILE_MAP_READ, 0, 0, 0);
+    MEMORY_BASIC_INFORMATION info = {};
+    if (!view || VirtualQuery(view, &info, sizeof(info)) == 0) {
+        if (view) UnmapViewOfFile(view);
+        CloseHandle(hMapping);
+        return false;
+    }
+    size = info.RegionSize;
+    m_mapping = hMapping;
+#else
+    int fd = shm_open(FileIO::ToUtf8(name).c_str(), O_RDONLY, 0);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat st = {};
+    if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+        close(fd);
+        return false;
+    }
+    size = static_cast<size_t>(st.st_size);
+    view = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (view == MAP_FAILED) {
+        return false;
+    }
+#endif
+
+    m_base = static_cast<const uint8_t*>(view);
+    m_size = size;
+
+    const RegionHeader* header = reinterpret_cast<const RegionHeader*>(m_base);
+    if (m_size < DATA_OFFSET || memcmp(header->magic, REGION_MAGIC, sizeof(REGION_MAGIC)) != 0) {
+        Close();
+        return false;
+    }
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (header->version != REGION_VERSION || header->slotCount != SLOT_COUNT ||
+        header->slotCapacity == 0 || header->slotCapacity % 64 != 0 ||
+        header->slotCapacity > (m_size - DATA_OFFSET) / SLOT_COUNT) {
+        Close();
+        return false;
+    }
+    m_slotCapacity = static_cast<size_t>(header->slotCapacity);
+    return true;
+}
+
+void SharedSnapshotReader::Close() {
+    if (m_base) {
+#ifdef _WIN32
+        UnmapViewOfFile(m_base);
+        CloseHandle(static_cast<HANDLE>(m_mapping));
+#else
+        munmap(const_cast<uint8_t*>(m_base), m_size);
+#endif
+    }
+
+    m_base = nullptr;
+    m_size = 0;
+    m_slotCapacity = 0;
+    m_mapping = nullptr;
+}
+
+uint64_t SharedSnapshotReader::Sequence() const {
+    if (!m_base) {
+        return 0;
+    }
+    return reinterpret_cast<const RegionHeader*>(m_base)->sequence.load(std::memory_order_acquire);
+}
+
+uint64_t SharedSnapshotReader::OverflowSize() const {
+    if (!m_base) {
+        return 0;
+    }
+    return reinterpret_cast<const RegionHeader*>(m_base)->overflow.load(std::memory_order_relaxed);
+}
+
+bool SharedSnapshotReader::Begin(SnapshotFileReader& view, uint64_t& sequence) const {
+    view.Close();
+    for (int attempt = 0; attempt < MAX_READ_ATTEMPTS; attempt++) {
+        uint64_t published = Sequence();
+        if (published == 0) {
+            return false;
+        }
+
+        uint32_t index = static_cast<uint32_t>(published % SLOT_COUNT);
+        const SlotHeader* slot = reinterpret_cast<const SlotHeader*>(m_base + HEADER_SIZE + index * SLOT_HEADER_SIZE);
+        if (slot->sequence.load(std::memory_order_acquire) != published * 2 + 2) {
+            continue;   // overrun before we got to it
+        }
+
+        // A torn size or index is caught by validation; Attach() only reads
+        // inside the slot
+        uint64_t size = slot->size;
+        bool attached = size <= m_slotCapacity &&
+            view.Attach(m_base + DATA_OFFSET + index * m_slotCapacity, static_cast<size_t>(size));
+        if (Validate(published)) {
+            sequence = published;
+            return attached;
+        }
+        view.Close();
+    }
+    return false;
+}
+
+bool SharedSnapshotReader::Validate(uint64_t sequence) const {
+    if (!m_base || sequence == 0) {
+        return false;
+    }
+    std::atomic_thread_fence(std::memory_order_acquire);
+    uint32_t index = static_cast<uint32_t>(sequence % SLOT_COUNT);
+    const SlotHeader* slot = reinterpret_cast<const SlotHeader*>(m_base + HEADER_SIZE + index * SLOT_HEADER_SIZE);
+    return slot->sequence.load(std::memory_order_relaxed) == sequence * 2 + 2;
+}
+
+bool SharedSnapshotReader::Read(std::vector<WindowInfo>& windows, uint64_t& captureTime, uint64_t& sequence) const {
+    SnapshotFileReader view;
+    for (int attempt = 0; attempt < MAX_READ_ATTEMPTS; attempt++) {
+        uint64_t published;
+        if (!Begin(view, published)) {
+            return false;
+        }
+        view.Materialize(windows);
+        uint64_t time = view.CaptureTime();
+        if (Validate(published)) {
+            captureTime = time;
+            sequence = published;
+            return true;
+        }
+    }
+    return false;
+}
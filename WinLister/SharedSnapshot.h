@@ -0,0 +1,100 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "WindowInfo.h"
+#include "SnapshotFile.h"
+
+// Named shared-memory region holding the latest window list, version 1:
+//
+//   header   magic "WLSHMEM\0", u32 version, u32 slot count (2), u64 slot
+//            capacity, u64 published sequence, u64 overflow size, padded to 64
+//   slots    per slot {u64 sequence, u64 size, u64 capture time}, padded to 64
+//   data     slot capacity bytes per slot, each a binary snapshot (see
+//            SnapshotFile.h) that readers attach to in place
+//
+// The writer alternates slots and guards each with a sequence lock: a slot's
+// sequence is odd while it is being written and 2n+2 once publish n is done,
+// after which the header's published sequence becomes n. Publish n reuses the
+// slot of publish n-2, so a reader has a whole refresh to finish with a slot
+// before it is overwritten, and the writer never waits for readers.
+// A snapshot larger than a slot is not published; the header's overflow size
+// tells readers how big the region would need to be.
+
+// Creates the region and publishes into it; one writer per name
+class SharedSnapshotWriter {
+public:
+    SharedSnapshotWriter() = default;
+    ~SharedSnapshotWriter();
+    SharedSnapshotWriter(const SharedSnapshotWriter&) = delete;
+    SharedSnapshotWriter& operator=(const SharedSnapshotWriter&) = delete;
+
+    // Fails if a writer already holds the name (Windows); on POSIX a
+    // leftover region from a crashed writer is replaced
+    bool Open(const std::wstring& name, size_t slotCapacity = DEFAULT_SLOT_CAPACITY);
+    // Removes the name on POSIX; mapped readers keep their view
+    void Close();
+    bool IsOpen() const { return m_base != nullptr; }
+
+    // False if the snapshot does not fit a slot
+    bool Publish(const std::vector<WindowInfo>& windows, uint64_t captureTime);
+    uint64_t Sequence() const { return m_sequence; }
+
+    // Per-session on Windows ("Local\" namespace); per-user elsewhere
+    static std::wstring DefaultName();
+
+    static const size_t DEFAULT_SLOT_CAPACITY = 8 * 1024 * 1024;
+
+private:
+    uint8_t* m_base = nullptr;
+    size_t m_size = 0;
+    size_t m_slotCapacity = 0;
+    uint64_t m_sequence = 0;
+    std::wstring m_name;
+    void* m_mapping = nullptr;   // mapping handle on Windows
+};
+
+// Reads the region without locking out the writer. Begin() attaches a
+// SnapshotFileReader to the newest slot in place; after reading the fields it
+// needs, the caller checks Validate() and discards what it read on failure.
+//
+//   SnapshotFileReader view;
+//   uint64_t seq;
+//   do {
+//       if (!reader.Begin(view, seq)) break;
+//       ... read view ...
+//   } while (!reader.Validate(seq));
+class SharedSnapshotReader {
+public:
+    SharedSnapshotReader() = default;
+    ~SharedSnapshotReader();
+    SharedSnapshotReader(const SharedSnapshotReader&) = delete;
+    SharedSnapshotReader& operator=(const SharedSnapshotReader&) = delete;
+
+    bool Open(const std::wstring& name);
+    void Close();
+    bool IsOpen() const { return m_base != nullptr; }
+
+    // Newest published sequence; 0 before the first publish. Cheap enough to
+    // poll for changes.
+    uint64_t Sequence() const;
+    // Size a slot would need for the last snapshot that did not fit, or 0
+    uint64_t OverflowSize() const;
+
+    // False before the first publish, or if the writer overran the slot
+    // while it was being attached
+    bool Begin(SnapshotFileReader& view, uint64_t& sequence) const;
+    // True if nothing read through the view since Begin() was overwritten
+    bool Validate(uint64_t sequence) const;
+
+    // Copies the newest snapshot out, retrying while the writer overruns it
+    bool Read(std::vector<WindowInfo>& windows, uint64_t& captureTime, uint64_t& sequence) const;
+
+private:
+    const uint8_t* m_base = nullptr;
+    size_t m_size = 0;
+    size_t m_slotCapacity = 0;
+    void* m_mapping = nullptr;   // mapping handle on Windows
+};
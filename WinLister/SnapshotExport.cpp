@@ -0,0 +1,297 @@
+#include "SnapshotExport.h"
+#include "WindowSort.h"
+#include <cstring>
+#include <cwchar>
+
+namespace {
+
+// One pass over the fields of a window; CSV and JSON plug in their own
+// emitters so the column set and order are defined once
+template <typename Emitter>
+void EmitFields(Emitter& e, const WindowInfo& win) {
+    size_t styleCount, exStyleCount;
+    const StyleFlagName* styleFlags = WindowInfo::StyleFlagNames(styleCount);
+    const StyleFlagName* exStyleFlags = WindowInfo::ExStyleFlagNames(exStyleCount);
+
+    e.Handle("hwnd", reinterpret_cast<uintptr_t>(win.hwnd));
+    e.Handle("parent", reinterpret_cast<uintptr_t>(win.hwndParent));
+    e.Handle("owner", reinterpret_cast<uintptr_t>(win.hwndOwner));
+    e.Text("title", win.title);
+    e.Text("className", win.className);
+    e.Unsigned("processId", win.processId);
+    e.Unsigned("threadId", win.threadId);
+    e.Text("processName", win.processName);
+    e.Text("processPath", win.processPath);
+    e.Signed("left", win.rect.left);
+    e.Signed("top", win.rect.top);
+    e.Signed("right", win.rect.right);
+    e.Signed("bottom", win.rect.bottom);
+    e.Signed("clientWidth", win.clientRect.right - win.clientRect.left);
+    e.Signed("clientHeight", win.clientRect.bottom - win.clientRect.top);
+    e.Style("style", win.style);
+    e.Style("exStyle", win.exStyle);
+    e.Flags("styleFlags", win.style, styleFlags, styleCount);
+    e.Flags("exStyleFlags", win.exStyle, exStyleFlags, exStyleCount);
+    e.Bool("visible", win.isVisible);
+    e.Bool("enabled", win.isEnabled);
+    e.Bool("minimized", win.isMinimized);
+    e.Bool("maximized", win.isMaximized);
+    e.Bool("topmost", win.isTopMost);
+    e.Bool("layered", win.isLayered);
+    e.Bool("transparent", win.isTransparent);
+    e.Bool("cloaked", win.isCloaked);
+    e.Bool("uwp", win.isUWP);
+    e.Bool("hung", win.isHung);
+    e.Unsigned("alpha", win.alpha);
+    e.Signed("zOrder", win.zOrder);
+    e.Bool("hasDwmFrame", win.hasDwmFrame);
+    e.Signed("dwmLeft", win.hasDwmFrame ? win.dwmExtendedFrame.left : 0);
+    e.Signed("dwmTop", win.hasDwmFrame ? win.dwmExtendedFrame.top : 0);
+    e.Signed("dwmRight", win.hasDwmFrame ? win.dwmExtendedFrame.right : 0);
+    e.Signed("dwmBottom", win.hasDwmFrame ? win.dwmExtendedFrame.bottom : 0);
+    e.Bool("system", win.IsSystemWindow());
+    e.Bool("hidden", win.IsHiddenWindow());
+}
+
+void PutFlagList(BufferedWriter& out, DWORD value, const StyleFlagName* flags, size_t count) {
+    bool first = true;
+    for (size_t i = 0; i < count; i++) {
+        if (value & flags[i].mask) {
+            if (!first) out.PutLiteral(" | ");
+            out.PutUtf8(flags[i].name, wcslen(flags[i].name));
+            first = false;
+        }
+    }
+}
+
+struct CsvHeaderEmitter {
+    BufferedWriter& out;
+    bool first = true;
+
+    void Name(const char* name) {
+        if (!first) out.Put(',');
+        out.Put(name, strlen(name));
+        first = false;
+    }
+    void Handle(const char* name, uintptr_t) { Name(name); }
+    void Text(const char* name, const std::wstring&) { Name(name); }
+    void Unsigned(const char* name, uint64_t) { Name(name); }
+    void Signed(const char* name, int64_t) { Name(name); }
+    void Style(const char* name, DWORD) { Name(name); }
+    void Flags(const char* name, DWORD, const StyleFlagName*, size_t) { Name(name); }
+    void Bool(const char* name, bool) { Name(name); }
+};
+
+struct CsvRowEmitter {
+    BufferedWriter& out;
+    bool first = true;
+
+    void Separator() {
+        if (!first) out.Put(',');
+        first = false;
+    }
+    void Handle(const char*, uintptr_t value) {
+        Separator();
+        out.PutLiteral("0x");
+        out.PutHex(value);
+    }
+    void Text(const char*, const std::wstring& text) {
+        Separator();
+        // Quote only when needed; embedded quotes are doubled
+        bool quote = text.find_first_of(L",\"\r\n") != std::wstring::npos;
+        if (!quote) {
+            out.PutUtf8(text.data(), text.size());
+            return;
+        }
+        out.Put('"');
+        size_t runStart = 0;
+        for (size_t i = 0; i < text.size(); i++) {
+            if (text[i] == L'"') {
+                out.PutUtf8(text.data() + runStart, i + 1 - runStart);
+                out.Put('"');
+                runStart = i + 1;
+            }
+        }
+        out.PutUtf8(text.data() + runStart, text.size() - runStart);
+        out.Put('"');
+    }
+    void Unsigned(const char*, uint64_t value) {
+        Separator();
+        out.PutUnsigned(value);
+    }
+    void Signed(const char*, int64_t value) {
+        Separator();
+        out.PutSigned(value);
+    }
+    void Style(const char*, DWORD value) {
+        Separator();
+        out.PutLiteral("0x");
+        out.PutHex(value, 8);
+    }
+    void Flags(const char*, DWORD value, const StyleFlagName* flags, size_t count) {
+        // Flag names never contain CSV specials
+        Separator();
+        PutFlagList(out, value, flags, count);
+    }
+    void Bool(const char*, bool value) {
+        Separator();
+        if (value) out.PutLiteral("true"); else out.PutLiteral("false");
+    }
+};
+
+struct JsonRowEmitter {
+    BufferedWriter& out;
+    bool first = true;
+
+    void Key(const char* name) {
+        out.Put(first ? '{' : ',');
+        out.Put('"');
+        out.Put(name, strlen(name));
+        out.PutLiteral("\":");
+        first = false;
+    }
+    void Handle(const char* name, uintptr_t value) {
+        Key(name);
+        out.PutLiteral("\"0x");
+        out.PutHex(value);
+        out.Put('"');
+    }
+    void Text(const char* name, const std::wstring& text) {
+        Key(name);
+        SnapshotExporter::WriteJsonString(out, text);
+    }
+    void Unsigned(const char* name, uint64_t value) {
+        Key(name);
+        out.PutUnsigned(value);
+    }
+    void Signed(const char* name, int64_t value) {
+        Key(name);
+        out.PutSigned(value);
+    }
+    void Style(const char* name, DWORD value) {
+        // Kept numeric for consumers that test bits
+        Key(name);
+        out.PutUnsigned(value);
+    }
+    void Flags(const char* name, DWORD value, const StyleFlagName* flags, size_t count) {
+        Key(name);
+        out.Put('"');
+        PutFlagList(out, value, flags, count);
+        out.Put('"');
+    }
+    void Bool(const char* name, bool value) {
+        Key(name);
+        if (value) out.PutLiteral("true"); else out.PutLiteral("false");
+    }
+};
+
+} // namespace
+
+bool SnapshotExporter::Write(const std::vector<WindowInfo>& windows, SnapshotFormat format, ByteSink& sink) {
+    BufferedWriter out(sink);
+    Begin(out, format);
+    for (size_t i = 0; i < windows.size(); i++) {
+        WriteRow(out, format, windows[i], i);
+    }
+    End(out, format, windows.size());
+    return out.Flush();
+}
+
+void SnapshotExporter::Begin(BufferedWriter& out, SnapshotFormat format) {
+    switch (format) {
+    case SNAPSHOT_CSV: {
+        CsvHeaderEmitter header = { out };
+        EmitFields(header, WindowInfo());
+        out.PutLiteral("\r\n");
+        break;
+    }
+    case SNAPSHOT_JSON:
+        out.Put('[');
+        break;
+    case SNAPSHOT_NDJSON:
+        break;
+    }
+}
+
+void SnapshotExporter::WriteRow(BufferedWriter& out, SnapshotFormat format, const WindowInfo& win, size_t index) {
+    switch (format) {
+    case SNAPSHOT_CSV: {
+        CsvRowEmitter row = { out };
+        EmitFields(row, win);
+        out.PutLiteral("\r\n");
+        break;
+    }
+    case SNAPSHOT_JSON:
+        if (index > 0) out.Put(',');
+        out.Put('\n');
+        WriteJsonObject(out, win);
+        break;
+    case SNAPSHOT_NDJSON:
+        WriteJsonObject(out, win);
+        out.Put('\n');
+        break;
+    }
+}
+
+void SnapshotExporter::End(BufferedWriter& out, SnapshotFormat format, size_t rowCount) {
+    if (format == SNAPSHOT_JSON) {
+        if (rowCount > 0) out.Put('\n');
+        out.PutLiteral("]\n");
+    }
+}
+
+void SnapshotExporter::WriteJsonObject(BufferedWriter& out, const WindowInfo& win) {
+    JsonRowEmitter row = { out };
+    EmitFields(row, win);
+    out.Put('}');
+}
+
+void SnapshotExporter::WriteJsonString(BufferedWriter& out, const std::wstring& text) {
+    static const char hexDigits[] = "0123456789abcdef";
+
+    out.Put('"');
+    size_t runStart = 0;
+    for (size_t i = 0; i < text.size(); i++) {
+        wchar_t c = text[i];
+        if (c != L'"' && c != L'\\' && c >= 0x20) {
+            continue;
+        }
+        out.PutUtf8(text.data() + runStart, i - runStart);
+        runStart = i + 1;
+
+        switch (c) {
+        case L'"': out.PutLiteral("\\\""); break;
+        case L'\\': out.PutLiteral("\\\\"); break;
+        case L'\n': out.PutLiteral("\\n"); break;
+        case L'\r': out.PutLiteral("\\r"); break;
+        case L'\t': out.PutLiteral("\\t"); break;
+        default:
+            out.PutLiteral("\\u00");
+            out.Put(hexDigits[(c >> 4) & 0xF]);
+            out.Put(hexDigits[c & 0xF]);
+            break;
+        }
+    }
+    out.PutUtf8(text.data() + runStart, text.size() - runStart);
+    out.Put('"');
+}
+
+const wchar_t* SnapshotExporter::FileExtension(SnapshotFormat format) {
+    switch (format) {
+    case SNAPSHOT_CSV: return L"csv";
+    case SNAPSHOT_JSON: return L"json";
+    case SNAPSHOT_NDJSON: return L"ndjson";
+    }
+    return L"";
+}
+
+bool SnapshotExporter::ParseFormat(const std::wstring& name, SnapshotFormat& format) {
+    static const SnapshotFormat formats[] = { SNAPSHOT_CSV, SNAPSHOT_JSON, SNAPSHOT_NDJSON };
+    for (SnapshotFormat candidate : formats) {
+        if (WindowSorter::CompareFolded(name.c_str(), FileExtension(candidate)) == 0) {
+            format = candidate;
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include "WindowInfo.h"
+#include "BufferedWriter.h"
+
+enum SnapshotFormat {
+    SNAPSHOT_CSV = 0,   // RFC 4180, header row, CRLF
+    SNAPSHOT_JSON,      // one array of objects
+    SNAPSHOT_NDJSON     // one object per line
+};
+
+// Streams whole window snapshots with every WindowInfo field, including the
+// decoded style flags. Text is UTF-8; handles are "0x"-prefixed hex strings.
+// Rows are encoded straight into the writer's buffer, with no per-row
+// allocation. Write() covers the common case; Begin/WriteRow/End let a caller
+// stream rows as it produces them.
+class SnapshotExporter {
+public:
+    static bool Write(const std::vector<WindowInfo>& windows, SnapshotFormat format, ByteSink& sink);
+
+    static void Begin(BufferedWriter& out, SnapshotFormat format);
+    // index is the row's position in the snapshot (0 for the first row)
+    static void WriteRow(BufferedWriter& out, SnapshotFormat format, const WindowInfo& win, size_t index);
+    static void End(BufferedWriter& out, SnapshotFormat format, size_t rowCount);
+
+    // One window as a JSON object, as in the JSON formats, with no separator
+    static void WriteJsonObject(BufferedWriter& out, const WindowInfo& win);
+    // A quoted, escaped JSON string
+    static void WriteJsonString(BufferedWriter& out, const std::wstring& text);
+
+    static const wchar_t* FileExtension(SnapshotFormat format);
+    static bool ParseFormat(const std::wstring& name, SnapshotFormat& format);
+};
@@ -0,0 +1,392 @@
+#include "SnapshotFile.h"
+#include <unordered_map>
+
+namespace {
+
+const char HEADER_MAGIC[8] = { 'W', 'L', 'S', 'N', 'A', 'P', 0, 0 };
+const char TRAILER_MAGIC[8] = { 'W', 'L', 'S', 'N', 'E', 'N', 'D', 0 };
+const size_t HEADER_SIZE = 32;
+const size_t INDEX_ENTRY_SIZE = 24;
+const size_t TRAILER_SIZE = 24;
+
+struct StringRef {
+    uint32_t offset;
+    uint32_t length;
+};
+
+const uint32_t COLUMN_WIDTHS[SNAPCOL_COUNT] = {
+    8, 8, 8,        // hwnd, parent, owner
+    4, 4,           // process id, thread id
+    16, 16,         // rect, client rect
+    4, 4, 4,        // style, exstyle, flags
+    1, 4,           // alpha, z-order
+    16,             // dwm frame
+    8, 8, 8, 8,     // title, class, process name, process path
+    2               // string pool
+};
+
+const int FIRST_STRING_COLUMN = SNAPCOL_TITLE;
+const int STRING_COLUMN_COUNT = SNAPCOL_STRING_POOL - SNAPCOL_TITLE;
+
+template <typename T>
+void PutValue(BufferedWriter& out, const T& value) {
+    out.Put(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+void PadTo8(BufferedWriter& out) {
+    while (out.BytesWritten() % 8 != 0) {
+        out.Put('\0');
+    }
+}
+
+SnapshotRect ToSnapshotRect(const RECT& rc) {
+    SnapshotRect result = {
+        static_cast<int32_t>(rc.left), static_cast<int32_t>(rc.top),
+        static_cast<int32_t>(rc.right), static_cast<int32_t>(rc.bottom)
+    };
+    return result;
+}
+
+RECT ToRect(const SnapshotRect& rc) {
+    RECT result = { rc.left, rc.top, rc.right, rc.bottom };
+    return result;
+}
+
+// Deduplicated UTF-16 pool; class names, process names and paths repeat a lot
+class StringPool {
+public:
+    bool Add(const std::wstring& text, StringRef& ref) {
+        auto it = m_offsets.find(text);
+        if (it != m_offsets.end()) {
+            ref = it->second;
+            return true;
+        }
+
+        size_t start = m_units.size();
+        for (wchar_t c : text) {
+            uint32_t cp = static_cast<uint32_t>(c);
+            if (cp > 0xFFFF) {
+                cp -= 0x10000;
+                m_units.push_back(static_cast<char16_t>(0xD800 + (cp >> 10)));
+                m_units.push_back(static_cast<char16_t>(0xDC00 + (cp & 0x3FF)));
+            } else {
+                m_units.push_back(static_cast<char16_t>(cp));
+            }
+        }
+        if (m_units.size() > UINT32_MAX) {
+            return false;
+        }
+
+        ref.offset = static_cast<uint32_t>(start);
+        ref.length = static_cast<uint32_t>(m_units.size() - start);
+        m_offsets.emplace(text, ref);
+        return true;
+    }
+
+    const std::vector<char16_t>& Units() const { return m_units; }
+
+private:
+    std::vector<char16_t> m_units;
+    std::unordered_map<std::wstring, StringRef> m_offsets;
+};
+
+void WriteColumnRow(BufferedWriter& out, int column, const WindowInfo& win, const StringRef* refs) {
+    switch (column) {
+    case SNAPCOL_HWND: PutValue(out, static_cast<uint64_t>(reinterpret_cast<uintptr_t>(win.hwnd))); break;
+    case SNAPCOL_PARENT: PutValue(out, static_cast<uint64_t>(reinterpret_cast<uintptr_t>(win.hwndParent))); break;
+    case SNAPCOL_OWNER: PutValue(out, static_cast<uint64_t>(reinterpret_cast<uintptr_t>(win.hwndOwner))); break;
+    case SNAPCOL_PROCESS_ID: PutValue(out, static_cast<uint32_t>(win.processId)); break;
+    case SNAPCOL_THREAD_ID: PutValue(out, static_cast<uint32_t>(win.threadId)); break;
+    case SNAPCOL_RECT: PutValue(out, ToSnapshotRect(win.rect)); break;
+    case SNAPCOL_CLIENT_RECT: PutValue(out, ToSnapshotRect(win.clientRect)); break;
+    case SNAPCOL_STYLE: PutValue(out, static_cast<uint32_t>(win.style)); break;
+    case SNAPCOL_EXSTYLE: PutValue(out, static_cast<uint32_t>(win.exStyle)); break;
+    case SNAPCOL_FLAGS: PutValue(out, SnapshotFlags::Pack(win)); break;
+    case SNAPCOL_ALPHA: PutValue(out, static_cast<uint8_t>(win.alpha)); break;
+    case SNAPCOL_ZORDER: PutValue(out, static_cast<int32_t>(win.zOrder)); break;
+    case SNAPCOL_DWM_FRAME: {
+        SnapshotRect frame = {};
+        if (win.hasDwmFrame) frame = ToSnapshotRect(win.dwmExtendedFrame);
+        PutValue(out, frame);
+        break;
+    }
+    default:
+        PutValue(out, refs[column - FIRST_STRING_COLUMN]);
+        break;
+    }
+}
+
+} // namespace
+
+uint32_t SnapshotFlags::Pack(const WindowInfo& win) {
+    uint32_t flags = 0;
+    if (win.isVisible) flags |= SNAPFLAG_VISIBLE;
+    if (win.isEnabled) flags |= SNAPFLAG_ENABLED;
+    if (win.isMinimized) flags |= SNAPFLAG_MINIMIZED;
+    if (win.isMaximized) flags |= SNAPFLAG_MAXIMIZED;
+    if (win.isTopMost) flags |= SNAPFLAG_TOPMOST;
+    if (win.isLayered) flags |= SNAPFLAG_LAYERED;
+    if (win.isTransparent) flags |= SNAPFLAG_TRANSPARENT;
+    if (win.isCloaked) flags |= SNAPFLAG_CLOAKED;
+    if (win.isUWP) flags |= SNAPFLAG_UWP;
+    if (win.isHung) flags |= SNAPFLAG_HUNG;
+    if (win.hasDwmFrame) flags |= SNAPFLAG_DWM_FRAME;
+    return flags;
+}
+
+void SnapshotFlags::Unpack(uint32_t flags, WindowInfo& win) {
+    win.isVisible = (flags & SNAPFLAG_VISIBLE) != 0;
+    win.isEnabled = (flags & SNAPFLAG_ENABLED) != 0;
+    win.isMinimized = (flags & SNAPFLAG_MINIMIZED) != 0;
+    win.isMaximized = (flags & SNAPFLAG_MAXIMIZED) != 0;
+    win.isTopMost = (flags & SNAPFLAG_TOPMOST) != 0;
+    win.isLayered = (flags & SNAPFLAG_LAYERED) != 0;
+    win.isTransparent = (flags & SNAPFLAG_TRANSPARENT) != 0;
+    win.isCloaked = (flags & SNAPFLAG_CLOAKED) != 0;
+    win.isUWP = (flags & SNAPFLAG_UWP) != 0;
+    win.isHung = (flags & SNAPFLAG_HUNG) != 0;
+    win.hasDwmFrame = (flags & SNAPFLAG_DWM_FRAME) != 0;
+}
+
+bool SnapshotFileWriter::Write(const std::vector<WindowInfo>& windows, uint64_t captureTime, ByteSink& sink) {
+    if (windows.size() > UINT32_MAX) {
+        return false;
+    }
+
+    // Pool the strings first so the reference columns can be written in order
+    StringPool pool;
+    std::vector<StringRef> refs(windows.size() * STRING_COLUMN_COUNT);
+    for (size_t i = 0; i < windows.size(); i++) {
+        const WindowInfo& win = windows[i];
+        StringRef* row = &refs[i * STRING_COLUMN_COUNT];
+        if (!pool.Add(win.title, row[SNAPCOL_TITLE - FIRST_STRING_COLUMN]) ||
+            !pool.Add(win.className, row[SNAPCOL_CLASS - FIRST_STRING_COLUMN]) ||
+            !pool.Add(win.processName, row[SNAPCOL_PROCESS_NAME - FIRST_STRING_COLUMN]) ||
+            !pool.Add(win.processPath, row[SNAPCOL_PROCESS_PATH - FIRST_STRING_COLUMN])) {
+            return false;
+        }
+    }
+
+    BufferedWriter out(sink);
+
+    // Header
+    out.Put(HEADER_MAGIC, sizeof(HEADER_MAGIC));
+    PutValue(out, VERSION);
+    PutValue(out, static_cast<uint32_t>(windows.size()));
+    PutValue(out, captureTime);
+    PutValue(out, static_cast<uint64_t>(0));
+
+    struct IndexEntry {
+        uint32_t column;
+        uint32_t width;
+        uint64_t offset;
+        uint64_t size;
+    };
+    IndexEntry index[SNAPCOL_COUNT];
+
+    // Fixed-width and string reference columns
+    for (int column = 0; column < SNAPCOL_STRING_POOL; column++) {
+        PadTo8(out);
+        index[column].column = static_cast<uint32_t>(column);
+        index[column].width = COLUMN_WIDTHS[column];
+        index[column].offset = out.BytesWritten();
+        for (size_t i = 0; i < windows.size(); i++) {
+            WriteColumnRow(out, column, windows[i], &refs[i * STRING_COLUMN_COUNT]);
+        }
+        index[column].size = out.BytesWritten() - index[column].offset;
+    }
+
+    // String pool
+    PadTo8(out);
+    const std::vector<char16_t>& units = pool.Units();
+    index[SNAPCOL_STRING_POOL].column = SNAPCOL_STRING_POOL;
+    index[SNAPCOL_STRING_POOL].width = COLUMN_WIDTHS[SNAPCOL_STRING_POOL];
+    index[SNAPCOL_STRING_POOL].offset = out.BytesWritten();
+    index[SNAPCOL_STRING_POOL].size = units.size() * sizeof(char16_t);
+    if (!units.empty()) {
+        out.Put(reinterpret_cast<const char*>(units.data()), units.size() * sizeof(char16_t));
+    }
+
+    // Index and trailer
+    PadTo8(out);
+    uint64_t indexOffset = out.BytesWritten();
+    for (const IndexEntry& entry : index) {
+        PutValue(out, entry.column);
+        PutValue(out, entry.width);
+        PutValue(out, entry.offset);
+        PutValue(out, entry.size);
+    }
+    PutValue(out, indexOffset);
+    PutValue(out, static_cast<uint32_t>(SNAPCOL_COUNT));
+    PutValue(out, static_cast<uint32_t>(0));
+    out.Put(TRAILER_MAGIC, sizeof(TRAILER_MAGIC));
+
+    return out.Flush();
+}
+
+SnapshotFileReader::~SnapshotFileReader() {
+    Close();
+}
+
+bool SnapshotFileReader::Open(const std::wstring& path) {
+    Close();
+    if (!m_file.Open(path)) {
+        return false;
+    }
+
+    m_data = m_file.Data();
+    m_size = m_file.Size();
+    if (!Parse()) {
+        Close();
+        return false;
+    }
+    return true;
+}
+
+bool SnapshotFileReader::Attach(const void* data, size_t size) {
+    Close();
+    m_data = static_cast<const uint8_t*>(data);
+    m_size = size;
+    if (!m_data || reinterpret_cast<uintptr_t>(m_data) % 8 != 0 || !Parse()) {
+        Close();
+        return false;
+    }
+    return true;
+}
+
+void SnapshotFileReader::Close() {
+    m_file.Close();
+    m_data = nullptr;
+    m_size = 0;
+    m_version = 0;
+    m_rowCount = 0;
+    m_captureTime = 0;
+    m_poolLength = 0;
+    for (Column& column : m_columns) {
+        column = Column();
+    }
+}
+
+bool SnapshotFileReader::Parse() {
+    if (m_size < HEADER_SIZE + TRAILER_SIZE) return false;
+    if (memcmp(m_data, HEADER_MAGIC, sizeof(HEADER_MAGIC)) != 0) return false;
+
+    uint32_t rowCount;
+    memcpy(&m_version, m_data + 8, sizeof(uint32_t));
+    memcpy(&rowCount, m_data + 12, sizeof(uint32_t));
+    memcpy(&m_captureTime, m_data + 16, sizeof(uint64_t));
+    if (m_version < 1) return false;
+    m_rowCount = rowCount;
+
+    const uint8_t* trailer = m_data + m_size - TRAILER_SIZE;
+    if (memcmp(trailer + 16, TRAILER_MAGIC, sizeof(TRAILER_MAGIC)) != 0) return false;
+
+    uint64_t indexOffset;
+    uint32_t indexCount;
+    memcpy(&indexOffset, trailer, sizeof(uint64_t));
+    memcpy(&indexCount, trailer + 8, sizeof(uint32_t));
+
+    uint64_t indexEnd = m_size - TRAILER_SIZE;
+    if (indexOffset < HEADER_SIZE || indexOffset > indexEnd ||
+        static_cast<uint64_t>(indexCount) * INDEX_ENTRY_SIZE != indexEnd - indexOffset) {
+        return false;
+    }
+
+    for (uint32_t i = 0; i < indexCount; i++) {
+        const uint8_t* entry = m_data + indexOffset + i * INDEX_ENTRY_SIZE;
+        uint32_t id, width;
+        uint64_t offset, size;
+        memcpy(&id, entry, sizeof(uint32_t));
+        memcpy(&width, entry + 4, sizeof(uint32_t));
+        memcpy(&offset, entry + 8, sizeof(uint64_t));
+        memcpy(&size, entry + 16, sizeof(uint64_t));
+
+        if (offset < HEADER_SIZE || offset > indexOffset || size > indexOffset - offset) return false;
+        if (offset % 8 != 0) return false;
+
+        // Columns from newer versions are skipped
+        if (id >= SNAPCOL_COUNT) continue;
+        if (width != COLUMN_WIDTHS[id]) return false;
+
+        if (id == SNAPCOL_STRING_POOL) {
+            if (size % sizeof(char16_t) != 0) return false;
+            m_poolLength = static_cast<size_t>(size / sizeof(char16_t));
+        } else if (size != static_cast<uint64_t>(rowCount) * width) {
+            return false;
+        }
+
+        m_columns[id].data = m_data + offset;
+        m_columns[id].width = width;
+    }
+
+    for (int column = FIRST_STRING_COLUMN; column < SNAPCOL_STRING_POOL; column++) {
+        if (m_columns[column].data && !m_columns[SNAPCOL_STRING_POOL].data && m_rowCount > 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+SnapshotString SnapshotFileReader::String(int column, size_t row) const {
+    static const char16_t empty[1] = { 0 };
+    SnapshotString result = { empty, 0 };
+
+    StringRef ref = Value<StringRef>(column, row);
+    if (ref.length == 0 || static_cast<uint64_t>(ref.offset) + ref.length > m_poolLength) {
+        return result;
+    }
+
+    result.data = reinterpret_cast<const char16_t*>(m_columns[SNAPCOL_STRING_POOL].data) + ref.offset;
+    result.length = ref.length;
+    return result;
+}
+
+std::wstring SnapshotFileReader::ToWide(const SnapshotString& text) {
+    std::wstring result;
+    result.reserve(text.length);
+    for (size_t i = 0; i < text.length; i++) {
+        uint32_t c = text.data[i];
+        if (sizeof(wchar_t) == 4 && c >= 0xD800 && c <= 0xDBFF && i + 1 < text.length) {
+            uint32_t low = text.data[i + 1];
+            if (low >= 0xDC00 && low <= 0xDFFF) {
+                c = 0x10000 + ((c - 0xD800) << 10) + (low - 0xDC00);
+                i++;
+            }
+        }
+        result.push_back(static_cast<wchar_t>(c));
+    }
+    return result;
+}
+
+WindowInfo SnapshotFileReader::Row(size_t row) const {
+    WindowInfo info = {};
+    info.hwnd = reinterpret_cast<HWND>(static_cast<uintptr_t>(Hwnd(row)));
+    info.hwndParent = reinterpret_cast<HWND>(static_cast<uintptr_t>(Parent(row)));
+    info.hwndOwner = reinterpret_cast<HWND>(static_cast<uintptr_t>(Owner(row)));
+    info.title = ToWide(Title(row));
+    info.className = ToWide(ClassName(row));
+    info.processId = ProcessId(row);
+    info.threadId = ThreadId(row);
+    info.processName = ToWide(ProcessName(row));
+    info.processPath = ToWide(ProcessPath(row));
+    info.rect = ToRect(Rect(row));
+    info.clientRect = ToRect(ClientRect(row));
+    info.style = Style(row);
+    info.exStyle = ExStyle(row);
+
+    SnapshotFlags::Unpack(Flags(row), info);
+
+    info.alpha = Alpha(row);
+    info.zOrder = ZOrder(row);
+    info.hIcon = nullptr;
+    info.dwmExtendedFrame = ToRect(DwmFrame(row));
+    return info;
+}
+
+void SnapshotFileReader::Materialize(std::vector<WindowInfo>& windows) const {
+    windows.clear();
+    windows.reserve(m_rowCount);
+    for (size_t i = 0; i < m_rowCount; i++) {
+        windows.push_back(Row(i));
+    }
+}
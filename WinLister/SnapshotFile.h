@@ -0,0 +1,166 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "WindowInfo.h"
+#include "BufferedWriter.h"
+#include "FileIO.h"
+
+// Binary window snapshot, version 1 (little-endian):
+//
+//   header   magic "WLSNAP\0\0", u32 version, u32 row count, u64 capture time
+//            (ms since the Unix epoch), u64 reserved
+//   columns  one fixed-width array per field, rowCount entries each, every
+//            column starting on an 8-byte boundary
+//   pool     UTF-16 code units shared by all string columns; a string column
+//            holds {u32 offset, u32 length} per row, in code units
+//   index    {u32 column id, u32 entry width, u64 offset, u64 size} per column
+//   trailer  u64 index offset, u32 index entries, u32 reserved, "WLSNEND\0"
+//
+// Readers locate everything through the trailer and index, so columns can be
+// added in later versions without breaking older readers.
+enum SnapshotColumn {
+    SNAPCOL_HWND = 0,       // u64
+    SNAPCOL_PARENT,         // u64
+    SNAPCOL_OWNER,          // u64
+    SNAPCOL_PROCESS_ID,     // u32
+    SNAPCOL_THREAD_ID,      // u32
+    SNAPCOL_RECT,           // 4 x i32
+    SNAPCOL_CLIENT_RECT,    // 4 x i32
+    SNAPCOL_STYLE,          // u32
+    SNAPCOL_EXSTYLE,        // u32
+    SNAPCOL_FLAGS,          // u32, SnapshotFlag bits
+    SNAPCOL_ALPHA,          // u8
+    SNAPCOL_ZORDER,         // i32
+    SNAPCOL_DWM_FRAME,      // 4 x i32
+    SNAPCOL_TITLE,          // string ref
+    SNAPCOL_CLASS,          // string ref
+    SNAPCOL_PROCESS_NAME,   // string ref
+    SNAPCOL_PROCESS_PATH,   // string ref
+    SNAPCOL_STRING_POOL,    // u16 code units
+    SNAPCOL_COUNT
+};
+
+enum SnapshotFlag {
+    SNAPFLAG_VISIBLE = 1 << 0,
+    SNAPFLAG_ENABLED = 1 << 1,
+    SNAPFLAG_MINIMIZED = 1 << 2,
+    SNAPFLAG_MAXIMIZED = 1 << 3,
+    SNAPFLAG_TOPMOST = 1 << 4,
+    SNAPFLAG_LAYERED = 1 << 5,
+    SNAPFLAG_TRANSPARENT = 1 << 6,
+    SNAPFLAG_CLOAKED = 1 << 7,
+    SNAPFLAG_UWP = 1 << 8,
+    SNAPFLAG_HUNG = 1 << 9,
+    SNAPFLAG_DWM_FRAME = 1 << 10
+};
+
+// Converts between WindowInfo state flags and SnapshotFlag bits
+class SnapshotFlags {
+public:
+    static uint32_t Pack(const WindowInfo& win);
+    static void Unpack(uint32_t flags, WindowInfo& win);
+};
+
+struct SnapshotRect {
+    int32_t left;
+    int32_t top;
+    int32_t right;
+    int32_t bottom;
+};
+
+// Text straight out of the mapped string pool (not null-terminated)
+struct SnapshotString {
+    const char16_t* data;
+    size_t length;
+};
+
+class SnapshotFileWriter {
+public:
+    static constexpr uint32_t VERSION = 1;
+
+    static bool Write(const std::vector<WindowInfo>& windows, uint64_t captureTime, ByteSink& sink);
+};
+
+// Read-only view of a binary snapshot. The file is memory-mapped and rows are
+// read in place: opening validates the header, index and column sizes but
+// does not touch the rows, and accessors read single fields on demand.
+// WindowFilter and WindowQuery test rows on the accessors, so a selection
+// builds WindowInfo values (Row) only for the rows it keeps. Materialize()
+// builds them all, for views that analyse the whole list.
+class SnapshotFileReader {
+public:
+    SnapshotFileReader() = default;
+    ~SnapshotFileReader();
+    SnapshotFileReader(const SnapshotFileReader&) = delete;
+    SnapshotFileReader& operator=(const SnapshotFileReader&) = delete;
+
+    bool Open(const std::wstring& path);
+    // Reads a snapshot already in memory; the buffer must be 8-byte aligned
+    // and outlive the reader
+    bool Attach(const void* data, size_t size);
+    void Close();
+
+    bool IsOpen() const { return m_data != nullptr; }
+    uint32_t Version() const { return m_version; }
+    size_t RowCount() const { return m_rowCount; }
+    uint64_t CaptureTime() const { return m_captureTime; }
+
+    uint64_t Hwnd(size_t row) const { return Value<uint64_t>(SNAPCOL_HWND, row); }
+    uint64_t Parent(size_t row) const { return Value<uint64_t>(SNAPCOL_PARENT, row); }
+    uint64_t Owner(size_t row) const { return Value<uint64_t>(SNAPCOL_OWNER, row); }
+    uint32_t ProcessId(size_t row) const { return Value<uint32_t>(SNAPCOL_PROCESS_ID, row); }
+    uint32_t ThreadId(size_t row) const { return Value<uint32_t>(SNAPCOL_THREAD_ID, row); }
+    SnapshotRect Rect(size_t row) const { return Value<SnapshotRect>(SNAPCOL_RECT, row); }
+    SnapshotRect ClientRect(size_t row) const { return Value<SnapshotRect>(SNAPCOL_CLIENT_RECT, row); }
+    uint32_t Style(size_t row) const { return Value<uint32_t>(SNAPCOL_STYLE, row); }
+    uint32_t ExStyle(size_t row) const { return Value<uint32_t>(SNAPCOL_EXSTYLE, row); }
+    uint32_t Flags(size_t row) const { return Value<uint32_t>(SNAPCOL_FLAGS, row); }
+    uint8_t Alpha(size_t row) const { return Value<uint8_t>(SNAPCOL_ALPHA, row); }
+    int32_t ZOrder(size_t row) const { return Value<int32_t>(SNAPCOL_ZORDER, row); }
+    SnapshotRect DwmFrame(size_t row) const { return Value<SnapshotRect>(SNAPCOL_DWM_FRAME, row); }
+    SnapshotString Title(size_t row) const { return String(SNAPCOL_TITLE, row); }
+    SnapshotString ClassName(size_t row) const { return String(SNAPCOL_CLASS, row); }
+    SnapshotString ProcessName(size_t row) const { return String(SNAPCOL_PROCESS_NAME, row); }
+    SnapshotString ProcessPath(size_t row) const { return String(SNAPCOL_PROCESS_PATH, row); }
+
+    WindowInfo Row(size_t row) const;
+    void Materialize(std::vector<WindowInfo>& windows) const;
+
+    static std::wstring ToWide(const SnapshotString& text);
+
+private:
+    struct Column {
+        const uint8_t* data = nullptr;
+        uint32_t width = 0;
+    };
+
+    template <typename T>
+    T Value(int column, size_t row) const;
+    SnapshotString String(int column, size_t row) const;
+    bool Parse();
+
+    const uint8_t* m_data = nullptr;
+    size_t m_size = 0;
+    uint32_t m_version = 0;
+    size_t m_rowCount = 0;
+    uint64_t m_captureTime = 0;
+    Column m_columns[SNAPCOL_COUNT];
+    size_t m_poolLength = 0;
+
+    // Owns the mapping when opened from a file
+    MappedFile m_file;
+};
+
+template <typename T>
+T SnapshotFileReader::Value(int column, size_t row) const {
+    T value = {};
+    const Column& c = m_columns[column];
+    if (c.data && row < m_rowCount) {
+        memcpy(&value, c.data + row * sizeof(T), sizeof(T));
+    }
+    return value;
+}
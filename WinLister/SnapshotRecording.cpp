@@ -0,0 +1,738 @@
+#include "SnapshotRecording.h"
+#include <algorithm>
+#include <cstring>
+#include <cwctype>
+
+namespace {
+
+const char RECORDING_MAGIC[8] = { 'W', 'L', 'R', 'E', 'C', 0, 0, 0 };
+const size_t RECORDING_HEADER_SIZE = 16;
+const uint32_t NO_STRING = UINT32_MAX;     // never interned; reads as empty
+
+enum RecordOp {
+    OP_COPY = 0,
+    OP_CHANGED = 1,
+    OP_NEW = 2
+};
+
+const int STRING_FIELD_COUNT = RECFIELD_COUNT - RECFIELD_TITLE;
+
+inline uint32_t FieldBit(int field) {
+    return 1u << field;
+}
+
+inline uint64_t ZigZag(int64_t value) {
+    return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+}
+
+inline int64_t UnZigZag(uint64_t value) {
+    return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+}
+
+void PutVarint(std::string& out, uint64_t value) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<char>((value & 0x7F) | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<char>(value));
+}
+
+void PutRectDelta(std::string& out, const SnapshotRect& previous, const SnapshotRect& next) {
+    PutVarint(out, ZigZag(static_cast<int64_t>(next.left) - previous.left));
+    PutVarint(out, ZigZag(static_cast<int64_t>(next.top) - previous.top));
+    PutVarint(out, ZigZag(static_cast<int64_t>(next.right) - previous.right));
+    PutVarint(out, ZigZag(static_cast<int64_t>(next.bottom) - previous.bottom));
+}
+
+inline uint64_t HandleValue(HWND hwnd) {
+    return static_cast<uint64_t>(reinterpret_cast<uintptr_t>(hwnd));
+}
+
+inline HWND ToHandle(uint64_t value) {
+    return reinterpret_cast<HWND>(static_cast<uintptr_t>(value));
+}
+
+inline SnapshotRect ToSnapshotRect(const RECT& rc) {
+    SnapshotRect result = {
+        static_cast<int32_t>(rc.left), static_cast<int32_t>(rc.top),
+        static_cast<int32_t>(rc.right), static_cast<int32_t>(rc.bottom)
+    };
+    return result;
+}
+
+inline bool SameRect(const SnapshotRect& a, const SnapshotRect& b) {
+    return a.left == b.left && a.top == b.top && a.right == b.right && a.bottom == b.bottom;
+}
+
+const std::wstring& StringField(const WindowInfo& win, int index) {
+    switch (index) {
+    case 0: return win.title;
+    case 1: return win.className;
+    case 2: return win.processName;
+    default: return win.processPath;
+    }
+}
+
+std::wstring& StringField(WindowInfo& win, int index) {
+    return const_cast<std::wstring&>(StringField(const_cast<const WindowInfo&>(win), index));
+}
+
+// Bounds-checked reads over a frame or segment; any overrun clears ok
+struct ByteReader {
+    const uint8_t* pos;
+    const uint8_t* end;
+    bool ok;
+
+    ByteReader(const uint8_t* data, size_t length) : pos(data), end(data + length), ok(true) {}
+
+    size_t Remaining() const { return static_cast<size_t>(end - pos); }
+
+    uint8_t Byte() {
+        if (pos == end) {
+            ok = false;
+            return 0;
+        }
+        return *pos++;
+    }
+
+    uint64_t Varint() {
+        uint64_t value = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            if (pos == end) break;
+            uint8_t b = *pos++;
+            value |= static_cast<uint64_t>(b & 0x7F) << shift;
+            if (!(b & 0x80)) return value;
+        }
+        ok = false;
+        return 0;
+    }
+
+    int64_t Signed() { return UnZigZag(Varint()); }
+
+    const uint8_t* Take(size_t length) {
+        if (length > Remaining()) {
+            ok = false;
+            return nullptr;
+        }
+        const uint8_t* data = pos;
+        pos += length;
+        return data;
+    }
+
+    void ReadRectDelta(RECT& rc) {
+        rc.left = static_cast<LONG>(rc.left + Signed());
+        rc.top = static_cast<LONG>(rc.top + Signed());
+        rc.right = static_cast<LONG>(rc.right + Signed());
+        rc.bottom = static_cast<LONG>(rc.bottom + Signed());
+    }
+};
+
+bool HasRecordingExtension(const std::wstring& path) {
+    static const wchar_t EXTENSION[] = L".wlr";
+    const size_t length = 4;
+    if (path.size() < length) return false;
+    for (size_t i = 0; i < length; i++) {
+        if (static_cast<wchar_t>(towlower(path[path.size() - length + i])) != EXTENSION[i]) return false;
+    }
+    return true;
+}
+
+// Splits "name.000012.wlr" into the base "name.wlr" and sequence 12
+bool ParseSegmentPath(const std::wstring& path, std::wstring& basePath, uint32_t& sequence) {
+    if (!HasRecordingExtension(path)) return false;
+    std::wstring stem = path.substr(0, path.size() - 4);
+    size_t dot = stem.find_last_of(L'.');
+    if (dot == std::wstring::npos || dot + 1 == stem.size() || stem.size() - dot - 1 > 9) return false;
+
+    uint32_t value = 0;
+    for (size_t i = dot + 1; i < stem.size(); i++) {
+        if (stem[i] < L'0' || stem[i] > L'9') return false;
+        value = value * 10 + static_cast<uint32_t>(stem[i] - L'0');
+    }
+    if (value == 0) return false;
+
+    basePath = stem.substr(0, dot) + L".wlr";
+    sequence = value;
+    return true;
+}
+
+// Windows file names ignore case
+bool SamePath(const std::wstring& a, const std::wstring& b) {
+#ifdef _WIN32
+    if (a.size() != b.size()) return false;
+    for (size_t i = 0; i < a.size(); i++) {
+        if (towlower(a[i]) != towlower(b[i])) return false;
+    }
+    return true;
+#else
+    return a == b;
+#endif
+}
+
+} // namespace
+
+void SnapshotDeltaEncoder::Encode(const std::vector<WindowInfo>& windows, uint64_t time, bool keyframe, std::string& out) {
+    bool key = keyframe || m_needKeyframe || m_framesSinceKey >= m_keyframeInterval ||
+        m_strings.size() > MAX_DICTIONARY;
+    if (key) {
+        m_previous.clear();
+        m_previousRows.clear();
+        m_dictionary.clear();
+        m_strings.clear();
+        m_framesSinceKey = 0;
+        m_needKeyframe = false;
+    }
+
+    m_frameNumber++;
+    if (m_sourceUsed.size() < m_previous.size()) {
+        m_sourceUsed.resize(m_previous.size(), 0);
+    }
+
+    m_payload.clear();
+    m_current.clear();
+    m_current.reserve(windows.size());
+    m_runStart = 0;
+    m_runLength = 0;
+    size_t cursor = 0;
+
+    // Previous state of a NEW window: zero fields and empty strings
+    Recorded empty = {};
+    for (uint32_t& id : empty.strings) {
+        id = NO_STRING;
+    }
+
+    PutVarint(m_payload, windows.size());
+    for (size_t row = 0; row < windows.size(); row++) {
+        const WindowInfo& win = windows[row];
+        m_current.push_back(Recorded());
+        Recorded& next = m_current.back();
+
+        // Rows usually keep their order, so try the row after the last source
+        // before the hash lookup
+        uint64_t hwnd = HandleValue(win.hwnd);
+        size_t expected = m_runLength > 0 ? m_runStart + m_runLength : cursor;
+        size_t source = m_previous.size();
+        if (expected < m_previous.size() && m_previous[expected].hwnd == hwnd) {
+            source = expected;
+        } else {
+            auto it = m_previousRows.find(hwnd);
+            if (it != m_previousRows.end()) source = it->second;
+        }
+
+        if (source < m_previous.size() && m_sourceUsed[source] != m_frameNumber) {
+            m_sourceUsed[source] = m_frameNumber;
+            uint32_t mask = Diff(m_previous[source], win, row, next);
+            if (mask == 0) {
+                if (m_runLength > 0 && source == m_runStart + m_runLength) {
+                    m_runLength++;
+                } else {
+                    FlushRun(cursor);
+                    m_runStart = source;
+                    m_runLength = 1;
+                }
+                continue;
+            }
+
+            FlushRun(cursor);
+            PutVarint(m_payload, (static_cast<uint64_t>(mask) << 2) | OP_CHANGED);
+            PutVarint(m_payload, ZigZag(static_cast<int64_t>(source) - static_cast<int64_t>(cursor)));
+            PutFields(mask, m_previous[source], next, win);
+            cursor = source + 1;
+            continue;
+        }
+
+        FlushRun(cursor);
+        uint32_t mask = Diff(empty, win, row, next) | FieldBit(RECFIELD_HWND);
+        PutVarint(m_payload, (static_cast<uint64_t>(mask) << 2) | OP_NEW);
+        PutFields(mask, empty, next, win);
+    }
+    FlushRun(cursor);
+
+    out.push_back(static_cast<char>(key ? RECFRAME_KEY : RECFRAME_DELTA));
+    PutVarint(out, m_payload.size());
+    PutVarint(out, time);
+    out.append(m_payload);
+
+    m_previous.swap(m_current);
+    m_previousRows.clear();
+    m_previousRows.reserve(m_previous.size());
+    for (size_t i = 0; i < m_previous.size(); i++) {
+        m_previousRows.emplace(m_previous[i].hwnd, static_cast<uint32_t>(i));
+    }
+    m_framesSinceKey++;
+}
+
+uint32_t SnapshotDeltaEncoder::Diff(const Recorded& previous, const WindowInfo& win, size_t row, Recorded& next) const {
+    next.hwnd = HandleValue(win.hwnd);
+    next.parent = HandleValue(win.hwndParent);
+    next.owner = HandleValue(win.hwndOwner);
+    next.processId = static_cast<uint32_t>(win.processId);
+    next.threadId = static_cast<uint32_t>(win.threadId);
+    next.rect = ToSnapshotRect(win.rect);
+    next.clientRect = ToSnapshotRect(win.clientRect);
+    next.style = static_cast<uint32_t>(win.style);
+    next.exStyle = static_cast<uint32_t>(win.exStyle);
+    next.flags = SnapshotFlags::Pack(win);
+    next.alpha = win.alpha;
+    next.zOrder = static_cast<int64_t>(win.zOrder) - static_cast<int64_t>(row);
+    next.dwmFrame = win.hasDwmFrame ? ToSnapshotRect(win.dwmExtendedFrame) : SnapshotRect();
+
+    uint32_t mask = 0;
+    if (next.hwnd != previous.hwnd) mask |= FieldBit(RECFIELD_HWND);
+    if (next.parent != previous.parent) mask |= FieldBit(RECFIELD_PARENT);
+    if (next.owner != previous.owner) mask |= FieldBit(RECFIELD_OWNER);
+    if (next.processId != previous.processId) mask |= FieldBit(RECFIELD_PROCESS_ID);
+    if (next.threadId != previous.threadId) mask |= FieldBit(RECFIELD_THREAD_ID);
+    if (!SameRect(next.rect, previous.rect)) mask |= FieldBit(RECFIELD_RECT);
+    if (!SameRect(next.clientRect, previous.clientRect)) mask |= FieldBit(RECFIELD_CLIENT_RECT);
+    if (next.style != previous.style) mask |= FieldBit(RECFIELD_STYLE);
+    if (next.exStyle != previous.exStyle) mask |= FieldBit(RECFIELD_EXSTYLE);
+    if (next.flags != previous.flags) mask |= FieldBit(RECFIELD_FLAGS);
+    if (next.alpha != previous.alpha) mask |= FieldBit(RECFIELD_ALPHA);
+    if (next.zOrder != previous.zOrder) mask |= FieldBit(RECFIELD_ZORDER);
+    if (!SameRect(next.dwmFrame, previous.dwmFrame)) mask |= FieldBit(RECFIELD_DWM_FRAME);
+
+    for (int i = 0; i < STRING_FIELD_COUNT; i++) {
+        uint32_t id = previous.strings[i];
+        next.strings[i] = id;
+        const std::wstring& text = StringField(win, i);
+        bool same = id == NO_STRING ? text.empty() : *m_strings[id] == text;
+        if (!same) mask |= FieldBit(RECFIELD_TITLE + i);
+    }
+    return mask;
+}
+
+void SnapshotDeltaEncoder::PutFields(uint32_t mask, const Recorded& previous, Recorded& next, const WindowInfo& win) {
+    if (mask & FieldBit(RECFIELD_HWND)) PutVarint(m_payload, next.hwnd);
+    if (mask & FieldBit(RECFIELD_PARENT)) PutVarint(m_payload, next.parent);
+    if (mask & FieldBit(RECFIELD_OWNER)) PutVarint(m_payload, next.owner);
+    if (mask & FieldBit(RECFIELD_PROCESS_ID)) PutVarint(m_payload, next.processId);
+    if (mask & FieldBit(RECFIELD_THREAD_ID)) PutVarint(m_payload, next.threadId);
+    if (mask & FieldBit(RECFIELD_RECT)) PutRectDelta(m_payload, previous.rect, next.rect);
+    if (mask & FieldBit(RECFIELD_CLIENT_RECT)) PutRectDelta(m_payload, previous.clientRect, next.clientRect);
+    if (mask & FieldBit(RECFIELD_STYLE)) PutVarint(m_payload, next.style);
+    if (mask & FieldBit(RECFIELD_EXSTYLE)) PutVarint(m_payload, next.exStyle);
+    if (mask & FieldBit(RECFIELD_FLAGS)) PutVarint(m_payload, next.flags);
+    if (mask & FieldBit(RECFIELD_ALPHA)) m_payload.push_back(static_cast<char>(next.alpha));
+    if (mask & FieldBit(RECFIELD_ZORDER)) PutVarint(m_payload, ZigZag(next.zOrder));
+    if (mask & FieldBit(RECFIELD_DWM_FRAME)) PutRectDelta(m_payload, previous.dwmFrame, next.dwmFrame);
+
+    for (int i = 0; i < STRING_FIELD_COUNT; i++) {
+        if (mask & FieldBit(RECFIELD_TITLE + i)) {
+            PutString(StringField(win, i), next.strings[i]);
+        }
+    }
+}
+
+void SnapshotDeltaEncoder::PutString(const std::wstring& text, uint32_t& id) {
+    auto it = m_dictionary.find(text);
+    if (it != m_dictionary.end()) {
+        id = it->second;
+        PutVarint(m_payload, id);
+        return;
+    }
+
+    id = static_cast<uint32_t>(m_strings.size());
+    auto inserted = m_dictionary.emplace(text, id).first;
+    m_strings.push_back(&inserted->first);
+
+    std::string utf8 = FileIO::ToUtf8(text);
+    PutVarint(m_payload, id);
+    PutVarint(m_payload, utf8.size());
+    m_payload.append(utf8);
+}
+
+void SnapshotDeltaEncoder::FlushRun(size_t& cursor) {
+    if (m_runLength == 0) {
+        return;
+    }
+
+    PutVarint(m_payload, (static_cast<uint64_t>(m_runLength) << 2) | OP_COPY);
+    PutVarint(m_payload, ZigZag(static_cast<int64_t>(m_runStart) - static_cast<int64_t>(cursor)));
+    cursor = m_runStart + m_runLength;
+    m_runLength = 0;
+}
+
+void SnapshotDeltaDecoder::Reset() {
+    m_windows.clear();
+    m_next.clear();
+    m_dictionary.clear();
+    m_valid = false;
+}
+
+bool SnapshotDeltaDecoder::Apply(uint8_t kind, const uint8_t* payload, size_t length) {
+    if (kind == RECFRAME_KEY) {
+        m_windows.clear();
+        m_dictionary.clear();
+    } else if (kind != RECFRAME_DELTA || !m_valid) {
+        m_valid = false;
+        return false;
+    }
+    m_valid = false;
+
+    ByteReader in(payload, length);
+    uint64_t count = in.Varint();
+    // Every row costs payload bytes unless copied from the previous frame
+    if (!in.ok || count > m_windows.size() + length) {
+        return false;
+    }
+
+    m_next.clear();
+    m_next.reserve(static_cast<size_t>(count));
+    size_t cursor = 0;
+
+    auto readString = [&](std::wstring& text) {
+        uint64_t id = in.Varint();
+        if (id < m_dictionary.size()) {
+            text = m_dictionary[static_cast<size_t>(id)];
+        } else if (id == m_dictionary.size()) {
+            uint64_t size = in.Varint();
+            if (!in.ok || size > in.Remaining()) {
+                in.ok = false;
+                return;
+            }
+            const uint8_t* data = in.Take(static_cast<size_t>(size));
+            m_dictionary.push_back(FileIO::FromUtf8(reinterpret_cast<const char*>(data), static_cast<size_t>(size)));
+            text = m_dictionary.back();
+        } else {
+            in.ok = false;
+        }
+    };
+
+    auto readFields = [&](uint32_t mask, WindowInfo& win, size_t row) {
+        if (mask & FieldBit(RECFIELD_HWND)) win.hwnd = ToHandle(in.Varint());
+        if (mask & FieldBit(RECFIELD_PARENT)) win.hwndParent = ToHandle(in.Varint());
+        if (mask & FieldBit(RECFIELD_OWNER)) win.hwndOwner = ToHandle(in.Varint());
+        if (mask & FieldBit(RECFIELD_PROCESS_ID)) win.processId = static_cast<DWORD>(in.Varint());
+        if (mask & FieldBit(RECFIELD_THREAD_ID)) win.threadId = static_cast<DWORD>(in.Varint());
+        if (mask & FieldBit(RECFIELD_RECT)) in.ReadRectDelta(win.rect);
+        if (mask & FieldBit(RECFIELD_CLIENT_RECT)) in.ReadRectDelta(win.clientRect);
+        if (mask & FieldBit(RECFIELD_STYLE)) win.style = static_cast<DWORD>(in.Varint());
+        if (mask & FieldBit(RECFIELD_EXSTYLE)) win.exStyle = static_cast<DWORD>(in.Varint());
+        if (mask & FieldBit(RECFIELD_FLAGS)) SnapshotFlags::Unpack(static_cast<uint32_t>(in.Varint()), win);
+        if (mask & FieldBit(RECFIELD_ALPHA)) win.alpha = in.Byte();
+        if (mask & FieldBit(RECFIELD_ZORDER)) win.zOrder = static_cast<int>(static_cast<int64_t>(row) + in.Signed());
+        if (mask & FieldBit(RECFIELD_DWM_FRAME)) in.ReadRectDelta(win.dwmExtendedFrame);
+
+        for (int i = 0; i < STRING_FIELD_COUNT && in.ok; i++) {
+            if (mask & FieldBit(RECFIELD_TITLE + i)) {
+                readString(StringField(win, i));
+            }
+        }
+    };
+
+    // Moves a row from the previous frame, keeping its z-order relative to the row
+    auto take = [&](size_t source) {
+        WindowInfo& win = m_windows[source];
+        int relative = win.zOrder - static_cast<int>(source);
+        m_next.push_back(std::move(win));
+        m_next.back().zOrder = relative + static_cast<int>(m_next.size() - 1);
+    };
+
+    while (in.ok && m_next.size() < count) {
+        uint64_t header = in.Varint();
+        uint64_t value = header >> 2;
+        size_t row = m_next.size();
+
+        switch (header & 3) {
+        case OP_COPY: {
+            int64_t source = static_cast<int64_t>(cursor) + in.Signed();
+            if (!in.ok || value == 0 || source < 0 || static_cast<uint64_t>(source) > m_windows.size() ||
+                value > m_windows.size() - static_cast<uint64_t>(source) || value > count - row) {
+                return false;
+            }
+            for (uint64_t i = 0; i < value; i++) {
+                take(static_cast<size_t>(source + i));
+            }
+            cursor = static_cast<size_t>(source + value);
+            break;
+        }
+        case OP_CHANGED: {
+            int64_t source = static_cast<int64_t>(cursor) + in.Signed();
+            if (!in.ok || source < 0 || static_cast<uint64_t>(source) >= m_windows.size() ||
+                value >= (1ull << RECFIELD_COUNT)) {
+                return false;
+            }
+            take(static_cast<size_t>(source));
+            readFields(static_cast<uint32_t>(value), m_next.back(), row);
+            cursor = static_cast<size_t>(source + 1);
+            break;
+        }
+        case OP_NEW: {
+            if (value >= (1ull << RECFIELD_COUNT)) {
+                return false;
+            }
+            m_next.push_back(WindowInfo());
+            m_next.back().zOrder = static_cast<int>(row);
+            readFields(static_cast<uint32_t>(value), m_next.back(), row);
+            break;
+        }
+        default:
+            return false;
+        }
+    }
+
+    if (!in.ok || m_next.size() != count || in.Remaining() != 0) {
+        return false;
+    }
+
+    m_windows.swap(m_next);
+    m_valid = true;
+    return true;
+}
+
+SnapshotRecorder::~SnapshotRecorder() {
+    Stop();
+}
+
+bool SnapshotRecorder::Start(const std::wstring& basePath, const RecordingOptions& options) {
+    Stop();
+    m_basePath = basePath;
+    m_options = options;
+    m_encoder.SetKeyframeInterval(options.keyframeInterval);
+    m_sequence = 0;
+    m_bytesWritten = 0;
+    m_lastTime = 0;
+
+    // Replace an earlier recording of the same name. One that rolled past
+    // maxSegments starts past 1, so every numbered segment in the directory
+    // goes, or its tail would be joined onto this one
+    std::wstring stem = SegmentPath(basePath, 1);
+    stem.resize(stem.size() - 11);
+    size_t slash = stem.find_last_of(L"/\\");
+    std::wstring directory = slash == std::wstring::npos ? L"." : stem.substr(0, slash == 0 ? 1 : slash);
+    std::wstring prefix = slash == std::wstring::npos ? std::wstring() : stem.substr(0, slash + 1);
+    for (const std::wstring& name : FileIO::ListFiles(directory)) {
+        std::wstring segmentBase;
+        uint32_t sequence;
+        if (ParseSegmentPath(prefix + name, segmentBase, sequence) &&
+            SamePath(segmentBase.substr(0, segmentBase.size() - 4), stem)) {
+            FileIO::Remove(prefix + name);
+        }
+    }
+
+    return OpenSegment();
+}
+
+bool SnapshotRecorder::OpenSegment() {
+    m_sequence++;
+    m_file = FileIO::Open(SegmentPath(m_basePath, m_sequence), "wb");
+    if (!m_file) {
+        return false;
+    }
+
+    char header[RECORDING_HEADER_SIZE] = {};
+    memcpy(header, RECORDING_MAGIC, sizeof(RECORDING_MAGIC));
+    memcpy(header + 8, &VERSION, sizeof(uint32_t));
+    if (fwrite(header, 1, sizeof(header), m_file) != sizeof(header) || fflush(m_file) != 0) {
+        Stop();
+        return false;
+    }
+    m_segmentSize = sizeof(header);
+    m_bytesWritten += sizeof(header);
+    m_encoder.Reset();
+
+    // Roll off the oldest segment
+    if (m_options.maxSegments > 0 && m_sequence > m_options.maxSegments) {
+        FileIO::Remove(SegmentPath(m_basePath, m_sequence - m_options.maxSegments));
+    }
+    return true;
+}
+
+bool SnapshotRecorder::Record(const std::vector<WindowInfo>& windows, uint64_t time) {
+    if (!m_file) {
+        return false;
+    }
+
+    if (m_segmentSize >= m_options.segmentBytes) {
+        Stop();
+        if (!OpenSegment()) {
+            return false;
+        }
+    }
+
+    // Replay seeks by time, so frame times must not go backwards
+    if (time < m_lastTime) {
+        time = m_lastTime;
+    }
+    m_lastTime = time;
+
+    m_frame.clear();
+    m_encoder.Encode(windows, time, false, m_frame);
+    if (fwrite(m_frame.data(), 1, m_frame.size(), m_file) != m_frame.size() || fflush(m_file) != 0) {
+        Stop();
+        return false;
+    }
+    m_segmentSize += m_frame.size();
+    m_bytesWritten += m_frame.size();
+    return true;
+}
+
+void SnapshotRecorder::Stop() {
+    if (m_file) {
+        fclose(m_file);
+        m_file = nullptr;
+    }
+}
+
+std::wstring SnapshotRecorder::SegmentPath(const std::wstring& basePath, uint32_t sequence) {
+    std::wstring path = basePath;
+    if (HasRecordingExtension(path)) {
+        path.resize(path.size() - 4);
+    }
+
+    wchar_t digits[16];
+    int length = 0;
+    do {
+        digits[length++] = static_cast<wchar_t>(L'0' + sequence % 10);
+        sequence /= 10;
+    } while (sequence > 0);
+    while (length < 6) {
+        digits[length++] = L'0';
+    }
+
+    path.push_back(L'.');
+    while (length > 0) {
+        path.push_back(digits[--length]);
+    }
+    path += L".wlr";
+    return path;
+}
+
+std::vector<std::wstring> SnapshotRecorder::FindSegments(const std::wstring& segmentPath) {
+    std::vector<std::wstring> segments;
+    std::wstring basePath;
+    uint32_t sequence;
+    if (!ParseSegmentPath(segmentPath, basePath, sequence)) {
+        segments.push_back(segmentPath);
+        return segments;
+    }
+
+    // The recorder keeps segments numbered without gaps
+    uint32_t first = sequence;
+    while (first > 1 && FileIO::Exists(SegmentPath(basePath, first - 1))) {
+        first--;
+    }
+    uint32_t last = sequence;
+    while (last < UINT32_MAX && FileIO::Exists(SegmentPath(basePath, last + 1))) {
+        last++;
+    }
+
+    for (uint32_t i = first; i <= last; i++) {
+        segments.push_back(i == sequence ? segmentPath : SegmentPath(basePath, i));
+    }
+    return segments;
+}
+
+bool SnapshotReplay::Open(const std::wstring& segmentPath) {
+    return OpenSegments(SnapshotRecorder::FindSegments(segmentPath));
+}
+
+bool SnapshotReplay::OpenSegments(const std::vector<std::wstring>& paths) {
+    Close();
+    for (const std::wstring& path : paths) {
+        std::unique_ptr<MappedFile> file(new MappedFile());
+        // A segment may be rolled off while the recording is being opened
+        if (!file->Open(path)) {
+            continue;
+        }
+
+        size_t before = m_frames.size();
+        IndexSegment(file->Data(), file->Size());
+        if (m_frames.size() > before) {
+            m_files.push_back(std::move(file));
+        }
+    }
+
+    if (m_frames.empty()) {
+        Close();
+        return false;
+    }
+    return true;
+}
+
+bool SnapshotReplay::Attach(const void* data, size_t size) {
+    Close();
+    if (data) {
+        IndexSegment(static_cast<const uint8_t*>(data), size);
+    }
+    return !m_frames.empty();
+}
+
+void SnapshotReplay::Close() {
+    m_frames.clear();
+    m_files.clear();
+    m_decoder.Reset();
+    m_current = NO_FRAME;
+}
+
+bool SnapshotReplay::IndexSegment(const uint8_t* data, size_t size) {
+    if (size < RECORDING_HEADER_SIZE || memcmp(data, RECORDING_MAGIC, sizeof(RECORDING_MAGIC)) != 0) {
+        return false;
+    }
+
+    uint32_t version;
+    memcpy(&version, data + 8, sizeof(uint32_t));
+    if (version < 1 || version > SnapshotRecorder::VERSION) {
+        return false;
+    }
+
+    ByteReader in(data + RECORDING_HEADER_SIZE, size - RECORDING_HEADER_SIZE);
+    size_t keyframe = NO_FRAME;
+    while (in.Remaining() > 0) {
+        uint8_t kind = in.Byte();
+        uint64_t length = in.Varint();
+        uint64_t time = in.Varint();
+        // A segment still being written, or cut short, ends mid-frame
+        if (!in.ok || length > in.Remaining()) break;
+        if (kind != RECFRAME_KEY && kind != RECFRAME_DELTA) break;
+
+        Frame frame;
+        frame.payload = in.Take(static_cast<size_t>(length));
+        frame.length = static_cast<size_t>(length);
+        frame.time = time;
+        frame.kind = kind;
+        if (kind == RECFRAME_KEY) {
+            keyframe = m_frames.size();
+        } else if (keyframe == NO_FRAME) {
+            continue;
+        }
+        frame.keyframe = keyframe;
+        m_frames.push_back(frame);
+    }
+    return true;
+}
+
+size_t SnapshotReplay::FindFrame(uint64_t time) const {
+    auto it = std::upper_bound(m_frames.begin(), m_frames.end(), time,
+        [](uint64_t value, const Frame& frame) { return value < frame.time; });
+    if (it == m_frames.begin()) {
+        return 0;
+    }
+    return static_cast<size_t>(it - m_frames.begin()) - 1;
+}
+
+bool SnapshotReplay::SeekFrame(size_t frame) {
+    if (frame >= m_frames.size()) {
+        return false;
+    }
+    if (frame == m_current) {
+        return true;
+    }
+
+    // Continue forward from the current frame when it is on the way
+    size_t start = m_frames[frame].keyframe;
+    if (m_current != NO_FRAME && m_current >= start && m_current < frame) {
+        start = m_current + 1;
+    }
+
+    for (size_t i = start; i <= frame; i++) {
+        const Frame& f = m_frames[i];
+        if (!m_decoder.Apply(f.kind, f.payload, f.length)) {
+            m_current = NO_FRAME;
+            return false;
+        }
+    }
+    m_current = frame;
+    return true;
+}
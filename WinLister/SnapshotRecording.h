@@ -0,0 +1,220 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "WindowInfo.h"
+#include "FileIO.h"
+#include "SnapshotFile.h"
+
+// Window recording, version 1. A recording is a numbered series of segment
+// files ("name.000001.wlr", ...), each self-contained:
+//
+//   header  magic "WLREC\0\0\0", u32 version, u32 reserved
+//   frames  u8 kind, varint payload length, varint time (ms since the Unix
+//           epoch), payload
+//
+// A payload is the varint window count followed by ops that build the frame's
+// window list, in z-order, from the previous frame's list:
+//
+//   COPY     a run of windows unchanged since the previous frame
+//   CHANGED  one window with the fields in a bit mask rewritten
+//   NEW      a window that was not in the previous frame
+//
+// Each op starts with a varint (value << 2 | op), where the value is the run
+// length or the field mask; COPY and CHANGED follow it with the zigzag offset
+// of their source row from the end of the previous source. Integers are
+// varints, rects are zigzag deltas against the previous value, z-order is
+// stored relative to the row, and strings are dictionary ids, followed by the
+// UTF-8 text the first time an id is used. Keyframes encode every window as
+// NEW and start a new dictionary, so decoding can begin at any keyframe.
+enum RecordFrameKind {
+    RECFRAME_KEY = 1,
+    RECFRAME_DELTA = 2
+};
+
+enum RecordField {
+    RECFIELD_HWND = 0,
+    RECFIELD_PARENT,
+    RECFIELD_OWNER,
+    RECFIELD_PROCESS_ID,
+    RECFIELD_THREAD_ID,
+    RECFIELD_RECT,
+    RECFIELD_CLIENT_RECT,
+    RECFIELD_STYLE,
+    RECFIELD_EXSTYLE,
+    RECFIELD_FLAGS,
+    RECFIELD_ALPHA,
+    RECFIELD_ZORDER,
+    RECFIELD_DWM_FRAME,
+    RECFIELD_TITLE,
+    RECFIELD_CLASS,
+    RECFIELD_PROCESS_NAME,
+    RECFIELD_PROCESS_PATH,
+    RECFIELD_COUNT
+};
+
+// Turns successive snapshots into keyframe and delta frames
+class SnapshotDeltaEncoder {
+public:
+    // Appends one frame to out. The frame is a keyframe when requested, for
+    // the first frame after Reset(), and every keyframeInterval frames.
+    void Encode(const std::vector<WindowInfo>& windows, uint64_t time, bool keyframe, std::string& out);
+    // Makes the next frame a keyframe
+    void Reset() { m_needKeyframe = true; }
+    void SetKeyframeInterval(uint32_t frames) { m_keyframeInterval = frames > 0 ? frames : 1; }
+
+    // Dictionary size that forces a keyframe, bounding decoder memory
+    static const size_t MAX_DICTIONARY = 65536;
+
+private:
+    // A window as last encoded, strings as dictionary ids
+    struct Recorded {
+        uint64_t hwnd;
+        uint64_t parent;
+        uint64_t owner;
+        uint32_t processId;
+        uint32_t threadId;
+        SnapshotRect rect;
+        SnapshotRect clientRect;
+        uint32_t style;
+        uint32_t exStyle;
+        uint32_t flags;
+        uint32_t alpha;
+        int64_t zOrder;     // relative to the row
+        SnapshotRect dwmFrame;
+        uint32_t strings[4];
+    };
+
+    uint32_t Diff(const Recorded& previous, const WindowInfo& win, size_t row, Recorded& next) const;
+    void PutFields(uint32_t mask, const Recorded& previous, Recorded& next, const WindowInfo& win);
+    void PutString(const std::wstring& text, uint32_t& id);
+    void FlushRun(size_t& cursor);
+
+    std::vector<Recorded> m_previous;
+    std::vector<Recorded> m_current;
+    std::unordered_map<uint64_t, uint32_t> m_previousRows;
+    std::vector<uint32_t> m_sourceUsed;     // frame number that last used each previous row
+    std::unordered_map<std::wstring, uint32_t> m_dictionary;
+    std::vector<const std::wstring*> m_strings;     // id -> dictionary key
+    std::string m_payload;
+    size_t m_runStart = 0;
+    size_t m_runLength = 0;
+    uint32_t m_frameNumber = 0;
+    uint32_t m_keyframeInterval = 120;
+    uint32_t m_framesSinceKey = 0;
+    bool m_needKeyframe = true;
+};
+
+// Rebuilds snapshots by applying frames in order
+class SnapshotDeltaDecoder {
+public:
+    void Reset();
+    // Applies one frame payload. A delta needs the frame before it applied;
+    // on failure the state is invalid until the next keyframe.
+    bool Apply(uint8_t kind, const uint8_t* payload, size_t length);
+
+    bool IsValid() const { return m_valid; }
+    const std::vector<WindowInfo>& Windows() const { return m_windows; }
+
+private:
+    std::vector<WindowInfo> m_windows;
+    std::vector<WindowInfo> m_next;
+    std::vector<std::wstring> m_dictionary;
+    bool m_valid = false;
+};
+
+struct RecordingOptions {
+    uint32_t keyframeInterval = 120;            // frames between keyframes
+    uint64_t segmentBytes = 32ull << 20;        // start a new segment past this size
+    uint32_t maxSegments = 16;                  // older segments are deleted
+};
+
+// Appends frames to a rolling series of segment files. Every segment starts
+// with a keyframe, and each frame is flushed as it is written, so a recording
+// cut short loses at most its last frame.
+class SnapshotRecorder {
+public:
+    SnapshotRecorder() = default;
+    ~SnapshotRecorder();
+    SnapshotRecorder(const SnapshotRecorder&) = delete;
+    SnapshotRecorder& operator=(const SnapshotRecorder&) = delete;
+
+    // basePath names the recording, e.g. "C:\\logs\\desk.wlr"; segments of an
+    // earlier recording with the same name are replaced
+    bool Start(const std::wstring& basePath, const RecordingOptions& options = RecordingOptions());
+    // Stops recording and returns false if the write fails
+    bool Record(const std::vector<WindowInfo>& windows, uint64_t time);
+    void Stop();
+
+    bool IsRecording() const { return m_file != nullptr; }
+    uint64_t BytesWritten() const { return m_bytesWritten; }
+
+    static const uint32_t VERSION = 1;
+
+    static std::wstring SegmentPath(const std::wstring& basePath, uint32_t sequence);
+    // All segments of the recording a segment file belongs to, oldest first
+    static std::vector<std::wstring> FindSegments(const std::wstring& segmentPath);
+
+private:
+    bool OpenSegment();
+
+    FILE* m_file = nullptr;
+    std::wstring m_basePath;
+    RecordingOptions m_options;
+    SnapshotDeltaEncoder m_encoder;
+    std::string m_frame;
+    uint32_t m_sequence = 0;
+    uint64_t m_segmentSize = 0;
+    uint64_t m_bytesWritten = 0;
+    uint64_t m_lastTime = 0;
+};
+
+// Random access to a recording. Opening maps the segments and indexes the
+// frame headers without decoding; seeking decodes from the nearest keyframe
+// at or before the target, or continues from the current frame when that is
+// closer, so a seek costs at most one keyframe interval of frames.
+class SnapshotReplay {
+public:
+    // Opens the recording a segment file belongs to
+    bool Open(const std::wstring& segmentPath);
+    bool OpenSegments(const std::vector<std::wstring>& paths);
+    // Reads one segment already in memory; the buffer must outlive the replay
+    bool Attach(const void* data, size_t size);
+    void Close();
+
+    bool IsOpen() const { return !m_frames.empty(); }
+    size_t FrameCount() const { return m_frames.size(); }
+    uint64_t FrameTime(size_t frame) const { return m_frames[frame].time; }
+    bool IsKeyframe(size_t frame) const { return m_frames[frame].keyframe == frame; }
+
+    // The frame in effect at time: the last one at or before it, or the
+    // first frame for earlier times
+    size_t FindFrame(uint64_t time) const;
+    bool SeekFrame(size_t frame);
+    bool SeekTime(uint64_t time) { return IsOpen() && SeekFrame(FindFrame(time)); }
+
+    static const size_t NO_FRAME = static_cast<size_t>(-1);
+    size_t CurrentFrame() const { return m_current; }
+    const std::vector<WindowInfo>& Windows() const { return m_decoder.Windows(); }
+
+private:
+    struct Frame {
+        const uint8_t* payload;
+        size_t length;
+        uint64_t time;
+        size_t keyframe;    // index of the keyframe this frame decodes from
+        uint8_t kind;
+    };
+
+    bool IndexSegment(const uint8_t* data, size_t size);
+
+    std::vector<std::unique_ptr<MappedFile>> m_files;
+    std::vector<Frame> m_frames;
+    SnapshotDeltaDecoder m_decoder;
+    size_t m_current = NO_FRAME;
+};
@@ -0,0 +1,81 @@
+#include "TextFormat.h"
+
+static const char DIGIT_PAIRS[] =
+    "00010203040506070809"
+    "10111213141516171819"
+    "20212223242526272829"
+    "30313233343536373839"
+    "40414243444546474849"
+    "50515253545556575859"
+    "60616263646566676869"
+    "70717273747576777879"
+    "80818283848586878889"
+    "90919293949596979899";
+
+static const wchar_t HEX_DIGITS[] = L"0123456789ABCDEF";
+
+size_t TextFormat::Unsigned(wchar_t* out, uint64_t value) {
+    // Fill from the end two digits at a time, then move to the front
+    wchar_t temp[MAX_CHARS];
+    wchar_t* p = temp + MAX_CHARS;
+    while (value >= 100) {
+        unsigned pair = static_cast<unsigned>(value % 100) * 2;
+        value /= 100;
+        *--p = DIGIT_PAIRS[pair + 1];
+        *--p = DIGIT_PAIRS[pair];
+    }
+    if (value >= 10) {
+        unsigned pair = static_cast<unsigned>(value) * 2;
+        *--p = DIGIT_PAIRS[pair + 1];
+        *--p = DIGIT_PAIRS[pair];
+    } else {
+        *--p = static_cast<wchar_t>(L'0' + value);
+    }
+
+    size_t length = static_cast<size_t>(temp + MAX_CHARS - p);
+    for (size_t i = 0; i < length; i++) {
+        out[i] = p[i];
+    }
+    out[length] = L'\0';
+    return length;
+}
+
+size_t TextFormat::Signed(wchar_t* out, int64_t value) {
+    if (value < 0) {
+        out[0] = L'-';
+        // Negate in unsigned arithmetic so INT64_MIN works
+        return 1 + Unsigned(out + 1, 0 - static_cast<uint64_t>(value));
+    }
+    return Unsigned(out, static_cast<uint64_t>(value));
+}
+
+size_t TextFormat::Hex(wchar_t* out, uint64_t value, int minDigits) {
+    int digits = 1;
+    while (digits < 16 && (value >> (digits * 4)) != 0) {
+        digits++;
+    }
+    if (digits < minDigits) {
+        digits = minDigits > 16 ? 16 : minDigits;
+    }
+    for (int i = digits - 1; i >= 0; i--) {
+        out[i] = HEX_DIGITS[value & 0xF];
+        value >>= 4;
+    }
+    out[digits] = L'\0';
+    return static_cast<size_t>(digits);
+}
+
+void TextFormat::AppendUnsigned(std::wstring& text, uint64_t value) {
+    wchar_t buffer[MAX_CHARS];
+    text.append(buffer, Unsigned(buffer, value));
+}
+
+void TextFormat::AppendSigned(std::wstring& text, int64_t value) {
+    wchar_t buffer[MAX_CHARS];
+    text.append(buffer, Signed(buffer, value));
+}
+
+void TextFormat::AppendHex(std::wstring& text, uint64_t value, int minDigits) {
+    wchar_t buffer[MAX_CHARS];
+    text.append(buffer, Hex(buffer, value, minDigits));
+}
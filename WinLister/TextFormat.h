@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Integer-to-text formatting without the printf machinery. The buffer forms
+// write a null-terminated string and return its length; buffers must hold at
+// least MAX_CHARS characters.
+class TextFormat {
+public:
+    static const size_t MAX_CHARS = 24;
+
+    static size_t Unsigned(wchar_t* out, uint64_t value);
+    static size_t Signed(wchar_t* out, int64_t value);
+    // Uppercase hex, zero-padded to at least minDigits
+    static size_t Hex(wchar_t* out, uint64_t value, int minDigits = 1);
+
+    static void AppendUnsigned(std::wstring& text, uint64_t value);
+    static void AppendSigned(std::wstring& text, int64_t value);
+    static void AppendHex(std::wstring& text, uint64_t value, int minDigits = 1);
+
+    // Two 32-bit values as one cache source, first in the high half
+    static uint64_t PackPair(int32_t a, int32_t b) {
+        return (static_cast<uint64_t>(static_cast<uint32_t>(a)) << 32) | static_cast<uint32_t>(b);
+    }
+};
+
+// Formatted text remembered together with the value it was formatted from, so
+// it is only re-formatted when that value changes. Values wider than 64 bits,
+// such as a rectangle's four coordinates, are given as two words and compared
+// in full.
+class CachedText {
+public:
+    template <typename Format>
+    const std::wstring& Get(uint64_t source, Format format) {
+        return Get(source, 0, format);
+    }
+
+    template <typename Format>
+    const std::wstring& Get(uint64_t source, uint64_t sourceHigh, Format format) {
+        if (!m_valid || m_source != source || m_sourceHigh != sourceHigh) {
+            m_text.clear();
+            format(m_text);
+            m_source = source;
+            m_sourceHigh = sourceHigh;
+            m_valid = true;
+            m_formatCount++;
+        }
+        return m_text;
+    }
+
+    void Invalidate() { m_valid = false; }
+    uint64_t FormatCount() const { return m_formatCount; }
+
+private:
+    std::wstring m_text;
+    uint64_t m_source = 0;
+    uint64_t m_sourceHigh = 0;
+    uint64_t m_formatCount = 0;
+    bool m_valid = false;
+};
@@ -0,0 +1,295 @@
+#include "WindowAnimation.h"
+#include <algorithm>
+#include <cmath>
+
+#ifdef _WIN32
+#include <dwmapi.h>
+#endif
+
+double Easing::Apply(EasingCurve curve, double t) {
+    t = std::min(1.0, std::max(0.0, t));
+    switch (curve) {
+    case EASE_IN_QUAD:
+        return t * t;
+    case EASE_OUT_QUAD:
+        return t * (2.0 - t);
+    case EASE_IN_OUT_CUBIC:
+        if (t < 0.5) {
+            return 4.0 * t * t * t;
+        } else {
+            double u = 2.0 * t - 2.0;
+            return 1.0 + u * u * u / 2.0;
+        }
+    default:
+        return t;
+    }
+}
+
+void AnimationFrame::Clear() {
+    alphas.clear();
+    placement.Clear();
+}
+
+void AnimationScheduler::AnimateAlpha(const WindowInfo& win, BYTE target, uint32_t durationMs, EasingCurve curve, uint64_t nowUs) {
+    Animation& anim = AnimationFor(win);
+    if (!anim.alpha.active) {
+        anim.alphaNow = win.isLayered ? win.alpha : 255;
+    }
+    anim.alphaFrom = anim.alphaNow;
+    anim.alphaTo = target;
+    anim.alpha.started = anim.alpha.active && anim.alpha.started;
+    StartTrack(anim.alpha, durationMs, curve, nowUs);
+}
+
+void AnimationScheduler::AnimateBounds(const WindowInfo& win, const RECT& target, uint32_t durationMs, EasingCurve curve, uint64_t nowUs) {
+    Animation& anim = AnimationFor(win);
+    if (!anim.bounds.active) {
+        anim.boundsNow = win.rect;
+    }
+    anim.boundsFrom = anim.boundsNow;
+    anim.boundsTo = target;
+    anim.bounds.started = anim.bounds.active && anim.bounds.started;
+    StartTrack(anim.bounds, durationMs, curve, nowUs);
+}
+
+void AnimationScheduler::Cancel(HWND hwnd) {
+    auto it = m_index.find(hwnd);
+    if (it != m_index.end()) {
+        Remove(it->second);
+    }
+}
+
+void AnimationScheduler::CancelAll() {
+    m_animations.clear();
+    m_index.clear();
+}
+
+void AnimationScheduler::Tick(uint64_t nowUs, AnimationFrame& frame) {
+    for (size_t i = 0; i < m_animations.size();) {
+        Animation& anim = m_animations[i];
+
+        if (anim.alpha.active) {
+            double t = Progress(anim.alpha, nowUs);
+            int alpha = t >= 1.0 ? anim.alphaTo : Lerp(anim.alphaFrom, anim.alphaTo, Easing::Apply(anim.alpha.curve, t));
+            // The last value always goes out, so a fade that rounds onto its
+            // target early still ends with the target's layered state
+            if (alpha != anim.alphaNow || t >= 1.0) {
+                frame.alphas.push_back({ anim.win.hwnd, static_cast<BYTE>(alpha), !anim.alpha.started, t >= 1.0 });
+                anim.alpha.started = true;
+                anim.alphaNow = alpha;
+            }
+            anim.alpha.active = t < 1.0;
+        }
+
+        if (anim.bounds.active) {
+            double t = Progress(anim.bounds, nowUs);
+            double eased = t >= 1.0 ? 1.0 : Easing::Apply(anim.bounds.curve, t);
+            RECT rc = {
+                Lerp(anim.boundsFrom.left, anim.boundsTo.left, eased),
+                Lerp(anim.boundsFrom.top, anim.boundsTo.top, eased),
+                Lerp(anim.boundsFrom.right, anim.boundsTo.right, eased),
+                Lerp(anim.boundsFrom.bottom, anim.boundsTo.bottom, eased)
+            };
+            bool moved = rc.left != anim.boundsNow.left || rc.top != anim.boundsNow.top;
+            bool sized = (rc.right - rc.left) != (anim.boundsNow.right - anim.boundsNow.left) ||
+                (rc.bottom - rc.top) != (anim.boundsNow.bottom - anim.boundsNow.top);
+            if (moved || !anim.bounds.started) {
+                frame.placement.Move(anim.win, rc.left, rc.top);
+            }
+            if (sized || !anim.bounds.started) {
+                frame.placement.Resize(anim.win, rc.right - rc.left, rc.bottom - rc.top);
+            }
+            if (moved || sized || !anim.bounds.started) {
+                // Minimized or maximized windows are restored once, on the first frame
+                anim.win.isMinimized = false;
+                anim.win.isMaximized = false;
+                anim.bounds.started = true;
+            }
+            anim.boundsNow = rc;
+            anim.bounds.active = t < 1.0;
+        }
+
+        if (!anim.alpha.active && !anim.bounds.active) {
+            Remove(i);
+        } else {
+            i++;
+        }
+    }
+}
+
+AnimationScheduler::Animation& AnimationScheduler::AnimationFor(const WindowInfo& win) {
+    auto it = m_index.find(win.hwnd);
+    if (it != m_index.end()) {
+        return m_animations[it->second];
+    }
+
+    // Only the handle, parent, style and state are kept
+    Animation anim;
+    anim.win = win;
+    anim.win.title.clear();
+    anim.win.className.clear();
+    anim.win.processName.clear();
+    anim.win.processPath.clear();
+    m_index.emplace(win.hwnd, m_animations.size());
+    m_animations.push_back(std::move(anim));
+    return m_animations.back();
+}
+
+void AnimationScheduler::StartTrack(Track& track, uint32_t durationMs, EasingCurve curve, uint64_t nowUs) {
+    track.active = true;
+    track.start = nowUs;
+    track.duration = durationMs * 1000;
+    track.curve = curve;
+}
+
+double AnimationScheduler::Progress(const Track& track, uint64_t nowUs) {
+    if (track.duration == 0 || nowUs >= track.start + track.duration) {
+        return 1.0;
+    }
+    if (nowUs <= track.start) {
+        return 0.0;
+    }
+    return static_cast<double>(nowUs - track.start) / static_cast<double>(track.duration);
+}
+
+int AnimationScheduler::Lerp(int from, int to, double eased) {
+    return from + static_cast<int>(std::lround(static_cast<double>(to - from) * eased));
+}
+
+void AnimationScheduler::Remove(size_t index) {
+    // The last animation takes the removed one's place
+    m_index.erase(m_animations[index].win.hwnd);
+    if (index + 1 < m_animations.size()) {
+        m_animations[index] = std::move(m_animations.back());
+        m_index[m_animations[index].win.hwnd] = index;
+    }
+    m_animations.pop_back();
+}
+
+#ifdef _WIN32
+WindowAnimator::~WindowAnimator() {
+    Detach();
+}
+
+void WindowAnimator::Attach(HWND owner, UINT frameMessage) {
+    Detach();
+    m_owner = owner;
+    m_frameMessage = frameMessage;
+    m_stop = false;
+    m_running = false;
+    m_posted = false;
+    m_pacer = std::thread(&WindowAnimator::PaceLoop, this);
+}
+
+void WindowAnimator::Detach() {
+    if (!m_pacer.joinable()) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_wake.notify_one();
+    m_pacer.join();
+    m_scheduler.CancelAll();
+    m_owner = nullptr;
+}
+
+void WindowAnimator::FadeTo(const WindowInfo& win, BYTE alpha, uint32_t durationMs, EasingCurve curve) {
+    m_scheduler.AnimateAlpha(win, alpha, durationMs, curve, NowUs());
+    Wake();
+}
+
+void WindowAnimator::MoveTo(const WindowInfo& win, const RECT& bounds, uint32_t durationMs, EasingCurve curve) {
+    m_scheduler.AnimateBounds(win, bounds, durationMs, curve, NowUs());
+    Wake();
+}
+
+void WindowAnimator::OnFrame() {
+    m_posted = false;
+
+    m_frame.Clear();
+    m_scheduler.Tick(NowUs(), m_frame);
+
+    for (const AnimationFrame::Alpha& change : m_frame.alphas) {
+        if (!IsWindow(change.hwnd)) {
+            m_scheduler.Cancel(change.hwnd);
+            continue;
+        }
+        LONG_PTR exStyle = GetWindowLongPtrW(change.hwnd, GWL_EXSTYLE);
+        // Same as the detail dialog's Set Alpha: opaque drops the layered style
+        if (change.last && change.alpha == 255) {
+            SetWindowLongPtrW(change.hwnd, GWL_EXSTYLE, exStyle & ~WS_EX_LAYERED);
+            continue;
+        }
+        if (change.first && !(exStyle & WS_EX_LAYERED)) {
+            SetWindowLongPtrW(change.hwnd, GWL_EXSTYLE, exStyle | WS_EX_LAYERED);
+        }
+        if (!SetLayeredWindowAttributes(change.hwnd, 0, change.alpha, LWA_ALPHA)) {
+            m_scheduler.Cancel(change.hwnd);
+        }
+    }
+
+    if (!m_frame.placement.Empty()) {
+        Win32PlacementBackend backend;
+        PlacementResult result;
+        PlacementTransaction::Apply(m_frame.placement, backend, result);
+        for (HWND hwnd : result.failed) {
+            m_scheduler.Cancel(hwnd);
+        }
+    }
+
+    if (!m_scheduler.IsActive()) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_running = false;
+    }
+}
+
+uint64_t WindowAnimator::NowUs() {
+    static LARGE_INTEGER frequency = {};
+    if (frequency.QuadPart == 0) {
+        QueryPerformanceFrequency(&frequency);
+    }
+    LARGE_INTEGER counter;
+    QueryPerformanceCounter(&counter);
+    return static_cast<uint64_t>(counter.QuadPart / frequency.QuadPart * 1000000 +
+        counter.QuadPart % frequency.QuadPart * 1000000 / frequency.QuadPart);
+}
+
+void WindowAnimator::Wake() {
+    if (!m_pacer.joinable() || !m_scheduler.IsActive()) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_running = true;
+    }
+    m_wake.notify_one();
+}
+
+void WindowAnimator::PaceLoop() {
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_wake.wait(lock, [this] { return m_running || m_stop; });
+            if (m_stop) {
+                return;
+            }
+        }
+
+        // DwmFlush returns after the next composition; without composition
+        // (some remote sessions) it fails at once, so fall back to about 60 Hz
+        if (FAILED(DwmFlush())) {
+            Sleep(16);
+        }
+
+        // A frame the UI thread has not handled yet is not queued again, so a
+        // busy UI thread skips frames instead of falling behind
+        if (!m_posted.exchange(true)) {
+            if (!PostMessageW(m_owner, m_frameMessage, 0, 0)) {
+                m_posted = false;
+            }
+        }
+    }
+}
+#endif
@@ -0,0 +1,137 @@
+#pragma once
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+#include "WindowInfo.h"
+#include "WindowBatch.h"
+
+#ifdef _WIN32
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#endif
+
+enum EasingCurve {
+    EASE_LINEAR = 0,
+    EASE_IN_QUAD,       // starts slowly
+    EASE_OUT_QUAD,      // ends slowly
+    EASE_IN_OUT_CUBIC   // starts and ends slowly
+};
+
+class Easing {
+public:
+    // Progress t in [0, 1] to eased progress; 0 and 1 map to themselves
+    static double Apply(EasingCurve curve, double t);
+};
+
+// Values due on one frame for every animating window. Alpha changes are
+// listed per window; moves and resizes are planned together so they go out
+// as one batch.
+struct AnimationFrame {
+    struct Alpha {
+        HWND hwnd;
+        BYTE alpha;
+        bool first;     // the animation's first change: make the window layered
+        bool last;      // reached the target: 255 means no longer layered
+    };
+
+    std::vector<Alpha> alphas;
+    PlacementPlan placement;
+
+    bool Empty() const { return alphas.empty() && placement.Empty(); }
+    void Clear();
+};
+
+// Animates alpha, position and size for any number of windows. Starting an
+// animation on a window that is already animating retargets it from the
+// value it has reached, so nothing jumps. Each tick yields only the values
+// that changed since the last one, and the last tick of an animation lands
+// exactly on its target. Time is passed in by the caller (microseconds, any
+// monotonic origin).
+class AnimationScheduler {
+public:
+    void AnimateAlpha(const WindowInfo& win, BYTE target, uint32_t durationMs, EasingCurve curve, uint64_t nowUs);
+    // target is the window rectangle, as in WindowInfo::rect
+    void AnimateBounds(const WindowInfo& win, const RECT& target, uint32_t durationMs, EasingCurve curve, uint64_t nowUs);
+
+    // Stops where it is; the window keeps the last value sent
+    void Cancel(HWND hwnd);
+    void CancelAll();
+
+    bool IsActive() const { return !m_animations.empty(); }
+    size_t Count() const { return m_animations.size(); }
+
+    // Appends the values due at nowUs to frame and drops finished animations
+    void Tick(uint64_t nowUs, AnimationFrame& frame);
+
+private:
+    struct Track {
+        bool active = false;
+        bool started = false;   // a value has been sent
+        uint64_t start = 0;
+        uint32_t duration = 0;  // microseconds
+        EasingCurve curve = EASE_LINEAR;
+    };
+
+    struct Animation {
+        WindowInfo win;         // what placement needs: handle, parent, style, state
+        Track alpha;
+        int alphaFrom = 255;
+        int alphaTo = 255;
+        int alphaNow = 255;
+        Track bounds;
+        RECT boundsFrom = {};
+        RECT boundsTo = {};
+        RECT boundsNow = {};
+    };
+
+    Animation& AnimationFor(const WindowInfo& win);
+    static void StartTrack(Track& track, uint32_t durationMs, EasingCurve curve, uint64_t nowUs);
+    static double Progress(const Track& track, uint64_t nowUs);
+    static int Lerp(int from, int to, double eased);
+    void Remove(size_t index);
+
+    std::vector<Animation> m_animations;
+    std::unordered_map<HWND, size_t> m_index;   // hwnd -> animation
+};
+
+#ifdef _WIN32
+// Runs a scheduler on the display's refresh: a pacing thread waits for each
+// DWM composition and posts frameMessage to the owner window, at most one at a
+// time, and the owner calls OnFrame from its handler. The thread sleeps while
+// nothing is animating. Windows that go away are dropped from the animation.
+class WindowAnimator {
+public:
+    WindowAnimator() = default;
+    ~WindowAnimator();
+
+    void Attach(HWND owner, UINT frameMessage);
+    void Detach();
+
+    void FadeTo(const WindowInfo& win, BYTE alpha, uint32_t durationMs, EasingCurve curve = EASE_IN_OUT_CUBIC);
+    void MoveTo(const WindowInfo& win, const RECT& bounds, uint32_t durationMs, EasingCurve curve = EASE_OUT_QUAD);
+    void Cancel(HWND hwnd) { m_scheduler.Cancel(hwnd); }
+    void CancelAll() { m_scheduler.CancelAll(); }
+
+    void OnFrame();
+
+private:
+    static uint64_t NowUs();
+    void Wake();
+    void PaceLoop();
+
+    AnimationScheduler m_scheduler;
+    AnimationFrame m_frame;
+    HWND m_owner = nullptr;
+    UINT m_frameMessage = 0;
+
+    std::thread m_pacer;
+    std::mutex m_mutex;
+    std::condition_variable m_wake;
+    bool m_running = false;     // guarded by m_mutex
+    bool m_stop = false;        // guarded by m_mutex
+    std::atomic<bool> m_posted{ false };
+};
+#endif
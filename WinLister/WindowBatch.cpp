@@ -0,0 +1,259 @@
+#include "WindowBatch.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// Widest invisible border treated as a DWM resize border rather than an
+// unrelated frame
+const LONG MAX_BORDER = 32;
+
+// Selection ordered by stacking, top window first
+std::vector<const WindowInfo*> ByZOrder(const std::vector<WindowInfo>& windows) {
+    std::vector<const WindowInfo*> ordered;
+    ordered.reserve(windows.size());
+    for (const WindowInfo& win : windows) {
+        ordered.push_back(&win);
+    }
+    std::stable_sort(ordered.begin(), ordered.end(),
+        [](const WindowInfo* a, const WindowInfo* b) { return a->zOrder < b->zOrder; });
+    return ordered;
+}
+
+// Splits length into count parts whose sizes differ by at most one
+LONG Split(LONG start, LONG length, size_t index, size_t count) {
+    return start + static_cast<LONG>(static_cast<int64_t>(length) * static_cast<int64_t>(index) / static_cast<int64_t>(count));
+}
+
+} // namespace
+
+void PlacementPlan::Move(const WindowInfo& win, int x, int y) {
+    PlacementEntry& entry = EntryFor(win, false);
+    entry.x = x;
+    entry.y = y;
+    entry.flags &= ~SWP_NOMOVE;
+    entry.restore = win.isMinimized || win.isMaximized;
+}
+
+void PlacementPlan::Resize(const WindowInfo& win, int width, int height) {
+    PlacementEntry& entry = EntryFor(win, false);
+    entry.cx = width;
+    entry.cy = height;
+    entry.flags &= ~SWP_NOSIZE;
+    entry.restore = win.isMinimized || win.isMaximized;
+}
+
+void PlacementPlan::SetBounds(const WindowInfo& win, const RECT& bounds) {
+    // The insets only mean something for a window shown at its normal size
+    LONG left = 0, top = 0, right = 0, bottom = 0;
+    if (win.hasDwmFrame && !win.isMinimized && !win.isMaximized) {
+        left = win.dwmExtendedFrame.left - win.rect.left;
+        top = win.dwmExtendedFrame.top - win.rect.top;
+        right = win.rect.right - win.dwmExtendedFrame.right;
+        bottom = win.rect.bottom - win.dwmExtendedFrame.bottom;
+        if (left < 0 || top < 0 || right < 0 || bottom < 0 ||
+            left > MAX_BORDER || top > MAX_BORDER || right > MAX_BORDER || bottom > MAX_BORDER) {
+            left = top = right = bottom = 0;
+        }
+    }
+
+    PlacementEntry& entry = EntryFor(win, false);
+    entry.x = bounds.left - left;
+    entry.y = bounds.top - top;
+    entry.cx = (bounds.right - bounds.left) + left + right;
+    entry.cy = (bounds.bottom - bounds.top) + top + bottom;
+    entry.flags &= ~(SWP_NOMOVE | SWP_NOSIZE);
+    entry.restore = win.isMinimized || win.isMaximized;
+}
+
+void PlacementPlan::SetZOrder(const WindowInfo& win, HWND insertAfter) {
+    PlacementEntry& entry = EntryFor(win, true);
+    entry.insertAfter = insertAfter;
+    entry.flags &= ~SWP_NOZORDER;
+}
+
+void PlacementPlan::Clear() {
+    m_entries.clear();
+    m_index.clear();
+}
+
+PlacementEntry& PlacementPlan::EntryFor(const WindowInfo& win, bool toEnd) {
+    auto it = m_index.find(win.hwnd);
+    if (it == m_index.end()) {
+        PlacementEntry entry;
+        entry.hwnd = win.hwnd;
+        entry.parent = (win.style & WS_CHILD) ? win.hwndParent : nullptr;
+        entry.flags = SWP_NOMOVE | SWP_NOSIZE | SWP_NOZORDER | SWP_NOACTIVATE;
+        if (win.isHung) {
+            entry.flags |= SWP_ASYNCWINDOWPOS;
+        }
+        m_index.emplace(win.hwnd, m_entries.size());
+        m_entries.push_back(entry);
+        return m_entries.back();
+    }
+
+    size_t index = it->second;
+    if (toEnd && index + 1 < m_entries.size()) {
+        PlacementEntry entry = m_entries[index];
+        m_entries.erase(m_entries.begin() + index);
+        for (size_t i = index; i < m_entries.size(); i++) {
+            m_index[m_entries[i].hwnd] = i;
+        }
+        it->second = m_entries.size();
+        m_entries.push_back(entry);
+        return m_entries.back();
+    }
+    return m_entries[index];
+}
+
+void PlacementPlanner::Tile(const std::vector<WindowInfo>& windows, const RECT& area, PlacementPlan& plan) {
+    if (windows.empty()) {
+        return;
+    }
+
+    std::vector<const WindowInfo*> ordered = ByZOrder(windows);
+    size_t count = ordered.size();
+    size_t columns = static_cast<size_t>(std::ceil(std::sqrt(static_cast<double>(count))));
+    size_t rows = (count + columns - 1) / columns;
+    LONG width = area.right - area.left;
+    LONG height = area.bottom - area.top;
+
+    for (size_t i = 0; i < count; i++) {
+        size_t row = i / columns;
+        size_t column = i % columns;
+        // A short last row spreads its windows over the full width
+        size_t inRow = std::min(columns, count - row * columns);
+        RECT cell = {
+            Split(area.left, width, column, inRow),
+            Split(area.top, height, row, rows),
+            Split(area.left, width, column + 1, inRow),
+            Split(area.top, height, row + 1, rows)
+        };
+        plan.SetBounds(*ordered[i], cell);
+    }
+}
+
+void PlacementPlanner::Cascade(const std::vector<WindowInfo>& windows, const RECT& area, PlacementPlan& plan) {
+    if (windows.empty()) {
+        return;
+    }
+
+    LONG width = (area.right - area.left) * 2 / 3;
+    LONG height = (area.bottom - area.top) * 2 / 3;
+    LONG stepsX = (area.right - area.left - width) / CASCADE_STEP;
+    LONG stepsY = (area.bottom - area.top - height) / CASCADE_STEP;
+    size_t steps = static_cast<size_t>(std::max<LONG>(1, std::min(stepsX, stepsY) + 1));
+
+    // The back window starts the cascade so the top one lands last, in front
+    std::vector<const WindowInfo*> ordered = ByZOrder(windows);
+    std::reverse(ordered.begin(), ordered.end());
+    for (size_t i = 0; i < ordered.size(); i++) {
+        LONG offset = static_cast<LONG>(i % steps) * CASCADE_STEP;
+        RECT bounds = { area.left + offset, area.top + offset, area.left + offset + width, area.top + offset + height };
+        plan.SetBounds(*ordered[i], bounds);
+    }
+}
+
+void PlacementPlanner::BringToFront(const std::vector<WindowInfo>& windows, PlacementPlan& plan) {
+    // Raising the lowest first leaves the selection's top window on top
+    std::vector<const WindowInfo*> ordered = ByZOrder(windows);
+    for (auto it = ordered.rbegin(); it != ordered.rend(); ++it) {
+        plan.SetZOrder(**it, HWND_TOP);
+    }
+}
+
+void PlacementPlanner::SendToBack(const std::vector<WindowInfo>& windows, PlacementPlan& plan) {
+    // Each window goes below the previous one, so the order is kept
+    for (const WindowInfo* win : ByZOrder(windows)) {
+        plan.SetZOrder(*win, HWND_BOTTOM);
+    }
+}
+
+void PlacementPlanner::SetTopmost(const std::vector<WindowInfo>& windows, bool topmost, PlacementPlan& plan) {
+    std::vector<const WindowInfo*> ordered = ByZOrder(windows);
+    for (auto it = ordered.rbegin(); it != ordered.rend(); ++it) {
+        plan.SetZOrder(**it, topmost ? HWND_TOPMOST : HWND_NOTOPMOST);
+    }
+}
+
+void PlacementTransaction::Apply(const PlacementPlan& plan, PlacementBackend& backend, PlacementResult& result) {
+    const std::vector<PlacementEntry>& entries = plan.Entries();
+
+    // Group siblings, keeping plan order within each group
+    std::vector<std::vector<const PlacementEntry*>> groups;
+    std::unordered_map<HWND, size_t> groupOf;
+    for (const PlacementEntry& entry : entries) {
+        if (entry.restore) {
+            backend.Restore(entry);
+        }
+        if (entry.flags & SWP_ASYNCWINDOWPOS) {
+            if (backend.SetPosition(entry)) {
+                result.direct++;
+            } else {
+                result.failed.push_back(entry.hwnd);
+            }
+            continue;
+        }
+        auto it = groupOf.emplace(entry.parent, groups.size()).first;
+        if (it->second == groups.size()) {
+            groups.emplace_back();
+        }
+        groups[it->second].push_back(&entry);
+    }
+
+    for (const auto& group : groups) {
+        if (group.size() == 1) {
+            if (backend.SetPosition(*group[0])) {
+                result.direct++;
+            } else {
+                result.failed.push_back(group[0]->hwnd);
+            }
+            continue;
+        }
+
+        void* batch = backend.BeginBatch(static_cast<int>(group.size()));
+        for (size_t i = 0; batch && i < group.size(); i++) {
+            batch = backend.Defer(batch, *group[i]);
+        }
+        if (batch && backend.EndBatch(batch)) {
+            result.batches++;
+            result.batched += group.size();
+            continue;
+        }
+
+        for (const PlacementEntry* entry : group) {
+            result.fallbacks++;
+            if (!backend.SetPosition(*entry)) {
+                result.failed.push_back(entry->hwnd);
+            }
+        }
+    }
+}
+
+#ifdef _WIN32
+void* Win32PlacementBackend::BeginBatch(int count) {
+    return BeginDeferWindowPos(count);
+}
+
+void* Win32PlacementBackend::Defer(void* batch, const PlacementEntry& entry) {
+    return DeferWindowPos(static_cast<HDWP>(batch), entry.hwnd, entry.insertAfter,
+        entry.x, entry.y, entry.cx, entry.cy, entry.flags);
+}
+
+bool Win32PlacementBackend::EndBatch(void* batch) {
+    return EndDeferWindowPos(static_cast<HDWP>(batch)) != FALSE;
+}
+
+bool Win32PlacementBackend::SetPosition(const PlacementEntry& entry) {
+    return SetWindowPos(entry.hwnd, entry.insertAfter, entry.x, entry.y, entry.cx, entry.cy, entry.flags) != FALSE;
+}
+
+void Win32PlacementBackend::Restore(const PlacementEntry& entry) {
+    // A hung window would block a synchronous call; it is moved asynchronously too
+    if (entry.flags & SWP_ASYNCWINDOWPOS) {
+        ShowWindowAsync(entry.hwnd, SW_RESTORE);
+    } else {
+        ShowWindow(entry.hwnd, SW_RESTORE);
+    }
+}
+#endif
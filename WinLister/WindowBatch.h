@@ -0,0 +1,106 @@
+#pragma once
+
+#include <cstddef>
+#include <unordered_map>
+#include <vector>
+#include "WindowInfo.h"
+
+// One window's part of a batch, in SetWindowPos terms: flags carry the
+// SWP_NO* bits for whatever the entry leaves alone
+struct PlacementEntry {
+    HWND hwnd = nullptr;
+    HWND parent = nullptr;      // nullptr for top-level windows
+    HWND insertAfter = nullptr;
+    int x = 0;
+    int y = 0;
+    int cx = 0;
+    int cy = 0;
+    UINT flags = 0;
+    bool restore = false;       // minimized or maximized; restored before moving
+};
+
+// Moves, resizes and z-order changes for many windows. Each window has one
+// entry; later changes merge into it. Entries are applied in order, and a
+// z-order change moves the window's entry to the end, so stacking follows
+// the order the changes were made in.
+class PlacementPlan {
+public:
+    // Keeps the size
+    void Move(const WindowInfo& win, int x, int y);
+    // Keeps the position
+    void Resize(const WindowInfo& win, int width, int height);
+    // bounds is where the visible frame should go; the invisible resize
+    // borders DWM adds around it are allowed for
+    void SetBounds(const WindowInfo& win, const RECT& bounds);
+    // HWND_TOP, HWND_BOTTOM, HWND_TOPMOST, HWND_NOTOPMOST or a window
+    void SetZOrder(const WindowInfo& win, HWND insertAfter);
+
+    const std::vector<PlacementEntry>& Entries() const { return m_entries; }
+    bool Empty() const { return m_entries.empty(); }
+    void Clear();
+
+private:
+    PlacementEntry& EntryFor(const WindowInfo& win, bool toEnd);
+
+    std::vector<PlacementEntry> m_entries;
+    std::unordered_map<HWND, size_t> m_index;   // hwnd -> entry
+};
+
+// Whole-selection operations. Windows are taken in the order given; z-order
+// operations keep the selection's stacking order among itself.
+class PlacementPlanner {
+public:
+    // A near-square grid over area, in z-order (top window first)
+    static void Tile(const std::vector<WindowInfo>& windows, const RECT& area, PlacementPlan& plan);
+    // Diagonal steps from the area's top-left, each two thirds of its size
+    static void Cascade(const std::vector<WindowInfo>& windows, const RECT& area, PlacementPlan& plan);
+    static void BringToFront(const std::vector<WindowInfo>& windows, PlacementPlan& plan);
+    static void SendToBack(const std::vector<WindowInfo>& windows, PlacementPlan& plan);
+    static void SetTopmost(const std::vector<WindowInfo>& windows, bool topmost, PlacementPlan& plan);
+
+    static const int CASCADE_STEP = 32;
+};
+
+// Where a transaction's calls go: DeferWindowPos and friends on Windows, a
+// recording fake in tests
+class PlacementBackend {
+public:
+    virtual ~PlacementBackend() = default;
+
+    // A batch handle sized for count entries, or nullptr
+    virtual void* BeginBatch(int count) = 0;
+    // The batch handle to use from now on; nullptr if the entry was refused,
+    // in which case the whole batch has been discarded
+    virtual void* Defer(void* batch, const PlacementEntry& entry) = 0;
+    virtual bool EndBatch(void* batch) = 0;
+    virtual bool SetPosition(const PlacementEntry& entry) = 0;
+    virtual void Restore(const PlacementEntry& entry) = 0;
+};
+
+struct PlacementResult {
+    size_t batches = 0;     // committed deferred-positioning batches
+    size_t batched = 0;     // entries applied through them
+    size_t direct = 0;      // entries applied alone (single or async entries)
+    size_t fallbacks = 0;   // entries retried alone after a batch failed
+    std::vector<HWND> failed;
+};
+
+// Applies a plan with one deferred-positioning batch per parent, since a
+// batch may only hold siblings. If the batch fails, each of its entries is
+// retried on its own, so one closed window does not stop the rest. Entries
+// for hung windows (SWP_ASYNCWINDOWPOS) are never batched.
+class PlacementTransaction {
+public:
+    static void Apply(const PlacementPlan& plan, PlacementBackend& backend, PlacementResult& result);
+};
+
+#ifdef _WIN32
+class Win32PlacementBackend : public PlacementBackend {
+public:
+    void* BeginBatch(int count) override;
+    void* Defer(void* batch, const PlacementEntry& entry) override;
+    bool EndBatch(void* batch) override;
+    bool SetPosition(const PlacementEntry& entry) override;
+    void Restore(const PlacementEntry& entry) override;
+};
+#endif
@@ -0,0 +1,104 @@
+#include "WindowFilter.h"
+#include "WindowMonitor.h"
+#include "SnapshotFile.h"
+#include <cwctype>
+
+WindowFilter::WindowFilter(const WindowFilterOptions& options)
+    : m_options(options)
+{
+    m_searchLower.reserve(options.search.size());
+    for (wchar_t c : options.search) {
+        m_searchLower.push_back(static_cast<wchar_t>(towlower(c)));
+    }
+}
+
+bool WindowFilter::Matches(const WindowInfo& win) const {
+    // Filter hidden windows
+    if (m_options.hideHidden && win.IsHiddenWindow()) {
+        return false;
+    }
+
+    // Filter system windows
+    if (m_options.hideSystem && win.IsSystemWindow()) {
+        return false;
+    }
+
+    // Needs WindowInfo::exposed filled in by OcclusionEngine
+    if (m_options.occludedOnly && win.exposed != 0) {
+        return false;
+    }
+
+    // Needs WindowInfo::monitor filled in by MonitorLayout
+    if (m_options.offScreenOnly && !MonitorLayout::IsOffScreen(win)) {
+        return false;
+    }
+
+    // Search filter
+    if (!m_searchLower.empty()) {
+        return ContainsFolded(win.title, m_searchLower) ||
+               ContainsFolded(win.className, m_searchLower) ||
+               ContainsFolded(win.processName, m_searchLower);
+    }
+
+    return true;
+}
+
+bool WindowFilter::Matches(const SnapshotFileReader& snapshot, size_t row) const {
+    uint32_t flags = snapshot.Flags(row);
+    bool cloaked = (flags & SNAPFLAG_CLOAKED) != 0;
+    if (m_options.hideHidden && (!(flags & SNAPFLAG_VISIBLE) || cloaked)) {
+        return false;
+    }
+
+    SnapshotString className = snapshot.ClassName(row);
+    if (m_options.hideSystem && WindowInfo::IsSystemWindow(className.data, className.length,
+            snapshot.Title(row).length == 0, snapshot.ExStyle(row), cloaked, (flags & SNAPFLAG_UWP) != 0)) {
+        return false;
+    }
+
+    if (!m_searchLower.empty()) {
+        SnapshotString title = snapshot.Title(row);
+        SnapshotString processName = snapshot.ProcessName(row);
+        return ContainsFolded(title.data, title.length, m_searchLower) ||
+               ContainsFolded(className.data, className.length, m_searchLower) ||
+               ContainsFolded(processName.data, processName.length, m_searchLower);
+    }
+
+    return true;
+}
+
+std::vector<WindowInfo> WindowFilter::Apply(const std::vector<WindowInfo>& windows) const {
+    std::vector<WindowInfo> filtered;
+    for (const auto& win : windows) {
+        if (Matches(win)) {
+            filtered.push_back(win);
+        }
+    }
+    return filtered;
+}
+
+bool WindowFilter::ContainsFolded(const std::wstring& text, const std::wstring& foldedNeedle) {
+    return ContainsFolded(text.data(), text.size(), foldedNeedle);
+}
+
+template <typename CharT>
+bool WindowFilter::ContainsFolded(const CharT* text, size_t length, const std::wstring& foldedNeedle) {
+    if (foldedNeedle.empty()) return true;
+    if (length < foldedNeedle.size()) return false;
+
+    size_t last = length - foldedNeedle.size();
+    wchar_t first = foldedNeedle[0];
+    for (size_t i = 0; i <= last; i++) {
+        if (static_cast<wchar_t>(towlower(text[i])) != first) continue;
+
+        size_t j = 1;
+        while (j < foldedNeedle.size() && static_cast<wchar_t>(towlower(text[i + j])) == foldedNeedle[j]) {
+            j++;
+        }
+        if (j == foldedNeedle.size()) return true;
+    }
+    return false;
+}
+
+template bool WindowFilter::ContainsFolded<wchar_t>(const wchar_t*, size_t, const std::wstring&);
+template bool WindowFilter::ContainsFolded<char16_t>(const char16_t*, size_t, const std::wstring&);
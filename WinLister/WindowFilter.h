@@ -0,0 +1,41 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include "WindowInfo.h"
+
+class SnapshotFileReader;
+
+struct WindowFilterOptions {
+    bool hideHidden = false;
+    bool hideSystem = false;
+    bool occludedOnly = false;  // only shown windows that are fully covered
+    bool offScreenOnly = false; // only shown windows on no monitor
+    std::wstring search;    // case-insensitive substring of title, class or process
+};
+
+// The main list's row filter, usable on live or captured snapshots. The search
+// text is folded once; rows are matched without building lowered copies.
+class WindowFilter {
+public:
+    explicit WindowFilter(const WindowFilterOptions& options);
+
+    bool Matches(const WindowInfo& win) const;
+    std::vector<WindowInfo> Apply(const std::vector<WindowInfo>& windows) const;
+
+    // The same test on a row of a snapshot file, read through its accessors
+    // without building a WindowInfo. The occlusion and monitor options need
+    // rows analysed against the whole list, so they must not be set
+    // (NeedsAnalysis) when filtering this way.
+    bool Matches(const SnapshotFileReader& snapshot, size_t row) const;
+    bool NeedsAnalysis() const { return m_options.occludedOnly || m_options.offScreenOnly; }
+
+    static bool ContainsFolded(const std::wstring& text, const std::wstring& foldedNeedle);
+    // Instantiated for wchar_t and char16_t text
+    template <typename CharT>
+    static bool ContainsFolded(const CharT* text, size_t length, const std::wstring& foldedNeedle);
+
+private:
+    WindowFilterOptions m_options;
+    std::wstring m_searchLower;
+};
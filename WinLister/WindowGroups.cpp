@@ -0,0 +1,239 @@
+#include "WindowGroups.h"
+
+// Slots are kept at most half full
+static const size_t MIN_SLOTS = 16;
+
+// 64-bit finalizer from MurmurHash3, so neighbouring ids and handles spread out
+static inline size_t Hash(uint64_t key) {
+    key ^= key >> 33;
+    key *= 0xff51afd7ed558ccdULL;
+    key ^= key >> 33;
+    key *= 0xc4ceb9fe1a85ec53ULL;
+    key ^= key >> 33;
+    return static_cast<size_t>(key);
+}
+
+WindowGroups::WindowGroups(bool byThread)
+    : m_byThread(byThread) {
+}
+
+void WindowGroups::SetByThread(bool byThread) {
+    m_byThread = byThread;
+    Clear();
+}
+
+void WindowGroups::Clear() {
+    m_groups.clear();
+    m_slots.clear();
+    m_shares.clear();
+}
+
+void WindowGroups::Build(const std::vector<WindowInfo>& windows) {
+    // The table keeps its size, so a snapshot like the last one never grows it
+    m_groups.clear();
+    for (Slot& slot : m_slots) {
+        slot.group = NO_GROUP;
+    }
+    m_shares.resize(windows.size());
+    for (size_t i = 0; i < windows.size(); i++) {
+        m_shares[i] = ShareOf(windows[i]);
+        Add(m_shares[i], windows[i]);
+    }
+}
+
+void WindowGroups::Update(const std::vector<WindowInfo>& windows, const std::vector<uint32_t>& previousRows,
+    size_t previousCount) {
+    if (previousCount != m_shares.size() || previousRows.size() != windows.size()) {
+        Build(windows);
+        return;
+    }
+
+    m_generation++;
+    m_seen.resize(m_shares.size(), 0);
+    m_nextShares.resize(windows.size());
+    size_t matched = 0;
+    for (size_t i = 0; i < windows.size(); i++) {
+        const WindowInfo& win = windows[i];
+        Share now = ShareOf(win);
+        m_nextShares[i] = now;
+        uint32_t row = previousRows[i];
+        // A row matched twice would be taken off its group twice
+        if (row < m_shares.size() && m_seen[row] != m_generation) {
+            m_seen[row] = m_generation;
+            matched++;
+            const Share& before = m_shares[row];
+            if (before.key == now.key && before.area == now.area && before.visible == now.visible) {
+                continue;
+            }
+            Remove(before);
+        }
+        Add(now, win);
+    }
+
+    // Windows that went
+    if (matched < m_shares.size()) {
+        for (size_t row = 0; row < m_shares.size(); row++) {
+            if (m_seen[row] != m_generation) {
+                Remove(m_shares[row]);
+            }
+        }
+    }
+    m_shares.swap(m_nextShares);
+}
+
+uint32_t WindowGroups::Find(const WindowInfo& win) const {
+    if (m_slots.empty()) {
+        return NO_GROUP;
+    }
+    return m_slots[SlotOf(KeyOf(win))].group;
+}
+
+uint64_t WindowGroups::KeyOf(const WindowInfo& win) const {
+    return (static_cast<uint64_t>(win.processId) << 32) | (m_byThread ? win.threadId : 0);
+}
+
+void WindowGroups::Layout(const std::vector<WindowInfo>& windows, const std::unordered_set<uint64_t>& expanded,
+    std::vector<GroupRow>& rows) const {
+    rows.clear();
+
+    // Groups are numbered in order of their first window, and windows are
+    // bucketed by that number with a counting sort, which keeps their order
+    m_windowGroups.resize(windows.size());
+    m_ordinals.assign(m_groups.size(), NO_GROUP);
+    m_order.clear();
+    m_starts.clear();
+    for (size_t i = 0; i < windows.size(); i++) {
+        uint32_t group = Find(windows[i]);
+        m_windowGroups[i] = group;
+        if (group == NO_GROUP) continue;
+        if (m_ordinals[group] == NO_GROUP) {
+            m_ordinals[group] = static_cast<uint32_t>(m_order.size());
+            m_order.push_back(group);
+            m_starts.push_back(0);
+        }
+        m_starts[m_ordinals[group]]++;
+    }
+    uint32_t offset = 0;
+    for (uint32_t& start : m_starts) {
+        uint32_t count = start;
+        start = offset;
+        offset += count;
+    }
+    m_members.resize(offset);
+    for (size_t i = 0; i < windows.size(); i++) {
+        uint32_t group = m_windowGroups[i];
+        if (group == NO_GROUP) continue;
+        m_members[m_starts[m_ordinals[group]]++] = static_cast<uint32_t>(i);
+    }
+
+    // m_starts now holds each group's end
+    uint32_t first = 0;
+    for (size_t n = 0; n < m_order.size(); n++) {
+        uint32_t group = m_order[n];
+        uint32_t end = m_starts[n];
+        rows.push_back({ group, GroupRow::HEADER });
+        if (expanded.count(m_groups[group].key)) {
+            for (uint32_t i = first; i < end; i++) {
+                rows.push_back({ group, m_members[i] });
+            }
+        }
+        first = end;
+    }
+}
+
+WindowGroups::Share WindowGroups::ShareOf(const WindowInfo& win) const {
+    int64_t width = win.rect.right - win.rect.left;
+    int64_t height = win.rect.bottom - win.rect.top;
+    Share share;
+    share.key = KeyOf(win);
+    share.area = width > 0 && height > 0 ? static_cast<uint64_t>(width * height) : 0;
+    share.visible = win.isVisible;
+    return share;
+}
+
+void WindowGroups::Add(const Share& share, const WindowInfo& win) {
+    if ((m_groups.size() + 1) * 2 > m_slots.size()) {
+        Grow();
+    }
+    size_t slot = SlotOf(share.key);
+    uint32_t group = m_slots[slot].group;
+    if (group == NO_GROUP) {
+        group = static_cast<uint32_t>(m_groups.size());
+        WindowGroup created;
+        created.key = share.key;
+        created.processId = win.processId;
+        created.threadId = m_byThread ? win.threadId : 0;
+        created.processName = win.processName;
+        m_groups.push_back(std::move(created));
+        m_slots[slot] = { share.key, group };
+    }
+
+    WindowGroup& target = m_groups[group];
+    target.windows++;
+    target.visible += share.visible ? 1 : 0;
+    target.area += share.area;
+}
+
+void WindowGroups::Remove(const Share& share) {
+    if (m_slots.empty()) {
+        return;
+    }
+    uint32_t group = m_slots[SlotOf(share.key)].group;
+    if (group == NO_GROUP) {
+        return;
+    }
+    WindowGroup& target = m_groups[group];
+    target.windows--;
+    target.visible -= share.visible ? 1 : 0;
+    target.area -= share.area;
+    if (target.windows == 0) {
+        Erase(group);
+    }
+}
+
+void WindowGroups::Erase(uint32_t group) {
+    // Backward-shift deletion: later entries of the probe run move up into
+    // the gap when it lies between their home slot and where they are
+    size_t mask = m_slots.size() - 1;
+    size_t gap = SlotOf(m_groups[group].key);
+    size_t next = gap;
+    for (;;) {
+        next = (next + 1) & mask;
+        if (m_slots[next].group == NO_GROUP) break;
+        size_t home = Home(m_slots[next].key);
+        if (((next - home) & mask) >= ((next - gap) & mask)) {
+            m_slots[gap] = m_slots[next];
+            gap = next;
+        }
+    }
+    m_slots[gap].group = NO_GROUP;
+
+    // The last group takes the erased one's place
+    uint32_t last = static_cast<uint32_t>(m_groups.size() - 1);
+    if (group != last) {
+        m_slots[SlotOf(m_groups[last].key)].group = group;
+        m_groups[group] = std::move(m_groups[last]);
+    }
+    m_groups.pop_back();
+}
+
+size_t WindowGroups::Home(uint64_t key) const {
+    return Hash(key) & (m_slots.size() - 1);
+}
+
+size_t WindowGroups::SlotOf(uint64_t key) const {
+    size_t mask = m_slots.size() - 1;
+    size_t slot = Home(key);
+    while (m_slots[slot].group != NO_GROUP && m_slots[slot].key != key) {
+        slot = (slot + 1) & mask;
+    }
+    return slot;
+}
+
+void WindowGroups::Grow() {
+    size_t size = m_slots.empty() ? MIN_SLOTS : m_slots.size() * 2;
+    m_slots.assign(size, Slot{ 0, NO_GROUP });
+    for (uint32_t group = 0; group < m_groups.size(); group++) {
+        m_slots[SlotOf(m_groups[group].key)] = { m_groups[group].key, group };
+    }
+}
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <unordered_set>
+#include <vector>
+#include "WindowInfo.h"
+
+// Totals for the windows of one process, or one thread of it
+struct WindowGroup {
+    uint64_t key;
+    DWORD processId;
+    DWORD threadId;             // 0 when grouped by process
+    std::wstring processName;   // from the window that opened the group
+    uint32_t windows = 0;
+    uint32_t visible = 0;
+    uint64_t area = 0;          // sum of the window rectangles, in pixels
+};
+
+// A row of the grouped list: a group's header, or one of its windows
+struct GroupRow {
+    uint32_t group;     // index into WindowGroups::Groups()
+    uint32_t window;    // index into the listed windows, or HEADER
+    static constexpr uint32_t HEADER = static_cast<uint32_t>(-1);
+};
+
+// Per-process (or per-thread) window counts, visible counts and areas. The
+// first snapshot is aggregated in one pass over a flat open-addressing table.
+// After that, each snapshot is taken as a delta against the one before, using
+// the handle matching the refresh has already done (ZOrderTracker's): only
+// the groups of windows that came, went or changed are touched. Groups that
+// lose their last window are dropped, so group indexes are only good until
+// the next update.
+class WindowGroups {
+public:
+    explicit WindowGroups(bool byThread = false);
+
+    // Forgets the groups; the next Build regroups
+    void SetByThread(bool byThread);
+    bool ByThread() const { return m_byThread; }
+
+    // Forgets the last snapshot and aggregates this one
+    void Build(const std::vector<WindowInfo>& windows);
+    // Brings the totals from the last snapshot to this one. previousRows
+    // holds, for each window, its row in the last snapshot of previousCount
+    // windows, or NO_GROUP for a new one (ZOrderTracker::PreviousRows). If
+    // the last snapshot is not the one built or updated here, this builds.
+    void Update(const std::vector<WindowInfo>& windows, const std::vector<uint32_t>& previousRows,
+        size_t previousCount);
+    void Clear();
+
+    const std::vector<WindowGroup>& Groups() const { return m_groups; }
+    // Index of the window's group, or NO_GROUP
+    uint32_t Find(const WindowInfo& win) const;
+    uint64_t KeyOf(const WindowInfo& win) const;
+
+    // Lists windows (already filtered and sorted) under their group headers.
+    // Groups come in the order of their first window; collapsed groups show
+    // only their header.
+    void Layout(const std::vector<WindowInfo>& windows, const std::unordered_set<uint64_t>& expanded,
+        std::vector<GroupRow>& rows) const;
+
+    static constexpr uint32_t NO_GROUP = static_cast<uint32_t>(-1);
+
+private:
+    // Keys are kept next to the group indexes, so probes stay in the table
+    struct Slot {
+        uint64_t key;
+        uint32_t group;     // NO_GROUP when free
+    };
+
+    // What one window adds to its group
+    struct Share {
+        uint64_t key;
+        uint64_t area;
+        bool visible;
+    };
+
+    Share ShareOf(const WindowInfo& win) const;
+    void Add(const Share& share, const WindowInfo& win);
+    void Remove(const Share& share);
+    void Erase(uint32_t group);
+    size_t Home(uint64_t key) const;
+    size_t SlotOf(uint64_t key) const;
+    void Grow();
+
+    bool m_byThread;
+    std::vector<WindowGroup> m_groups;
+    std::vector<Slot> m_slots;          // linear probing, at most half full
+
+    // The last snapshot's shares, by row
+    std::vector<Share> m_shares;
+    std::vector<Share> m_nextShares;
+    std::vector<uint32_t> m_seen;       // generation per last row, once matched
+    uint32_t m_generation = 0;
+
+    // Layout scratch
+    mutable std::vector<uint32_t> m_windowGroups;   // group per listed window
+    mutable std::vector<uint32_t> m_ordinals;       // order of first appearance per group
+    mutable std::vector<uint32_t> m_order;          // groups in that order
+    mutable std::vector<uint32_t> m_starts;         // bucket per ordinal
+    mutable std::vector<uint32_t> m_members;
+};
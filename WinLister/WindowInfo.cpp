@@ -1,13 +1,22 @@
 #include "WindowInfo.h"
-#include <Psapi.h>
 #include <sstream>
 #include <algorithm>
+#include <unordered_map>
 
+#ifdef _WIN32
+#include <Psapi.h>
 #pragma comment(lib, "dwmapi.lib")
+#endif
 
 bool WindowInfo::IsSystemWindow() const {
+    return IsSystemWindow(className.data(), className.size(), title.empty(), exStyle, isCloaked, isUWP);
+}
+
+template <typename CharT>
+bool WindowInfo::IsSystemWindow(const CharT* className, size_t classLength, bool untitled, DWORD exStyle,
+    bool cloaked, bool uwp) {
     // System windows typically have these characteristics
-    static const std::vector<std::wstring> systemClasses = {
+    static const wchar_t* const systemClasses[] = {
         L"Shell_TrayWnd",
         L"Shell_SecondaryTrayWnd",
         L"Progman",
@@ -21,91 +30,120 @@ bool WindowInfo::IsSystemWindow() const {
         L"Windows.UI.Composition.DesktopWindowContentBridge"
     };
 
-    for (const auto& sysClass : systemClasses) {
-        if (className == sysClass) {
+    for (const wchar_t* sysClass : systemClasses) {
+        size_t i = 0;
+        while (i < classLength && sysClass[i] != 0 && static_cast<wchar_t>(className[i]) == sysClass[i]) {
+            i++;
+        }
+        if (i == classLength && sysClass[i] == 0) {
             return true;
         }
     }
 
     // Windows with no title and specific styles
-    if (title.empty() && (exStyle & WS_EX_TOOLWINDOW)) {
+    if (untitled && (exStyle & WS_EX_TOOLWINDOW)) {
         return true;
     }
 
     // Cloaked UWP windows
-    if (isCloaked && isUWP) {
+    if (cloaked && uwp) {
         return true;
     }
 
     return false;
 }
 
+template bool WindowInfo::IsSystemWindow<wchar_t>(const wchar_t*, size_t, bool, DWORD, bool, bool);
+template bool WindowInfo::IsSystemWindow<char16_t>(const char16_t*, size_t, bool, DWORD, bool, bool);
+
 bool WindowInfo::IsHiddenWindow() const {
     return !isVisible || isCloaked;
 }
 
-std::wstring WindowInfo::GetStyleString() const {
-    std::wstring result;
+static const StyleFlagName STYLE_FLAG_NAMES[] = {
+    { WS_POPUP, L"WS_POPUP" },
+    { WS_CHILD, L"WS_CHILD" },
+    { WS_MINIMIZE, L"WS_MINIMIZE" },
+    { WS_VISIBLE, L"WS_VISIBLE" },
+    { WS_DISABLED, L"WS_DISABLED" },
+    { WS_CLIPSIBLINGS, L"WS_CLIPSIBLINGS" },
+    { WS_CLIPCHILDREN, L"WS_CLIPCHILDREN" },
+    { WS_MAXIMIZE, L"WS_MAXIMIZE" },
+    { WS_CAPTION, L"WS_CAPTION" },
+    { WS_BORDER, L"WS_BORDER" },
+    { WS_DLGFRAME, L"WS_DLGFRAME" },
+    { WS_VSCROLL, L"WS_VSCROLL" },
+    { WS_HSCROLL, L"WS_HSCROLL" },
+    { WS_SYSMENU, L"WS_SYSMENU" },
+    { WS_THICKFRAME, L"WS_THICKFRAME" },
+    { WS_MINIMIZEBOX, L"WS_MINIMIZEBOX" },
+    { WS_MAXIMIZEBOX, L"WS_MAXIMIZEBOX" },
+};
+
+static const StyleFlagName EXSTYLE_FLAG_NAMES[] = {
+    { WS_EX_DLGMODALFRAME, L"WS_EX_DLGMODALFRAME" },
+    { WS_EX_NOPARENTNOTIFY, L"WS_EX_NOPARENTNOTIFY" },
+    { WS_EX_TOPMOST, L"WS_EX_TOPMOST" },
+    { WS_EX_ACCEPTFILES, L"WS_EX_ACCEPTFILES" },
+    { WS_EX_TRANSPARENT, L"WS_EX_TRANSPARENT" },
+    { WS_EX_MDICHILD, L"WS_EX_MDICHILD" },
+    { WS_EX_TOOLWINDOW, L"WS_EX_TOOLWINDOW" },
+    { WS_EX_WINDOWEDGE, L"WS_EX_WINDOWEDGE" },
+    { WS_EX_CLIENTEDGE, L"WS_EX_CLIENTEDGE" },
+    { WS_EX_CONTEXTHELP, L"WS_EX_CONTEXTHELP" },
+    { WS_EX_RIGHT, L"WS_EX_RIGHT" },
+    { WS_EX_RTLREADING, L"WS_EX_RTLREADING" },
+    { WS_EX_LEFTSCROLLBAR, L"WS_EX_LEFTSCROLLBAR" },
+    { WS_EX_CONTROLPARENT, L"WS_EX_CONTROLPARENT" },
+    { WS_EX_STATICEDGE, L"WS_EX_STATICEDGE" },
+    { WS_EX_APPWINDOW, L"WS_EX_APPWINDOW" },
+    { WS_EX_LAYERED, L"WS_EX_LAYERED" },
+    { WS_EX_NOINHERITLAYOUT, L"WS_EX_NOINHERITLAYOUT" },
+    { WS_EX_NOREDIRECTIONBITMAP, L"WS_EX_NOREDIRECTIONBITMAP" },
+    { WS_EX_LAYOUTRTL, L"WS_EX_LAYOUTRTL" },
+    { WS_EX_COMPOSITED, L"WS_EX_COMPOSITED" },
+    { WS_EX_NOACTIVATE, L"WS_EX_NOACTIVATE" },
+};
+
+const StyleFlagName* WindowInfo::StyleFlagNames(size_t& count) {
+    count = sizeof(STYLE_FLAG_NAMES) / sizeof(STYLE_FLAG_NAMES[0]);
+    return STYLE_FLAG_NAMES;
+}
 
-    if (style & WS_POPUP) result += L"WS_POPUP | ";
-    if (style & WS_CHILD) result += L"WS_CHILD | ";
-    if (style & WS_MINIMIZE) result += L"WS_MINIMIZE | ";
-    if (style & WS_VISIBLE) result += L"WS_VISIBLE | ";
-    if (style & WS_DISABLED) result += L"WS_DISABLED | ";
-    if (style & WS_CLIPSIBLINGS) result += L"WS_CLIPSIBLINGS | ";
-    if (style & WS_CLIPCHILDREN) result += L"WS_CLIPCHILDREN | ";
-    if (style & WS_MAXIMIZE) result += L"WS_MAXIMIZE | ";
-    if (style & WS_CAPTION) result += L"WS_CAPTION | ";
-    if (style & WS_BORDER) result += L"WS_BORDER | ";
-    if (style & WS_DLGFRAME) result += L"WS_DLGFRAME | ";
-    if (style & WS_VSCROLL) result += L"WS_VSCROLL | ";
-    if (style & WS_HSCROLL) result += L"WS_HSCROLL | ";
-    if (style & WS_SYSMENU) result += L"WS_SYSMENU | ";
-    if (style & WS_THICKFRAME) result += L"WS_THICKFRAME | ";
-    if (style & WS_MINIMIZEBOX) result += L"WS_MINIMIZEBOX | ";
-    if (style & WS_MAXIMIZEBOX) result += L"WS_MAXIMIZEBOX | ";
-
-    if (!result.empty()) {
-        result = result.substr(0, result.length() - 3);
-    }
-    return result;
+const StyleFlagName* WindowInfo::ExStyleFlagNames(size_t& count) {
+    count = sizeof(EXSTYLE_FLAG_NAMES) / sizeof(EXSTYLE_FLAG_NAMES[0]);
+    return EXSTYLE_FLAG_NAMES;
 }
 
-std::wstring WindowInfo::GetExStyleString() const {
+// A flag is listed when any of its bits are set (WS_CAPTION is two bits)
+static std::wstring JoinFlags(DWORD value, const StyleFlagName* flags, size_t count) {
     std::wstring result;
-
-    if (exStyle & WS_EX_DLGMODALFRAME) result += L"WS_EX_DLGMODALFRAME | ";
-    if (exStyle & WS_EX_NOPARENTNOTIFY) result += L"WS_EX_NOPARENTNOTIFY | ";
-    if (exStyle & WS_EX_TOPMOST) result += L"WS_EX_TOPMOST | ";
-    if (exStyle & WS_EX_ACCEPTFILES) result += L"WS_EX_ACCEPTFILES | ";
-    if (exStyle & WS_EX_TRANSPARENT) result += L"WS_EX_TRANSPARENT | ";
-    if (exStyle & WS_EX_MDICHILD) result += L"WS_EX_MDICHILD | ";
-    if (exStyle & WS_EX_TOOLWINDOW) result += L"WS_EX_TOOLWINDOW | ";
-    if (exStyle & WS_EX_WINDOWEDGE) result += L"WS_EX_WINDOWEDGE | ";
-    if (exStyle & WS_EX_CLIENTEDGE) result += L"WS_EX_CLIENTEDGE | ";
-    if (exStyle & WS_EX_CONTEXTHELP) result += L"WS_EX_CONTEXTHELP | ";
-    if (exStyle & WS_EX_RIGHT) result += L"WS_EX_RIGHT | ";
-    if (exStyle & WS_EX_RTLREADING) result += L"WS_EX_RTLREADING | ";
-    if (exStyle & WS_EX_LEFTSCROLLBAR) result += L"WS_EX_LEFTSCROLLBAR | ";
-    if (exStyle & WS_EX_CONTROLPARENT) result += L"WS_EX_CONTROLPARENT | ";
-    if (exStyle & WS_EX_STATICEDGE) result += L"WS_EX_STATICEDGE | ";
-    if (exStyle & WS_EX_APPWINDOW) result += L"WS_EX_APPWINDOW | ";
-    if (exStyle & WS_EX_LAYERED) result += L"WS_EX_LAYERED | ";
-    if (exStyle & WS_EX_NOINHERITLAYOUT) result += L"WS_EX_NOINHERITLAYOUT | ";
-    if (exStyle & WS_EX_NOREDIRECTIONBITMAP) result += L"WS_EX_NOREDIRECTIONBITMAP | ";
-    if (exStyle & WS_EX_LAYOUTRTL) result += L"WS_EX_LAYOUTRTL | ";
-    if (exStyle & WS_EX_COMPOSITED) result += L"WS_EX_COMPOSITED | ";
-    if (exStyle & WS_EX_NOACTIVATE) result += L"WS_EX_NOACTIVATE | ";
-
-    if (!result.empty()) {
-        result = result.substr(0, result.length() - 3);
+    for (size_t i = 0; i < count; i++) {
+        if (value & flags[i].mask) {
+            if (!result.empty()) result += L" | ";
+            result += flags[i].name;
+        }
     }
     return result;
 }
 
-std::vector<WindowInfo> WindowEnumerator::EnumerateAllWindows() {
+std::wstring WindowInfo::GetStyleString() const {
+    size_t count;
+    const StyleFlagName* flags = StyleFlagNames(count);
+    return JoinFlags(style, flags, count);
+}
+
+std::wstring WindowInfo::GetExStyleString() const {
+    size_t count;
+    const StyleFlagName* flags = ExStyleFlagNames(count);
+    return JoinFlags(exStyle, flags, count);
+}
+
+#ifdef _WIN32
+std::vector<WindowInfo> WindowEnumerator::EnumerateAllWindows(bool withIcons) {
     std::vector<WindowInfo> windows;
-    EnumWindows(EnumWindowsProc, reinterpret_cast<LPARAM>(&windows));
+    EnumContext context = { &windows, withIcons };
+    EnumWindows(EnumWindowsProc, reinterpret_cast<LPARAM>(&context));
 
     // Set z-order
     int zOrder = 0;
@@ -116,26 +154,58 @@ std::vector<WindowInfo> WindowEnumerator::EnumerateAllWindows() {
     return windows;
 }
 
+void WindowEnumerator::RefreshAllWindows(std::vector<WindowInfo>& windows, bool withIcons) {
+    std::vector<HWND> handles;
+    EnumWindows(EnumHandlesProc, reinterpret_cast<LPARAM>(&handles));
+
+    std::unordered_map<HWND, size_t> known;
+    known.reserve(windows.size());
+    for (size_t i = 0; i < windows.size(); i++) {
+        known[windows[i].hwnd] = i;
+    }
+
+    std::vector<WindowInfo> refreshed;
+    refreshed.reserve(handles.size());
+    for (HWND hwnd : handles) {
+        DWORD processId = 0;
+        DWORD threadId = GetWindowThreadProcessId(hwnd, &processId);
+        auto it = known.find(hwnd);
+        if (it != known.end() && windows[it->second].threadId == threadId &&
+            windows[it->second].processId == processId) {
+            WindowInfo& info = windows[it->second];
+            info.hwndParent = GetParent(hwnd);
+            info.hwndOwner = GetWindow(hwnd, GW_OWNER);
+            RefreshVolatileDetails(info);
+            refreshed.push_back(std::move(info));
+        } else {
+            refreshed.push_back(GetWindowDetails(hwnd, withIcons));
+        }
+    }
+
+    int zOrder = 0;
+    for (auto& win : refreshed) {
+        win.zOrder = zOrder++;
+    }
+    windows.swap(refreshed);
+}
+
+BOOL CALLBACK WindowEnumerator::EnumHandlesProc(HWND hwnd, LPARAM lParam) {
+    reinterpret_cast<std::vector<HWND>*>(lParam)->push_back(hwnd);
+    return TRUE;
+}
+
 BOOL CALLBACK WindowEnumerator::EnumWindowsProc(HWND hwnd, LPARAM lParam) {
-    auto* windows = reinterpret_cast<std::vector<WindowInfo>*>(lParam);
-    windows->push_back(GetWindowDetails(hwnd));
+    auto* context = reinterpret_cast<EnumContext*>(lParam);
+    context->windows->push_back(GetWindowDetails(hwnd, context->withIcons));
     return TRUE;
 }
 
-WindowInfo WindowEnumerator::GetWindowDetails(HWND hwnd) {
+WindowInfo WindowEnumerator::GetWindowDetails(HWND hwnd, bool withIcon) {
     WindowInfo info = {};
     info.hwnd = hwnd;
     info.hwndParent = GetParent(hwnd);
     info.hwndOwner = GetWindow(hwnd, GW_OWNER);
 
-    // Window title
-    int titleLen = GetWindowTextLengthW(hwnd);
-    if (titleLen > 0) {
-        info.title.resize(titleLen + 1);
-        GetWindowTextW(hwnd, &info.title[0], titleLen + 1);
-        info.title.resize(titleLen);
-    }
-
     // Class name
     wchar_t className[256] = {};
     GetClassNameW(hwnd, className, 256);
@@ -146,6 +216,30 @@ WindowInfo WindowEnumerator::GetWindowDetails(HWND hwnd) {
     info.processName = GetProcessName(info.processId);
     info.processPath = GetProcessPath(info.processId);
 
+    info.isUWP = IsUWPWindow(hwnd);
+
+    // Title, geometry, styles and state
+    RefreshVolatileDetails(info);
+
+    // Icon
+    info.hIcon = withIcon ? GetWindowIcon(hwnd) : nullptr;
+
+    return info;
+}
+
+void WindowEnumerator::RefreshVolatileDetails(WindowInfo& info) {
+    HWND hwnd = info.hwnd;
+
+    // Window title
+    int titleLen = GetWindowTextLengthW(hwnd);
+    if (titleLen > 0) {
+        info.title.resize(titleLen + 1);
+        int copied = GetWindowTextW(hwnd, &info.title[0], titleLen + 1);
+        info.title.resize(copied);
+    } else {
+        info.title.clear();
+    }
+
     // Rectangles
     GetWindowRect(hwnd, &info.rect);
     GetClientRect(hwnd, &info.clientRect);
@@ -163,7 +257,6 @@ WindowInfo WindowEnumerator::GetWindowDetails(HWND hwnd) {
     info.isLayered = (info.exStyle & WS_EX_LAYERED) != 0;
     info.isTransparent = (info.exStyle & WS_EX_TRANSPARENT) != 0;
     info.isCloaked = IsWindowCloaked(hwnd);
-    info.isUWP = IsUWPWindow(hwnd);
     info.isHung = IsHungAppWindow(hwnd) != FALSE;
 
     // Alpha/transparency
@@ -178,9 +271,6 @@ WindowInfo WindowEnumerator::GetWindowDetails(HWND hwnd) {
         }
     }
 
-    // Icon
-    info.hIcon = GetWindowIcon(hwnd);
-
     // DWM extended frame
     info.hasDwmFrame = false;
     BOOL dwmEnabled = FALSE;
@@ -190,8 +280,6 @@ WindowInfo WindowEnumerator::GetWindowDetails(HWND hwnd) {
             info.hasDwmFrame = true;
         }
     }
-
-    return info;
 }
 
 std::wstring WindowEnumerator::GetProcessName(DWORD processId) {
@@ -263,3 +351,4 @@ bool WindowEnumerator::IsUWPWindow(HWND hwnd) {
     return wcscmp(className, L"ApplicationFrameWindow") == 0 ||
            wcscmp(className, L"Windows.UI.Core.CoreWindow") == 0;
 }
+#endif
@@ -3,10 +3,16 @@
 #define WIN32_LEAN_AND_MEAN
 #define NOMINMAX
 #include <Windows.h>
+#include <cstdint>
 #include <string>
 #include <vector>
 #include <dwmapi.h>
 
+struct StyleFlagName {
+    DWORD mask;
+    const wchar_t* name;
+};
+
 struct WindowInfo {
     HWND hwnd;
     HWND hwndParent;
@@ -39,22 +45,67 @@ struct WindowInfo {
     bool hasDwmFrame;
     RECT dwmExtendedFrame;
 
+    // Share of the frame not covered by shown windows above it, in hundredths
+    // of a percent; -1 when the window is not shown. Filled in per snapshot by
+    // OcclusionEngine.
+    int exposed = -1;
+
+    // When the window was last raised above windows it had been below, in
+    // the snapshot's time base; 0 when it has not been. Filled in by
+    // ZOrderTracker.
+    uint64_t raisedAt = 0;
+
+    // Monitor the frame overlaps most, as an index into the snapshot's
+    // monitor list (-1 when on none), and the window rectangle in logical
+    // pixels (96 DPI) from that monitor's top-left corner, or the physical
+    // rectangle when on none. Filled in per snapshot by MonitorLayout.
+    int monitor = -1;
+    RECT logicalRect = {};
+
     bool IsSystemWindow() const;
     bool IsHiddenWindow() const;
+    // IsSystemWindow from the fields it reads, for rows read in place from a
+    // snapshot file; instantiated for wchar_t and char16_t class names
+    template <typename CharT>
+    static bool IsSystemWindow(const CharT* className, size_t classLength, bool untitled, DWORD exStyle,
+        bool cloaked, bool uwp);
     std::wstring GetStyleString() const;
     std::wstring GetExStyleString() const;
+
+    // Flag tables behind the style strings, in display order, for writers
+    // that decode styles without building a string per window
+    static const StyleFlagName* StyleFlagNames(size_t& count);
+    static const StyleFlagName* ExStyleFlagNames(size_t& count);
 };
 
+#ifdef _WIN32
 class WindowEnumerator {
 public:
-    static std::vector<WindowInfo> EnumerateAllWindows();
-    static WindowInfo GetWindowDetails(HWND hwnd);
+    // Icons cost a cross-process message per window; callers that do not
+    // draw them (headless dumps) can skip them
+    static std::vector<WindowInfo> EnumerateAllWindows(bool withIcons = true);
+    static WindowInfo GetWindowDetails(HWND hwnd, bool withIcon = true);
+    // Re-enumerates into an earlier result: windows still owned by the same
+    // thread keep their process, class and icon and re-read only the volatile
+    // details and parent/owner; new windows are queried in full
+    static void RefreshAllWindows(std::vector<WindowInfo>& windows, bool withIcons = true);
+    // Re-reads only the properties that change while a window is in use
+    // (title, rects, styles, state flags, alpha, DWM frame), skipping the
+    // process queries, icon lookup and class name
+    static void RefreshVolatileDetails(WindowInfo& info);
 
 private:
+    struct EnumContext {
+        std::vector<WindowInfo>* windows;
+        bool withIcons;
+    };
+
     static BOOL CALLBACK EnumWindowsProc(HWND hwnd, LPARAM lParam);
+    static BOOL CALLBACK EnumHandlesProc(HWND hwnd, LPARAM lParam);
     static std::wstring GetProcessName(DWORD processId);
     static std::wstring GetProcessPath(DWORD processId);
     static HICON GetWindowIcon(HWND hwnd);
     static bool IsWindowCloaked(HWND hwnd);
     static bool IsUWPWindow(HWND hwnd);
 };
+#endif
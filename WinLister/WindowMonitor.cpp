@@ -0,0 +1,146 @@
+#include "WindowMonitor.h"
+#include "WindowOcclusion.h"
+#include "WindowSpatial.h"
+#include <algorithm>
+
+#ifdef _WIN32
+#include <ShellScalingApi.h>
+#pragma comment(lib, "shcore.lib")
+#endif
+
+// By value, unlike std::min and std::max, so the sweep has no branches
+static inline int32_t Min32(int32_t a, int32_t b) {
+    return a < b ? a : b;
+}
+
+static inline int32_t Max32(int32_t a, int32_t b) {
+    return a > b ? a : b;
+}
+
+bool MonitorLayout::Load(MonitorSource& source) {
+    std::vector<MonitorDesc> monitors;
+    if (!source.Load(monitors)) {
+        return false;
+    }
+    m_monitors.swap(monitors);
+    return true;
+}
+
+void MonitorLayout::Assign(std::vector<WindowInfo>& windows) {
+    // Windows are taken a block at a time, so each is still in cache when
+    // its results are written back
+    size_t block = std::min(windows.size(), BLOCK_SIZE);
+    m_left.resize(block);
+    m_top.resize(block);
+    m_right.resize(block);
+    m_bottom.resize(block);
+    m_bestArea.resize(block);
+    m_best.resize(block);
+
+    for (size_t first = 0; first < windows.size(); first += block) {
+        WindowInfo* batch = windows.data() + first;
+        size_t count = std::min(block, windows.size() - first);
+        for (size_t i = 0; i < count; i++) {
+            RECT frame = SpatialIndex::Frame(batch[i]);
+            m_left[i] = static_cast<int32_t>(frame.left);
+            m_top[i] = static_cast<int32_t>(frame.top);
+            m_right[i] = static_cast<int32_t>(frame.right);
+            m_bottom[i] = static_cast<int32_t>(frame.bottom);
+            m_bestArea[i] = 0.0f;
+            m_best[i] = -1;
+        }
+
+        SweepMonitors(count);
+
+        for (size_t i = 0; i < count; i++) {
+            WindowInfo& win = batch[i];
+            win.monitor = m_best[i];
+            if (m_best[i] < 0) {
+                win.logicalRect = win.rect;
+                continue;
+            }
+            const MonitorDesc& monitor = m_monitors[m_best[i]];
+            UINT dpi = monitor.dpi ? monitor.dpi : BASE_DPI;
+            win.logicalRect.left = ToLogical(win.rect.left - monitor.bounds.left, dpi);
+            win.logicalRect.top = ToLogical(win.rect.top - monitor.bounds.top, dpi);
+            win.logicalRect.right = ToLogical(win.rect.right - monitor.bounds.left, dpi);
+            win.logicalRect.bottom = ToLogical(win.rect.bottom - monitor.bounds.top, dpi);
+        }
+    }
+}
+
+void MonitorLayout::SweepMonitors(size_t count) {
+    // Areas are floats so they fill the same vector lanes as the coordinates;
+    // overlaps within a few parts in a hundred million of each other tie
+    const int32_t* left = m_left.data();
+    const int32_t* top = m_top.data();
+    const int32_t* right = m_right.data();
+    const int32_t* bottom = m_bottom.data();
+    float* bestArea = m_bestArea.data();
+    int32_t* best = m_best.data();
+    for (size_t m = 0; m < m_monitors.size(); m++) {
+        const RECT& bounds = m_monitors[m].bounds;
+        int32_t monitorLeft = static_cast<int32_t>(bounds.left);
+        int32_t monitorTop = static_cast<int32_t>(bounds.top);
+        int32_t monitorRight = static_cast<int32_t>(bounds.right);
+        int32_t monitorBottom = static_cast<int32_t>(bounds.bottom);
+        int32_t index = static_cast<int32_t>(m);
+        for (size_t i = 0; i < count; i++) {
+            int32_t width = Max32(Min32(right[i], monitorRight) - Max32(left[i], monitorLeft), 0);
+            int32_t height = Max32(Min32(bottom[i], monitorBottom) - Max32(top[i], monitorTop), 0);
+            float area = static_cast<float>(width) * static_cast<float>(height);
+            float previous = bestArea[i];
+            int32_t better = -static_cast<int32_t>(area > previous);
+            bestArea[i] = area > previous ? area : previous;
+            best[i] = (index & better) | (best[i] & ~better);
+        }
+    }
+}
+
+LONG MonitorLayout::ToLogical(LONG physical, UINT dpi) {
+    // Rounded half away from zero
+    int64_t scaled = static_cast<int64_t>(physical) * BASE_DPI;
+    int64_t half = dpi / 2;
+    return static_cast<LONG>((scaled >= 0 ? scaled + half : scaled - half) / static_cast<int64_t>(dpi));
+}
+
+bool MonitorLayout::IsOffScreen(const WindowInfo& win) {
+    if (win.monitor >= 0 || !OcclusionEngine::IsShown(win)) {
+        return false;
+    }
+    RECT frame = SpatialIndex::Frame(win);
+    return frame.right > frame.left && frame.bottom > frame.top;
+}
+
+#ifdef _WIN32
+static BOOL CALLBACK CollectMonitor(HMONITOR handle, HDC, LPRECT, LPARAM lParam) {
+    auto* monitors = reinterpret_cast<std::vector<MonitorDesc>*>(lParam);
+    MONITORINFO info = { sizeof(info) };
+    if (!GetMonitorInfoW(handle, &info)) {
+        return TRUE;
+    }
+
+    MonitorDesc monitor = {};
+    monitor.bounds = info.rcMonitor;
+    monitor.work = info.rcWork;
+    monitor.primary = (info.dwFlags & MONITORINFOF_PRIMARY) != 0;
+    UINT dpiX = 0;
+    UINT dpiY = 0;
+    monitor.dpi = SUCCEEDED(GetDpiForMonitor(handle, MDT_EFFECTIVE_DPI, &dpiX, &dpiY)) ? dpiX : MonitorLayout::BASE_DPI;
+    monitors->push_back(monitor);
+    return TRUE;
+}
+
+bool Win32MonitorSource::Load(std::vector<MonitorDesc>& monitors) {
+    monitors.clear();
+    if (!EnumDisplayMonitors(nullptr, nullptr, CollectMonitor, reinterpret_cast<LPARAM>(&monitors))) {
+        return false;
+    }
+    std::stable_sort(monitors.begin(), monitors.end(), [](const MonitorDesc& a, const MonitorDesc& b) {
+        if (a.primary != b.primary) return a.primary;
+        if (a.bounds.left != b.bounds.left) return a.bounds.left < b.bounds.left;
+        return a.bounds.top < b.bounds.top;
+    });
+    return !monitors.empty();
+}
+#endif
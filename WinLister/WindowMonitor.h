@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "WindowInfo.h"
+
+struct MonitorDesc {
+    RECT bounds;    // physical pixels, virtual-screen coordinates
+    RECT work;      // bounds less the taskbar and app bars
+    UINT dpi;       // effective DPI; 96 is 100%
+    bool primary;
+};
+
+// Where monitor topology comes from: the display configuration on Windows,
+// synthetic layouts in tests and benchmarks
+class MonitorSource {
+public:
+    virtual ~MonitorSource() = default;
+    virtual bool Load(std::vector<MonitorDesc>& monitors) = 0;
+};
+
+#ifdef _WIN32
+// The attached monitors, primary first, then left to right and top to bottom
+class Win32MonitorSource : public MonitorSource {
+public:
+    bool Load(std::vector<MonitorDesc>& monitors) override;
+};
+#endif
+
+// Puts each window of a snapshot on a monitor and works out its geometry in
+// logical pixels, so positions compare across monitors with different
+// scaling. A window belongs to the monitor its frame overlaps most (the
+// first one on a tie); one that overlaps none is on no monitor. The pass is
+// done in batch: frames are split into coordinate arrays and each monitor is
+// one branch-free sweep over them, which the compiler vectorizes.
+class MonitorLayout {
+public:
+    bool Load(MonitorSource& source);
+    void SetMonitors(const std::vector<MonitorDesc>& monitors) { m_monitors = monitors; }
+    const std::vector<MonitorDesc>& Monitors() const { return m_monitors; }
+
+    // Fills in WindowInfo::monitor and WindowInfo::logicalRect
+    void Assign(std::vector<WindowInfo>& windows);
+
+    // Shown, with a frame, yet on no monitor
+    static bool IsOffScreen(const WindowInfo& win);
+
+    static const UINT BASE_DPI = 96;
+    // Physical offset on a monitor to logical pixels
+    static LONG ToLogical(LONG physical, UINT dpi);
+
+private:
+    void SweepMonitors(size_t count);
+
+    static constexpr size_t BLOCK_SIZE = 256;
+
+    std::vector<MonitorDesc> m_monitors;
+    // Per window of the current block
+    std::vector<int32_t> m_left;
+    std::vector<int32_t> m_top;
+    std::vector<int32_t> m_right;
+    std::vector<int32_t> m_bottom;
+    std::vector<float> m_bestArea;
+    std::vector<int32_t> m_best;
+};
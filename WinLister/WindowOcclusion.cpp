@@ -0,0 +1,167 @@
+#include "WindowOcclusion.h"
+#include "WindowSpatial.h"
+#include <algorithm>
+
+void CoverRegion::Add(const RECT& rc) {
+    if (rc.right <= rc.left || rc.bottom <= rc.top) {
+        return;
+    }
+
+    // Bands [first, last) overlap rc vertically; they are rebuilt in scratch
+    // with rc's span added, and the gaps between them filled with rc alone
+    auto first = std::lower_bound(m_bands.begin(), m_bands.end(), rc.top,
+        [](const Band& band, LONG top) { return band.bottom <= top; });
+    auto last = first;
+    while (last != m_bands.end() && last->top < rc.bottom) {
+        ++last;
+    }
+
+    m_scratch.clear();
+    LONG y = rc.top;
+    for (auto it = first; it != last; ++it) {
+        if (it->top < rc.top) {
+            m_scratch.push_back({ it->top, rc.top, it->spans });
+        }
+        LONG top = std::max(it->top, rc.top);
+        if (y < top) {
+            m_scratch.push_back({ y, top, { { rc.left, rc.right } } });
+        }
+        LONG bottom = std::min(it->bottom, rc.bottom);
+        m_scratch.push_back({ top, bottom, it->spans });
+        AddSpan(m_scratch.back().spans, rc.left, rc.right);
+        if (it->bottom > rc.bottom) {
+            m_scratch.push_back({ rc.bottom, it->bottom, std::move(it->spans) });
+        }
+        y = bottom;
+    }
+    if (y < rc.bottom) {
+        m_scratch.push_back({ y, rc.bottom, { { rc.left, rc.right } } });
+    }
+
+    // Merge touching bands with the same spans, including the neighbours
+    size_t begin = static_cast<size_t>(first - m_bands.begin());
+    size_t end = static_cast<size_t>(last - m_bands.begin());
+    if (begin > 0) {
+        begin--;
+        m_scratch.insert(m_scratch.begin(), std::move(m_bands[begin]));
+    }
+    if (end < m_bands.size()) {
+        m_scratch.push_back(std::move(m_bands[end]));
+        end++;
+    }
+    size_t kept = 0;
+    for (size_t i = 1; i < m_scratch.size(); i++) {
+        Band& prev = m_scratch[kept];
+        if (prev.bottom == m_scratch[i].top && SameSpans(prev, m_scratch[i])) {
+            prev.bottom = m_scratch[i].bottom;
+        } else if (++kept != i) {
+            m_scratch[kept] = std::move(m_scratch[i]);
+        }
+    }
+    m_scratch.resize(kept + 1);
+
+    m_bands.erase(m_bands.begin() + begin, m_bands.begin() + end);
+    m_bands.insert(m_bands.begin() + begin,
+        std::make_move_iterator(m_scratch.begin()), std::make_move_iterator(m_scratch.end()));
+}
+
+int64_t CoverRegion::OverlapArea(const RECT& rc) const {
+    if (rc.right <= rc.left || rc.bottom <= rc.top) {
+        return 0;
+    }
+
+    int64_t area = 0;
+    auto it = std::lower_bound(m_bands.begin(), m_bands.end(), rc.top,
+        [](const Band& band, LONG top) { return band.bottom <= top; });
+    for (; it != m_bands.end() && it->top < rc.bottom; ++it) {
+        int64_t height = std::min(it->bottom, rc.bottom) - std::max(it->top, rc.top);
+        int64_t width = 0;
+        for (const Span& span : it->spans) {
+            if (span.left >= rc.right) {
+                break;
+            }
+            LONG left = std::max(span.left, rc.left);
+            LONG right = std::min(span.right, rc.right);
+            if (left < right) {
+                width += right - left;
+            }
+        }
+        area += width * height;
+    }
+    return area;
+}
+
+void CoverRegion::AddSpan(std::vector<Span>& spans, LONG left, LONG right) {
+    // Spans that touch or overlap [left, right) are folded into it
+    auto first = std::lower_bound(spans.begin(), spans.end(), left,
+        [](const Span& span, LONG x) { return span.right < x; });
+    auto last = first;
+    while (last != spans.end() && last->left <= right) {
+        left = std::min(left, last->left);
+        right = std::max(right, last->right);
+        ++last;
+    }
+    if (first == last) {
+        spans.insert(first, { left, right });
+    } else {
+        first->left = left;
+        first->right = right;
+        spans.erase(first + 1, last);
+    }
+}
+
+bool CoverRegion::SameSpans(const Band& a, const Band& b) {
+    if (a.spans.size() != b.spans.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < a.spans.size(); i++) {
+        if (a.spans[i].left != b.spans[i].left || a.spans[i].right != b.spans[i].right) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool OcclusionEngine::IsShown(const WindowInfo& win) {
+    return win.isVisible && !win.isCloaked && !win.isMinimized;
+}
+
+bool OcclusionEngine::Covers(const WindowInfo& win) {
+    return IsShown(win) && !(win.isLayered && win.alpha == 0);
+}
+
+void OcclusionEngine::Compute(std::vector<WindowInfo>& windows) {
+    std::vector<size_t> order(windows.size());
+    for (size_t i = 0; i < order.size(); i++) {
+        order[i] = i;
+    }
+    std::stable_sort(order.begin(), order.end(),
+        [&windows](size_t a, size_t b) { return windows[a].zOrder < windows[b].zOrder; });
+
+    CoverRegion covered;
+    for (size_t index : order) {
+        WindowInfo& win = windows[index];
+        RECT frame = SpatialIndex::Frame(win);
+        int64_t area = static_cast<int64_t>(frame.right - frame.left) * (frame.bottom - frame.top);
+        if (!IsShown(win) || frame.right <= frame.left || frame.bottom <= frame.top) {
+            win.exposed = -1;
+            continue;
+        }
+
+        // Rounded to hundredths of a percent, but never onto 0 or 100% unless
+        // the window really is fully covered or fully exposed
+        int64_t exposedArea = area - covered.OverlapArea(frame);
+        int64_t exposed = (exposedArea * EXPOSED_FULL + area / 2) / area;
+        if (exposedArea > 0 && exposed == 0) {
+            exposed = 1;
+        } else if (exposedArea < area && exposed == EXPOSED_FULL) {
+            exposed = EXPOSED_FULL - 1;
+        }
+        win.exposed = static_cast<int>(exposed);
+
+        // A fully covered window adds nothing to the region
+        if (exposedArea > 0 && Covers(win)) {
+            covered.Add(frame);
+        }
+    }
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "WindowInfo.h"
+
+// A union of rectangles kept as horizontal bands, each with sorted, disjoint
+// x spans, the way GDI keeps regions. Adjacent bands with the same spans are
+// merged, so a region built from many overlapping windows stays small.
+class CoverRegion {
+public:
+    void Clear() { m_bands.clear(); }
+    bool Empty() const { return m_bands.empty(); }
+
+    void Add(const RECT& rc);
+    // Pixels of rc inside the region
+    int64_t OverlapArea(const RECT& rc) const;
+
+    size_t BandCount() const { return m_bands.size(); }
+
+private:
+    struct Span {
+        LONG left;
+        LONG right;
+    };
+
+    struct Band {
+        LONG top;
+        LONG bottom;
+        std::vector<Span> spans;
+    };
+
+    static void AddSpan(std::vector<Span>& spans, LONG left, LONG right);
+    static bool SameSpans(const Band& a, const Band& b);
+
+    std::vector<Band> m_bands;  // sorted by top, not overlapping
+    std::vector<Band> m_scratch;
+};
+
+// Works out how much of each window can actually be seen. Windows are taken
+// from the top of the z-order down; each one's frame (the DWM frame when
+// there is one) is measured against the region covered by the shown windows
+// above it, then added to that region. Hidden, cloaked, minimized and fully
+// transparent windows cover nothing.
+class OcclusionEngine {
+public:
+    // Fills in WindowInfo::exposed for every window
+    static void Compute(std::vector<WindowInfo>& windows);
+
+    static bool IsShown(const WindowInfo& win);
+    static bool Covers(const WindowInfo& win);
+
+    static const int EXPOSED_FULL = 10000;
+};
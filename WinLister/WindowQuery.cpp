@@ -0,0 +1,392 @@
+#include "WindowQuery.h"
+#include "WindowFilter.h"
+#include "SnapshotFile.h"
+#include <algorithm>
+#include <cwctype>
+
+namespace {
+
+const wchar_t* const FIELD_NAMES[QUERY_FIELD_COUNT] = {
+    L"", L"title", L"class", L"process", L"path", L"pid", L"tid", L"hwnd", L"z",
+    L"visible", L"enabled", L"minimized", L"maximized", L"topmost", L"layered",
+    L"cloaked", L"hung", L"uwp", L"hidden", L"system"
+};
+
+inline bool IsStringField(int field) {
+    return field >= QUERY_TEXT && field <= QUERY_PATH;
+}
+
+inline bool IsNumberField(int field) {
+    return field >= QUERY_PID && field <= QUERY_ZORDER;
+}
+
+// Evaluation order: flags, then numbers, then single-field globs, then the
+// three-field substring search
+int TermCost(int field) {
+    if (field == QUERY_TEXT) return 3;
+    if (IsStringField(field)) return 2;
+    if (IsNumberField(field)) return 1;
+    return 0;
+}
+
+std::wstring Fold(const std::wstring& text) {
+    std::wstring folded;
+    folded.reserve(text.size());
+    for (wchar_t c : text) {
+        folded.push_back(static_cast<wchar_t>(towlower(c)));
+    }
+    return folded;
+}
+
+int FindField(const std::wstring& name) {
+    std::wstring folded = Fold(name);
+    for (int field = QUERY_TITLE; field < QUERY_FIELD_COUNT; field++) {
+        if (folded == FIELD_NAMES[field]) return field;
+    }
+    if (folded == L"zorder") return QUERY_ZORDER;
+    return -1;
+}
+
+bool ParseNumber(const std::wstring& text, bool hex, uint64_t& value) {
+    size_t i = 0;
+    if (hex && text.size() > 2 && text[0] == L'0' && (text[1] == L'x' || text[1] == L'X')) {
+        i = 2;
+    }
+    if (i == text.size()) return false;
+
+    value = 0;
+    for (; i < text.size(); i++) {
+        wchar_t c = text[i];
+        uint64_t digit;
+        if (c >= L'0' && c <= L'9') {
+            digit = static_cast<uint64_t>(c - L'0');
+        } else if (hex && c >= L'a' && c <= L'f') {
+            digit = static_cast<uint64_t>(c - L'a' + 10);
+        } else if (hex && c >= L'A' && c <= L'F') {
+            digit = static_cast<uint64_t>(c - L'A' + 10);
+        } else {
+            return false;
+        }
+
+        uint64_t base = hex ? 16 : 10;
+        if (value > (UINT64_MAX - digit) / base) return false;
+        value = value * base + digit;
+    }
+    return true;
+}
+
+bool ParseFlag(const std::wstring& text, bool& flag) {
+    std::wstring folded = Fold(text);
+    if (folded == L"yes" || folded == L"true" || folded == L"1") {
+        flag = true;
+        return true;
+    }
+    if (folded == L"no" || folded == L"false" || folded == L"0") {
+        flag = false;
+        return true;
+    }
+    return false;
+}
+
+uint64_t NumberValue(const WindowInfo& win, int field) {
+    switch (field) {
+    case QUERY_PID: return win.processId;
+    case QUERY_TID: return win.threadId;
+    case QUERY_HWND: return static_cast<uint64_t>(reinterpret_cast<uintptr_t>(win.hwnd));
+    default: return static_cast<uint64_t>(static_cast<int64_t>(win.zOrder));
+    }
+}
+
+bool FlagValue(const WindowInfo& win, int field) {
+    switch (field) {
+    case QUERY_VISIBLE: return win.isVisible;
+    case QUERY_ENABLED: return win.isEnabled;
+    case QUERY_MINIMIZED: return win.isMinimized;
+    case QUERY_MAXIMIZED: return win.isMaximized;
+    case QUERY_TOPMOST: return win.isTopMost;
+    case QUERY_LAYERED: return win.isLayered;
+    case QUERY_CLOAKED: return win.isCloaked;
+    case QUERY_HUNG: return win.isHung;
+    case QUERY_UWP: return win.isUWP;
+    case QUERY_HIDDEN: return win.IsHiddenWindow();
+    default: return win.IsSystemWindow();
+    }
+}
+
+const std::wstring& StringValue(const WindowInfo& win, int field) {
+    switch (field) {
+    case QUERY_TITLE: return win.title;
+    case QUERY_CLASS: return win.className;
+    case QUERY_PROCESS: return win.processName;
+    default: return win.processPath;
+    }
+}
+
+// Term inputs from a live row
+struct LiveRow {
+    const WindowInfo& win;
+
+    uint64_t Number(int field) const { return NumberValue(win, field); }
+    bool Flag(int field) const { return FlagValue(win, field); }
+    bool TextContains(const std::wstring& word) const {
+        return WindowFilter::ContainsFolded(win.title, word) ||
+               WindowFilter::ContainsFolded(win.className, word) ||
+               WindowFilter::ContainsFolded(win.processName, word);
+    }
+    bool Glob(int field, const std::wstring& pattern) const {
+        return WindowQuery::GlobMatchFolded(StringValue(win, field), pattern);
+    }
+};
+
+// Term inputs read in place from a snapshot file row
+struct CapturedRow {
+    const SnapshotFileReader& snapshot;
+    size_t row;
+
+    uint64_t Number(int field) const {
+        switch (field) {
+        case QUERY_PID: return snapshot.ProcessId(row);
+        case QUERY_TID: return snapshot.ThreadId(row);
+        case QUERY_HWND: return snapshot.Hwnd(row);
+        default: return static_cast<uint64_t>(static_cast<int64_t>(snapshot.ZOrder(row)));
+        }
+    }
+    bool Flag(int field) const {
+        uint32_t flags = snapshot.Flags(row);
+        switch (field) {
+        case QUERY_VISIBLE: return (flags & SNAPFLAG_VISIBLE) != 0;
+        case QUERY_ENABLED: return (flags & SNAPFLAG_ENABLED) != 0;
+        case QUERY_MINIMIZED: return (flags & SNAPFLAG_MINIMIZED) != 0;
+        case QUERY_MAXIMIZED: return (flags & SNAPFLAG_MAXIMIZED) != 0;
+        case QUERY_TOPMOST: return (flags & SNAPFLAG_TOPMOST) != 0;
+        case QUERY_LAYERED: return (flags & SNAPFLAG_LAYERED) != 0;
+        case QUERY_CLOAKED: return (flags & SNAPFLAG_CLOAKED) != 0;
+        case QUERY_HUNG: return (flags & SNAPFLAG_HUNG) != 0;
+        case QUERY_UWP: return (flags & SNAPFLAG_UWP) != 0;
+        case QUERY_HIDDEN: return !(flags & SNAPFLAG_VISIBLE) || (flags & SNAPFLAG_CLOAKED);
+        default: {
+            SnapshotString className = snapshot.ClassName(row);
+            return WindowInfo::IsSystemWindow(className.data, className.length, snapshot.Title(row).length == 0,
+                snapshot.ExStyle(row), (flags & SNAPFLAG_CLOAKED) != 0, (flags & SNAPFLAG_UWP) != 0);
+        }
+        }
+    }
+    bool TextContains(const std::wstring& word) const {
+        for (SnapshotString text : { snapshot.Title(row), snapshot.ClassName(row), snapshot.ProcessName(row) }) {
+            if (WindowFilter::ContainsFolded(text.data, text.length, word)) return true;
+        }
+        return false;
+    }
+    bool Glob(int field, const std::wstring& pattern) const {
+        SnapshotString text;
+        switch (field) {
+        case QUERY_TITLE: text = snapshot.Title(row); break;
+        case QUERY_CLASS: text = snapshot.ClassName(row); break;
+        case QUERY_PROCESS: text = snapshot.ProcessName(row); break;
+        default: text = snapshot.ProcessPath(row); break;
+        }
+        return WindowQuery::GlobMatchFolded(text.data, text.length, pattern);
+    }
+};
+
+template <typename Row>
+bool MatchesTerm(const QueryTerm& term, const Row& row) {
+    if (term.field == QUERY_TEXT) {
+        return row.TextContains(term.patterns[0]);
+    }
+
+    if (IsStringField(term.field)) {
+        for (const std::wstring& pattern : term.patterns) {
+            if (row.Glob(term.field, pattern)) return true;
+        }
+        return false;
+    }
+
+    if (IsNumberField(term.field)) {
+        uint64_t value = row.Number(term.field);
+        // z-order compares as signed
+        if (term.field == QUERY_ZORDER) {
+            int64_t a = static_cast<int64_t>(value);
+            int64_t b = static_cast<int64_t>(term.number);
+            switch (term.compare) {
+            case QUERY_LESS: return a < b;
+            case QUERY_LESS_EQUAL: return a <= b;
+            case QUERY_GREATER: return a > b;
+            case QUERY_GREATER_EQUAL: return a >= b;
+            default: return a == b;
+            }
+        }
+        switch (term.compare) {
+        case QUERY_LESS: return value < term.number;
+        case QUERY_LESS_EQUAL: return value <= term.number;
+        case QUERY_GREATER: return value > term.number;
+        case QUERY_GREATER_EQUAL: return value >= term.number;
+        default: return value == term.number;
+        }
+    }
+
+    return row.Flag(term.field) == term.flag;
+}
+
+} // namespace
+
+bool WindowQuery::Parse(const std::wstring& text, WindowQuery& query, std::wstring& error) {
+    query.m_terms.clear();
+
+    size_t i = 0;
+    while (i < text.size()) {
+        if (iswspace(text[i])) {
+            i++;
+            continue;
+        }
+
+        QueryTerm term;
+        if (text[i] == L'-' && i + 1 < text.size() && !iswspace(text[i + 1])) {
+            term.negate = true;
+            i++;
+        }
+
+        // Read the term, dropping quotes; a colon before any quote ends the field name
+        std::wstring value;
+        size_t colon = std::wstring::npos;
+        bool quoted = false;
+        bool inQuotes = false;
+        for (; i < text.size() && (inQuotes || !iswspace(text[i])); i++) {
+            wchar_t c = text[i];
+            if (c == L'"') {
+                inQuotes = !inQuotes;
+                quoted = true;
+            } else {
+                if (c == L':' && colon == std::wstring::npos && !quoted) {
+                    colon = value.size();
+                }
+                value.push_back(c);
+            }
+        }
+        if (inQuotes) {
+            error = L"Unterminated quote in query";
+            return false;
+        }
+
+        std::wstring argument = value;
+        if (colon != std::wstring::npos && colon > 0) {
+            std::wstring name = value.substr(0, colon);
+            int field = FindField(name);
+            if (field < 0) {
+                // Single letters are left alone so "c:\windows" still searches
+                bool word = name.size() > 1 &&
+                    std::all_of(name.begin(), name.end(), [](wchar_t c) { return iswalpha(c) != 0; });
+                if (word) {
+                    error = L"Unknown query field '" + name + L"'";
+                    return false;
+                }
+            } else {
+                term.field = field;
+                argument = value.substr(colon + 1);
+            }
+        }
+
+        if (IsStringField(term.field)) {
+            std::wstring folded = Fold(argument);
+            if (term.field == QUERY_TEXT) {
+                term.patterns.push_back(folded);
+            } else {
+                size_t start = 0;
+                for (;;) {
+                    size_t bar = folded.find(L'|', start);
+                    term.patterns.push_back(folded.substr(start, bar == std::wstring::npos ? std::wstring::npos : bar - start));
+                    if (bar == std::wstring::npos) break;
+                    start = bar + 1;
+                }
+            }
+        } else if (IsNumberField(term.field)) {
+            size_t skip = 0;
+            if (argument.compare(0, 2, L"<=") == 0) {
+                term.compare = QUERY_LESS_EQUAL;
+                skip = 2;
+            } else if (argument.compare(0, 2, L">=") == 0) {
+                term.compare = QUERY_GREATER_EQUAL;
+                skip = 2;
+            } else if (argument.compare(0, 1, L"<") == 0) {
+                term.compare = QUERY_LESS;
+                skip = 1;
+            } else if (argument.compare(0, 1, L">") == 0) {
+                term.compare = QUERY_GREATER;
+                skip = 1;
+            }
+            if (!ParseNumber(argument.substr(skip), term.field == QUERY_HWND, term.number)) {
+                error = L"Expected a number for '" + std::wstring(FIELD_NAMES[term.field]) + L"'";
+                return false;
+            }
+        } else if (!ParseFlag(argument, term.flag)) {
+            error = L"Expected yes or no for '" + std::wstring(FIELD_NAMES[term.field]) + L"'";
+            return false;
+        }
+
+        query.m_terms.push_back(term);
+    }
+
+    std::stable_sort(query.m_terms.begin(), query.m_terms.end(),
+        [](const QueryTerm& a, const QueryTerm& b) { return TermCost(a.field) < TermCost(b.field); });
+    return true;
+}
+
+bool WindowQuery::Matches(const WindowInfo& win) const {
+    LiveRow row = { win };
+    for (const QueryTerm& term : m_terms) {
+        if (MatchesTerm(term, row) == term.negate) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool WindowQuery::Matches(const SnapshotFileReader& snapshot, size_t row) const {
+    CapturedRow captured = { snapshot, row };
+    for (const QueryTerm& term : m_terms) {
+        if (MatchesTerm(term, captured) == term.negate) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool WindowQuery::GlobMatchFolded(const std::wstring& text, const std::wstring& foldedPattern) {
+    return GlobMatchFolded(text.data(), text.size(), foldedPattern);
+}
+
+template <typename CharT>
+bool WindowQuery::GlobMatchFolded(const CharT* text, size_t length, const std::wstring& foldedPattern) {
+    // Greedy match that backtracks only to the most recent '*'
+    size_t t = 0;
+    size_t p = 0;
+    size_t starPattern = std::wstring::npos;
+    size_t starText = 0;
+    while (t < length) {
+        if (p < foldedPattern.size() && foldedPattern[p] == L'*') {
+            starPattern = p++;
+            starText = t;
+        } else if (p < foldedPattern.size() &&
+                   (foldedPattern[p] == L'?' ||
+                    foldedPattern[p] == static_cast<wchar_t>(towlower(static_cast<wchar_t>(text[t]))))) {
+            p++;
+            t++;
+        } else if (starPattern != std::wstring::npos) {
+            p = starPattern + 1;
+            t = ++starText;
+        } else {
+            return false;
+        }
+    }
+    while (p < foldedPattern.size() && foldedPattern[p] == L'*') {
+        p++;
+    }
+    return p == foldedPattern.size();
+}
+
+template bool WindowQuery::GlobMatchFolded<wchar_t>(const wchar_t*, size_t, const std::wstring&);
+template bool WindowQuery::GlobMatchFolded<char16_t>(const char16_t*, size_t, const std::wstring&);
+
+const wchar_t* WindowQuery::FieldName(int field) {
+    return (field >= 0 && field < QUERY_FIELD_COUNT) ? FIELD_NAMES[field] : L"";
+}
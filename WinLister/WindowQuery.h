@@ -0,0 +1,86 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "WindowInfo.h"
+
+class SnapshotFileReader;
+
+// Fields a query term can test
+enum QueryField {
+    QUERY_TEXT = 0,         // title, class or process contains the word
+    QUERY_TITLE,
+    QUERY_CLASS,
+    QUERY_PROCESS,
+    QUERY_PATH,
+    QUERY_PID,
+    QUERY_TID,
+    QUERY_HWND,
+    QUERY_ZORDER,
+    QUERY_VISIBLE,
+    QUERY_ENABLED,
+    QUERY_MINIMIZED,
+    QUERY_MAXIMIZED,
+    QUERY_TOPMOST,
+    QUERY_LAYERED,
+    QUERY_CLOAKED,
+    QUERY_HUNG,
+    QUERY_UWP,
+    QUERY_HIDDEN,           // WindowInfo::IsHiddenWindow
+    QUERY_SYSTEM,           // WindowInfo::IsSystemWindow
+    QUERY_FIELD_COUNT
+};
+
+enum QueryCompare {
+    QUERY_EQUAL = 0,
+    QUERY_LESS,
+    QUERY_LESS_EQUAL,
+    QUERY_GREATER,
+    QUERY_GREATER_EQUAL
+};
+
+struct QueryTerm {
+    int field = QUERY_TEXT;
+    bool negate = false;
+    std::vector<std::wstring> patterns;     // lowercase; any may match
+    int compare = QUERY_EQUAL;
+    uint64_t number = 0;
+    bool flag = false;
+};
+
+// A window query as typed on the command line. Terms are separated by spaces
+// and must all match:
+//
+//   word            title, class or process contains word
+//   title:pattern   also class:, process:, path:; case-insensitive glob with
+//                   * and ?, and '|' between alternatives
+//   pid:1234        also tid:, z: (z-order); may start with <, <=, > or >=
+//   hwnd:1A2B       hex, with or without 0x
+//   visible:yes     also enabled, minimized, maximized, topmost, layered,
+//                   cloaked, hung, uwp, hidden, system; yes/no, true/false, 1/0
+//   -term           excludes matches
+//
+// Double quotes keep spaces inside a term: title:"* - Notepad". Terms are
+// evaluated cheapest first: numbers and flags before strings.
+class WindowQuery {
+public:
+    static bool Parse(const std::wstring& text, WindowQuery& query, std::wstring& error);
+
+    bool IsEmpty() const { return m_terms.empty(); }
+    bool Matches(const WindowInfo& win) const;
+    // The same test on a row of a snapshot file, reading only the fields the
+    // terms use, in place
+    bool Matches(const SnapshotFileReader& snapshot, size_t row) const;
+    const std::vector<QueryTerm>& Terms() const { return m_terms; }
+
+    // Case-insensitive glob; the pattern must already be lowercase
+    static bool GlobMatchFolded(const std::wstring& text, const std::wstring& foldedPattern);
+    // Instantiated for wchar_t and char16_t text
+    template <typename CharT>
+    static bool GlobMatchFolded(const CharT* text, size_t length, const std::wstring& foldedPattern);
+    static const wchar_t* FieldName(int field);
+
+private:
+    std::vector<QueryTerm> m_terms;
+};
@@ -0,0 +1,620 @@
+#include "WindowRules.h"
+#include "FileIO.h"
+#include <algorithm>
+#include <cwctype>
+#include <functional>
+
+namespace {
+
+// Window fields a rule verdict can depend on. Class and process id are part
+// of the identity and the handle is the key, so they need no bit here.
+enum WindowInput {
+    INPUT_TITLE = 0,
+    INPUT_UNTITLED,         // only whether the title is empty
+    INPUT_PROCESS,
+    INPUT_PATH,
+    INPUT_THREAD,
+    INPUT_ZORDER,
+    INPUT_VISIBLE,          // the flags, in WindowInfo order, up to INPUT_UWP
+    INPUT_ENABLED,
+    INPUT_MINIMIZED,
+    INPUT_MAXIMIZED,
+    INPUT_TOPMOST,
+    INPUT_LAYERED,
+    INPUT_CLOAKED,
+    INPUT_HUNG,
+    INPUT_UWP,
+    INPUT_EXSTYLE
+};
+
+uint32_t InputBit(int input) {
+    return 1u << input;
+}
+
+// The inputs each query field's predicate reads; see MatchesTerm and
+// WindowInfo::IsHiddenWindow / IsSystemWindow
+const uint32_t FIELD_INPUTS[QUERY_FIELD_COUNT] = {
+    InputBit(INPUT_TITLE) | InputBit(INPUT_PROCESS),    // QUERY_TEXT, with the class
+    InputBit(INPUT_TITLE),                              // QUERY_TITLE
+    0,                                                  // QUERY_CLASS
+    InputBit(INPUT_PROCESS),                            // QUERY_PROCESS
+    InputBit(INPUT_PATH),                               // QUERY_PATH
+    0,                                                  // QUERY_PID
+    InputBit(INPUT_THREAD),                             // QUERY_TID
+    0,                                                  // QUERY_HWND
+    InputBit(INPUT_ZORDER),                             // QUERY_ZORDER
+    InputBit(INPUT_VISIBLE),                            // QUERY_VISIBLE
+    InputBit(INPUT_ENABLED),                            // QUERY_ENABLED
+    InputBit(INPUT_MINIMIZED),                          // QUERY_MINIMIZED
+    InputBit(INPUT_MAXIMIZED),                          // QUERY_MAXIMIZED
+    InputBit(INPUT_TOPMOST),                            // QUERY_TOPMOST
+    InputBit(INPUT_LAYERED),                            // QUERY_LAYERED
+    InputBit(INPUT_CLOAKED),                            // QUERY_CLOAKED
+    InputBit(INPUT_HUNG),                               // QUERY_HUNG
+    InputBit(INPUT_UWP),                                // QUERY_UWP
+    InputBit(INPUT_VISIBLE) | InputBit(INPUT_CLOAKED),  // QUERY_HIDDEN
+    InputBit(INPUT_UNTITLED) | InputBit(INPUT_EXSTYLE) | InputBit(INPUT_CLOAKED) |
+        InputBit(INPUT_UWP),                            // QUERY_SYSTEM, with the class
+};
+
+inline uint64_t Mix(uint64_t hash, uint64_t value) {
+    hash ^= value + 0x9E3779B97F4A7C15ull + (hash << 6) + (hash >> 2);
+    return hash;
+}
+
+inline uint64_t HashText(const std::wstring& text) {
+    return static_cast<uint64_t>(std::hash<std::wstring>()(text));
+}
+
+void FoldInto(const std::wstring& text, std::wstring& folded) {
+    folded.resize(text.size());
+    for (size_t i = 0; i < text.size(); i++) {
+        folded[i] = static_cast<wchar_t>(towlower(text[i]));
+    }
+}
+
+bool IsLiteral(const std::wstring& pattern) {
+    return pattern.find_first_of(L"*?") == std::wstring::npos;
+}
+
+std::wstring Trim(const std::wstring& text) {
+    size_t start = 0;
+    size_t end = text.size();
+    while (start < end && iswspace(text[start])) start++;
+    while (end > start && iswspace(text[end - 1])) end--;
+    return text.substr(start, end - start);
+}
+
+bool ParseInt(const std::wstring& text, int& value) {
+    if (text.empty()) return false;
+    size_t i = (text[0] == L'-' || text[0] == L'+') ? 1 : 0;
+    if (i == text.size()) return false;
+
+    int64_t result = 0;
+    for (; i < text.size(); i++) {
+        if (text[i] < L'0' || text[i] > L'9') return false;
+        result = result * 10 + (text[i] - L'0');
+        if (result > INT32_MAX) return false;
+    }
+    value = static_cast<int>(text[0] == L'-' ? -result : result);
+    return true;
+}
+
+bool ParsePair(const std::wstring& text, int& x, int& y) {
+    size_t comma = text.find(L',');
+    return comma != std::wstring::npos &&
+        ParseInt(Trim(text.substr(0, comma)), x) && ParseInt(Trim(text.substr(comma + 1)), y);
+}
+
+// Splits the action list on spaces; double quotes keep spaces and are dropped
+bool SplitActions(const std::wstring& text, std::vector<std::wstring>& tokens, std::wstring& error) {
+    size_t i = 0;
+    while (i < text.size()) {
+        if (iswspace(text[i])) {
+            i++;
+            continue;
+        }
+        std::wstring token;
+        bool inQuotes = false;
+        for (; i < text.size() && (inQuotes || !iswspace(text[i])); i++) {
+            if (text[i] == L'"') {
+                inQuotes = !inQuotes;
+            } else {
+                token.push_back(text[i]);
+            }
+        }
+        if (inQuotes) {
+            error = L"Unterminated quote in actions";
+            return false;
+        }
+        tokens.push_back(token);
+    }
+    return true;
+}
+
+struct ActionName {
+    const wchar_t* name;
+    int type;
+};
+
+const ActionName SIMPLE_ACTIONS[] = {
+    { L"onscreen", RULE_ONSCREEN },
+    { L"topmost", RULE_TOPMOST },
+    { L"notopmost", RULE_NOTOPMOST },
+    { L"show", RULE_SHOW },
+    { L"hide", RULE_HIDE },
+    { L"enable", RULE_ENABLE },
+    { L"disable", RULE_DISABLE },
+    { L"minimize", RULE_MINIMIZE },
+    { L"maximize", RULE_MAXIMIZE },
+    { L"restore", RULE_RESTORE },
+};
+
+bool ParseAction(const std::wstring& token, RuleAction& action, std::wstring& error) {
+    size_t equals = token.find(L'=');
+    std::wstring name;
+    FoldInto(token.substr(0, equals), name);
+    std::wstring value = equals == std::wstring::npos ? std::wstring() : token.substr(equals + 1);
+
+    if (equals == std::wstring::npos) {
+        for (const ActionName& simple : SIMPLE_ACTIONS) {
+            if (name == simple.name) {
+                action.type = simple.type;
+                return true;
+            }
+        }
+    } else if (name == L"move") {
+        action.type = RULE_MOVE;
+        if (!ParsePair(value, action.x, action.y)) {
+            error = L"Expected move=X,Y";
+            return false;
+        }
+        return true;
+    } else if (name == L"size") {
+        action.type = RULE_SIZE;
+        if (!ParsePair(value, action.x, action.y) || action.x <= 0 || action.y <= 0) {
+            error = L"Expected size=W,H with positive values";
+            return false;
+        }
+        return true;
+    } else if (name == L"alpha") {
+        action.type = RULE_ALPHA;
+        if (!ParseInt(value, action.x) || action.x < 0 || action.x > 255) {
+            error = L"Expected alpha=0..255";
+            return false;
+        }
+        return true;
+    } else if (name == L"title") {
+        action.type = RULE_TITLE;
+        action.text = value;
+        return true;
+    }
+
+    error = L"Unknown action '" + token + L"'";
+    return false;
+}
+
+} // namespace
+
+bool RuleParser::ParseRule(const std::wstring& line, WindowRule& rule, std::wstring& error) {
+    // "=>" outside quotes separates the query from the actions
+    size_t arrow = std::wstring::npos;
+    bool inQuotes = false;
+    for (size_t i = 0; i + 1 < line.size(); i++) {
+        if (line[i] == L'"') {
+            inQuotes = !inQuotes;
+        } else if (!inQuotes && line[i] == L'=' && line[i + 1] == L'>') {
+            arrow = i;
+            break;
+        }
+    }
+    if (arrow == std::wstring::npos) {
+        error = L"Expected '=>' between the query and the actions";
+        return false;
+    }
+
+    if (!WindowQuery::Parse(line.substr(0, arrow), rule.query, error)) {
+        return false;
+    }
+
+    std::vector<std::wstring> tokens;
+    if (!SplitActions(line.substr(arrow + 2), tokens, error)) {
+        return false;
+    }
+    if (tokens.empty()) {
+        error = L"No actions after '=>'";
+        return false;
+    }
+
+    rule.actions.clear();
+    for (const std::wstring& token : tokens) {
+        RuleAction action;
+        if (!ParseAction(token, action, error)) {
+            return false;
+        }
+        rule.actions.push_back(action);
+    }
+    return true;
+}
+
+bool RuleParser::ParseRules(const std::wstring& text, std::vector<WindowRule>& rules, std::wstring& error) {
+    rules.clear();
+    size_t start = 0;
+    int lineNumber = 0;
+    while (start <= text.size()) {
+        size_t end = text.find(L'\n', start);
+        if (end == std::wstring::npos) {
+            end = text.size();
+        }
+        lineNumber++;
+
+        std::wstring line = Trim(text.substr(start, end - start));
+        start = end + 1;
+        if (line.empty() || line[0] == L'#') {
+            continue;
+        }
+
+        WindowRule rule;
+        rule.line = lineNumber;
+        if (!ParseRule(line, rule, error)) {
+            error = L"Line " + std::to_wstring(lineNumber) + L": " + error;
+            return false;
+        }
+        rules.push_back(std::move(rule));
+    }
+    return true;
+}
+
+bool RuleParser::LoadRules(const std::wstring& path, std::vector<WindowRule>& rules, std::wstring& error) {
+    FILE* file = FileIO::Open(path, "rb");
+    if (!file) {
+        error = L"Cannot open " + path;
+        return false;
+    }
+
+    std::string bytes;
+    char buffer[16 * 1024];
+    size_t count;
+    while ((count = fread(buffer, 1, sizeof(buffer), file)) > 0) {
+        bytes.append(buffer, count);
+    }
+    bool failed = ferror(file) != 0;
+    fclose(file);
+    if (failed) {
+        error = L"Cannot read " + path;
+        return false;
+    }
+
+    size_t skip = bytes.compare(0, 3, "\xEF\xBB\xBF") == 0 ? 3 : 0;
+    return ParseRules(FileIO::FromUtf8(bytes.data() + skip, bytes.size() - skip), rules, error);
+}
+
+void RuleEffects::Clear() {
+    placement.Clear();
+    actions.clear();
+    evaluated = 0;
+    candidates = 0;
+    fired = 0;
+}
+
+void RuleEngine::SetRules(std::vector<WindowRule> rules) {
+    m_rules = std::move(rules);
+    Compile();
+    m_windows.clear();
+}
+
+void RuleEngine::Compile() {
+    for (auto& index : m_strings) {
+        index.clear();
+    }
+    m_hwnds.clear();
+    m_pids.clear();
+    m_unindexed.clear();
+    m_usedInputs = 0;
+    m_ruleStamp.assign(m_rules.size(), 0);
+    m_evaluation = 0;
+
+    for (uint32_t i = 0; i < m_rules.size(); i++) {
+        // Index each rule under its most selective exact term:
+        // hwnd, then class, process, pid, title
+        const QueryTerm* best = nullptr;
+        int bestRank = INT32_MAX;
+        for (const QueryTerm& term : m_rules[i].query.Terms()) {
+            m_usedInputs |= FIELD_INPUTS[term.field];
+            if (term.negate) continue;
+
+            int rank = INT32_MAX;
+            if (term.field == QUERY_HWND && term.compare == QUERY_EQUAL) {
+                rank = 0;
+            } else if (term.field == QUERY_CLASS || term.field == QUERY_PROCESS || term.field == QUERY_TITLE) {
+                if (std::all_of(term.patterns.begin(), term.patterns.end(), IsLiteral)) {
+                    rank = term.field == QUERY_CLASS ? 1 : term.field == QUERY_PROCESS ? 2 : 4;
+                }
+            } else if (term.field == QUERY_PID && term.compare == QUERY_EQUAL) {
+                rank = 3;
+            }
+            if (rank < bestRank) {
+                best = &term;
+                bestRank = rank;
+            }
+        }
+
+        if (!best) {
+            m_unindexed.push_back(i);
+        } else if (best->field == QUERY_HWND) {
+            m_hwnds[best->number].push_back(i);
+        } else if (best->field == QUERY_PID) {
+            m_pids[best->number].push_back(i);
+        } else {
+            int kind = best->field == QUERY_CLASS ? INDEX_CLASS : best->field == QUERY_PROCESS ? INDEX_PROCESS : INDEX_TITLE;
+            for (const std::wstring& pattern : best->patterns) {
+                std::vector<uint32_t>& bucket = m_strings[kind][pattern];
+                if (bucket.empty() || bucket.back() != i) {
+                    bucket.push_back(i);
+                }
+            }
+        }
+    }
+}
+
+uint64_t RuleEngine::Identity(const WindowInfo& win) {
+    return Mix(Mix(0, win.processId), HashText(win.className));
+}
+
+uint64_t RuleEngine::Fingerprint(const WindowInfo& win, uint64_t identity) const {
+    uint64_t hash = identity;
+    uint32_t used = m_usedInputs;
+    if (used & InputBit(INPUT_TITLE)) {
+        hash = Mix(hash, HashText(win.title));
+    } else if (used & InputBit(INPUT_UNTITLED)) {
+        hash = Mix(hash, win.title.empty() ? 1 : 0);
+    }
+    if (used & InputBit(INPUT_PROCESS)) hash = Mix(hash, HashText(win.processName));
+    if (used & InputBit(INPUT_PATH)) hash = Mix(hash, HashText(win.processPath));
+    if (used & InputBit(INPUT_THREAD)) hash = Mix(hash, win.threadId);
+    if (used & InputBit(INPUT_ZORDER)) hash = Mix(hash, static_cast<uint64_t>(static_cast<int64_t>(win.zOrder)));
+
+    // Only the flags some predicate reads, so others can change freely
+    uint32_t flags =
+        (win.isVisible ? InputBit(INPUT_VISIBLE) : 0) | (win.isEnabled ? InputBit(INPUT_ENABLED) : 0) |
+        (win.isMinimized ? InputBit(INPUT_MINIMIZED) : 0) | (win.isMaximized ? InputBit(INPUT_MAXIMIZED) : 0) |
+        (win.isTopMost ? InputBit(INPUT_TOPMOST) : 0) | (win.isLayered ? InputBit(INPUT_LAYERED) : 0) |
+        (win.isCloaked ? InputBit(INPUT_CLOAKED) : 0) | (win.isHung ? InputBit(INPUT_HUNG) : 0) |
+        (win.isUWP ? InputBit(INPUT_UWP) : 0);
+    hash = Mix(hash, flags & used);
+    if (used & InputBit(INPUT_EXSTYLE)) hash = Mix(hash, static_cast<uint32_t>(win.exStyle));
+    return hash;
+}
+
+void RuleEngine::AddCandidates(const std::vector<uint32_t>* rules, std::vector<uint32_t>& candidates) {
+    if (!rules) {
+        return;
+    }
+    for (uint32_t rule : *rules) {
+        if (m_ruleStamp[rule] != m_evaluation) {
+            m_ruleStamp[rule] = m_evaluation;
+            candidates.push_back(rule);
+        }
+    }
+}
+
+void RuleEngine::Evaluate(const WindowInfo& win, std::vector<uint32_t>& matched) {
+    if (++m_evaluation == 0) {
+        std::fill(m_ruleStamp.begin(), m_ruleStamp.end(), 0);
+        m_evaluation = 1;
+    }
+
+    m_candidates.clear();
+    AddCandidates(&m_unindexed, m_candidates);
+
+    const std::wstring* texts[INDEX_KIND_COUNT] = { &win.className, &win.processName, &win.title };
+    for (int kind = 0; kind < INDEX_KIND_COUNT; kind++) {
+        if (m_strings[kind].empty()) continue;
+        FoldInto(*texts[kind], m_folded);
+        auto it = m_strings[kind].find(m_folded);
+        AddCandidates(it == m_strings[kind].end() ? nullptr : &it->second, m_candidates);
+    }
+    if (!m_hwnds.empty()) {
+        auto it = m_hwnds.find(static_cast<uint64_t>(reinterpret_cast<uintptr_t>(win.hwnd)));
+        AddCandidates(it == m_hwnds.end() ? nullptr : &it->second, m_candidates);
+    }
+    if (!m_pids.empty()) {
+        auto it = m_pids.find(win.processId);
+        AddCandidates(it == m_pids.end() ? nullptr : &it->second, m_candidates);
+    }
+
+    std::sort(m_candidates.begin(), m_candidates.end());
+    matched.clear();
+    for (uint32_t rule : m_candidates) {
+        if (m_rules[rule].query.Matches(win)) {
+            matched.push_back(rule);
+        }
+    }
+}
+
+void RuleEngine::Update(const std::vector<WindowInfo>& windows, RuleEffects& effects) {
+    if (m_rules.empty()) {
+        return;
+    }
+
+    if (++m_generation == 0) {
+        m_windows.clear();
+        m_generation = 1;
+    }
+
+    std::vector<uint32_t> matched;
+    for (const WindowInfo& win : windows) {
+        WindowState& state = m_windows[win.hwnd];
+        uint64_t identity = Identity(win);
+        uint64_t fingerprint = Fingerprint(win, identity);
+        bool known = state.generation != 0;
+        if (state.generation == m_generation || (known && state.fingerprint == fingerprint)) {
+            state.generation = m_generation;
+            continue;
+        }
+        if (known && state.identity != identity) {
+            // A recycled handle: another process or class is a new window
+            state.matched.clear();
+        }
+
+        effects.evaluated++;
+        Evaluate(win, matched);
+        effects.candidates += m_candidates.size();
+
+        // Fire the rules the window did not match before, in file order
+        auto before = state.matched.begin();
+        for (uint32_t rule : matched) {
+            while (before != state.matched.end() && *before < rule) ++before;
+            if (before == state.matched.end() || *before != rule) {
+                Fire(win, m_rules[rule], effects);
+                effects.fired++;
+            }
+        }
+
+        state.matched.swap(matched);
+        state.identity = identity;
+        state.fingerprint = fingerprint;
+        state.generation = m_generation;
+    }
+
+    // Forget windows that are gone, so a recycled handle starts fresh
+    if (m_windows.size() > windows.size()) {
+        for (auto it = m_windows.begin(); it != m_windows.end();) {
+            if (it->second.generation != m_generation) {
+                it = m_windows.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+}
+
+void RuleEngine::Fire(const WindowInfo& win, const WindowRule& rule, RuleEffects& effects) const {
+    for (const RuleAction& action : rule.actions) {
+        switch (action.type) {
+        case RULE_MOVE:
+            effects.placement.Move(win, action.x, action.y);
+            break;
+        case RULE_SIZE:
+            effects.placement.Resize(win, action.x, action.y);
+            break;
+        case RULE_ONSCREEN: {
+            RECT bounds;
+            if (!win.isMinimized && OnScreenBounds(win.rect, bounds)) {
+                effects.placement.Move(win, bounds.left, bounds.top);
+            }
+            break;
+        }
+        case RULE_TOPMOST:
+            effects.placement.SetZOrder(win, HWND_TOPMOST);
+            break;
+        case RULE_NOTOPMOST:
+            effects.placement.SetZOrder(win, HWND_NOTOPMOST);
+            break;
+        default:
+            effects.actions.push_back({ win.hwnd, &action });
+            break;
+        }
+    }
+}
+
+bool RuleEngine::OnScreenBounds(const RECT& rect, RECT& bounds) const {
+    if (m_workAreas.empty()) {
+        return false;
+    }
+
+    // The area holding most of the window, or else the one nearest to it
+    const RECT* best = &m_workAreas[0];
+    int64_t bestOverlap = 0;
+    int64_t bestDistance = INT64_MAX;
+    int64_t cx = (static_cast<int64_t>(rect.left) + rect.right) / 2;
+    int64_t cy = (static_cast<int64_t>(rect.top) + rect.bottom) / 2;
+    for (const RECT& area : m_workAreas) {
+        int64_t w = std::min<int64_t>(rect.right, area.right) - std::max<int64_t>(rect.left, area.left);
+        int64_t h = std::min<int64_t>(rect.bottom, area.bottom) - std::max<int64_t>(rect.top, area.top);
+        int64_t overlap = (w > 0 && h > 0) ? w * h : 0;
+        int64_t dx = cx - std::max<int64_t>(area.left, std::min<int64_t>(cx, area.right));
+        int64_t dy = cy - std::max<int64_t>(area.top, std::min<int64_t>(cy, area.bottom));
+        int64_t distance = dx * dx + dy * dy;
+        if (overlap > bestOverlap || (bestOverlap == 0 && overlap == 0 && distance < bestDistance)) {
+            best = &area;
+            bestOverlap = overlap;
+            bestDistance = distance;
+        }
+    }
+
+    // Pull the window inside; one larger than the area keeps its top-left in
+    LONG width = rect.right - rect.left;
+    LONG height = rect.bottom - rect.top;
+    LONG left = std::max(best->left, std::min(rect.left, best->right - width));
+    LONG top = std::max(best->top, std::min(rect.top, best->bottom - height));
+    if (left == rect.left && top == rect.top) {
+        return false;
+    }
+    bounds = { left, top, left + width, top + height };
+    return true;
+}
+
+#ifdef _WIN32
+size_t RuleActions::Apply(const RuleEffects& effects) {
+    Win32PlacementBackend backend;
+    PlacementResult result;
+    PlacementTransaction::Apply(effects.placement, backend, result);
+    size_t failures = result.failed.size();
+
+    // Asynchronous where possible: the rules run on the UI thread, and any
+    // target may be hung
+    for (const RuleEffects::Action& item : effects.actions) {
+        HWND hwnd = item.hwnd;
+        const RuleAction& action = *item.action;
+        bool ok = true;
+        switch (action.type) {
+        case RULE_SHOW: ok = ShowWindowAsync(hwnd, SW_SHOWNOACTIVATE) != FALSE; break;
+        case RULE_HIDE: ok = ShowWindowAsync(hwnd, SW_HIDE) != FALSE; break;
+        case RULE_MINIMIZE: ok = ShowWindowAsync(hwnd, SW_MINIMIZE) != FALSE; break;
+        case RULE_MAXIMIZE: ok = ShowWindowAsync(hwnd, SW_MAXIMIZE) != FALSE; break;
+        case RULE_RESTORE: ok = ShowWindowAsync(hwnd, SW_RESTORE) != FALSE; break;
+        case RULE_ENABLE: EnableWindow(hwnd, TRUE); ok = IsWindow(hwnd) != FALSE; break;
+        case RULE_DISABLE: EnableWindow(hwnd, FALSE); ok = IsWindow(hwnd) != FALSE; break;
+        case RULE_ALPHA: {
+            // As the Modify tab does: fully opaque drops the layered style
+            LONG_PTR exStyle = GetWindowLongPtrW(hwnd, GWL_EXSTYLE);
+            if (action.x == 255) {
+                ok = SetWindowLongPtrW(hwnd, GWL_EXSTYLE, exStyle & ~WS_EX_LAYERED) != 0 || IsWindow(hwnd);
+            } else {
+                if (!(exStyle & WS_EX_LAYERED)) {
+                    SetWindowLongPtrW(hwnd, GWL_EXSTYLE, exStyle | WS_EX_LAYERED);
+                }
+                ok = SetLayeredWindowAttributes(hwnd, 0, static_cast<BYTE>(action.x), LWA_ALPHA) != FALSE;
+            }
+            break;
+        }
+        case RULE_TITLE: {
+            DWORD_PTR unused = 0;
+            ok = SendMessageTimeoutW(hwnd, WM_SETTEXT, 0, reinterpret_cast<LPARAM>(action.text.c_str()),
+                SMTO_ABORTIFHUNG, 200, &unused) != 0;
+            break;
+        }
+        }
+        if (!ok) {
+            failures++;
+        }
+    }
+    return failures;
+}
+
+static BOOL CALLBACK CollectWorkArea(HMONITOR monitor, HDC, LPRECT, LPARAM lParam) {
+    auto* areas = reinterpret_cast<std::vector<RECT>*>(lParam);
+    MONITORINFO info = { sizeof(info) };
+    if (GetMonitorInfoW(monitor, &info)) {
+        areas->push_back(info.rcWork);
+    }
+    return TRUE;
+}
+
+std::vector<RECT> RuleActions::MonitorWorkAreas() {
+    std::vector<RECT> areas;
+    EnumDisplayMonitors(nullptr, nullptr, CollectWorkArea, reinterpret_cast<LPARAM>(&areas));
+    return areas;
+}
+#endif
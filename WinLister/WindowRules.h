@@ -0,0 +1,137 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "WindowInfo.h"
+#include "WindowQuery.h"
+#include "WindowBatch.h"
+
+enum RuleActionType {
+    RULE_MOVE = 0,      // move=X,Y
+    RULE_SIZE,          // size=W,H
+    RULE_ONSCREEN,      // onscreen: pull inside the nearest work area
+    RULE_TOPMOST,       // topmost / notopmost
+    RULE_NOTOPMOST,
+    RULE_SHOW,          // show / hide
+    RULE_HIDE,
+    RULE_ENABLE,        // enable / disable
+    RULE_DISABLE,
+    RULE_MINIMIZE,      // minimize / maximize / restore
+    RULE_MAXIMIZE,
+    RULE_RESTORE,
+    RULE_ALPHA,         // alpha=0..255
+    RULE_TITLE          // title=text
+};
+
+struct RuleAction {
+    int type = RULE_MOVE;
+    int x = 0;          // position, size or alpha
+    int y = 0;
+    std::wstring text;
+};
+
+struct WindowRule {
+    WindowQuery query;
+    std::vector<RuleAction> actions;
+    int line = 0;       // in the rules file, for messages
+};
+
+// Rules file: one rule per line, a window query (see WindowQuery.h), "=>",
+// then actions separated by spaces. Blank lines and lines starting with '#'
+// are skipped.
+//
+//   class:ToolWindowClass => topmost
+//   process:overlay.exe title:"HUD*" => alpha=200
+//   class:#32770 process:setup.exe => onscreen
+class RuleParser {
+public:
+    static bool ParseRule(const std::wstring& line, WindowRule& rule, std::wstring& error);
+    static bool ParseRules(const std::wstring& text, std::vector<WindowRule>& rules, std::wstring& error);
+    static bool LoadRules(const std::wstring& path, std::vector<WindowRule>& rules, std::wstring& error);
+};
+
+// Actions owed after an update. Moves, resizes and z-order changes are
+// planned together so they can go out as one batch; the rest are listed in
+// rule order.
+struct RuleEffects {
+    struct Action {
+        HWND hwnd;
+        const RuleAction* action;   // owned by the engine's rules
+    };
+
+    PlacementPlan placement;
+    std::vector<Action> actions;
+    size_t evaluated = 0;   // windows tested, i.e. new or changed
+    size_t candidates = 0;  // rule tests the index let through
+    size_t fired = 0;       // rules newly matched
+
+    void Clear();
+};
+
+// Applies rules as windows come and change. A rule fires when a window
+// starts matching it: a new window, or a change that makes it match; it
+// fires again only after the window has stopped matching. Only windows that
+// appeared or changed in a field some rule tests are evaluated, and rules
+// are compiled into one index: a rule with an exact hwnd, class, process,
+// pid or title term is only tested against windows with that value.
+class RuleEngine {
+public:
+    // Every current window is evaluated again on the next update
+    void SetRules(std::vector<WindowRule> rules);
+    size_t RuleCount() const { return m_rules.size(); }
+
+    // Monitor work areas, for onscreen
+    void SetWorkAreas(const std::vector<RECT>& areas) { m_workAreas = areas; }
+
+    // Appends the actions owed for this snapshot to effects
+    void Update(const std::vector<WindowInfo>& windows, RuleEffects& effects);
+
+    size_t IndexedRules() const { return m_rules.size() - m_unindexed.size(); }
+
+private:
+    enum IndexKind { INDEX_CLASS = 0, INDEX_PROCESS, INDEX_TITLE, INDEX_KIND_COUNT };
+
+    struct WindowState {
+        uint64_t identity = 0;      // process and class
+        uint64_t fingerprint = 0;   // identity and every input a rule reads
+        uint32_t generation = 0;
+        std::vector<uint32_t> matched;  // sorted rule indexes
+    };
+
+    void Compile();
+    static uint64_t Identity(const WindowInfo& win);
+    uint64_t Fingerprint(const WindowInfo& win, uint64_t identity) const;
+    void Evaluate(const WindowInfo& win, std::vector<uint32_t>& matched);
+    void AddCandidates(const std::vector<uint32_t>* rules, std::vector<uint32_t>& candidates);
+    void Fire(const WindowInfo& win, const WindowRule& rule, RuleEffects& effects) const;
+    bool OnScreenBounds(const RECT& rect, RECT& bounds) const;
+
+    std::vector<WindowRule> m_rules;
+    std::vector<RECT> m_workAreas;
+
+    // Compiled index: folded string or number -> rule indexes
+    std::unordered_map<std::wstring, std::vector<uint32_t>> m_strings[INDEX_KIND_COUNT];
+    std::unordered_map<uint64_t, std::vector<uint32_t>> m_hwnds;
+    std::unordered_map<uint64_t, std::vector<uint32_t>> m_pids;
+    std::vector<uint32_t> m_unindexed;
+    uint32_t m_usedInputs = 0;      // window inputs any rule's predicates read
+
+    std::unordered_map<HWND, WindowState> m_windows;
+    uint32_t m_generation = 0;
+    std::vector<uint32_t> m_ruleStamp;  // per rule, the evaluation that last collected it
+    uint32_t m_evaluation = 0;
+    std::vector<uint32_t> m_candidates;
+    std::wstring m_folded;
+};
+
+#ifdef _WIN32
+// Carries out effects: the placement plan as one transaction, then the other
+// actions one window at a time. Returns the number of windows that failed.
+class RuleActions {
+public:
+    static size_t Apply(const RuleEffects& effects);
+    static std::vector<RECT> MonitorWorkAreas();
+};
+#endif
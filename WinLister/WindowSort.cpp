@@ -0,0 +1,516 @@
+#include "WindowSort.h"
+#include <algorithm>
+#include <cwctype>
+
+// Number of code units packed into a collation prefix: 4 on Windows, where
+// wchar_t is UTF-16, and 3 of 21 bits (all of Unicode) where it is UTF-32
+static const int PREFIX_UNIT_BITS = sizeof(wchar_t) == 2 ? 16 : 21;
+static const int PREFIX_UNITS = 64 / PREFIX_UNIT_BITS;
+
+// Below this size a comparison sort beats the radix passes
+static const size_t RADIX_THRESHOLD = 64;
+
+// Below this size ranking every field of a multi-key spec costs more than
+// comparing rows field by field
+static const size_t COMPOSITE_THRESHOLD = 256;
+
+// 64-bit finalizer from MurmurHash3, so neighbouring handles spread out
+static size_t HashHandle(HWND hwnd) {
+    uint64_t key = reinterpret_cast<uintptr_t>(hwnd);
+    key ^= key >> 33;
+    key *= 0xff51afd7ed558ccdULL;
+    key ^= key >> 33;
+    key *= 0xc4ceb9fe1a85ec53ULL;
+    key ^= key >> 33;
+    return static_cast<size_t>(key);
+}
+
+static uint64_t BiasSigned(int64_t value) {
+    return static_cast<uint64_t>(value) ^ 0x8000000000000000ULL;
+}
+
+static uint64_t BiasSigned32(LONG value) {
+    return static_cast<uint32_t>(value) ^ 0x80000000U;
+}
+
+// Clamped to 28 bits, about 134 million pixels either way
+static uint64_t BiasSigned28(LONG value) {
+    const LONG limit = (1 << 27) - 1;
+    return static_cast<uint64_t>(std::min(std::max(value, -limit), limit) + limit);
+}
+
+static const wchar_t* const FIELD_NAMES[SORT_FIELD_COUNT] = {
+    L"hwnd", L"title", L"class", L"process", L"pid", L"visible", L"position", L"size", L"exposed", L"raised", L"monitor", L"zorder"
+};
+
+const wchar_t* SortSpec::FieldName(int column) {
+    return (column >= 0 && column < SORT_FIELD_COUNT) ? FIELD_NAMES[column] : L"";
+}
+
+const SortKey* SortSpec::Find(int column) const {
+    for (const auto& key : keys) {
+        if (key.column == column) {
+            return &key;
+        }
+    }
+    return nullptr;
+}
+
+std::wstring SortSpec::ToString() const {
+    std::wstring result;
+    for (const auto& key : keys) {
+        if (!result.empty()) {
+            result += L',';
+        }
+        if (!key.ascending) {
+            result += L'-';
+        }
+        result += FieldName(key.column);
+    }
+    return result;
+}
+
+bool SortSpec::Parse(const std::wstring& text, SortSpec& spec) {
+    SortSpec parsed;
+    size_t pos = 0;
+    while (pos <= text.size()) {
+        size_t end = text.find(L',', pos);
+        if (end == std::wstring::npos) {
+            end = text.size();
+        }
+        std::wstring name = text.substr(pos, end - pos);
+        pos = end + 1;
+
+        SortKey key = { -1, true };
+        if (!name.empty() && (name[0] == L'-' || name[0] == L'+')) {
+            key.ascending = (name[0] == L'+');
+            name.erase(0, 1);
+        }
+        std::transform(name.begin(), name.end(), name.begin(), ::towlower);
+        if (name.empty() && end == text.size() && parsed.keys.empty() && key.ascending) {
+            break;  // Empty spec
+        }
+        for (int i = 0; i < SORT_FIELD_COUNT; i++) {
+            if (name == FIELD_NAMES[i]) {
+                key.column = i;
+                break;
+            }
+        }
+        if (key.column < 0 || parsed.Find(key.column)) {
+            return false;
+        }
+        parsed.keys.push_back(key);
+    }
+    spec = parsed;
+    return true;
+}
+
+bool WindowSorter::IsStringColumn(int column) {
+    return column == COLUMN_TITLE || column == COLUMN_CLASS || column == COLUMN_PROCESS;
+}
+
+const std::wstring& WindowSorter::StringKey(const WindowInfo& win, int column) {
+    switch (column) {
+    case COLUMN_CLASS:
+        return win.className;
+    case COLUMN_PROCESS:
+        return win.processName;
+    default:
+        return win.title;
+    }
+}
+
+uint64_t WindowSorter::NumericKey(const WindowInfo& win, int column) {
+    switch (column) {
+    case COLUMN_HWND:
+        return static_cast<uint64_t>(reinterpret_cast<uintptr_t>(win.hwnd));
+    case COLUMN_PID:
+        return win.processId;
+    case COLUMN_VISIBLE:
+        // Visible rows sort first in ascending order
+        return win.isVisible ? 0 : 1;
+    case COLUMN_POSITION:
+        // Left, then top
+        return (BiasSigned32(win.rect.left) << 32) | BiasSigned32(win.rect.top);
+    case COLUMN_SIZE: {
+        int64_t width = win.rect.right - win.rect.left;
+        int64_t height = win.rect.bottom - win.rect.top;
+        return BiasSigned(width * height);
+    }
+    case COLUMN_EXPOSED:
+        // Windows that are not shown sort before fully covered ones
+        return static_cast<uint64_t>(static_cast<int64_t>(win.exposed) + 1);
+    case COLUMN_RAISED:
+        return win.raisedAt;
+    case COLUMN_MONITOR: {
+        // Monitor, then logical left and top on it; windows on no monitor
+        // sort first, by their physical position
+        uint64_t monitor = static_cast<uint64_t>(std::min(win.monitor + 1, 255));
+        return (monitor << 56) | (BiasSigned28(win.logicalRect.left) << 28) | BiasSigned28(win.logicalRect.top);
+    }
+    case SORT_FIELD_ZORDER:
+        return BiasSigned32(win.zOrder);
+    }
+    return 0;
+}
+
+uint64_t WindowSorter::CollationPrefix(const std::wstring& text, size_t offset) {
+    // Case-folded code units packed most significant first, so comparing two
+    // prefixes orders the same way CompareFolded does. Short strings pad with zero,
+    // which sorts before any character just like the terminator does.
+    uint64_t key = 0;
+    for (int i = 0; i < PREFIX_UNITS; i++) {
+        uint64_t unit = 0;
+        if (offset + i < text.size()) {
+            unit = static_cast<uint64_t>(towlower(text[offset + i])) & ((1ULL << PREFIX_UNIT_BITS) - 1);
+        }
+        key = (key << PREFIX_UNIT_BITS) | unit;
+    }
+    return key;
+}
+
+int WindowSorter::CompareFolded(const wchar_t* a, const wchar_t* b) {
+    // Code units compared after towlower, as _wcsicmp does, on any platform
+    for (;; a++, b++) {
+        wint_t x = towlower(*a);
+        wint_t y = towlower(*b);
+        if (x != y) {
+            return x < y ? -1 : 1;
+        }
+        if (x == 0) {
+            return 0;
+        }
+    }
+}
+
+int WindowSorter::Compare(const WindowInfo& a, const WindowInfo& b, int column) {
+    if (IsStringColumn(column)) {
+        return CompareFolded(StringKey(a, column).c_str(), StringKey(b, column).c_str());
+    }
+    uint64_t keyA = NumericKey(a, column);
+    uint64_t keyB = NumericKey(b, column);
+    return (keyA < keyB) ? -1 : (keyA > keyB) ? 1 : 0;
+}
+
+int WindowSorter::Compare(const WindowInfo& a, const WindowInfo& b, const SortSpec& spec) {
+    for (const auto& key : spec.keys) {
+        int cmp = Compare(a, b, key.column);
+        if (cmp != 0) {
+            return key.ascending ? cmp : -cmp;
+        }
+    }
+    return 0;
+}
+
+void WindowSorter::RadixSort(std::vector<KeyedIndex>& items) {
+    if (items.size() < RADIX_THRESHOLD) {
+        std::stable_sort(items.begin(), items.end(),
+            [](const KeyedIndex& a, const KeyedIndex& b) { return a.key < b.key; });
+        return;
+    }
+
+    // Find which bytes actually vary so constant high bytes cost no pass
+    uint64_t varying = 0;
+    for (const auto& item : items) {
+        varying |= item.key ^ items[0].key;
+    }
+
+    std::vector<KeyedIndex> scratch(items.size());
+    for (int shift = 0; shift < 64; shift += 8) {
+        if (((varying >> shift) & 0xFF) == 0) {
+            continue;
+        }
+
+        size_t counts[257] = {};
+        for (const auto& item : items) {
+            counts[((item.key >> shift) & 0xFF) + 1]++;
+        }
+        for (int i = 0; i < 256; i++) {
+            counts[i + 1] += counts[i];
+        }
+        for (const auto& item : items) {
+            scratch[counts[(item.key >> shift) & 0xFF]++] = item;
+        }
+        items.swap(scratch);
+    }
+}
+
+std::vector<uint32_t> WindowSorter::SortedOrder(const std::vector<WindowInfo>& windows, int column, bool ascending) {
+    std::vector<KeyedIndex> items(windows.size());
+    bool isString = IsStringColumn(column);
+
+    for (size_t i = 0; i < windows.size(); i++) {
+        uint64_t key = isString
+            ? CollationPrefix(StringKey(windows[i], column))
+            : NumericKey(windows[i], column);
+        items[i].key = ascending ? key : ~key;
+        items[i].index = static_cast<uint32_t>(i);
+    }
+
+    RadixSort(items);
+
+    if (isString) {
+        SettleTies(windows, column, ascending, items);
+    }
+
+    std::vector<uint32_t> order(items.size());
+    for (size_t i = 0; i < items.size(); i++) {
+        order[i] = items[i].index;
+    }
+    return order;
+}
+
+void WindowSorter::SettleTies(const std::vector<WindowInfo>& windows, int column, bool ascending,
+    std::vector<KeyedIndex>& items) {
+    // Prefixes only order strings up to their first few characters. Each run
+    // of tied prefixes is keyed on the next few and radix-sorted again, until
+    // the run's strings differ or all of them have ended, which makes them
+    // equal; equal rows keep their order.
+    struct Run {
+        size_t first;
+        size_t last;
+        size_t offset;
+    };
+    std::vector<Run> pending = { { 0, items.size(), 0 } };
+    std::vector<KeyedIndex> run;
+    while (!pending.empty()) {
+        Run range = pending.back();
+        pending.pop_back();
+        size_t next = range.offset + PREFIX_UNITS;
+        size_t runStart = range.first;
+        while (runStart < range.last) {
+            size_t runEnd = runStart + 1;
+            bool longer = StringKey(windows[items[runStart].index], column).size() > next;
+            while (runEnd < range.last && items[runEnd].key == items[runStart].key) {
+                longer = longer || StringKey(windows[items[runEnd].index], column).size() > next;
+                runEnd++;
+            }
+            if (runEnd - runStart > 1 && longer) {
+                run.assign(items.begin() + runStart, items.begin() + runEnd);
+                for (auto& item : run) {
+                    uint64_t key = CollationPrefix(StringKey(windows[item.index], column), next);
+                    item.key = ascending ? key : ~key;
+                }
+                RadixSort(run);
+                std::copy(run.begin(), run.end(), items.begin() + runStart);
+                pending.push_back({ runStart, runEnd, next });
+            }
+            runStart = runEnd;
+        }
+    }
+}
+
+std::vector<uint32_t> WindowSorter::DenseRanks(const std::vector<WindowInfo>& windows, int column, uint32_t& maxRank) {
+    // Rank 0 is the smallest value; equal values share a rank
+    std::vector<uint32_t> order = SortedOrder(windows, column, true);
+    std::vector<uint32_t> ranks(windows.size());
+    uint32_t rank = 0;
+    for (size_t i = 0; i < order.size(); i++) {
+        if (i > 0 && Compare(windows[order[i - 1]], windows[order[i]], column) != 0) {
+            rank++;
+        }
+        ranks[order[i]] = rank;
+    }
+    maxRank = rank;
+    return ranks;
+}
+
+static int BitWidth(uint32_t value) {
+    int bits = 0;
+    while (value) {
+        bits++;
+        value >>= 1;
+    }
+    return bits;
+}
+
+std::vector<uint32_t> WindowSorter::SortedOrder(const std::vector<WindowInfo>& windows, const SortSpec& spec) {
+    if (spec.keys.empty()) {
+        std::vector<uint32_t> order(windows.size());
+        for (size_t i = 0; i < order.size(); i++) {
+            order[i] = static_cast<uint32_t>(i);
+        }
+        return order;
+    }
+    if (spec.keys.size() == 1) {
+        return SortedOrder(windows, spec.keys[0].column, spec.keys[0].ascending);
+    }
+
+    std::vector<uint32_t> order;
+    order.reserve(windows.size());
+    if (windows.size() < COMPOSITE_THRESHOLD) {
+        for (size_t i = 0; i < windows.size(); i++) {
+            order.push_back(static_cast<uint32_t>(i));
+        }
+        std::stable_sort(order.begin(), order.end(),
+            [&](uint32_t a, uint32_t b) { return Compare(windows[a], windows[b], spec) < 0; });
+        return order;
+    }
+
+    // Replace every field by its dense rank, flipped for descending keys
+    std::vector<std::vector<uint32_t>> ranks(spec.keys.size());
+    std::vector<int> widths(spec.keys.size());
+    int totalBits = 0;
+    for (size_t k = 0; k < spec.keys.size(); k++) {
+        uint32_t maxRank = 0;
+        ranks[k] = DenseRanks(windows, spec.keys[k].column, maxRank);
+        if (!spec.keys[k].ascending) {
+            for (auto& rank : ranks[k]) {
+                rank = maxRank - rank;
+            }
+        }
+        widths[k] = BitWidth(maxRank);
+        totalBits += widths[k];
+    }
+
+    if (totalBits <= 64) {
+        // One composite key, first field in the most significant bits
+        std::vector<KeyedIndex> items(windows.size());
+        for (size_t i = 0; i < windows.size(); i++) {
+            uint64_t key = 0;
+            for (size_t k = 0; k < spec.keys.size(); k++) {
+                key = widths[k] ? ((key << widths[k]) | ranks[k][i]) : key;
+            }
+            items[i].key = key;
+            items[i].index = static_cast<uint32_t>(i);
+        }
+        RadixSort(items);
+        for (const auto& item : items) {
+            order.push_back(item.index);
+        }
+        return order;
+    }
+
+    // Too many distinct values to pack; compare the integer ranks in turn
+    for (size_t i = 0; i < windows.size(); i++) {
+        order.push_back(static_cast<uint32_t>(i));
+    }
+    std::stable_sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) {
+        for (const auto& fieldRanks : ranks) {
+            if (fieldRanks[a] != fieldRanks[b]) {
+                return fieldRanks[a] < fieldRanks[b];
+            }
+        }
+        return false;
+    });
+    return order;
+}
+
+void WindowSorter::Sort(std::vector<WindowInfo>& windows, const SortSpec& spec) {
+    std::vector<uint32_t> order = SortedOrder(windows, spec);
+
+    std::vector<WindowInfo> sorted;
+    sorted.reserve(windows.size());
+    for (uint32_t index : order) {
+        sorted.push_back(std::move(windows[index]));
+    }
+    windows.swap(sorted);
+}
+
+bool WindowSorter::SameKey(const WindowInfo& a, const WindowInfo& b, const SortSpec& spec) {
+    // Identical strings are equal without folding them
+    for (const auto& key : spec.keys) {
+        if (IsStringColumn(key.column)) {
+            const std::wstring& textA = StringKey(a, key.column);
+            const std::wstring& textB = StringKey(b, key.column);
+            if (textA != textB && CompareFolded(textA.c_str(), textB.c_str()) != 0) {
+                return false;
+            }
+        } else if (NumericKey(a, key.column) != NumericKey(b, key.column)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool WindowSorter::Precedes(const WindowInfo& a, const WindowInfo& b, const SortSpec& spec) {
+    // Equal keys keep z-order, as the stable sorts in SortedOrder do
+    int cmp = Compare(a, b, spec);
+    if (cmp != 0) {
+        return cmp < 0;
+    }
+    return a.zOrder < b.zOrder;
+}
+
+void WindowSorter::Update(std::vector<WindowInfo>& sorted, std::vector<WindowInfo>&& fresh, const SortSpec& spec) {
+    // Open-addressed handle index into fresh, at most half full
+    const uint32_t EMPTY = UINT32_MAX;
+    size_t slots = 16;
+    while (slots < fresh.size() * 2) {
+        slots *= 2;
+    }
+    size_t mask = slots - 1;
+    std::vector<uint32_t> freshIndex(slots, EMPTY);
+    for (uint32_t i = 0; i < fresh.size(); i++) {
+        size_t slot = HashHandle(fresh[i].hwnd) & mask;
+        while (freshIndex[slot] != EMPTY) {
+            slot = (slot + 1) & mask;
+        }
+        freshIndex[slot] = i;
+    }
+
+    // Keep rows that still exist with an unchanged key. A row that now breaks
+    // the order (its z-order moved relative to an equal-keyed neighbour) is
+    // handled like a changed row. Kept rows are in key order already, so only
+    // a z-order inversion needs a compare.
+    std::vector<bool> placed(fresh.size(), false);
+    std::vector<uint32_t> kept;
+    kept.reserve(fresh.size());
+    for (const auto& old : sorted) {
+        size_t slot = HashHandle(old.hwnd) & mask;
+        while (freshIndex[slot] != EMPTY && fresh[freshIndex[slot]].hwnd != old.hwnd) {
+            slot = (slot + 1) & mask;
+        }
+        uint32_t index = freshIndex[slot];
+        if (index == EMPTY) {
+            continue;
+        }
+        const WindowInfo& current = fresh[index];
+        if (!SameKey(old, current, spec)) {
+            continue;
+        }
+        if (!kept.empty()) {
+            const WindowInfo& last = fresh[kept.back()];
+            if (last.zOrder >= current.zOrder && Compare(last, current, spec) == 0) {
+                continue;
+            }
+        }
+        placed[index] = true;
+        kept.push_back(index);
+    }
+
+    // New and changed rows, still in z-order. Past a small fraction of the
+    // list the batch is as much work as a full sort, so sort everything.
+    std::vector<uint32_t> batch;
+    for (uint32_t i = 0; i < fresh.size(); i++) {
+        if (!placed[i]) {
+            batch.push_back(i);
+        }
+    }
+    std::vector<uint32_t> order;
+    if (batch.size() > fresh.size() / 8) {
+        order = SortedOrder(fresh, spec);
+    } else {
+        std::sort(batch.begin(), batch.end(),
+            [&](uint32_t a, uint32_t b) { return Precedes(fresh[a], fresh[b], spec); });
+
+        // Each batch row is placed by binary search, so a small batch costs a
+        // few compares rather than one per kept row
+        order.reserve(fresh.size());
+        auto k = kept.begin();
+        for (uint32_t row : batch) {
+            auto at = std::partition_point(k, kept.end(),
+                [&](uint32_t keptRow) { return !Precedes(fresh[row], fresh[keptRow], spec); });
+            order.insert(order.end(), k, at);
+            order.push_back(row);
+            k = at;
+        }
+        order.insert(order.end(), k, kept.end());
+    }
+
+    // Rows are moved once, into the list's existing storage
+    sorted.resize(fresh.size());
+    for (size_t i = 0; i < order.size(); i++) {
+        sorted[i] = std::move(fresh[order[i]]);
+    }
+}
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "WindowInfo.h"
+
+// Main list view column indices, also used as sort columns
+enum ListColumn {
+    COLUMN_HWND = 0,
+    COLUMN_TITLE,
+    COLUMN_CLASS,
+    COLUMN_PROCESS,
+    COLUMN_PID,
+    COLUMN_VISIBLE,
+    COLUMN_POSITION,
+    COLUMN_SIZE,
+    COLUMN_EXPOSED,
+    COLUMN_RAISED,
+    COLUMN_MONITOR,
+    COLUMN_COUNT
+};
+
+// Fields that can be sorted on but have no list column of their own
+enum SortOnlyField {
+    SORT_FIELD_ZORDER = COLUMN_COUNT,
+    SORT_FIELD_COUNT
+};
+
+struct SortKey {
+    int column;
+    bool ascending;
+};
+
+// Ordered list of sort keys. The text form is a comma-separated list of field
+// names, each optionally prefixed with '-' for descending, e.g. "process,zorder"
+// or "-visible,size".
+struct SortSpec {
+    std::vector<SortKey> keys;
+
+    bool IsEmpty() const { return keys.empty(); }
+    const SortKey* Find(int column) const;
+    std::wstring ToString() const;
+    static bool Parse(const std::wstring& text, SortSpec& spec);
+    static const wchar_t* FieldName(int column);
+};
+
+// Sorts window snapshots by a sort spec. Keys are computed once per sort:
+// numeric fields become 64-bit integers ordered with an LSD radix sort, and
+// string fields are ordered by a packed case-folded prefix, and rows whose
+// prefixes tie are radix-sorted again on the next few characters.
+// Multi-key specs rank each field densely and, when the ranks fit, pack them
+// into one 64-bit composite key so the final order is a single radix pass.
+// Rows that compare equal keep their incoming (z-order) order.
+class WindowSorter {
+public:
+    static void Sort(std::vector<WindowInfo>& windows, const SortSpec& spec);
+    static std::vector<uint32_t> SortedOrder(const std::vector<WindowInfo>& windows, const SortSpec& spec);
+    static std::vector<uint32_t> SortedOrder(const std::vector<WindowInfo>& windows, int column, bool ascending);
+
+    // Brings an already sorted list up to date with a fresh snapshot (in
+    // z-order) without re-sorting it: rows that are gone are erased, rows
+    // whose key is unchanged stay in place, and new or changed rows are sorted
+    // as a small batch and merged in; a large batch falls back to a full
+    // sort. Rows are moved once, into the list's storage. The result equals
+    // a full Sort.
+    static void Update(std::vector<WindowInfo>& sorted, std::vector<WindowInfo>&& fresh, const SortSpec& spec);
+
+    // Three-way compare of two rows by a field, matching the sorted order
+    static int Compare(const WindowInfo& a, const WindowInfo& b, int column);
+    // Three-way compare by a whole spec, directions applied
+    static int Compare(const WindowInfo& a, const WindowInfo& b, const SortSpec& spec);
+
+    // Case-insensitive compare of folded code units; the order collation
+    // prefixes follow
+    static int CompareFolded(const wchar_t* a, const wchar_t* b);
+
+    static bool IsStringColumn(int column);
+    static uint64_t NumericKey(const WindowInfo& win, int column);
+    // Packed folded code units from offset on
+    static uint64_t CollationPrefix(const std::wstring& text, size_t offset = 0);
+    static const std::wstring& StringKey(const WindowInfo& win, int column);
+
+private:
+    static bool Precedes(const WindowInfo& a, const WindowInfo& b, const SortSpec& spec);
+    static bool SameKey(const WindowInfo& a, const WindowInfo& b, const SortSpec& spec);
+    static std::vector<uint32_t> DenseRanks(const std::vector<WindowInfo>& windows, int column, uint32_t& maxRank);
+
+    struct KeyedIndex {
+        uint64_t key;
+        uint32_t index;
+    };
+
+    static void RadixSort(std::vector<KeyedIndex>& items);
+    static void SettleTies(const std::vector<WindowInfo>& windows, int column, bool ascending,
+        std::vector<KeyedIndex>& items);
+};
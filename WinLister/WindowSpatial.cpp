@@ -0,0 +1,220 @@
+#include "WindowSpatial.h"
+#include <algorithm>
+#include <cmath>
+#include <queue>
+
+namespace {
+
+bool IsEmpty(const RECT& rc) {
+    return rc.right <= rc.left || rc.bottom <= rc.top;
+}
+
+void Extend(RECT& box, const RECT& rc) {
+    box.left = std::min(box.left, rc.left);
+    box.top = std::min(box.top, rc.top);
+    box.right = std::max(box.right, rc.right);
+    box.bottom = std::max(box.bottom, rc.bottom);
+}
+
+bool Contains(const RECT& rc, POINT pt) {
+    return pt.x >= rc.left && pt.x < rc.right && pt.y >= rc.top && pt.y < rc.bottom;
+}
+
+bool Overlaps(const RECT& a, const RECT& b) {
+    return a.left < b.right && b.left < a.right && a.top < b.bottom && b.top < a.bottom;
+}
+
+// Squared distance from pt to the nearest pixel of rc
+int64_t Distance(const RECT& rc, POINT pt) {
+    int64_t dx = std::max<int64_t>({ 0, static_cast<int64_t>(rc.left) - pt.x, static_cast<int64_t>(pt.x) - (rc.right - 1) });
+    int64_t dy = std::max<int64_t>({ 0, static_cast<int64_t>(rc.top) - pt.y, static_cast<int64_t>(pt.y) - (rc.bottom - 1) });
+    return dx * dx + dy * dy;
+}
+
+} // namespace
+
+void SpatialIndex::Build(const std::vector<WindowInfo>& windows, SpatialScope scope) {
+    Clear();
+    for (size_t i = 0; i < windows.size(); i++) {
+        const WindowInfo& win = windows[i];
+        if (scope == SPATIAL_SHOWN && (!win.isVisible || win.isCloaked || win.isMinimized)) {
+            continue;
+        }
+        RECT frame = Frame(win);
+        if (!IsEmpty(frame)) {
+            m_items.push_back({ frame, win.zOrder, static_cast<uint32_t>(i) });
+        }
+    }
+    if (m_items.empty()) {
+        return;
+    }
+
+    // Leaves over the items, then each level over the one below until one
+    // node is left
+    SortTiles(m_items, 0, m_items.size());
+    for (size_t first = 0; first < m_items.size(); first += NODE_CAPACITY) {
+        size_t count = std::min(NODE_CAPACITY, m_items.size() - first);
+        Node node = { m_items[first].box, static_cast<uint32_t>(first), static_cast<uint32_t>(count) };
+        for (size_t i = first + 1; i < first + count; i++) {
+            Extend(node.box, m_items[i].box);
+        }
+        m_nodes.push_back(node);
+    }
+    m_leafCount = m_nodes.size();
+
+    size_t levelBegin = 0;
+    size_t levelEnd = m_nodes.size();
+    while (levelEnd - levelBegin > 1) {
+        SortTiles(m_nodes, levelBegin, levelEnd);
+        for (size_t first = levelBegin; first < levelEnd; first += NODE_CAPACITY) {
+            size_t count = std::min(NODE_CAPACITY, levelEnd - first);
+            Node node = { m_nodes[first].box, static_cast<uint32_t>(first), static_cast<uint32_t>(count) };
+            for (size_t i = first + 1; i < first + count; i++) {
+                Extend(node.box, m_nodes[i].box);
+            }
+            m_nodes.push_back(node);
+        }
+        levelBegin = levelEnd;
+        levelEnd = m_nodes.size();
+    }
+}
+
+void SpatialIndex::Clear() {
+    m_items.clear();
+    m_nodes.clear();
+    m_leafCount = 0;
+}
+
+void SpatialIndex::QueryPoint(POINT pt, std::vector<size_t>& hits) const {
+    hits.clear();
+    if (m_nodes.empty()) {
+        return;
+    }
+
+    std::vector<std::pair<int, size_t>> found;
+    std::vector<uint32_t> stack(1, static_cast<uint32_t>(m_nodes.size() - 1));
+    while (!stack.empty()) {
+        uint32_t index = stack.back();
+        stack.pop_back();
+        const Node& node = m_nodes[index];
+        if (!Contains(node.box, pt)) {
+            continue;
+        }
+        if (index < m_leafCount) {
+            for (uint32_t i = node.first; i < node.first + node.count; i++) {
+                if (Contains(m_items[i].box, pt)) {
+                    found.emplace_back(m_items[i].z, m_items[i].index);
+                }
+            }
+        } else {
+            for (uint32_t i = node.first; i < node.first + node.count; i++) {
+                stack.push_back(i);
+            }
+        }
+    }
+    SortByZ(found, hits);
+}
+
+void SpatialIndex::QueryRegion(const RECT& region, std::vector<size_t>& hits) const {
+    hits.clear();
+    if (m_nodes.empty() || IsEmpty(region)) {
+        return;
+    }
+
+    std::vector<std::pair<int, size_t>> found;
+    std::vector<uint32_t> stack(1, static_cast<uint32_t>(m_nodes.size() - 1));
+    while (!stack.empty()) {
+        uint32_t index = stack.back();
+        stack.pop_back();
+        const Node& node = m_nodes[index];
+        if (!Overlaps(node.box, region)) {
+            continue;
+        }
+        if (index < m_leafCount) {
+            for (uint32_t i = node.first; i < node.first + node.count; i++) {
+                if (Overlaps(m_items[i].box, region)) {
+                    found.emplace_back(m_items[i].z, m_items[i].index);
+                }
+            }
+        } else {
+            for (uint32_t i = node.first; i < node.first + node.count; i++) {
+                stack.push_back(i);
+            }
+        }
+    }
+    SortByZ(found, hits);
+}
+
+void SpatialIndex::Nearest(POINT pt, size_t count, std::vector<size_t>& hits) const {
+    hits.clear();
+    if (m_nodes.empty() || count == 0) {
+        return;
+    }
+
+    // Best-first search: a node is opened before any item at the same
+    // distance is taken, so ties among items are settled by z-order
+    struct Candidate {
+        int64_t distance;
+        bool item;
+        int z;
+        uint32_t index;
+        bool operator>(const Candidate& other) const {
+            if (distance != other.distance) return distance > other.distance;
+            if (item != other.item) return item;
+            return z > other.z;
+        }
+    };
+    std::priority_queue<Candidate, std::vector<Candidate>, std::greater<Candidate>> queue;
+    uint32_t root = static_cast<uint32_t>(m_nodes.size() - 1);
+    queue.push({ Distance(m_nodes[root].box, pt), false, 0, root });
+
+    while (!queue.empty() && hits.size() < count) {
+        Candidate next = queue.top();
+        queue.pop();
+        if (next.item) {
+            hits.push_back(m_items[next.index].index);
+            continue;
+        }
+        const Node& node = m_nodes[next.index];
+        bool leaf = next.index < m_leafCount;
+        for (uint32_t i = node.first; i < node.first + node.count; i++) {
+            const RECT& box = leaf ? m_items[i].box : m_nodes[i].box;
+            queue.push({ Distance(box, pt), leaf, leaf ? m_items[i].z : 0, i });
+        }
+    }
+}
+
+RECT SpatialIndex::Frame(const WindowInfo& win) {
+    if (win.hasDwmFrame && !win.isMinimized && !IsEmpty(win.dwmExtendedFrame)) {
+        return win.dwmExtendedFrame;
+    }
+    return win.rect;
+}
+
+template <typename T>
+void SpatialIndex::SortTiles(std::vector<T>& entries, size_t begin, size_t end) {
+    // Sort-tile-recursive: vertical slices by center x, each slice sorted by
+    // center y, so consecutive runs of NODE_CAPACITY form compact tiles
+    size_t count = end - begin;
+    size_t pages = (count + NODE_CAPACITY - 1) / NODE_CAPACITY;
+    size_t slices = static_cast<size_t>(std::ceil(std::sqrt(static_cast<double>(pages))));
+    size_t sliceSize = slices * NODE_CAPACITY;
+
+    auto centerX = [](const T& e) { return static_cast<int64_t>(e.box.left) + e.box.right; };
+    auto centerY = [](const T& e) { return static_cast<int64_t>(e.box.top) + e.box.bottom; };
+    std::sort(entries.begin() + begin, entries.begin() + end,
+        [&](const T& a, const T& b) { return centerX(a) < centerX(b); });
+    for (size_t first = begin; first < end; first += sliceSize) {
+        size_t last = std::min(end, first + sliceSize);
+        std::sort(entries.begin() + first, entries.begin() + last,
+            [&](const T& a, const T& b) { return centerY(a) < centerY(b); });
+    }
+}
+
+void SpatialIndex::SortByZ(std::vector<std::pair<int, size_t>>& found, std::vector<size_t>& hits) {
+    std::sort(found.begin(), found.end());
+    hits.reserve(found.size());
+    for (const auto& hit : found) {
+        hits.push_back(hit.second);
+    }
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+#include "WindowInfo.h"
+
+enum SpatialScope {
+    SPATIAL_ALL = 0,    // every window with a non-empty frame
+    SPATIAL_SHOWN       // only windows that can be seen: visible, not cloaked, not minimized
+};
+
+// Point, region and nearest queries over window frames, for hit testing and
+// overlap questions. Built once per snapshot as a packed R-tree (sort-tile-
+// recursive bulk load), which keeps queries logarithmic whether windows are
+// spread out, stacked or of very different sizes. Results are indexes into
+// the windows given to Build.
+class SpatialIndex {
+public:
+    void Build(const std::vector<WindowInfo>& windows, SpatialScope scope = SPATIAL_ALL);
+    void Clear();
+    size_t Size() const { return m_items.size(); }
+
+    // Windows whose frame contains pt, top window first
+    void QueryPoint(POINT pt, std::vector<size_t>& hits) const;
+    // Windows whose frame overlaps region, top window first
+    void QueryRegion(const RECT& region, std::vector<size_t>& hits) const;
+    // The count windows whose frame is closest to pt (distance 0 inside it),
+    // nearest first; at equal distance the higher window comes first
+    void Nearest(POINT pt, size_t count, std::vector<size_t>& hits) const;
+
+    // What a window covers on screen: the DWM frame without its invisible
+    // resize borders when there is one, otherwise the window rectangle
+    static RECT Frame(const WindowInfo& win);
+
+private:
+    struct Item {
+        RECT box;
+        int z;
+        uint32_t index;
+    };
+
+    // Children are nodes [first, first + count), or items for a leaf
+    struct Node {
+        RECT box;
+        uint32_t first;
+        uint32_t count;
+    };
+
+    template <typename T> static void SortTiles(std::vector<T>& entries, size_t begin, size_t end);
+    static void SortByZ(std::vector<std::pair<int, size_t>>& found, std::vector<size_t>& hits);
+
+    std::vector<Item> m_items;      // in leaf order
+    std::vector<Node> m_nodes;      // leaves first, root last
+    size_t m_leafCount = 0;
+
+    static constexpr size_t NODE_CAPACITY = 16;
+};
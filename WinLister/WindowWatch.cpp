@@ -0,0 +1,343 @@
+#include "WindowWatch.h"
+#include "SnapshotExport.h"
+#include <cstring>
+#include <cwctype>
+
+namespace {
+
+struct FieldName {
+    const wchar_t* name;
+    uint32_t fields;
+};
+
+const uint32_t MOVED_FIELDS =
+    (1u << WATCHFIELD_RECT) | (1u << WATCHFIELD_CLIENT_RECT) | (1u << WATCHFIELD_DWM_FRAME);
+const uint32_t STATE_FIELDS =
+    ((1u << (WATCHFIELD_ALPHA + 1)) - 1) & ~((1u << WATCHFIELD_STYLE) - 1);
+const uint32_t ALL_FIELDS = (1u << WATCHFIELD_COUNT) - 1;
+
+const FieldName FIELD_NAMES[] = {
+    { L"created", 1u << WATCHFIELD_CREATED },
+    { L"destroyed", 1u << WATCHFIELD_DESTROYED },
+    { L"rect", 1u << WATCHFIELD_RECT },
+    { L"client", 1u << WATCHFIELD_CLIENT_RECT },
+    { L"dwm", 1u << WATCHFIELD_DWM_FRAME },
+    { L"title", 1u << WATCHFIELD_TITLE },
+    { L"style", 1u << WATCHFIELD_STYLE },
+    { L"exstyle", 1u << WATCHFIELD_EXSTYLE },
+    { L"visible", 1u << WATCHFIELD_VISIBLE },
+    { L"enabled", 1u << WATCHFIELD_ENABLED },
+    { L"minimized", 1u << WATCHFIELD_MINIMIZED },
+    { L"maximized", 1u << WATCHFIELD_MAXIMIZED },
+    { L"topmost", 1u << WATCHFIELD_TOPMOST },
+    { L"layered", 1u << WATCHFIELD_LAYERED },
+    { L"transparent", 1u << WATCHFIELD_TRANSPARENT },
+    { L"cloaked", 1u << WATCHFIELD_CLOAKED },
+    { L"hung", 1u << WATCHFIELD_HUNG },
+    { L"alpha", 1u << WATCHFIELD_ALPHA },
+    { L"zorder", 1u << WATCHFIELD_ZORDER },
+    { L"parent", 1u << WATCHFIELD_PARENT },
+    { L"owner", 1u << WATCHFIELD_OWNER },
+    // Event names select all of their fields
+    { L"moved", MOVED_FIELDS },
+    { L"retitled", 1u << WATCHFIELD_TITLE },
+    { L"state", STATE_FIELDS },
+    { L"restacked", 1u << WATCHFIELD_ZORDER },
+    { L"reparented", (1u << WATCHFIELD_PARENT) | (1u << WATCHFIELD_OWNER) },
+    { L"all", ALL_FIELDS },
+};
+
+const char* const EVENT_NAMES[WATCH_EVENT_COUNT] = {
+    "created", "destroyed", "moved", "retitled", "state", "restacked", "reparented"
+};
+
+// The event each field is reported under
+const uint8_t FIELD_EVENTS[WATCHFIELD_COUNT] = {
+    WATCH_CREATED, WATCH_DESTROYED,
+    WATCH_MOVED, WATCH_MOVED, WATCH_MOVED,
+    WATCH_RETITLED,
+    WATCH_STATE, WATCH_STATE, WATCH_STATE, WATCH_STATE, WATCH_STATE, WATCH_STATE,
+    WATCH_STATE, WATCH_STATE, WATCH_STATE, WATCH_STATE, WATCH_STATE, WATCH_STATE,
+    WATCH_RESTACKED,
+    WATCH_REPARENTED, WATCH_REPARENTED
+};
+
+inline bool SameRect(const RECT& a, const RECT& b) {
+    return a.left == b.left && a.top == b.top && a.right == b.right && a.bottom == b.bottom;
+}
+
+inline uintptr_t HandleKey(HWND hwnd) {
+    return reinterpret_cast<uintptr_t>(hwnd);
+}
+
+void PutKey(BufferedWriter& out, const char* key, size_t length) {
+    out.Put(',');
+    out.Put('"');
+    out.Put(key, length);
+    out.PutLiteral("\":");
+}
+
+template <size_t N>
+void PutSigned(BufferedWriter& out, const char (&key)[N], int64_t value) {
+    PutKey(out, key, N - 1);
+    out.PutSigned(value);
+}
+
+template <size_t N>
+void PutUnsigned(BufferedWriter& out, const char (&key)[N], uint64_t value) {
+    PutKey(out, key, N - 1);
+    out.PutUnsigned(value);
+}
+
+template <size_t N>
+void PutBool(BufferedWriter& out, const char (&key)[N], bool value) {
+    PutKey(out, key, N - 1);
+    if (value) out.PutLiteral("true"); else out.PutLiteral("false");
+}
+
+template <size_t N>
+void PutHandle(BufferedWriter& out, const char (&key)[N], HWND value) {
+    PutKey(out, key, N - 1);
+    out.PutLiteral("\"0x");
+    out.PutHex(HandleKey(value));
+    out.Put('"');
+}
+
+template <size_t N>
+void PutText(BufferedWriter& out, const char (&key)[N], const std::wstring& value) {
+    PutKey(out, key, N - 1);
+    SnapshotExporter::WriteJsonString(out, value);
+}
+
+} // namespace
+
+WindowWatcher::WindowWatcher(uint32_t fields, const WindowFilter& filter, const WindowQuery& query)
+    : m_fields(fields), m_filter(filter), m_query(query) {
+}
+
+size_t WindowWatcher::Update(std::vector<WindowInfo>& windows, uint64_t time, BufferedWriter& out) {
+    uint64_t eventsBefore = m_eventCount;
+    bool report = m_hasBaseline || m_reportInitial;
+    m_generation++;
+    m_seen.resize(m_previous.size(), 0);
+
+    // Match rows first so removals can be written before creations; windows
+    // mostly keep their rows, so the same row is tried before the map
+    m_matches.resize(windows.size());
+    for (size_t i = 0; i < windows.size(); i++) {
+        const WindowInfo& win = windows[i];
+        uint32_t row = NO_ROW;
+        if (i < m_previous.size() && m_previous[i].hwnd == win.hwnd) {
+            row = static_cast<uint32_t>(i);
+        } else {
+            auto it = m_previousRows.find(HandleKey(win.hwnd));
+            if (it != m_previousRows.end()) row = it->second;
+        }
+
+        // A recycled handle is a different window
+        if (row != NO_ROW) {
+            const WindowInfo& before = m_previous[row];
+            if (before.processId != win.processId || before.className != win.className) {
+                row = NO_ROW;
+            } else {
+                m_seen[row] = m_generation;
+            }
+        }
+        m_matches[i] = row;
+    }
+
+    // Restacking is the fewest moves between the two z-orders (the matches
+    // are the new rows' previous positions), so windows that only shifted
+    // below a raised one are not reported
+    if (m_fields & (1u << WATCHFIELD_ZORDER)) {
+        m_zorder.Compute(m_matches, m_previous.size());
+    }
+    const std::vector<ZOrderMove>& moves = m_zorder.Moves();
+    size_t nextMove = 0;
+
+    if (m_fields & (1u << WATCHFIELD_DESTROYED)) {
+        for (size_t row = 0; row < m_previous.size(); row++) {
+            const WindowInfo& gone = m_previous[row];
+            if (m_seen[row] == m_generation || !IsWatched(gone)) continue;
+            WriteStart(out, WATCH_DESTROYED, time, gone);
+            PutUnsigned(out, "processId", gone.processId);
+            PutText(out, "className", gone.className);
+            PutText(out, "title", gone.title);
+            out.PutLiteral("}\n");
+        }
+    }
+
+    for (size_t i = 0; i < windows.size(); i++) {
+        const WindowInfo& win = windows[i];
+        uint32_t row = m_matches[i];
+        if (row == NO_ROW) {
+            if (report && (m_fields & (1u << WATCHFIELD_CREATED)) && IsWatched(win)) {
+                WriteStart(out, WATCH_CREATED, time, win);
+                out.PutLiteral(",\"window\":");
+                SnapshotExporter::WriteJsonObject(out, win);
+                out.PutLiteral("}\n");
+            }
+            continue;
+        }
+
+        uint32_t mask = Diff(m_previous[row], win) & m_fields;
+        const ZOrderMove* move = nullptr;
+        if (nextMove < moves.size() && moves[nextMove].row == i) {
+            move = &moves[nextMove++];
+            mask |= 1u << WATCHFIELD_ZORDER;
+        }
+        if (mask && (IsWatched(win) || IsWatched(m_previous[row]))) {
+            WriteChanges(out, mask, time, win, move, i > 0 ? windows[i - 1].hwnd : nullptr);
+        }
+    }
+
+    // The new snapshot becomes the baseline
+    m_previous.swap(windows);
+    m_previousRows.clear();
+    m_previousRows.reserve(m_previous.size());
+    for (size_t row = 0; row < m_previous.size(); row++) {
+        m_previousRows[HandleKey(m_previous[row].hwnd)] = static_cast<uint32_t>(row);
+    }
+    m_hasBaseline = true;
+    return static_cast<size_t>(m_eventCount - eventsBefore);
+}
+
+uint32_t WindowWatcher::Diff(const WindowInfo& before, const WindowInfo& after) {
+    uint32_t mask = 0;
+    if (!SameRect(before.rect, after.rect)) mask |= 1u << WATCHFIELD_RECT;
+    if (!SameRect(before.clientRect, after.clientRect)) mask |= 1u << WATCHFIELD_CLIENT_RECT;
+    if (before.hasDwmFrame != after.hasDwmFrame ||
+        (after.hasDwmFrame && !SameRect(before.dwmExtendedFrame, after.dwmExtendedFrame))) {
+        mask |= 1u << WATCHFIELD_DWM_FRAME;
+    }
+    if (before.title != after.title) mask |= 1u << WATCHFIELD_TITLE;
+    if (before.style != after.style) mask |= 1u << WATCHFIELD_STYLE;
+    if (before.exStyle != after.exStyle) mask |= 1u << WATCHFIELD_EXSTYLE;
+    if (before.isVisible != after.isVisible) mask |= 1u << WATCHFIELD_VISIBLE;
+    if (before.isEnabled != after.isEnabled) mask |= 1u << WATCHFIELD_ENABLED;
+    if (before.isMinimized != after.isMinimized) mask |= 1u << WATCHFIELD_MINIMIZED;
+    if (before.isMaximized != after.isMaximized) mask |= 1u << WATCHFIELD_MAXIMIZED;
+    if (before.isTopMost != after.isTopMost) mask |= 1u << WATCHFIELD_TOPMOST;
+    if (before.isLayered != after.isLayered) mask |= 1u << WATCHFIELD_LAYERED;
+    if (before.isTransparent != after.isTransparent) mask |= 1u << WATCHFIELD_TRANSPARENT;
+    if (before.isCloaked != after.isCloaked) mask |= 1u << WATCHFIELD_CLOAKED;
+    if (before.isHung != after.isHung) mask |= 1u << WATCHFIELD_HUNG;
+    if (before.alpha != after.alpha) mask |= 1u << WATCHFIELD_ALPHA;
+    if (before.hwndParent != after.hwndParent) mask |= 1u << WATCHFIELD_PARENT;
+    if (before.hwndOwner != after.hwndOwner) mask |= 1u << WATCHFIELD_OWNER;
+    return mask;
+}
+
+bool WindowWatcher::IsWatched(const WindowInfo& win) const {
+    return m_filter.Matches(win) && m_query.Matches(win);
+}
+
+void WindowWatcher::WriteStart(BufferedWriter& out, int event, uint64_t time, const WindowInfo& win) {
+    out.PutLiteral("{\"time\":");
+    out.PutUnsigned(time);
+    out.PutLiteral(",\"event\":\"");
+    out.Put(EVENT_NAMES[event], strlen(EVENT_NAMES[event]));
+    out.Put('"');
+    PutHandle(out, "hwnd", win.hwnd);
+    m_eventCount++;
+}
+
+void WindowWatcher::WriteChanges(BufferedWriter& out, uint32_t mask, uint64_t time, const WindowInfo& win,
+    const ZOrderMove* move, HWND insertAfter) {
+    // One line per event, fields in WatchField order, which groups each event's fields
+    int event = -1;
+    for (int field = WATCHFIELD_RECT; field < WATCHFIELD_COUNT; field++) {
+        if (!(mask & (1u << field))) continue;
+        if (FIELD_EVENTS[field] != event) {
+            if (event >= 0) out.PutLiteral("}\n");
+            event = FIELD_EVENTS[field];
+            WriteStart(out, event, time, win);
+        }
+
+        switch (field) {
+        case WATCHFIELD_RECT:
+            PutSigned(out, "left", win.rect.left);
+            PutSigned(out, "top", win.rect.top);
+            PutSigned(out, "right", win.rect.right);
+            PutSigned(out, "bottom", win.rect.bottom);
+            break;
+        case WATCHFIELD_CLIENT_RECT:
+            PutSigned(out, "clientWidth", win.clientRect.right - win.clientRect.left);
+            PutSigned(out, "clientHeight", win.clientRect.bottom - win.clientRect.top);
+            break;
+        case WATCHFIELD_DWM_FRAME:
+            PutBool(out, "hasDwmFrame", win.hasDwmFrame);
+            PutSigned(out, "dwmLeft", win.hasDwmFrame ? win.dwmExtendedFrame.left : 0);
+            PutSigned(out, "dwmTop", win.hasDwmFrame ? win.dwmExtendedFrame.top : 0);
+            PutSigned(out, "dwmRight", win.hasDwmFrame ? win.dwmExtendedFrame.right : 0);
+            PutSigned(out, "dwmBottom", win.hasDwmFrame ? win.dwmExtendedFrame.bottom : 0);
+            break;
+        case WATCHFIELD_TITLE: PutText(out, "title", win.title); break;
+        case WATCHFIELD_STYLE: PutUnsigned(out, "style", win.style); break;
+        case WATCHFIELD_EXSTYLE: PutUnsigned(out, "exStyle", win.exStyle); break;
+        case WATCHFIELD_VISIBLE: PutBool(out, "visible", win.isVisible); break;
+        case WATCHFIELD_ENABLED: PutBool(out, "enabled", win.isEnabled); break;
+        case WATCHFIELD_MINIMIZED: PutBool(out, "minimized", win.isMinimized); break;
+        case WATCHFIELD_MAXIMIZED: PutBool(out, "maximized", win.isMaximized); break;
+        case WATCHFIELD_TOPMOST: PutBool(out, "topmost", win.isTopMost); break;
+        case WATCHFIELD_LAYERED: PutBool(out, "layered", win.isLayered); break;
+        case WATCHFIELD_TRANSPARENT: PutBool(out, "transparent", win.isTransparent); break;
+        case WATCHFIELD_CLOAKED: PutBool(out, "cloaked", win.isCloaked); break;
+        case WATCHFIELD_HUNG: PutBool(out, "hung", win.isHung); break;
+        case WATCHFIELD_ALPHA: PutUnsigned(out, "alpha", win.alpha); break;
+        case WATCHFIELD_ZORDER:
+            PutSigned(out, "zOrder", win.zOrder);
+            PutHandle(out, "insertAfter", insertAfter);
+            PutBool(out, "raised", move->raised);
+            break;
+        case WATCHFIELD_PARENT: PutHandle(out, "parent", win.hwndParent); break;
+        case WATCHFIELD_OWNER: PutHandle(out, "owner", win.hwndOwner); break;
+        }
+    }
+    if (event >= 0) out.PutLiteral("}\n");
+}
+
+bool WindowWatcher::ParseFields(const std::wstring& text, uint32_t& fields, std::wstring& error) {
+    fields = 0;
+    bool first = true;
+    size_t start = 0;
+    while (start <= text.size()) {
+        size_t comma = text.find(L',', start);
+        if (comma == std::wstring::npos) comma = text.size();
+        std::wstring name = text.substr(start, comma - start);
+        start = comma + 1;
+
+        bool remove = !name.empty() && name[0] == L'-';
+        if (remove) name.erase(0, 1);
+        for (wchar_t& c : name) c = static_cast<wchar_t>(towlower(c));
+        if (name.empty()) {
+            error = L"Empty name in the field list";
+            return false;
+        }
+
+        uint32_t selected = 0;
+        for (const FieldName& entry : FIELD_NAMES) {
+            if (name == entry.name) {
+                selected = entry.fields;
+                break;
+            }
+        }
+        if (!selected) {
+            error = L"Unknown watch field '" + name + L"'";
+            return false;
+        }
+
+        if (remove) {
+            if (first) fields = DEFAULT_FIELDS;
+            fields &= ~selected;
+        } else {
+            fields |= selected;
+        }
+        first = false;
+    }
+    return true;
+}
+
+const char* WindowWatcher::EventName(int event) {
+    return (event >= 0 && event < WATCH_EVENT_COUNT) ? EVENT_NAMES[event] : "";
+}
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "WindowInfo.h"
+#include "WindowFilter.h"
+#include "WindowQuery.h"
+#include "WindowZOrder.h"
+#include "BufferedWriter.h"
+
+// The changes a watch can report, as bits of a field mask
+enum WatchField {
+    WATCHFIELD_CREATED = 0,
+    WATCHFIELD_DESTROYED,
+    WATCHFIELD_RECT,
+    WATCHFIELD_CLIENT_RECT,
+    WATCHFIELD_DWM_FRAME,
+    WATCHFIELD_TITLE,
+    WATCHFIELD_STYLE,
+    WATCHFIELD_EXSTYLE,
+    WATCHFIELD_VISIBLE,
+    WATCHFIELD_ENABLED,
+    WATCHFIELD_MINIMIZED,
+    WATCHFIELD_MAXIMIZED,
+    WATCHFIELD_TOPMOST,
+    WATCHFIELD_LAYERED,
+    WATCHFIELD_TRANSPARENT,
+    WATCHFIELD_CLOAKED,
+    WATCHFIELD_HUNG,
+    WATCHFIELD_ALPHA,
+    WATCHFIELD_ZORDER,
+    WATCHFIELD_PARENT,
+    WATCHFIELD_OWNER,
+    WATCHFIELD_COUNT
+};
+
+// Event names in the feed; each changed field belongs to one event
+enum WatchEvent {
+    WATCH_CREATED = 0,
+    WATCH_DESTROYED,
+    WATCH_MOVED,        // rect, client rect, DWM frame
+    WATCH_RETITLED,
+    WATCH_STATE,        // styles, state flags, alpha
+    WATCH_RESTACKED,    // moved in the z-order
+    WATCH_REPARENTED,   // parent, owner
+    WATCH_EVENT_COUNT
+};
+
+// Turns successive snapshots into an NDJSON change feed. Windows are matched
+// by handle; a handle that comes back with another process or class is a new
+// window. Each update writes destroyed windows first, then creations and
+// changes in z-order, one line per window and event:
+//
+//   {"time":...,"event":"moved","hwnd":"0x1A2B","left":0,"top":0,...}
+//
+// A change line carries the new values of the fields that changed; created
+// lines carry the whole window, destroyed lines its last identity. Restacked
+// lines name only the windows that moved in the z-order, not the ones that
+// shifted because of them, with the window now directly above ("insertAfter",
+// 0x0 at the top) and whether the window was raised. Only
+// windows passing the filter and query are reported, tested against the new
+// state and, for changes and removals, the old one, so a window leaving the
+// filter (say, becoming hidden) still shows up.
+class WindowWatcher {
+public:
+    WindowWatcher(uint32_t fields, const WindowFilter& filter, const WindowQuery& query);
+
+    // The first snapshot sets the baseline and reports nothing unless initial
+    // creations were asked for
+    void SetReportInitial(bool report) { m_reportInitial = report; }
+
+    // Compares a snapshot (in z-order, as enumerated) with the previous one
+    // and writes its events to out.
+    // Takes the snapshot's contents; windows is left holding older storage for
+    // the caller to reuse. Returns the number of events written.
+    size_t Update(std::vector<WindowInfo>& windows, uint64_t time, BufferedWriter& out);
+
+    uint64_t EventCount() const { return m_eventCount; }
+
+    // Parses a comma-separated list of field and event names ("moved,title").
+    // Names prefixed with '-' are removed; a list that starts with a removal
+    // starts from the defaults.
+    static bool ParseFields(const std::wstring& text, uint32_t& fields, std::wstring& error);
+    static const char* EventName(int event);
+
+    static const uint32_t DEFAULT_FIELDS = (1u << WATCHFIELD_COUNT) - 1;
+
+private:
+    static uint32_t Diff(const WindowInfo& before, const WindowInfo& after);
+    bool IsWatched(const WindowInfo& win) const;
+    void WriteStart(BufferedWriter& out, int event, uint64_t time, const WindowInfo& win);
+    void WriteChanges(BufferedWriter& out, uint32_t mask, uint64_t time, const WindowInfo& win,
+        const ZOrderMove* move, HWND insertAfter);
+
+    static const uint32_t NO_ROW = ZOrderDelta::NEW_WINDOW;
+
+    uint32_t m_fields;
+    WindowFilter m_filter;
+    WindowQuery m_query;
+    bool m_reportInitial = false;
+    bool m_hasBaseline = false;
+
+    std::vector<WindowInfo> m_previous;
+    std::unordered_map<uintptr_t, uint32_t> m_previousRows;  // hwnd -> row in m_previous
+    std::vector<uint32_t> m_matches;    // per new row, its previous row or NO_ROW
+    std::vector<uint32_t> m_seen;       // per previous row, the update that matched it
+    ZOrderDelta m_zorder;
+    uint32_t m_generation = 0;
+    uint64_t m_eventCount = 0;
+};
@@ -0,0 +1,110 @@
+#include "WindowZOrder.h"
+
+void ZOrderDelta::Compute(const std::vector<uint32_t>& previous, size_t previousCount) {
+    size_t count = previous.size();
+    m_tails.clear();
+    m_links.assign(count, NEW_WINDOW);
+    m_stable.assign(count, 0);
+    m_moves.clear();
+
+    // Patience sort over previous positions: m_tails[k] is the row ending the
+    // increasing run of length k + 1 with the smallest last position
+    for (size_t row = 0; row < count; row++) {
+        uint32_t position = previous[row];
+        if (position == NEW_WINDOW) continue;
+
+        // Most windows keep their order and extend the longest run directly
+        size_t length = m_tails.size();
+        if (length > 0 && previous[m_tails.back()] >= position) {
+            size_t low = 0;
+            size_t high = length;
+            while (low < high) {
+                size_t mid = (low + high) / 2;
+                if (previous[m_tails[mid]] < position) {
+                    low = mid + 1;
+                } else {
+                    high = mid;
+                }
+            }
+            length = low;
+        }
+
+        if (length > 0) m_links[row] = m_tails[length - 1];
+        if (length == m_tails.size()) {
+            m_tails.push_back(static_cast<uint32_t>(row));
+        } else {
+            m_tails[length] = static_cast<uint32_t>(row);
+        }
+    }
+
+    m_stableCount = m_tails.size();
+    if (m_tails.empty()) return;
+    for (uint32_t row = m_tails.back(); row != NEW_WINDOW; row = m_links[row]) {
+        m_stable[row] = 1;
+    }
+
+    // Stable windows above each previous position, to tell raised from lowered
+    m_stableAbove.assign(previousCount, 0);
+    for (size_t row = 0; row < count; row++) {
+        if (m_stable[row]) m_stableAbove[previous[row]] = 1;
+    }
+    uint32_t above = 0;
+    for (uint32_t& slot : m_stableAbove) {
+        uint32_t stable = slot;
+        slot = above;
+        above += stable;
+    }
+
+    // A moved window always changes its place among the stable ones; had it
+    // kept it, the run could have included it
+    above = 0;
+    for (size_t row = 0; row < count; row++) {
+        uint32_t position = previous[row];
+        if (position == NEW_WINDOW) continue;
+        if (m_stable[row]) {
+            above++;
+        } else {
+            m_moves.push_back({ static_cast<uint32_t>(row), position, above < m_stableAbove[position] });
+        }
+    }
+}
+
+void ZOrderTracker::Update(std::vector<WindowInfo>& windows, uint64_t time) {
+    // Windows mostly keep their rows, so the same row is tried before the map
+    m_positions.resize(windows.size());
+    for (size_t i = 0; i < windows.size(); i++) {
+        WindowInfo& win = windows[i];
+        uint32_t row = ZOrderDelta::NEW_WINDOW;
+        if (i < m_previous.size() && m_previous[i].hwnd == win.hwnd) {
+            row = static_cast<uint32_t>(i);
+        } else {
+            auto it = m_previousRows.find(win.hwnd);
+            if (it != m_previousRows.end()) row = it->second;
+        }
+        if (row != ZOrderDelta::NEW_WINDOW && m_previous[row].processId != win.processId) {
+            row = ZOrderDelta::NEW_WINDOW;
+        }
+        m_positions[i] = row;
+        win.raisedAt = row != ZOrderDelta::NEW_WINDOW ? m_previous[row].raisedAt : 0;
+    }
+
+    m_previousCount = m_previous.size();
+    m_delta.Compute(m_positions, m_previousCount);
+    for (const ZOrderMove& move : m_delta.Moves()) {
+        if (move.raised) windows[move.row].raisedAt = time;
+    }
+
+    m_previous.resize(windows.size());
+    m_previousRows.clear();
+    m_previousRows.reserve(windows.size());
+    for (size_t i = 0; i < windows.size(); i++) {
+        const WindowInfo& win = windows[i];
+        m_previous[i] = { win.hwnd, win.processId, win.raisedAt };
+        m_previousRows[win.hwnd] = static_cast<uint32_t>(i);
+    }
+}
+
+void ZOrderTracker::Reset() {
+    m_previous.clear();
+    m_previousRows.clear();
+}
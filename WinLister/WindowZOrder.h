@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+#include "WindowInfo.h"
+
+// A window that changed place in the stack between two snapshots
+struct ZOrderMove {
+    uint32_t row;       // position in the new z-order
+    uint32_t previous;  // position in the previous z-order
+    bool raised;        // now above windows it used to be below
+};
+
+// Works out which windows were restacked between two z-orders, as opposed to
+// the ones that only shifted because something above them came or went. The
+// windows present in both keep the longest run whose relative order did not
+// change (a longest increasing subsequence of their previous positions, found
+// by patience sorting in O(n log n)); the rest are the fewest moves that turn
+// the previous order into the new one. Applying the moves top first, each
+// window placed directly below the one now above it, rebuilds the new order.
+class ZOrderDelta {
+public:
+    static constexpr uint32_t NEW_WINDOW = static_cast<uint32_t>(-1);
+
+    // previous holds, for each window of the new z-order (top first), its
+    // position in the previous z-order of previousCount windows, or
+    // NEW_WINDOW. Moves come out in new z-order.
+    void Compute(const std::vector<uint32_t>& previous, size_t previousCount);
+
+    const std::vector<ZOrderMove>& Moves() const { return m_moves; }
+    // Windows present in both z-orders that kept their relative order
+    size_t StableCount() const { return m_stableCount; }
+
+private:
+    std::vector<uint32_t> m_tails;      // per run length, the row ending the best such run
+    std::vector<uint32_t> m_links;      // per row, the row before it in its run
+    std::vector<uint32_t> m_stableAbove;    // per previous position, stable windows above it
+    std::vector<uint8_t> m_stable;      // per row
+    std::vector<ZOrderMove> m_moves;
+    size_t m_stableCount = 0;
+};
+
+// Follows the z-order across refreshes and stamps WindowInfo::raisedAt on
+// windows that were raised. Windows are matched by handle; a handle that
+// comes back with another process is a new window, and new windows do not
+// count as raised.
+class ZOrderTracker {
+public:
+    // windows must be in z-order, as enumerated. Windows raised since the
+    // last update get time; the others keep the time they were last raised.
+    void Update(std::vector<WindowInfo>& windows, uint64_t time);
+    // The next update only sets the baseline
+    void Reset();
+
+    const std::vector<ZOrderMove>& Moves() const { return m_delta.Moves(); }
+    // The last update's matching: per window, its row in the z-order before,
+    // or NEW_WINDOW, and how many windows that z-order had
+    const std::vector<uint32_t>& PreviousRows() const { return m_positions; }
+    size_t PreviousCount() const { return m_previousCount; }
+
+private:
+    struct Entry {
+        HWND hwnd;
+        DWORD processId;
+        uint64_t raisedAt;
+    };
+
+    ZOrderDelta m_delta;
+    std::vector<Entry> m_previous;  // previous z-order
+    std::unordered_map<HWND, uint32_t> m_previousRows;
+    std::vector<uint32_t> m_positions;
+    size_t m_previousCount = 0;
+};
@@ -1,10 +1,221 @@
 #define WIN32_LEAN_AND_MEAN
 #define NOMINMAX
 #include <Windows.h>
+#include <algorithm>
 #include "MainWindow.h"
+#include "HeadlessMode.h"
 
 static const wchar_t* MUTEX_NAME = L"WinLister_SingleInstance_Mutex";
 
+// Writes headless output to a standard handle. Pipes and files get the UTF-8
+// bytes as they are; a console gets UTF-16 through WriteConsoleW, so text
+// shows correctly whatever the console code page.
+class StdHandleSink : public ByteSink {
+public:
+    explicit StdHandleSink(HANDLE handle) : m_handle(handle), m_console(false) {
+        DWORD mode;
+        m_console = handle && GetConsoleMode(handle, &mode);
+    }
+
+    bool Write(const char* data, size_t length) override {
+        if (!m_handle) {
+            return false;
+        }
+        if (m_console) {
+            return WriteToConsole(data, length);
+        }
+
+        while (length > 0) {
+            DWORD chunk = static_cast<DWORD>(length > 0x10000000 ? 0x10000000 : length);
+            DWORD written = 0;
+            if (!WriteFile(m_handle, data, chunk, &written, nullptr) || written == 0) {
+                return false;
+            }
+            data += written;
+            length -= written;
+        }
+        return true;
+    }
+
+private:
+    bool WriteToConsole(const char* data, size_t length) {
+        // Hold back a UTF-8 sequence split across writes
+        m_pending.append(data, length);
+        size_t complete = m_pending.size();
+        for (size_t back = 1; back <= 3 && back <= m_pending.size(); back++) {
+            unsigned char c = static_cast<unsigned char>(m_pending[m_pending.size() - back]);
+            if ((c & 0xC0) == 0x80) continue;
+            size_t needed = c >= 0xF0 ? 4 : c >= 0xE0 ? 3 : c >= 0xC0 ? 2 : 1;
+            if (needed > back) complete = m_pending.size() - back;
+            break;
+        }
+        if (complete == 0) {
+            return true;
+        }
+
+        int wideLength = MultiByteToWideChar(CP_UTF8, 0, m_pending.data(), static_cast<int>(complete), nullptr, 0);
+        std::wstring wide(static_cast<size_t>(wideLength), L'\0');
+        MultiByteToWideChar(CP_UTF8, 0, m_pending.data(), static_cast<int>(complete), &wide[0], wideLength);
+        m_pending.erase(0, complete);
+
+        const wchar_t* p = wide.data();
+        DWORD remaining = static_cast<DWORD>(wide.size());
+        while (remaining > 0) {
+            DWORD written = 0;
+            if (!WriteConsoleW(m_handle, p, remaining, &written, nullptr) || written == 0) {
+                return false;
+            }
+            p += written;
+            remaining -= written;
+        }
+        return true;
+    }
+
+    HANDLE m_handle;
+    bool m_console;
+    std::string m_pending;
+};
+
+// Live windows for the headless modes. Each load refreshes the previous
+// result in place, so a watch pays the full process and class queries only
+// for new windows. Waits pump WinEvent hooks for top-level window changes
+// and end early, after a short settle, when one arrives; Ctrl+C ends a watch.
+class LiveWindowSource : public WindowSource {
+public:
+    ~LiveWindowSource() {
+        for (HWINEVENTHOOK hook : m_hooks) {
+            if (hook) UnhookWinEvent(hook);
+        }
+        if (s_stopEvent) {
+            SetConsoleCtrlHandler(OnConsoleControl, FALSE);
+            CloseHandle(s_stopEvent);
+            s_stopEvent = nullptr;
+        }
+    }
+
+    bool Load(std::vector<WindowInfo>& windows, std::wstring& error) override {
+        UNREFERENCED_PARAMETER(error);
+        WindowEnumerator::RefreshAllWindows(m_windows, false);
+        windows = m_windows;
+        m_lastLoad = GetTickCount64();
+        return true;
+    }
+
+    bool WaitForChange(uint32_t intervalMs) override {
+        if (!s_stopEvent) {
+            StartWatching();
+        }
+
+        ULONGLONG deadline = m_lastLoad + intervalMs;
+        for (;;) {
+            // A change is picked up once the burst it belongs to settles
+            if (s_changed) {
+                deadline = std::min(deadline, m_lastLoad + SETTLE_MS);
+            }
+            ULONGLONG now = GetTickCount64();
+            if (now >= deadline) {
+                break;
+            }
+
+            DWORD result = MsgWaitForMultipleObjects(1, &s_stopEvent, FALSE,
+                static_cast<DWORD>(deadline - now), QS_ALLINPUT);
+            if (result == WAIT_OBJECT_0) {
+                return false;
+            }
+            MSG msg;
+            while (PeekMessageW(&msg, nullptr, 0, 0, PM_REMOVE)) {
+                DispatchMessageW(&msg);
+            }
+        }
+        s_changed = false;
+        return true;
+    }
+
+    MonitorSource* Monitors() override {
+        return &m_monitors;
+    }
+
+private:
+    void StartWatching() {
+        s_stopEvent = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+        SetConsoleCtrlHandler(OnConsoleControl, TRUE);
+
+        // Foreground through minimize, object create through name change, and cloaking
+        const DWORD ranges[][2] = {
+            { EVENT_SYSTEM_FOREGROUND, EVENT_SYSTEM_MINIMIZEEND },
+            { EVENT_OBJECT_CREATE, EVENT_OBJECT_NAMECHANGE },
+            { EVENT_OBJECT_CLOAKED, EVENT_OBJECT_UNCLOAKED },
+        };
+        for (size_t i = 0; i < ARRAYSIZE(ranges); i++) {
+            m_hooks[i] = SetWinEventHook(ranges[i][0], ranges[i][1], nullptr, OnWinEvent, 0, 0,
+                WINEVENT_OUTOFCONTEXT | WINEVENT_SKIPOWNPROCESS);
+        }
+    }
+
+    static void CALLBACK OnWinEvent(HWINEVENTHOOK hook, DWORD event, HWND hwnd, LONG idObject, LONG idChild,
+        DWORD eventThread, DWORD eventTime) {
+        UNREFERENCED_PARAMETER(hook);
+        UNREFERENCED_PARAMETER(event);
+        UNREFERENCED_PARAMETER(eventThread);
+        UNREFERENCED_PARAMETER(eventTime);
+        // Child controls are not listed; a destroyed window reads as style 0
+        if (hwnd && idObject == OBJID_WINDOW && idChild == CHILDID_SELF &&
+            !(GetWindowLongPtrW(hwnd, GWL_STYLE) & WS_CHILD)) {
+            s_changed = true;
+        }
+    }
+
+    static BOOL WINAPI OnConsoleControl(DWORD type) {
+        UNREFERENCED_PARAMETER(type);
+        SetEvent(s_stopEvent);
+        return TRUE;
+    }
+
+    static const ULONGLONG SETTLE_MS = 30;
+
+    // Out-of-context hooks call back on this thread while it pumps messages
+    static bool s_changed;
+    static HANDLE s_stopEvent;
+
+    std::vector<WindowInfo> m_windows;
+    Win32MonitorSource m_monitors;
+    HWINEVENTHOOK m_hooks[3] = {};
+    ULONGLONG m_lastLoad = 0;
+};
+
+bool LiveWindowSource::s_changed = false;
+HANDLE LiveWindowSource::s_stopEvent = nullptr;
+
+static HANDLE GetStandardHandle(DWORD which) {
+    HANDLE handle = GetStdHandle(which);
+    return handle == INVALID_HANDLE_VALUE ? nullptr : handle;
+}
+
+// Runs a headless command and exits without creating a window, taking the
+// single-instance mutex or initializing common controls and dark mode
+static int RunHeadless(const std::vector<std::wstring>& args) {
+    // A GUI-subsystem process has no standard handles unless they are
+    // redirected; use the console of the shell that started it for the rest
+    HANDLE hOut = GetStandardHandle(STD_OUTPUT_HANDLE);
+    HANDLE hErr = GetStandardHandle(STD_ERROR_HANDLE);
+    if ((!hOut || !hErr) && AttachConsole(ATTACH_PARENT_PROCESS)) {
+        HANDLE hConsole = CreateFileW(L"CONOUT$", GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ | FILE_SHARE_WRITE,
+            nullptr, OPEN_EXISTING, 0, nullptr);
+        if (hConsole != INVALID_HANDLE_VALUE) {
+            if (!hOut) hOut = hConsole;
+            if (!hErr) hErr = hConsole;
+        }
+    }
+
+    // Same coordinates as the GUI reports
+    SetProcessDpiAwarenessContext(DPI_AWARENESS_CONTEXT_PER_MONITOR_AWARE_V2);
+
+    StdHandleSink out(hOut);
+    StdHandleSink err(hErr);
+    LiveWindowSource live;
+    return HeadlessRunner::Run(args, &live, out, err);
+}
+
 int WINAPI wWinMain(
     _In_ HINSTANCE hInstance,
     _In_opt_ HINSTANCE hPrevInstance,
@@ -12,7 +223,12 @@ int WINAPI wWinMain(
     _In_ int nCmdShow)
 {
     UNREFERENCED_PARAMETER(hPrevInstance);
-    UNREFERENCED_PARAMETER(lpCmdLine);
+
+    // Any argument selects the headless mode
+    std::vector<std::wstring> args = CommandLine::Split(lpCmdLine);
+    if (!args.empty()) {
+        return RunHeadless(args);
+    }
 
     // Check for single instance
     HANDLE hMutex = CreateMutexW(nullptr, TRUE, MUTEX_NAME);
@@ -12,6 +12,9 @@
 #define IDC_EDIT_SEARCH         1006
 #define IDC_CHECK_AUTO_REFRESH  1007
 #define IDC_EDIT_REFRESH_TIME   1008
+#define IDC_BTN_EXPORT          1009
+#define IDC_REPLAY_SLIDER       1010
+#define IDC_BTN_PICK            1011
 
 // Menu IDs
 #define IDM_FILE_EXIT           2001
@@ -30,6 +33,38 @@
 #define IDM_DETAIL_COPY_PROP    4101
 #define IDM_DETAIL_COPY_VALUE   4102
 #define IDM_DETAIL_COPY_BOTH    4103
+#define IDM_DETAIL_COPY_TSV     4104
+#define IDM_DETAIL_COPY_JSON    4105
+#define IDM_DETAIL_COPY_MARKDOWN 4106
+
+// Export Menu IDs
+#define IDM_EXPORT_CSV          4201
+#define IDM_EXPORT_JSON         4202
+#define IDM_EXPORT_NDJSON       4203
+#define IDM_EXPORT_BINARY       4204
+#define IDM_OPEN_SNAPSHOT       4205
+#define IDM_RECORD_START        4206
+#define IDM_RECORD_STOP         4207
+#define IDM_OPEN_RECORDING      4208
+#define IDM_RULES_LOAD          4209
+#define IDM_RULES_CLEAR         4210
+#define IDM_FILTER_OCCLUDED     4211
+#define IDM_FILTER_OFFSCREEN    4212
+#define IDM_GROUP_MONITOR       4213
+#define IDM_GROUP_PROCESS       4214
+#define IDM_GROUP_THREAD        4215
+
+// Arrange Menu IDs (a contiguous range)
+#define IDM_ARRANGE_TILE        4301
+#define IDM_ARRANGE_CASCADE     4302
+#define IDM_ARRANGE_FRONT       4303
+#define IDM_ARRANGE_BACK        4304
+#define IDM_ARRANGE_TOPMOST     4305
+#define IDM_ARRANGE_NOTOPMOST   4306
+
+// Fade Menu IDs
+#define IDM_FADE_HALF           4401
+#define IDM_FADE_OPAQUE         4402
 
 // Detail Dialog Controls
 #define IDD_DETAIL              3000
@@ -59,3 +94,4 @@
 #define IDC_BTN_REFRESH_INFO    3028
 #define IDC_DETAIL_AUTO_REFRESH 3029
 #define IDC_DETAIL_REFRESH_TIME 3030
+#define IDC_DETAIL_FAST_REFRESH 3031
@@ -0,0 +1,253 @@
+// AnimationScheduler on a simulated clock, ticked at 60 Hz: easing curves
+// hold their endpoints and never step backwards, fades and moves send only
+// values that changed and land exactly on their targets, retargeting carries
+// on from the value reached without a jump, and cancelled animations send
+// nothing more.
+
+#include "TestHarness.h"
+#include "WindowAnimation.h"
+#include <cstdlib>
+#include <map>
+
+static const uint64_t FRAME_US = 16667;
+static const EasingCurve CURVES[] = { EASE_LINEAR, EASE_IN_QUAD, EASE_OUT_QUAD, EASE_IN_OUT_CUBIC };
+
+static WindowInfo MakeWindow(uint32_t id) {
+    WindowInfo win = {};
+    win.hwnd = MakeHandle(0x1000 + id * 4);
+    win.rect = { 100, 100, 500, 400 };
+    win.style = WS_CAPTION | WS_VISIBLE;
+    win.isVisible = true;
+    win.alpha = 255;
+    return win;
+}
+
+// Everything sent for one window over a run of ticks
+struct Sent {
+    std::vector<AnimationFrame::Alpha> alphas;
+    std::vector<PlacementEntry> entries;
+};
+
+// Ticks from now until the scheduler is idle or frames run out
+static std::map<HWND, Sent> Run(AnimationScheduler& scheduler, uint64_t& now, size_t frames = 1000) {
+    std::map<HWND, Sent> sent;
+    AnimationFrame frame;
+    for (size_t i = 0; i < frames && scheduler.IsActive(); i++) {
+        now += FRAME_US;
+        frame.Clear();
+        scheduler.Tick(now, frame);
+        for (const AnimationFrame::Alpha& alpha : frame.alphas) {
+            sent[alpha.hwnd].alphas.push_back(alpha);
+        }
+        for (const PlacementEntry& entry : frame.placement.Entries()) {
+            sent[entry.hwnd].entries.push_back(entry);
+        }
+    }
+    return sent;
+}
+
+// Checks a fade's values: each differs from the one before, all move
+// towards the target no faster than maxStep, only the first is marked first
+// and only the last, which is the target, is marked last
+static void CheckFade(const std::vector<AnimationFrame::Alpha>& alphas, int from, int to, int maxStep, bool first) {
+    CHECK(!alphas.empty());
+    int previous = from;
+    for (size_t i = 0; i < alphas.size(); i++) {
+        int alpha = alphas[i].alpha;
+        CHECK(alphas[i].first == (first && i == 0));
+        CHECK(alphas[i].last == (i + 1 == alphas.size()));
+        CHECK(i + 1 == alphas.size() || alpha != previous);
+        CHECK(to >= from ? alpha >= previous : alpha <= previous);
+        CHECK(std::abs(alpha - previous) <= maxStep);
+        previous = alpha;
+    }
+    CHECK(alphas.back().alpha == to);
+}
+
+int main() {
+    // Easing: endpoints exact, clamped outside [0, 1], never decreasing
+    for (EasingCurve curve : CURVES) {
+        CHECK(Easing::Apply(curve, 0.0) == 0.0);
+        CHECK(Easing::Apply(curve, 1.0) == 1.0);
+        CHECK(Easing::Apply(curve, -0.5) == 0.0);
+        CHECK(Easing::Apply(curve, 2.0) == 1.0);
+        double previous = 0.0;
+        for (int i = 1; i <= 1000; i++) {
+            double eased = Easing::Apply(curve, i / 1000.0);
+            CHECK(eased >= previous && eased <= 1.0);
+            previous = eased;
+        }
+    }
+    CHECK(Easing::Apply(EASE_LINEAR, 0.25) == 0.25);
+    CHECK(Easing::Apply(EASE_IN_QUAD, 0.5) < 0.5 && Easing::Apply(EASE_OUT_QUAD, 0.5) > 0.5);
+    CHECK(Easing::Apply(EASE_IN_OUT_CUBIC, 0.5) == 0.5);
+
+    // A fade out on every curve, from an unlayered window
+    for (EasingCurve curve : CURVES) {
+        AnimationScheduler scheduler;
+        uint64_t now = 5000000;
+        WindowInfo win = MakeWindow(1);
+        scheduler.AnimateAlpha(win, 0, 200, curve, now);
+        CHECK(scheduler.IsActive() && scheduler.Count() == 1);
+
+        // Nothing is due at the start time itself
+        AnimationFrame frame;
+        scheduler.Tick(now, frame);
+        CHECK(frame.Empty());
+
+        std::map<HWND, Sent> sent = Run(scheduler, now);
+        CHECK(!scheduler.IsActive());
+        // 200 ms is 12 frames; the steepest curve moves 3x the linear rate
+        CheckFade(sent[win.hwnd].alphas, 255, 0, 255 * 3 * 17 / 200 + 1, true);
+        CHECK(sent[win.hwnd].alphas.size() <= 13 && sent[win.hwnd].entries.empty());
+
+        frame.Clear();
+        scheduler.Tick(now + FRAME_US, frame);
+        CHECK(frame.Empty());
+    }
+
+    // A fade from a layered window starts at its alpha; zero duration lands at once
+    {
+        AnimationScheduler scheduler;
+        uint64_t now = 0;
+        WindowInfo win = MakeWindow(2);
+        win.isLayered = true;
+        win.alpha = 100;
+        scheduler.AnimateAlpha(win, 200, 100, EASE_LINEAR, now);
+        CheckFade(Run(scheduler, now)[win.hwnd].alphas, 100, 200, 100 * 17 / 100 + 1, true);
+
+        scheduler.AnimateAlpha(win, 30, 0, EASE_LINEAR, now);
+        std::vector<AnimationFrame::Alpha> alphas = Run(scheduler, now)[win.hwnd].alphas;
+        CHECK(alphas.size() == 1 && alphas[0].alpha == 30 && alphas[0].first && alphas[0].last);
+    }
+
+    // A move and resize: placed on the first frame, then only what changed
+    {
+        AnimationScheduler scheduler;
+        uint64_t now = 0;
+        WindowInfo win = MakeWindow(3);
+        win.isMaximized = true;
+        RECT target = { 700, 300, 1300, 700 };
+        scheduler.AnimateBounds(win, target, 150, EASE_OUT_QUAD, now);
+        std::vector<PlacementEntry> entries = Run(scheduler, now)[win.hwnd].entries;
+        CHECK(entries.size() >= 2 && entries.size() <= 10);
+        CHECK(entries[0].restore && !(entries[0].flags & (SWP_NOMOVE | SWP_NOSIZE)));
+        for (size_t i = 1; i < entries.size(); i++) {
+            CHECK(!entries[i].restore);
+        }
+        const PlacementEntry& last = entries.back();
+        CHECK(last.x == 700 && last.y == 300 && last.cx == 600 && last.cy == 400);
+
+        // Same size: after the first frame, only moves
+        RECT shifted = { 900, 300, 1500, 700 };
+        win.isMaximized = false;
+        win.rect = target;
+        scheduler.AnimateBounds(win, shifted, 100, EASE_LINEAR, now);
+        entries = Run(scheduler, now)[win.hwnd].entries;
+        CHECK(!(entries[0].flags & SWP_NOSIZE) && !entries[0].restore);
+        int x = 700;
+        for (size_t i = 0; i < entries.size(); i++) {
+            CHECK(i == 0 || ((entries[i].flags & SWP_NOSIZE) && !(entries[i].flags & SWP_NOMOVE)));
+            CHECK(entries[i].x > x && entries[i].x - x <= 200 * 17 / 100 + 1);
+            x = entries[i].x;
+        }
+        CHECK(x == 900);
+    }
+
+    // Retargeting mid-fade carries on from the value reached, with no jump
+    {
+        AnimationScheduler scheduler;
+        uint64_t now = 0;
+        WindowInfo win = MakeWindow(4);
+        scheduler.AnimateAlpha(win, 0, 300, EASE_LINEAR, now);
+        std::vector<AnimationFrame::Alpha> out = Run(scheduler, now, 9)[win.hwnd].alphas;
+        CHECK(scheduler.IsActive() && out.size() == 9 && !out.back().last);
+        int reached = out.back().alpha;
+        CHECK(reached > 0 && reached < 255);
+
+        // The caller's copy is stale; the scheduler's own value wins
+        scheduler.AnimateAlpha(win, 255, 200, EASE_LINEAR, now);
+        CHECK(scheduler.Count() == 1);
+        std::vector<AnimationFrame::Alpha> back = Run(scheduler, now)[win.hwnd].alphas;
+        CheckFade(back, reached, 255, (255 - reached) * 17 / 200 + 1, false);
+
+        // The same for bounds, retargeted twice
+        RECT target = { 1100, 100, 1500, 400 };
+        scheduler.AnimateBounds(win, target, 200, EASE_LINEAR, now);
+        std::vector<PlacementEntry> moves = Run(scheduler, now, 5)[win.hwnd].entries;
+        int x = moves.back().x;
+        CHECK(x > 100 && x < 1100);
+        for (int turn = 0; turn < 2; turn++) {
+            RECT retarget = turn == 0 ? RECT{ -500, 100, -100, 400 } : RECT{ 2000, 100, 2400, 400 };
+            scheduler.AnimateBounds(win, retarget, 200, EASE_LINEAR, now);
+            moves = Run(scheduler, now, turn == 0 ? 6 : 1000)[win.hwnd].entries;
+            int step = std::abs(static_cast<int>(retarget.left) - x) * 17 / 200 + 1;
+            CHECK(std::abs(moves[0].x - x) <= step && !moves[0].restore);
+            for (size_t i = 1; i < moves.size(); i++) {
+                CHECK(std::abs(moves[i].x - moves[i - 1].x) <= step + 1);
+            }
+            x = moves.back().x;
+        }
+        CHECK(x == 2000 && !scheduler.IsActive());
+    }
+
+    // Cancelling stops one window where it is and leaves the rest running
+    {
+        AnimationScheduler scheduler;
+        uint64_t now = 0;
+        std::vector<WindowInfo> windows;
+        for (uint32_t i = 0; i < 50; i++) {
+            windows.push_back(MakeWindow(10 + i));
+            scheduler.AnimateAlpha(windows[i], static_cast<BYTE>(i), 100 + i * 10, EASE_IN_OUT_CUBIC, now);
+            if (i % 3 == 0) {
+                RECT target = { static_cast<LONG>(i * 10), 0, static_cast<LONG>(i * 10 + 400), 300 };
+                scheduler.AnimateBounds(windows[i], target, 200, EASE_LINEAR, now);
+            }
+        }
+        CHECK(scheduler.Count() == 50);
+        std::map<HWND, Sent> early = Run(scheduler, now, 3);
+
+        // Cancelled windows, out of order so the removals move others about
+        for (uint32_t i : { 49u, 0u, 17u, 18u, 31u }) {
+            scheduler.Cancel(windows[i].hwnd);
+        }
+        scheduler.Cancel(MakeHandle(0x999999));
+        CHECK(scheduler.Count() == 45);
+
+        std::map<HWND, Sent> late = Run(scheduler, now);
+        CHECK(!scheduler.IsActive());
+        for (uint32_t i = 0; i < 50; i++) {
+            HWND hwnd = windows[i].hwnd;
+            bool cancelled = i == 49 || i == 0 || i == 17 || i == 18 || i == 31;
+            if (cancelled) {
+                CHECK(late.find(hwnd) == late.end());
+                continue;
+            }
+            std::vector<AnimationFrame::Alpha> alphas = early[hwnd].alphas;
+            alphas.insert(alphas.end(), late[hwnd].alphas.begin(), late[hwnd].alphas.end());
+            CheckFade(alphas, 255, static_cast<int>(i), 255, true);
+            if (i % 3 == 0) {
+                // The size never changes, so only the first frame sets it
+                const PlacementEntry& last = late[hwnd].entries.back();
+                CHECK(last.x == static_cast<int>(i * 10) && last.y == 0 && (last.flags & SWP_NOSIZE));
+                CHECK(early[hwnd].entries[0].cx == 400 && early[hwnd].entries[0].cy == 300);
+            }
+        }
+
+        // A cancelled window animates afresh from the value it is given
+        WindowInfo win = windows[17];
+        win.isLayered = true;
+        win.alpha = 40;
+        scheduler.AnimateAlpha(win, 80, 50, EASE_LINEAR, now);
+        CheckFade(Run(scheduler, now)[win.hwnd].alphas, 40, 80, 40, true);
+
+        for (const WindowInfo& each : windows) {
+            scheduler.AnimateAlpha(each, 0, 100, EASE_LINEAR, now);
+        }
+        scheduler.CancelAll();
+        CHECK(!scheduler.IsActive() && Run(scheduler, now).empty());
+    }
+
+    std::printf("AnimationSchedulerTest passed\n");
+    return 0;
+}
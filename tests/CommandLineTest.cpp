@@ -0,0 +1,98 @@
+// CommandLine::Split with the Windows quoting rules, and CommandLine::Parse
+// on good arguments and on each kind of error.
+
+#include "TestHarness.h"
+#include "CommandLine.h"
+
+static bool SplitsTo(const wchar_t* text, const std::vector<std::wstring>& expected) {
+    return CommandLine::Split(text) == expected;
+}
+
+static bool Fails(const std::vector<std::wstring>& args, const std::wstring& expectedError) {
+    HeadlessOptions options;
+    std::wstring error;
+    return !CommandLine::Parse(args, options, error) && error == expectedError;
+}
+
+int main() {
+    // Whitespace and quotes
+    CHECK(SplitsTo(nullptr, {}));
+    CHECK(SplitsTo(L"", {}));
+    CHECK(SplitsTo(L" \t\r\n ", {}));
+    CHECK(SplitsTo(L"--dump  --format\tcsv\n", { L"--dump", L"--format", L"csv" }));
+    CHECK(SplitsTo(L"--query \"title:* - Notepad\"", { L"--query", L"title:* - Notepad" }));
+    CHECK(SplitsTo(L"a\"b c\"d e", { L"ab cd", L"e" }));
+    CHECK(SplitsTo(L"\"\" x", { L"", L"x" }));
+    CHECK(SplitsTo(L"\"unterminated arg", { L"unterminated arg" }));
+    CHECK(SplitsTo(L"--query=\"a b\"", { L"--query=a b" }));
+
+    // Backslashes are literal unless they precede a quote: 2n escape to n and
+    // the quote toggles, 2n+1 escape to n and a literal quote
+    CHECK(SplitsTo(L"C:\\Temp\\a.wls", { L"C:\\Temp\\a.wls" }));
+    CHECK(SplitsTo(L"\"C:\\Program Files\\\\\" next", { L"C:\\Program Files\\", L"next" }));
+    CHECK(SplitsTo(L"a\\\"b", { L"a\"b" }));
+    CHECK(SplitsTo(L"a\\\\\\\"b", { L"a\\\"b" }));
+    CHECK(SplitsTo(L"a\\\\\"b c\"", { L"a\\b c" }));
+    CHECK(SplitsTo(L"\\\\server\\share", { L"\\\\server\\share" }));
+
+    // Good arguments, with values after a space or '='
+    {
+        HeadlessOptions options;
+        std::wstring error;
+        CHECK(CommandLine::Parse({ L"--dump", L"--format=csv", L"--query", L"class:Notepad", L"--query=-visible:no",
+            L"--sort", L"process,-pid", L"--hide-hidden", L"--hide-system", L"--input", L"a.wlr",
+            L"--at=1700000000000" }, options, error));
+        CHECK(options.command == HEADLESS_DUMP);
+        CHECK(options.format == SNAPSHOT_CSV);
+        CHECK(options.query == L"class:Notepad -visible:no");
+        CHECK(options.sort.keys.size() == 2 && options.sort.keys[1].column == COLUMN_PID &&
+            !options.sort.keys[1].ascending);
+        CHECK(options.hideHidden && options.hideSystem);
+        CHECK(options.input == L"a.wlr");
+        CHECK(options.hasTime && options.time == 1700000000000ULL);
+    }
+    {
+        HeadlessOptions options;
+        std::wstring error;
+        CHECK(CommandLine::Parse({ L"--watch", L"--fields", L"moved,-rect", L"--interval=50", L"--initial" },
+            options, error));
+        CHECK(options.command == HEADLESS_WATCH && options.format == SNAPSHOT_NDJSON);
+        CHECK(options.watchInterval == 50 && options.watchInitial);
+        CHECK(CommandLine::Parse({ L"/?" }, options, error) && options.command == HEADLESS_HELP);
+        CHECK(CommandLine::Parse({ L"--help", L"--dump" }, options, error) && options.command == HEADLESS_HELP);
+        CHECK(CommandLine::Parse({ L"--dump", L"--dump" }, options, error) && options.command == HEADLESS_DUMP);
+        // Parsing starts from the defaults every time
+        CHECK(CommandLine::Parse({ L"--dump" }, options, error));
+        CHECK(options.format == SNAPSHOT_NDJSON && !options.watchInitial && options.watchInterval == 250);
+    }
+
+    // Errors
+    CHECK(Fails({}, L"No command given; use --dump, --watch or --help"));
+    CHECK(Fails({ L"--format", L"csv" }, L"No command given; use --dump, --watch or --help"));
+    CHECK(Fails({ L"--dump", L"--watch" }, L"Use either --dump or --watch"));
+    CHECK(Fails({ L"--dump", L"--frobnicate" }, L"Unknown option '--frobnicate'"));
+    CHECK(Fails({ L"--dump", L"--hide-hidden=yes" }, L"--hide-hidden takes no value"));
+    CHECK(Fails({ L"--watch", L"--initial=no" }, L"--initial takes no value"));
+    CHECK(Fails({ L"--dump=csv" }, L"--dump takes no value"));
+    CHECK(Fails({ L"dump" }, L"Unknown option 'dump'"));
+    CHECK(Fails({ L"--dump", L"--format" }, L"--format needs a value"));
+    CHECK(Fails({ L"--dump", L"--format", L"xml" }, L"Unknown format 'xml' (expected csv, json or ndjson)"));
+    CHECK(Fails({ L"--dump", L"--format=" }, L"Unknown format '' (expected csv, json or ndjson)"));
+    CHECK(Fails({ L"--dump", L"--sort", L"pid,pid" }, L"Bad sort spec 'pid,pid'"));
+    CHECK(Fails({ L"--dump", L"--sort=colour" }, L"Bad sort spec 'colour'"));
+    CHECK(Fails({ L"--dump", L"--at", L"yesterday" }, L"Expected milliseconds since 1970 for --at, got 'yesterday'"));
+    CHECK(Fails({ L"--dump", L"--at=99999999999999999999" },
+        L"Expected milliseconds since 1970 for --at, got '99999999999999999999'"));
+    CHECK(Fails({ L"--watch", L"--interval", L"0" }, L"Expected 1 to 3600000 milliseconds for --interval, got '0'"));
+    CHECK(Fails({ L"--watch", L"--interval=3600001" },
+        L"Expected 1 to 3600000 milliseconds for --interval, got '3600001'"));
+    CHECK(Fails({ L"--watch", L"--format", L"csv" }, L"--watch writes NDJSON only"));
+    CHECK(Fails({ L"--watch", L"--sort", L"pid" }, L"--sort does not apply to --watch"));
+    CHECK(Fails({ L"--dump", L"--sort", L"title,-raised" },
+        L"--sort raised does not apply to --dump; it needs the window list followed over time"));
+    CHECK(Fails({ L"--watch", L"--fields", L"colour" }, L"Unknown watch field 'colour'"));
+    CHECK(Fails({ L"--watch", L"--fields=title,,rect" }, L"Empty name in the field list"));
+
+    std::printf("CommandLineTest passed\n");
+    return 0;
+}
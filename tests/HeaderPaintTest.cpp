@@ -0,0 +1,99 @@
+// HeaderPaintState: when the cached header bitmap is redrawn, and where the
+// text and sort arrow of each item go.
+
+#include "TestHarness.h"
+#include "HeaderPaint.h"
+
+static std::vector<HeaderItemState> Columns() {
+    std::vector<HeaderItemState> items;
+    const wchar_t* const names[] = { L"HWND", L"Title", L"Class", L"Process" };
+    int left = 0;
+    for (int i = 0; i < 4; i++) {
+        items.push_back({ left, 0, left + 100 + i * 20, 24, i == 1 ? 1 : 0, names[i] });
+        left = items.back().right;
+    }
+    return items;
+}
+
+int main() {
+    // Redrawn the first time, then only when something shown changes
+    {
+        HeaderPaintState state;
+        CHECK(state.Update(400, 24, Columns()));
+        CHECK(state.Width() == 400 && state.Height() == 24);
+        CHECK(state.Items() == Columns());
+        CHECK(!state.Update(400, 24, Columns()));
+
+        CHECK(state.Update(401, 24, Columns()));
+        CHECK(!state.Update(401, 24, Columns()));
+        CHECK(state.Update(401, 30, Columns()));
+        CHECK(!state.Update(401, 30, Columns()));
+
+        std::vector<HeaderItemState> items = Columns();
+        items[2].right += 5;
+        CHECK(state.Update(401, 30, std::move(items)));
+        CHECK(state.Items()[2].right == Columns()[2].right + 5);
+
+        items = Columns();
+        items[1].sortDirection = -1;
+        CHECK(state.Update(401, 30, std::move(items)));
+        items = Columns();
+        items[1].sortDirection = -1;
+        CHECK(!state.Update(401, 30, std::move(items)));
+
+        items = Columns();
+        items[1].sortDirection = -1;
+        items[3].text = L"Process Name";
+        CHECK(state.Update(401, 30, std::move(items)));
+
+        items = Columns();
+        items[1].sortDirection = -1;
+        items[3].text = L"Process Name";
+        items.pop_back();
+        CHECK(state.Update(401, 30, std::move(items)));
+        CHECK(state.Items().size() == 3);
+
+        // Invalidate forces one redraw of unchanged items
+        std::vector<HeaderItemState> same = state.Items();
+        state.Invalidate();
+        CHECK(state.Update(401, 30, std::vector<HeaderItemState>(same)));
+        CHECK(!state.Update(401, 30, std::vector<HeaderItemState>(same)));
+    }
+
+    // An empty header at zero size is still drawn once
+    {
+        HeaderPaintState state;
+        CHECK(state.Update(0, 0, {}));
+        CHECK(!state.Update(0, 0, {}));
+    }
+
+    // Text inset, no arrow when unsorted
+    {
+        HeaderItemState item = { 100, 0, 220, 24, 0, L"Title" };
+        HeaderItemGeometry geometry = HeaderPaintState::Layout(item);
+        CHECK(geometry.textLeft == 106 && geometry.textRight == 208);
+        CHECK(geometry.textTop == 0 && geometry.textBottom == 24);
+        CHECK(!geometry.hasArrow);
+    }
+
+    // Ascending points up, descending down, centred right of the text
+    for (int direction : { 1, -1 }) {
+        HeaderItemState item = { 100, 4, 220, 28, direction, L"Title" };
+        HeaderItemGeometry geometry = HeaderPaintState::Layout(item);
+        CHECK(geometry.hasArrow);
+        int cx = 208;
+        int cy = 16;
+        CHECK(geometry.arrowX[0] == cx && geometry.arrowX[1] == cx + 4 && geometry.arrowX[2] == cx - 4);
+        CHECK(geometry.arrowY[1] == geometry.arrowY[2]);
+        if (direction > 0) {
+            CHECK(geometry.arrowY[0] == cy - 3 && geometry.arrowY[1] == cy + 2);
+        } else {
+            CHECK(geometry.arrowY[0] == cy + 3 && geometry.arrowY[1] == cy - 2);
+        }
+        CHECK(geometry.arrowX[1] <= item.right && geometry.arrowX[2] >= geometry.textRight - 4);
+        CHECK(geometry.arrowY[0] > item.top && geometry.arrowY[0] < item.bottom);
+    }
+
+    std::printf("HeaderPaintTest passed\n");
+    return 0;
+}
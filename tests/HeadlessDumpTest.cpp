@@ -0,0 +1,261 @@
+// HeadlessRunner --dump --input against golden output: a small snapshot file
+// and recording written here, dumped in each format, with a query, a sort,
+// the hide switches and --at, and the exit codes and messages for bad input.
+
+#include "TestHarness.h"
+#include "HeadlessMode.h"
+#include "BufferedWriter.h"
+#include "FileIO.h"
+#include "SnapshotFile.h"
+#include "SnapshotRecording.h"
+
+static const wchar_t* const SNAPSHOT_PATH = L"HeadlessDumpTest.wls";
+static const wchar_t* const RECORDING_PATH = L"HeadlessDumpTest.wlr";
+
+#define CSV_HEADER \
+    "hwnd,parent,owner,title,className,processId,threadId,processName,processPath,left,top,right,bottom," \
+    "clientWidth,clientHeight,style,exStyle,styleFlags,exStyleFlags,visible,enabled,minimized,maximized," \
+    "topmost,layered,transparent,cloaked,uwp,hung,alpha,zOrder,hasDwmFrame,dwmLeft,dwmTop,dwmRight," \
+    "dwmBottom,system,hidden\r\n"
+#define NOTEPAD_CSV \
+    "0x1A2B,0x0,0x0,Untitled - Notepad,Notepad,4242,4243,notepad.exe,C:\\Windows\\notepad.exe,10,20,810,620," \
+    "784,541,0x10C80000,0x00000000,WS_VISIBLE | WS_CAPTION | WS_BORDER | WS_DLGFRAME | WS_SYSMENU,,true,true," \
+    "false,false,false,false,false,false,false,false,255,0,false,0,0,0,0,false,false\r\n"
+#define WORD_CSV \
+    "0x2C3C,0x0,0x0,\"Report, \"\"final\"\" \xC3\xA9\",OpusApp,77,78,WINWORD.EXE,,-8,-8,1928,1048,0,0,0x10C00000," \
+    "0x00000000,WS_VISIBLE | WS_CAPTION | WS_BORDER | WS_DLGFRAME,,true,true,false,true,false,false,false," \
+    "false,false,false,255,1,false,0,0,0,0,false,false\r\n"
+#define NOTEPAD_JSON \
+    "{\"hwnd\":\"0x1A2B\",\"parent\":\"0x0\",\"owner\":\"0x0\",\"title\":\"Untitled - Notepad\"," \
+    "\"className\":\"Notepad\",\"processId\":4242,\"threadId\":4243,\"processName\":\"notepad.exe\"," \
+    "\"processPath\":\"C:\\\\Windows\\\\notepad.exe\",\"left\":10,\"top\":20,\"right\":810,\"bottom\":620," \
+    "\"clientWidth\":784,\"clientHeight\":541,\"style\":281542656,\"exStyle\":0," \
+    "\"styleFlags\":\"WS_VISIBLE | WS_CAPTION | WS_BORDER | WS_DLGFRAME | WS_SYSMENU\",\"exStyleFlags\":\"\"," \
+    "\"visible\":true,\"enabled\":true,\"minimized\":false,\"maximized\":false,\"topmost\":false," \
+    "\"layered\":false,\"transparent\":false,\"cloaked\":false,\"uwp\":false,\"hung\":false,\"alpha\":255," \
+    "\"zOrder\":0,\"hasDwmFrame\":false,\"dwmLeft\":0,\"dwmTop\":0,\"dwmRight\":0,\"dwmBottom\":0," \
+    "\"system\":false,\"hidden\":false}"
+#define WORD_JSON \
+    "{\"hwnd\":\"0x2C3C\",\"parent\":\"0x0\",\"owner\":\"0x0\",\"title\":\"Report, \\\"final\\\" \xC3\xA9\"," \
+    "\"className\":\"OpusApp\",\"processId\":77,\"threadId\":78,\"processName\":\"WINWORD.EXE\"," \
+    "\"processPath\":\"\",\"left\":-8,\"top\":-8,\"right\":1928,\"bottom\":1048,\"clientWidth\":0," \
+    "\"clientHeight\":0,\"style\":281018368,\"exStyle\":0," \
+    "\"styleFlags\":\"WS_VISIBLE | WS_CAPTION | WS_BORDER | WS_DLGFRAME\",\"exStyleFlags\":\"\"," \
+    "\"visible\":true,\"enabled\":true,\"minimized\":false,\"maximized\":true,\"topmost\":false," \
+    "\"layered\":false,\"transparent\":false,\"cloaked\":false,\"uwp\":false,\"hung\":false,\"alpha\":255," \
+    "\"zOrder\":1,\"hasDwmFrame\":false,\"dwmLeft\":0,\"dwmTop\":0,\"dwmRight\":0,\"dwmBottom\":0," \
+    "\"system\":false,\"hidden\":false}"
+
+static std::vector<WindowInfo> GoldenWindows() {
+    std::vector<WindowInfo> windows(4);
+    windows[0].hwnd = MakeHandle(0x1A2B);
+    windows[0].title = L"Untitled - Notepad";
+    windows[0].className = L"Notepad";
+    windows[0].processId = 4242;
+    windows[0].threadId = 4243;
+    windows[0].processName = L"notepad.exe";
+    windows[0].processPath = L"C:\\Windows\\notepad.exe";
+    windows[0].rect = { 10, 20, 810, 620 };
+    windows[0].clientRect = { 0, 0, 784, 541 };
+    windows[0].style = WS_CAPTION | WS_SYSMENU | WS_VISIBLE;
+    windows[0].isVisible = true;
+    windows[0].isEnabled = true;
+    windows[0].alpha = 255;
+
+    windows[1].hwnd = MakeHandle(0x2C3C);
+    windows[1].title = L"Report, \"final\" \u00e9";
+    windows[1].className = L"OpusApp";
+    windows[1].processId = 77;
+    windows[1].threadId = 78;
+    windows[1].processName = L"WINWORD.EXE";
+    windows[1].rect = { -8, -8, 1928, 1048 };
+    windows[1].style = WS_CAPTION | WS_VISIBLE;
+    windows[1].isVisible = true;
+    windows[1].isEnabled = true;
+    windows[1].isMaximized = true;
+    windows[1].alpha = 255;
+    windows[1].zOrder = 1;
+
+    // A system window: untitled tool window
+    windows[2].hwnd = MakeHandle(0x3D4C);
+    windows[2].className = L"tooltips_class32";
+    windows[2].processId = 4242;
+    windows[2].threadId = 4243;
+    windows[2].processName = L"notepad.exe";
+    windows[2].exStyle = WS_EX_TOOLWINDOW | WS_EX_TOPMOST;
+    windows[2].isVisible = true;
+    windows[2].isTopMost = true;
+    windows[2].alpha = 255;
+    windows[2].zOrder = 2;
+
+    // A hidden window
+    windows[3].hwnd = MakeHandle(0x4E50);
+    windows[3].title = L"Settings";
+    windows[3].className = L"ApplicationFrameWindow";
+    windows[3].processId = 9;
+    windows[3].threadId = 10;
+    windows[3].processName = L"ApplicationFrameHost.exe";
+    windows[3].isCloaked = true;
+    windows[3].isUWP = true;
+    windows[3].isVisible = true;
+    windows[3].alpha = 255;
+    windows[3].zOrder = 3;
+    return windows;
+}
+
+struct Result {
+    int status;
+    std::string out;
+    std::string err;
+};
+
+// No live windows, only a fixed set of monitors
+class FixedDisplay : public WindowSource, public MonitorSource {
+public:
+    explicit FixedDisplay(const std::vector<MonitorDesc>& monitors) : m_monitors(monitors) {}
+
+    bool Load(std::vector<WindowInfo>& windows, std::wstring& error) override {
+        windows.clear();
+        error = L"No live windows";
+        return false;
+    }
+    bool WaitForChange(uint32_t) override { return false; }
+    MonitorSource* Monitors() override { return this; }
+
+    bool Load(std::vector<MonitorDesc>& monitors) override {
+        monitors = m_monitors;
+        return !monitors.empty();
+    }
+
+private:
+    std::vector<MonitorDesc> m_monitors;
+};
+
+static Result Dump(std::vector<std::wstring> args, WindowSource* live = nullptr) {
+    Result result;
+    StringSink out(result.out);
+    StringSink err(result.err);
+    result.status = HeadlessRunner::Run(args, live, out, err);
+    return result;
+}
+
+static bool DumpsTo(const std::vector<std::wstring>& args, const char* expected, WindowSource* live = nullptr) {
+    Result result = Dump(args, live);
+    if (result.status != HeadlessRunner::EXIT_OK || result.out != expected || !result.err.empty()) {
+        std::printf("status %d\n--- out ---\n%s--- err ---\n%s", result.status, result.out.c_str(),
+            result.err.c_str());
+        return false;
+    }
+    return true;
+}
+
+static bool WriteSnapshot(const std::wstring& path, const std::vector<WindowInfo>& windows) {
+    std::string bytes;
+    StringSink sink(bytes);
+    if (!SnapshotFileWriter::Write(windows, 1700000000000ULL, sink)) return false;
+    FILE* file = FileIO::Open(path, "wb");
+    if (!file) return false;
+    bool ok = fwrite(bytes.data(), 1, bytes.size(), file) == bytes.size();
+    return fclose(file) == 0 && ok;
+}
+
+int main() {
+    std::vector<WindowInfo> windows = GoldenWindows();
+    CHECK(WriteSnapshot(SNAPSHOT_PATH, windows));
+
+    // Every window, every column, in z-order
+    CHECK(DumpsTo({ L"--dump", L"--input", SNAPSHOT_PATH, L"--format=csv" }, CSV_HEADER NOTEPAD_CSV WORD_CSV
+        "0x3D4C,0x0,0x0,,tooltips_class32,4242,4243,notepad.exe,,0,0,0,0,0,0,0x00000000,0x00000088,,"
+        "WS_EX_TOPMOST | WS_EX_TOOLWINDOW,true,false,false,false,true,false,false,false,false,false,255,2,false,"
+        "0,0,0,0,true,false\r\n"
+        "0x4E50,0x0,0x0,Settings,ApplicationFrameWindow,9,10,ApplicationFrameHost.exe,,0,0,0,0,0,0,0x00000000,"
+        "0x00000000,,,true,false,false,false,false,false,false,true,true,false,255,3,false,0,0,0,0,true,true\r\n"));
+
+    // Hide switches and a descending sort
+    CHECK(DumpsTo({ L"--dump", L"--input", SNAPSHOT_PATH, L"--format=csv", L"--hide-hidden", L"--hide-system",
+        L"--sort", L"-pid" }, CSV_HEADER NOTEPAD_CSV WORD_CSV));
+    CHECK(DumpsTo({ L"--dump", L"--input", SNAPSHOT_PATH, L"--format=csv", L"--hide-hidden", L"--hide-system",
+        L"--sort", L"pid" }, CSV_HEADER WORD_CSV NOTEPAD_CSV));
+
+    // Queries, and the default NDJSON
+    CHECK(DumpsTo({ L"--dump", L"--input", SNAPSHOT_PATH, L"--format=csv", L"--query", L"notepad -system:yes" },
+        CSV_HEADER NOTEPAD_CSV));
+    CHECK(DumpsTo({ L"--dump", L"--input", SNAPSHOT_PATH, L"--query", L"hwnd:1a2b" }, NOTEPAD_JSON "\n"));
+    CHECK(DumpsTo({ L"--dump", L"--input", SNAPSHOT_PATH, L"--format=json", L"--query", L"pid:77" },
+        "[\n" WORD_JSON "\n]\n"));
+    CHECK(DumpsTo({ L"--dump", L"--input", SNAPSHOT_PATH, L"--format=json", L"--query", L"pid:1" }, "[]\n"));
+    // Sorting on exposure measures every window before selecting
+    CHECK(DumpsTo({ L"--dump", L"--input", SNAPSHOT_PATH, L"--query", L"hwnd:1a2b", L"--sort", L"exposed" },
+        NOTEPAD_JSON "\n"));
+
+    // Sorting on monitors places the windows on the attached ones first:
+    // both on one monitor, Word further left; then Word mostly on a second
+    // monitor that sorts last
+    FixedDisplay display({ { { 0, 0, 1920, 1080 }, { 0, 0, 1920, 1040 }, 96, true } });
+    CHECK(DumpsTo({ L"--dump", L"--input", SNAPSHOT_PATH, L"--format=csv", L"--hide-hidden", L"--hide-system",
+        L"--sort", L"monitor" }, CSV_HEADER WORD_CSV NOTEPAD_CSV, &display));
+    {
+        FixedDisplay split({ { { -1000, -500, 800, 1080 }, { -1000, -500, 800, 1040 }, 192, true },
+            { { 800, 0, 2720, 1080 }, { 800, 0, 2720, 1040 }, 96, false } });
+        CHECK(DumpsTo({ L"--dump", L"--input", SNAPSHOT_PATH, L"--format=csv", L"--hide-hidden", L"--hide-system",
+            L"--sort", L"-monitor" }, CSV_HEADER WORD_CSV NOTEPAD_CSV, &split));
+    }
+
+    // A recording: the frame in effect at --at, or the last frame
+    {
+        SnapshotRecorder recorder;
+        CHECK(recorder.Start(RECORDING_PATH));
+        CHECK(recorder.Record(windows, 1000));
+        std::vector<WindowInfo> retitled = windows;
+        retitled[0].title = L"notes.txt - Notepad";
+        CHECK(recorder.Record(retitled, 2000));
+        recorder.Stop();
+
+        std::wstring segment = SnapshotRecorder::SegmentPath(RECORDING_PATH, 1);
+        std::string renamed = NOTEPAD_JSON "\n";
+        renamed.replace(renamed.find("Untitled - Notepad"), 18, "notes.txt - Notepad");
+        CHECK(DumpsTo({ L"--dump", L"--input", segment, L"--query", L"hwnd:1a2b", L"--at", L"1999" },
+            NOTEPAD_JSON "\n"));
+        CHECK(DumpsTo({ L"--dump", L"--input", segment, L"--query", L"hwnd:1a2b", L"--at", L"0" },
+            NOTEPAD_JSON "\n"));
+        CHECK(DumpsTo({ L"--dump", L"--input", segment, L"--query", L"hwnd:1a2b" }, renamed.c_str()));
+        CHECK(DumpsTo({ L"--dump", L"--input", segment, L"--query", L"hwnd:1a2b", L"--at=2000" }, renamed.c_str()));
+        // A recording frame is loaded whole, then placed on the monitors
+        CHECK(DumpsTo({ L"--dump", L"--input", segment, L"--at", L"1999", L"--format=csv", L"--hide-hidden",
+            L"--hide-system", L"--sort", L"monitor" }, CSV_HEADER WORD_CSV NOTEPAD_CSV, &display));
+        FileIO::Remove(segment);
+    }
+
+    // Failures: nothing on stdout, one line on stderr, and the exit code
+    {
+        Result result = Dump({ L"--dump", L"--input", L"missing.wls" });
+        CHECK(result.status == HeadlessRunner::EXIT_FAILED && result.out.empty());
+        CHECK(result.err == "WinLister: Cannot read 'missing.wls' as a WinLister snapshot or recording\n");
+
+        result = Dump({ L"--dump", L"--input", SNAPSHOT_PATH, L"--query", L"pid:abc" });
+        CHECK(result.status == HeadlessRunner::EXIT_USAGE && result.out.empty());
+        CHECK(result.err == "WinLister: Expected a number for 'pid'\n");
+
+        result = Dump({ L"--dump", L"--input", SNAPSHOT_PATH, L"--format", L"xml" });
+        CHECK(result.status == HeadlessRunner::EXIT_USAGE && result.out.empty());
+        std::string message = "WinLister: Unknown format 'xml' (expected csv, json or ndjson)\n";
+        CHECK(result.err.compare(0, message.size(), message) == 0);
+        CHECK(result.err.find("Usage: WinLister --dump") != std::string::npos);
+
+        result = Dump({ L"--dump", L"--input", SNAPSHOT_PATH, L"--sort", L"monitor" });
+        CHECK(result.status == HeadlessRunner::EXIT_FAILED && result.out.empty());
+        CHECK(result.err ==
+            "WinLister: --sort monitor needs the attached monitors, which are not available here\n");
+        FixedDisplay none({});
+        result = Dump({ L"--dump", L"--input", SNAPSHOT_PATH, L"--sort", L"monitor" }, &none);
+        CHECK(result.status == HeadlessRunner::EXIT_FAILED && result.out.empty());
+
+        result = Dump({ L"--dump" });
+        CHECK(result.status == HeadlessRunner::EXIT_FAILED && result.out.empty());
+        CHECK(result.err == "WinLister: Live windows are not available here; use --input\n");
+    }
+
+    FileIO::Remove(SNAPSHOT_PATH);
+    std::printf("HeadlessDumpTest passed\n");
+    return 0;
+}
@@ -0,0 +1,143 @@
+// IconRegistry with synthetic icon identities: handle and content numbers
+// stand in for HICONs and pixel hashes.
+
+#include "TestHarness.h"
+#include "IconRegistry.h"
+#include <algorithm>
+#include <map>
+
+int main() {
+    bool needsImage = false;
+
+    // Handles showing the same content share a slot and its references
+    {
+        IconRegistry registry(4);
+        CHECK(registry.AcquireHandle(1) == -1);
+        CHECK(registry.Acquire(1, 100, needsImage) == 0 && needsImage);
+        CHECK(registry.Acquire(2, 100, needsImage) == 0 && !needsImage);
+        CHECK(registry.AcquireHandle(2) == 0);
+        CHECK(registry.AcquireHandle(1) == 0);
+        CHECK(registry.SlotCount() == 1 && registry.ReferencedSlotCount() == 1);
+
+        // Four references; the slot is unreferenced only after the last
+        for (int i = 0; i < 3; i++) {
+            registry.Release(0);
+            CHECK(registry.ReferencedSlotCount() == 1);
+        }
+        registry.Release(0);
+        CHECK(registry.ReferencedSlotCount() == 0);
+        registry.Release(0);
+        registry.Release(-1);
+        registry.Release(7);
+        CHECK(registry.ReferencedSlotCount() == 0);
+
+        // Still cached by content: the released slot's handles are hashed
+        // again, and the same pixels come back without an image load
+        CHECK(registry.AcquireHandle(1) == -1);
+        CHECK(registry.Acquire(1, 100, needsImage) == 0 && !needsImage);
+        CHECK(registry.AcquireHandle(1) == 0);
+        CHECK(registry.AcquireHandle(2) == -1);
+        CHECK(registry.ReferencedSlotCount() == 1);
+    }
+
+    // A handle value freed with its slot and reused for another icon shows
+    // the new pixels, while the old ones stay cached for their content
+    {
+        IconRegistry registry(8);
+        CHECK(registry.Acquire(1, 100, needsImage) == 0 && needsImage);
+        registry.Release(0);
+        CHECK(registry.AcquireHandle(1) == -1);
+        CHECK(registry.Acquire(1, 200, needsImage) == 1 && needsImage);
+        CHECK(registry.Acquire(3, 100, needsImage) == 0 && !needsImage);
+        CHECK(registry.AcquireHandle(1) == 1);
+    }
+
+    // Once full, the least recently released slot is evicted and reused
+    {
+        IconRegistry registry(3);
+        for (uint64_t i = 0; i < 3; i++) {
+            CHECK(registry.Acquire(i + 1, 100 + i, needsImage) == static_cast<int>(i) && needsImage);
+        }
+        registry.Release(1);
+        registry.Release(0);
+        registry.Release(2);
+
+        CHECK(registry.Acquire(4, 103, needsImage) == 1 && needsImage);
+        CHECK(registry.AcquireHandle(2) == -1);
+        CHECK(registry.Acquire(5, 100, needsImage) == 0 && !needsImage);
+
+        // Slot 0 was taken back, so slot 2 is now the oldest release
+        CHECK(registry.Acquire(6, 104, needsImage) == 2 && needsImage);
+        CHECK(registry.AcquireHandle(3) == -1);
+        CHECK(registry.SlotCount() == 3);
+
+        // Nothing unreferenced: the registry grows past its limit
+        CHECK(registry.Acquire(7, 105, needsImage) == 3 && needsImage);
+        CHECK(registry.SlotCount() == 4);
+    }
+
+    // A recycled handle value showing new content gets a new slot and no
+    // longer resolves to the old one
+    {
+        IconRegistry registry(8);
+        CHECK(registry.Acquire(1, 100, needsImage) == 0);
+        CHECK(registry.Acquire(2, 100, needsImage) == 0);
+        CHECK(registry.Acquire(1, 200, needsImage) == 1 && needsImage);
+        CHECK(registry.AcquireHandle(1) == 1);
+        CHECK(registry.AcquireHandle(2) == 0);
+
+        // Evicting the old slot must not drop the handle's new mapping
+        IconRegistry small(2);
+        CHECK(small.Acquire(1, 100, needsImage) == 0);
+        CHECK(small.Acquire(1, 200, needsImage) == 1);
+        small.Release(0);
+        CHECK(small.Acquire(2, 300, needsImage) == 0 && needsImage);
+        CHECK(small.AcquireHandle(1) == 1);
+    }
+
+    // Random refreshes against a model of which slots hold references
+    {
+        const size_t maxSlots = 32;
+        IconRegistry registry(maxSlots);
+        SyntheticWindows synthetic(30);
+        std::vector<int> held;
+        std::map<int, int> refs;
+        std::map<int, uint64_t> content;
+        size_t peak = 0;
+        for (int step = 0; step < 200000; step++) {
+            if (!held.empty() && synthetic.Next(2) == 0) {
+                size_t pick = synthetic.Next(static_cast<uint32_t>(held.size()));
+                int slot = held[pick];
+                held[pick] = held.back();
+                held.pop_back();
+                registry.Release(slot);
+                refs[slot]--;
+                continue;
+            }
+            uint64_t hash = synthetic.Next(64);
+            uint64_t handle = hash * 16 + synthetic.Next(4);
+            int slot = registry.AcquireHandle(handle);
+            if (slot < 0) {
+                slot = registry.Acquire(handle, hash, needsImage);
+                if (needsImage) {
+                    CHECK(refs[slot] == 0);
+                    content[slot] = hash;
+                }
+            }
+            CHECK(content[slot] == hash);
+            refs[slot]++;
+            held.push_back(slot);
+
+            size_t referenced = 0;
+            for (const auto& entry : refs) {
+                referenced += entry.second > 0 ? 1 : 0;
+            }
+            CHECK(registry.ReferencedSlotCount() == referenced);
+            peak = std::max(peak, referenced);
+            CHECK(registry.SlotCount() <= std::max(maxSlots, peak));
+        }
+    }
+
+    std::printf("IconRegistryTest passed\n");
+    return 0;
+}
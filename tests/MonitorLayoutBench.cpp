@@ -0,0 +1,124 @@
+// MonitorLayout::Assign on synthetic desks of 1, 4 and 16 monitors at mixed
+// DPI, with piles of windows running off every edge. Every window is checked
+// against a per-window search of all monitors in 64-bit areas before the
+// batch pass is timed next to that search.
+
+#include "TestHarness.h"
+#include "WindowMonitor.h"
+#include "WindowSpatial.h"
+#include <algorithm>
+#include <cmath>
+
+class SyntheticMonitors : public MonitorSource {
+public:
+    explicit SyntheticMonitors(const std::vector<MonitorDesc>& monitors) : m_monitors(monitors) {}
+
+    bool Load(std::vector<MonitorDesc>& monitors) override {
+        monitors = m_monitors;
+        return !monitors.empty();
+    }
+
+private:
+    std::vector<MonitorDesc> m_monitors;
+};
+
+// A grid of 2560x1440 monitors, four to a row, cycling through the common
+// scalings; the first is primary
+static std::vector<MonitorDesc> Desk(int count) {
+    static const UINT DPIS[] = { 144, 96, 120, 168, 192 };
+    std::vector<MonitorDesc> monitors;
+    for (int m = 0; m < count; m++) {
+        LONG left = (m % 4) * 2560;
+        LONG top = (m / 4) * 1440;
+        MonitorDesc monitor = {};
+        monitor.bounds = { left, top, left + 2560, top + 1440 };
+        monitor.work = { left, top, left + 2560, top + 1400 };
+        monitor.dpi = DPIS[m % 5];
+        monitor.primary = m == 0;
+        monitors.push_back(monitor);
+    }
+    return monitors;
+}
+
+// The monitor the frame overlaps most, the first on a tie, or -1
+static int Search(const WindowInfo& win, const std::vector<MonitorDesc>& monitors) {
+    RECT frame = SpatialIndex::Frame(win);
+    int best = -1;
+    int64_t bestArea = 0;
+    for (size_t m = 0; m < monitors.size(); m++) {
+        const RECT& bounds = monitors[m].bounds;
+        int64_t width = std::min<int64_t>(frame.right, bounds.right) - std::max<int64_t>(frame.left, bounds.left);
+        int64_t height = std::min<int64_t>(frame.bottom, bounds.bottom) - std::max<int64_t>(frame.top, bounds.top);
+        if (width > 0 && height > 0 && width * height > bestArea) {
+            bestArea = width * height;
+            best = static_cast<int>(m);
+        }
+    }
+    return best;
+}
+
+static LONG Logical(LONG physical, UINT dpi) {
+    return static_cast<LONG>(std::lround(physical * 96.0 / dpi));
+}
+
+static void Place(WindowInfo& win, const std::vector<MonitorDesc>& monitors) {
+    win.monitor = Search(win, monitors);
+    if (win.monitor < 0) {
+        win.logicalRect = win.rect;
+        return;
+    }
+    const MonitorDesc& monitor = monitors[win.monitor];
+    win.logicalRect = { Logical(win.rect.left - monitor.bounds.left, monitor.dpi),
+        Logical(win.rect.top - monitor.bounds.top, monitor.dpi),
+        Logical(win.rect.right - monitor.bounds.left, monitor.dpi),
+        Logical(win.rect.bottom - monitor.bounds.top, monitor.dpi) };
+}
+
+static RECT Shifted(const RECT& rc, LONG dx, LONG dy) {
+    return { rc.left + dx, rc.top + dy, rc.right + dx, rc.bottom + dy };
+}
+
+int main(int argc, char** argv) {
+    size_t count = BenchSize(argc, argv, 1000000);
+
+    std::printf("%zu windows\n", count);
+    std::printf("%-9s %10s %12s %10s %10s\n", "monitors", "ms", "ns/window", "search ms", "on none");
+    for (int monitorCount : { 1, 4, 16 }) {
+        std::vector<MonitorDesc> monitors = Desk(monitorCount);
+        SyntheticMonitors source(monitors);
+        MonitorLayout layout;
+        CHECK(layout.Load(source));
+
+        // Spread over the desk and an eighth of a monitor beyond it each way
+        LONG width = std::min(monitorCount, 4) * 2560;
+        LONG height = ((monitorCount + 3) / 4) * 1440;
+        std::vector<WindowInfo> windows = StackedFrames(49, count, width + 640, height + 360);
+        for (WindowInfo& win : windows) {
+            win.rect = Shifted(win.rect, -320, -180);
+            win.dwmExtendedFrame = Shifted(win.dwmExtendedFrame, -320, -180);
+        }
+
+        layout.Assign(windows);
+        std::vector<WindowInfo> expected = windows;
+        Stopwatch watch;
+        for (WindowInfo& win : expected) {
+            Place(win, monitors);
+        }
+        double searchMs = watch.Ms();
+        size_t onNone = 0;
+        for (size_t i = 0; i < count; i++) {
+            CHECK(windows[i].monitor == expected[i].monitor);
+            CHECK(SameRect(windows[i].logicalRect, expected[i].logicalRect));
+            onNone += windows[i].monitor < 0 ? 1 : 0;
+        }
+
+        const int passes = 5;
+        watch.Restart();
+        for (int pass = 0; pass < passes; pass++) {
+            layout.Assign(windows);
+        }
+        double ms = watch.Ms() / passes;
+        std::printf("%-9d %10.2f %12.1f %10.2f %10zu\n", monitorCount, ms, ms * 1e6 / count, searchMs, onNone);
+    }
+    return 0;
+}
@@ -0,0 +1,47 @@
+// Multi-key sorting: dense ranks packed into one composite radix key against
+// a comparator chain under std::stable_sort, across list sizes.
+
+#include "TestHarness.h"
+#include "WindowSort.h"
+#include <algorithm>
+
+int main(int argc, char** argv) {
+    size_t largest = BenchSize(argc, argv, 1000000);
+    SyntheticWindows synthetic(28);
+    std::printf("%-24s %9s %14s %14s %9s\n", "spec", "windows", "comparator ms", "composite ms", "speedup");
+
+    for (const wchar_t* text : { L"process,title", L"visible,-pid,position", L"class,-size,title" }) {
+        SortSpec spec;
+        CHECK(SortSpec::Parse(text, spec));
+        for (size_t count = 16; count <= largest; count *= 8) {
+            std::vector<WindowInfo> windows = synthetic.MakeMany(count);
+            // Small lists are timed over many repeats
+            int repeats = static_cast<int>(std::max<size_t>(1, 200000 / count));
+
+            std::vector<uint32_t> chained;
+            Stopwatch watch;
+            for (int r = 0; r < repeats; r++) {
+                chained.resize(count);
+                for (size_t i = 0; i < count; i++) {
+                    chained[i] = static_cast<uint32_t>(i);
+                }
+                std::stable_sort(chained.begin(), chained.end(), [&](uint32_t a, uint32_t b) {
+                    return WindowSorter::Compare(windows[a], windows[b], spec) < 0;
+                });
+            }
+            double chainMs = watch.Ms() / repeats;
+
+            std::vector<uint32_t> composite;
+            watch.Restart();
+            for (int r = 0; r < repeats; r++) {
+                composite = WindowSorter::SortedOrder(windows, spec);
+            }
+            double compositeMs = watch.Ms() / repeats;
+
+            CHECK(composite == chained);
+            std::printf("%-24ls %9zu %14.3f %14.3f %8.1fx\n", text, count, chainMs, compositeMs,
+                compositeMs > 0 ? chainMs / compositeMs : 0.0);
+        }
+    }
+    return 0;
+}
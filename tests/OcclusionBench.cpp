@@ -0,0 +1,73 @@
+// OcclusionEngine::Compute over thousands of overlapping windows, piled on
+// three 1080p monitors and spread over a wider desktop. Reports the time per
+// pass, how many windows end up fully covered and how many bands the covered
+// region needs. A sample of windows is checked against a region rebuilt
+// from just the windows above each one.
+
+#include "TestHarness.h"
+#include "WindowOcclusion.h"
+#include "WindowSpatial.h"
+#include <algorithm>
+
+// What Compute should give the window at z-order index, from scratch
+static int Expected(const std::vector<WindowInfo>& windows, size_t index) {
+    const WindowInfo& win = windows[index];
+    RECT frame = SpatialIndex::Frame(win);
+    if (!OcclusionEngine::IsShown(win) || frame.right <= frame.left || frame.bottom <= frame.top) {
+        return -1;
+    }
+    CoverRegion above;
+    for (size_t i = 0; i < index; i++) {
+        if (OcclusionEngine::Covers(windows[i])) {
+            above.Add(SpatialIndex::Frame(windows[i]));
+        }
+    }
+    int64_t area = static_cast<int64_t>(frame.right - frame.left) * (frame.bottom - frame.top);
+    int64_t visible = area - above.OverlapArea(frame);
+    if (visible == 0 || visible == area) {
+        return visible == 0 ? 0 : OcclusionEngine::EXPOSED_FULL;
+    }
+    int64_t exposed = (visible * OcclusionEngine::EXPOSED_FULL + area / 2) / area;
+    return static_cast<int>(std::min<int64_t>(std::max<int64_t>(exposed, 1), OcclusionEngine::EXPOSED_FULL - 1));
+}
+
+int main(int argc, char** argv) {
+    size_t largest = BenchSize(argc, argv, 20000);
+
+    std::printf("%-8s %8s %10s %8s %10s %8s\n", "desktop", "windows", "ms/pass", "shown", "covered", "bands");
+    struct Desktop {
+        const char* name;
+        LONG width;
+        LONG height;
+    };
+    for (const Desktop& desktop : { Desktop{ "3x1080p", 5760, 1080 }, Desktop{ "wide", 30720, 4320 } }) {
+        for (size_t count : { largest / 20, largest / 4, largest }) {
+            std::vector<WindowInfo> windows = StackedFrames(47, count, desktop.width, desktop.height);
+
+            const int passes = 5;
+            Stopwatch watch;
+            for (int pass = 0; pass < passes; pass++) {
+                OcclusionEngine::Compute(windows);
+            }
+            double ms = watch.Ms() / passes;
+
+            size_t shown = 0;
+            size_t covered = 0;
+            CoverRegion region;
+            for (const WindowInfo& win : windows) {
+                shown += win.exposed >= 0 ? 1 : 0;
+                covered += win.exposed == 0 ? 1 : 0;
+                if (OcclusionEngine::Covers(win)) {
+                    region.Add(SpatialIndex::Frame(win));
+                }
+            }
+            for (size_t i = 0; i < count; i += std::max<size_t>(1, count / 40)) {
+                CHECK(windows[i].exposed == Expected(windows, i));
+            }
+
+            std::printf("%-8s %8zu %10.2f %8zu %10zu %8zu\n", desktop.name, count, ms, shown, covered,
+                region.BandCount());
+        }
+    }
+    return 0;
+}
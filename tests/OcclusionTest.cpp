@@ -0,0 +1,178 @@
+// CoverRegion and OcclusionEngine against a pixel grid. Random rectangles,
+// some empty, are added one at a time to a region and painted into a grid;
+// after each one every pixel, the overlap areas of random rectangles running
+// off the grid, and the band count must agree with the grid. Then exposed
+// fractions for random stacks of windows, hidden, cloaked, minimized and
+// transparent ones among them, against painting the same stack top down.
+
+#include "TestHarness.h"
+#include "WindowOcclusion.h"
+#include "WindowSpatial.h"
+#include <algorithm>
+#include <cstring>
+
+static const int GRID = 48;         // pixels [0, GRID) each way
+static const int MARGIN = 8;        // rectangles reach this far outside it
+
+class PixelGrid {
+public:
+    PixelGrid() { std::memset(m_pixels, 0, sizeof(m_pixels)); }
+
+    void Paint(const RECT& rc) {
+        for (LONG y = std::max<LONG>(rc.top, 0); y < std::min<LONG>(rc.bottom, GRID); y++) {
+            for (LONG x = std::max<LONG>(rc.left, 0); x < std::min<LONG>(rc.right, GRID); x++) {
+                m_pixels[y][x] = 1;
+            }
+        }
+    }
+
+    int64_t Count(const RECT& rc) const {
+        int64_t count = 0;
+        for (LONG y = std::max<LONG>(rc.top, 0); y < std::min<LONG>(rc.bottom, GRID); y++) {
+            for (LONG x = std::max<LONG>(rc.left, 0); x < std::min<LONG>(rc.right, GRID); x++) {
+                count += m_pixels[y][x];
+            }
+        }
+        return count;
+    }
+
+    bool At(int x, int y) const { return m_pixels[y][x] != 0; }
+
+    // Bands a canonical region needs: runs of rows with the same, non-empty
+    // pixels
+    size_t Bands() const {
+        size_t bands = 0;
+        for (int y = 0; y < GRID; y++) {
+            bool empty = std::count(m_pixels[y], m_pixels[y] + GRID, 1) == 0;
+            bool same = y > 0 && std::memcmp(m_pixels[y], m_pixels[y - 1], GRID) == 0;
+            if (!empty && !same) bands++;
+        }
+        return bands;
+    }
+
+private:
+    unsigned char m_pixels[GRID][GRID];
+};
+
+static RECT RandomRect(std::mt19937& rng, int maxSize) {
+    LONG left = static_cast<LONG>(rng() % (GRID + MARGIN)) - MARGIN / 2;
+    LONG top = static_cast<LONG>(rng() % (GRID + MARGIN)) - MARGIN / 2;
+    // Sizes start at zero, so some come out empty
+    LONG width = static_cast<LONG>(rng() % maxSize);
+    LONG height = static_cast<LONG>(rng() % maxSize);
+    return { left, top, left + width, top + height };
+}
+
+static RECT Clipped(const RECT& rc) {
+    return { std::max<LONG>(rc.left, 0), std::max<LONG>(rc.top, 0), std::min<LONG>(rc.right, GRID),
+        std::min<LONG>(rc.bottom, GRID) };
+}
+
+int main() {
+    std::mt19937 rng(47);
+
+    // Adding rectangles one by one, small and large
+    size_t adds = 0;
+    for (int trial = 0; trial < 400; trial++) {
+        CoverRegion region;
+        PixelGrid grid;
+        int maxSize = trial % 2 ? 12 : 40;
+        int count = 1 + static_cast<int>(rng() % 30);
+        for (int k = 0; k < count; k++) {
+            RECT rc = RandomRect(rng, maxSize);
+            // Keep within the grid so bands can be counted against it
+            rc = Clipped(rc);
+            region.Add(rc);
+            grid.Paint(rc);
+            adds++;
+
+            for (int y = 0; y < GRID; y++) {
+                for (int x = 0; x < GRID; x++) {
+                    CHECK(region.OverlapArea({ x, y, x + 1, y + 1 }) == (grid.At(x, y) ? 1 : 0));
+                }
+            }
+            for (int q = 0; q < 8; q++) {
+                RECT query = RandomRect(rng, 50);
+                CHECK(region.OverlapArea(query) == grid.Count(query));
+            }
+            CHECK(region.OverlapArea({ -MARGIN, -MARGIN, GRID + MARGIN, GRID + MARGIN }) ==
+                grid.Count({ 0, 0, GRID, GRID }));
+            CHECK(region.BandCount() == grid.Bands());
+            CHECK(region.Empty() == (grid.Bands() == 0));
+        }
+    }
+
+    // Rows and columns filled in any order collapse to one band
+    {
+        CoverRegion region;
+        for (int i : { 5, 0, 9, 2, 7, 1, 8, 3, 6, 4 }) {
+            region.Add({ 0, i * 10, 100, i * 10 + 10 });
+        }
+        CHECK(region.BandCount() == 1 && region.OverlapArea({ 0, 0, 100, 100 }) == 10000);
+        for (int x = 99; x >= 0; x--) {
+            region.Add({ x, 0, x + 1, 200 });
+        }
+        CHECK(region.BandCount() == 1 && region.OverlapArea({ -10, -10, 200, 300 }) == 20000);
+        region.Clear();
+        CHECK(region.Empty() && region.OverlapArea({ 0, 0, 100, 100 }) == 0);
+    }
+
+    // Exposed fractions against painting the stack top down
+    size_t windowsChecked = 0;
+    for (int trial = 0; trial < 500; trial++) {
+        size_t count = 1 + rng() % 20;
+        std::vector<WindowInfo> windows;
+        for (size_t i = 0; i < count; i++) {
+            WindowInfo win = {};
+            win.hwnd = MakeHandle(static_cast<uint32_t>(0x1000 + i * 4));
+            win.zOrder = static_cast<int>(i);
+            win.isVisible = rng() % 8 != 0;
+            win.isCloaked = rng() % 12 == 0;
+            win.isMinimized = rng() % 12 == 0;
+            win.isLayered = rng() % 4 == 0;
+            win.alpha = static_cast<BYTE>(win.isLayered && rng() % 2 ? 0 : 255);
+            win.rect = Clipped(RandomRect(rng, 40));
+            if (rng() % 3 == 0) {
+                win.hasDwmFrame = true;
+                win.dwmExtendedFrame = { win.rect.left + 2, win.rect.top, win.rect.right - 2, win.rect.bottom - 2 };
+            }
+            windows.push_back(win);
+        }
+        std::shuffle(windows.begin(), windows.end(), rng);
+        OcclusionEngine::Compute(windows);
+
+        std::vector<const WindowInfo*> stack;
+        for (const WindowInfo& win : windows) {
+            stack.push_back(&win);
+        }
+        std::sort(stack.begin(), stack.end(),
+            [](const WindowInfo* a, const WindowInfo* b) { return a->zOrder < b->zOrder; });
+        PixelGrid grid;
+        for (const WindowInfo* win : stack) {
+            RECT frame = SpatialIndex::Frame(*win);
+            int64_t area = static_cast<int64_t>(frame.right - frame.left) * (frame.bottom - frame.top);
+            if (!OcclusionEngine::IsShown(*win) || frame.right <= frame.left || frame.bottom <= frame.top) {
+                CHECK(win->exposed == -1);
+                continue;
+            }
+            int64_t visible = area - grid.Count(frame);
+            if (visible == 0) {
+                CHECK(win->exposed == 0);
+            } else if (visible == area) {
+                CHECK(win->exposed == OcclusionEngine::EXPOSED_FULL);
+            } else {
+                // Rounded, but never onto either end
+                int64_t expected = (visible * OcclusionEngine::EXPOSED_FULL + area / 2) / area;
+                expected = std::min<int64_t>(std::max<int64_t>(expected, 1), OcclusionEngine::EXPOSED_FULL - 1);
+                CHECK(win->exposed == expected);
+            }
+            if (OcclusionEngine::Covers(*win)) {
+                grid.Paint(frame);
+            }
+            windowsChecked++;
+        }
+    }
+
+    std::printf("OcclusionTest passed: %zu rectangles added, %zu windows checked\n", adds, windowsChecked);
+    return 0;
+}
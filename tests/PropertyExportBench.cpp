@@ -0,0 +1,118 @@
+// PropertyExporter: the two-pass measure and write against building the text
+// with a wostringstream, as the details copy did before, for every format.
+// Checks that Measure matches Write, and that the main list's Copy All text
+// is what its old fixed-size swprintf produced, with no final line break.
+
+#include "TestHarness.h"
+#include "PropertyExport.h"
+#include <sstream>
+
+static void CheckExport(const PropertyModel& model, PropertyExportFormat format, bool finalLineBreak) {
+    size_t length = PropertyExporter::Measure(model, format, finalLineBreak);
+    std::vector<wchar_t> buffer(length + 2, L'#');
+    CHECK(PropertyExporter::Write(model, format, buffer.data(), finalLineBreak) == length);
+    CHECK(buffer[length] == L'\0' && buffer[length + 1] == L'#');
+    std::wstring text = PropertyExporter::ToString(model, format, finalLineBreak);
+    CHECK(text == std::wstring(buffer.data(), length));
+}
+
+int main(int argc, char** argv) {
+    size_t rows = BenchSize(argc, argv, 200000);
+
+    // Copy All from the main list
+    {
+        PropertyModel properties;
+        properties.Begin();
+        properties.Add(L"HWND", L"1A2B");
+        properties.Add(L"Title", L"Untitled - Notepad");
+        properties.Add(L"Class", L"Notepad");
+        properties.Add(L"Process", L"notepad.exe");
+        properties.Add(L"PID", L"4242");
+        properties.End();
+        CHECK(PropertyExporter::ToString(properties, EXPORT_TEXT, false) ==
+            L"HWND: 1A2B\r\nTitle: Untitled - Notepad\r\nClass: Notepad\r\nProcess: notepad.exe\r\nPID: 4242");
+        CHECK(PropertyExporter::ToString(properties, EXPORT_TEXT) ==
+            PropertyExporter::ToString(properties, EXPORT_TEXT, false) + L"\r\n");
+    }
+
+    // Sections, escapes, and the line break before a section
+    {
+        PropertyModel properties;
+        properties.Begin();
+        properties.Add(L"Title", L"a\tb|\"c\"");
+        properties.AddSection(L"--- Styles ---");
+        properties.Add(L"Style", L"0x1");
+        properties.End();
+        CHECK(PropertyExporter::ToString(properties, EXPORT_TEXT, false) ==
+            L"Title: a\tb|\"c\"\r\n\r\n--- Styles ---\r\nStyle: 0x1");
+        CHECK(PropertyExporter::ToString(properties, EXPORT_TSV) ==
+            L"Title\ta b|\"c\"\r\n\t--- Styles ---\r\nStyle\t0x1\r\n");
+        CHECK(PropertyExporter::ToString(properties, EXPORT_JSON, false) ==
+            L"{\r\n  \"Title\": \"a\\tb|\\\"c\\\"\",\r\n  \"Styles\": {\r\n    \"Style\": \"0x1\"\r\n  }\r\n}");
+        CHECK(PropertyExporter::ToString(properties, EXPORT_MARKDOWN, false) ==
+            L"| Property | Value |\r\n| --- | --- |\r\n| Title | a\tb\\|\"c\" |\r\n| **Styles** |  |\r\n"
+            L"| Style | 0x1 |");
+        for (int format = EXPORT_TEXT; format <= EXPORT_MARKDOWN; format++) {
+            CheckExport(properties, static_cast<PropertyExportFormat>(format), true);
+            CheckExport(properties, static_cast<PropertyExportFormat>(format), false);
+        }
+
+        PropertyModel empty;
+        empty.Begin();
+        empty.End();
+        CHECK(PropertyExporter::ToString(empty, EXPORT_TEXT, false).empty());
+        CHECK(PropertyExporter::ToString(empty, EXPORT_TEXT).empty());
+    }
+
+    // A large model: a section every 16 rows, values of assorted lengths
+    SyntheticWindows synthetic(35);
+    PropertyModel model;
+    model.Begin();
+    for (size_t i = 0; i < rows; i++) {
+        if (i % 16 == 0) {
+            model.AddSection((L"--- Section " + std::to_wstring(i / 16) + L" ---").c_str());
+            continue;
+        }
+        WindowInfo win = synthetic.Make(static_cast<uint32_t>(i));
+        model.Add(win.className.c_str(), (win.title + L" " + win.processName).c_str());
+    }
+    model.End();
+    for (int format = EXPORT_TEXT; format <= EXPORT_MARKDOWN; format++) {
+        CheckExport(model, static_cast<PropertyExportFormat>(format), true);
+    }
+
+    const wchar_t* const names[] = { L"text", L"tsv", L"json", L"markdown" };
+    std::printf("%zu rows\n", rows);
+    std::printf("%-10s %12s %12s %14s %12s %12s\n", "format", "chars", "measure ms", "measure+write", "Mchars/s",
+        "MB/s");
+    for (int format = EXPORT_TEXT; format <= EXPORT_MARKDOWN; format++) {
+        PropertyExportFormat kind = static_cast<PropertyExportFormat>(format);
+        Stopwatch watch;
+        size_t length = PropertyExporter::Measure(model, kind);
+        double measureMs = watch.Ms();
+        std::vector<wchar_t> buffer(length + 1);
+        watch.Restart();
+        size_t written = PropertyExporter::Write(model, kind, buffer.data());
+        double totalMs = measureMs + watch.Ms();
+        CHECK(written == length);
+        std::printf("%-10ls %12zu %12.1f %14.1f %12.1f %12.1f\n", names[format], length, measureMs, totalMs,
+            length / (totalMs * 1000.0), length * sizeof(wchar_t) / (totalMs * 1000.0));
+    }
+
+    // The old details copy: TSV lines through a string stream
+    Stopwatch watch;
+    std::wostringstream stream;
+    for (size_t i = 0; i < model.Count(); i++) {
+        const PropertyRow& row = model.Row(i);
+        stream << row.name << L"\t" << row.value << L"\r\n";
+    }
+    std::wstring streamed = stream.str();
+    double streamMs = watch.Ms();
+    watch.Restart();
+    std::wstring exported = PropertyExporter::ToString(model, EXPORT_TSV);
+    double exportMs = watch.Ms();
+    std::printf("tsv: wostringstream %.1f ms, exporter %.1f ms (%.1fx)\n", streamMs, exportMs,
+        exportMs > 0 ? streamMs / exportMs : 0.0);
+    CHECK(!streamed.empty() && !exported.empty());
+    return 0;
+}
@@ -0,0 +1,184 @@
+// PropertyModel's diff: the edits it reports, applied to a stand-in for the
+// list view, must reproduce the new rows, touch only the rows that appeared
+// or went away, and leave value changes to ChangedRows.
+
+#include "TestHarness.h"
+#include "PropertyModel.h"
+
+// The list view: one name/value item per row
+typedef std::vector<PropertyRow> View;
+
+static void Apply(const PropertyModel& model, View& view) {
+    for (const PropertyEdit& edit : model.Edits()) {
+        if (edit.kind == PropertyEdit::INSERT) {
+            CHECK(edit.index <= view.size());
+            view.insert(view.begin() + edit.index, model.Row(edit.index));
+        } else {
+            CHECK(edit.index < view.size());
+            view.erase(view.begin() + edit.index);
+        }
+    }
+    for (size_t row : model.ChangedRows()) {
+        CHECK(row < view.size());
+        view[row].value = model.Row(row).value;
+    }
+}
+
+static void CheckView(const PropertyModel& model, const View& view) {
+    CHECK(view.size() == model.Count());
+    for (size_t i = 0; i < view.size(); i++) {
+        CHECK(view[i].name == model.Row(i).name);
+        CHECK(view[i].value == model.Row(i).value);
+        CHECK(view[i].section == model.Row(i).section);
+    }
+}
+
+// The details page's shape: fixed sections, two that come and go, and a
+// row that is only there when it has text
+struct Details {
+    bool layered = false;
+    bool dwm = false;
+    bool styleFlags = true;
+    int x = 0;
+    int alpha = 255;
+};
+
+static void Build(PropertyModel& model, const Details& details) {
+    std::wstring x = std::to_wstring(details.x);
+    model.Begin();
+    model.Add(L"HWND", L"0x1234");
+    model.Add(L"Title", L"Notepad");
+    model.AddSection(L"--- Position and Size ---");
+    model.Add(L"Window Rectangle", x.c_str());
+    model.Add(L"Window Size", L"800 x 600");
+    if (details.dwm) {
+        model.Add(L"DWM Extended Frame", x.c_str());
+    }
+    if (details.layered) {
+        model.AddSection(L"--- Transparency ---");
+        model.Add(L"Alpha", std::to_wstring(details.alpha).c_str());
+        model.Add(L"Transparent (mouse clicks)", L"No");
+    }
+    model.AddSection(L"--- Styles ---");
+    model.Add(L"Style (hex)", L"0x14CF0000");
+    if (details.styleFlags) {
+        model.Add(L"Style (Flags)", L"WS_CAPTION");
+    }
+    model.AddSection(L"--- Classification ---");
+    model.Add(L"System Window", L"No");
+}
+
+static size_t Inserts(const PropertyModel& model) {
+    size_t count = 0;
+    for (const PropertyEdit& edit : model.Edits()) {
+        count += edit.kind == PropertyEdit::INSERT ? 1 : 0;
+    }
+    return count;
+}
+
+int main() {
+    PropertyModel model;
+    View view;
+    Details details;
+
+    // First fill inserts every row
+    Build(model, details);
+    CHECK(model.End());
+    CHECK(model.Edits().size() == model.Count() && Inserts(model) == model.Count());
+    Apply(model, view);
+    CheckView(model, view);
+
+    // Same rows: nothing to do
+    Build(model, details);
+    CHECK(!model.End());
+    CHECK(model.Edits().empty() && model.ChangedRows().empty());
+
+    // A moved window changes values only
+    details.x = 10;
+    Build(model, details);
+    CHECK(!model.End());
+    CHECK(model.ChangedRows().size() == 1 && model.ChangedRows()[0] == 3);
+    Apply(model, view);
+    CheckView(model, view);
+
+    // The Transparency section appears: three inserts at its place, and a
+    // value change after it is reported at its new index
+    details.layered = true;
+    details.x = 20;
+    Build(model, details);
+    CHECK(model.End());
+    CHECK(model.Edits().size() == 3 && Inserts(model) == 3);
+    CHECK(model.Edits()[0].index == 5);
+    CHECK(model.ChangedRows().size() == 1 && model.ChangedRows()[0] == 3);
+    Apply(model, view);
+    CheckView(model, view);
+
+    // A row inside it changes in place
+    details.alpha = 128;
+    Build(model, details);
+    CHECK(!model.End());
+    CHECK(model.ChangedRows().size() == 1 && model.Row(model.ChangedRows()[0]).name == L"Alpha");
+    Apply(model, view);
+    CheckView(model, view);
+
+    // The section goes away while the DWM row appears before it
+    details.layered = false;
+    details.dwm = true;
+    Build(model, details);
+    CHECK(model.End());
+    CHECK(model.Edits().size() == 4 && Inserts(model) == 1);
+    Apply(model, view);
+    CheckView(model, view);
+
+    // Trailing and middle rows
+    details.styleFlags = false;
+    Build(model, details);
+    CHECK(model.End());
+    CHECK(model.Edits().size() == 1 && model.Edits()[0].kind == PropertyEdit::DELETE);
+    Apply(model, view);
+    CheckView(model, view);
+
+    // A model emptied and refilled
+    model.Begin();
+    CHECK(model.End());
+    Apply(model, view);
+    CHECK(view.empty() && model.Count() == 0);
+    Build(model, details);
+    CHECK(model.End());
+    Apply(model, view);
+    CheckView(model, view);
+
+    // Random refreshes: the edits are exactly the rows that came and went
+    SyntheticWindows synthetic(33);
+    for (int refresh = 0; refresh < 20000; refresh++) {
+        size_t before = model.Count();
+        Details next = details;
+        next.layered = synthetic.Next(4) == 0 ? !details.layered : details.layered;
+        next.dwm = synthetic.Next(4) == 0 ? !details.dwm : details.dwm;
+        next.styleFlags = synthetic.Next(8) == 0 ? !details.styleFlags : details.styleFlags;
+        next.x = synthetic.Next(3) == 0 ? static_cast<int>(synthetic.Next(100)) : details.x;
+        next.alpha = static_cast<int>(synthetic.Next(2)) + 254;
+
+        size_t appeared = 0;
+        size_t gone = 0;
+        for (size_t* count : { &appeared, &gone }) {
+            bool adding = count == &appeared;
+            if (next.layered != details.layered && next.layered == adding) *count += 3;
+            if (next.dwm != details.dwm && next.dwm == adding) *count += 1;
+            if (next.styleFlags != details.styleFlags && next.styleFlags == adding) *count += 1;
+        }
+        details = next;
+
+        Build(model, details);
+        bool structural = model.End();
+        CHECK(structural == (appeared + gone > 0));
+        CHECK(Inserts(model) == appeared);
+        CHECK(model.Edits().size() == appeared + gone);
+        CHECK(model.Count() == before + appeared - gone);
+        Apply(model, view);
+        CheckView(model, view);
+    }
+
+    std::printf("PropertyModelTest passed\n");
+    return 0;
+}
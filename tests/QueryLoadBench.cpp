@@ -0,0 +1,156 @@
+// Load test for the query server: client threads each connect a QueryClient
+// and keep a fixed number of requests in flight, while the list is
+// republished underneath them. Reports queries per second and the median and
+// p99 latency from send to response. Every response is checked against the
+// answer for the snapshot it names.
+
+#include "TestHarness.h"
+#include "QueryServer.h"
+#include "FileIO.h"
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <thread>
+
+#ifdef _WIN32
+static const wchar_t* const ENDPOINT = L"\\\\.\\pipe\\WinLister_QueryLoadBench";
+#else
+static const wchar_t* const ENDPOINT = L"QueryLoadBench.sock";
+#endif
+
+static const char* const REQUESTS[] = {
+    "--dump --query class:Notepad",
+    "--dump --format csv --query \"pid:<1100 visible:yes\" --sort title",
+    "--dump --format json --hide-system --query title:*word*",
+    "--dump --query hwnd:10010",
+    "--watch",
+};
+static const size_t REQUEST_COUNT = sizeof(REQUESTS) / sizeof(REQUESTS[0]);
+
+// The two lists published in turn; time identifies which one answered
+struct Expected {
+    std::string bodies[2][REQUEST_COUNT];
+    int statuses[REQUEST_COUNT];
+};
+
+struct ClientResult {
+    std::vector<double> latencies;
+    bool ok = true;
+};
+
+static void RunClient(size_t requests, size_t depth, uint32_t seed, const Expected& expected, ClientResult& result) {
+    QueryClient client;
+    if (!client.Connect(ENDPOINT)) {
+        result.ok = false;
+        return;
+    }
+
+    SyntheticWindows random(seed);
+    std::vector<size_t> sent;
+    std::vector<Stopwatch> started;
+    size_t next = 0;
+    QueryClient::Response response;
+    for (size_t done = 0; done < requests; done++) {
+        // Top the pipeline up, then wait for its oldest response
+        while (next < requests && next - done < depth) {
+            size_t kind = random.Next(REQUEST_COUNT);
+            sent.push_back(kind);
+            started.emplace_back();
+            if (!client.Send(REQUESTS[kind])) {
+                result.ok = false;
+                return;
+            }
+            next++;
+        }
+        if (!client.Receive(response)) {
+            result.ok = false;
+            return;
+        }
+        result.latencies.push_back(started[done].Ms());
+
+        size_t kind = sent[done];
+        if (response.snapshotTime != 1 && response.snapshotTime != 2) {
+            result.ok = false;
+            return;
+        }
+        if (response.status != expected.statuses[kind] ||
+            response.body != expected.bodies[response.snapshotTime - 1][kind]) {
+            result.ok = false;
+            return;
+        }
+    }
+}
+
+int main(int argc, char** argv) {
+    size_t requests = BenchSize(argc, argv, 20000);
+
+    SyntheticWindows synthetic(41);
+    std::vector<WindowInfo> lists[2] = { synthetic.MakeMany(400), synthetic.MakeMany(500) };
+
+    // What each request should get from each list
+    Expected expected;
+    for (int list = 0; list < 2; list++) {
+        PublishedSnapshot snapshot;
+        snapshot.windows = lists[list];
+        snapshot.time = list + 1;
+        for (size_t kind = 0; kind < REQUEST_COUNT; kind++) {
+            std::string response;
+            QueryServer::Answer(REQUESTS[kind], strlen(REQUESTS[kind]), &snapshot, response);
+            size_t header = response.find('\n');
+            expected.bodies[list][kind] = response.substr(header + 1);
+            expected.statuses[kind] = response[0] - '0';
+        }
+    }
+    CHECK(expected.statuses[0] == 0 && expected.statuses[REQUEST_COUNT - 1] == 2);
+    CHECK(expected.bodies[0][0] != expected.bodies[1][0]);
+
+    QueryServer server;
+    CHECK(server.Start(ENDPOINT));
+    server.Publish(lists[0], 1);
+
+    // Republish every millisecond for the whole run
+    std::atomic<bool> stop(false);
+    std::thread publisher([&]() {
+        for (int turn = 1; !stop; turn++) {
+            server.Publish(lists[turn % 2], turn % 2 + 1);
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    });
+
+    std::printf("%zu requests per client, lists of %zu and %zu windows\n", requests, lists[0].size(),
+        lists[1].size());
+    std::printf("%8s %6s %12s %10s %10s\n", "clients", "depth", "queries/s", "p50 ms", "p99 ms");
+    for (size_t clients : { 1, 4, 16 }) {
+        for (size_t depth : { 1, 8 }) {
+            std::vector<ClientResult> results(clients);
+            std::vector<std::thread> threads;
+            Stopwatch watch;
+            for (size_t i = 0; i < clients; i++) {
+                threads.emplace_back(RunClient, requests, depth, static_cast<uint32_t>(i + 1), std::cref(expected),
+                    std::ref(results[i]));
+            }
+            for (std::thread& thread : threads) {
+                thread.join();
+            }
+            double ms = watch.Ms();
+
+            std::vector<double> latencies;
+            for (const ClientResult& result : results) {
+                CHECK(result.ok);
+                latencies.insert(latencies.end(), result.latencies.begin(), result.latencies.end());
+            }
+            CHECK(latencies.size() == clients * requests);
+            std::sort(latencies.begin(), latencies.end());
+            std::printf("%8zu %6zu %12.0f %10.3f %10.3f\n", clients, depth, latencies.size() / (ms / 1000.0),
+                latencies[latencies.size() / 2], latencies[latencies.size() * 99 / 100]);
+        }
+    }
+
+    stop = true;
+    publisher.join();
+    server.Stop();
+#ifndef _WIN32
+    FileIO::Remove(ENDPOINT);
+#endif
+    return 0;
+}
@@ -0,0 +1,124 @@
+// RefreshCadence on a simulated clock: how many volatile and full refreshes
+// a run of timer ticks produces, with exact, jittery and stalled ticks.
+
+#include "TestHarness.h"
+#include "RefreshCadence.h"
+
+struct Counts {
+    int none = 0;
+    int volatileOnly = 0;
+    int full = 0;
+};
+
+// Ticks from start to end every step ms, each shifted by up to jitter ms
+static Counts Run(RefreshCadence& cadence, uint64_t start, uint64_t end, uint32_t step, uint32_t jitter,
+    SyntheticWindows& random) {
+    Counts counts;
+    for (uint64_t tick = start + step; tick <= end; tick += step) {
+        uint64_t now = tick;
+        if (jitter > 0) {
+            now = tick + random.Next(2 * jitter + 1) - jitter;
+        }
+        switch (cadence.Poll(now)) {
+        case REFRESH_NONE: counts.none++; break;
+        case REFRESH_VOLATILE: counts.volatileOnly++; break;
+        case REFRESH_FULL: counts.full++; break;
+        }
+    }
+    return counts;
+}
+
+int main() {
+    SyntheticWindows random(34);
+
+    // Intervals are clamped: at least 1 ms, and full no faster than volatile
+    {
+        RefreshCadence cadence(0, 0);
+        CHECK(cadence.VolatileInterval() == 1 && cadence.FullInterval() == 1);
+        cadence.SetIntervals(250, 100);
+        CHECK(cadence.VolatileInterval() == 250 && cadence.FullInterval() == 250);
+        cadence.SetIntervals(250, 2000);
+        CHECK(cadence.VolatileInterval() == 250 && cadence.FullInterval() == 2000);
+    }
+
+    // Exact ticks at the fast rate: one full refresh per slow interval and a
+    // volatile one on every other tick
+    {
+        RefreshCadence cadence(250, 2000);
+        cadence.Reset(1000);
+        Counts counts = Run(cadence, 1000, 1000 + 60000, 250, 0, random);
+        CHECK(counts.full == 30);
+        CHECK(counts.volatileOnly == 240 - 30);
+        CHECK(counts.none == 0);
+    }
+
+    // The first full refresh comes one slow interval after Reset; a poll a
+    // few ms early already counts for it
+    {
+        RefreshCadence cadence(250, 2000);
+        cadence.Reset(0);
+        CHECK(cadence.Poll(100) == REFRESH_NONE);
+        CHECK(cadence.Poll(250) == REFRESH_VOLATILE);
+        CHECK(cadence.Poll(300) == REFRESH_NONE);
+        CHECK(cadence.Poll(1800) == REFRESH_VOLATILE);
+        CHECK(cadence.Poll(1880) == REFRESH_FULL);
+        CHECK(cadence.Poll(2100) == REFRESH_NONE);
+        CHECK(cadence.Poll(2250) == REFRESH_VOLATILE);
+    }
+
+    // Ticks early or late by less than half a fast interval neither slip a
+    // refresh nor add one, and the phase does not drift
+    for (uint32_t jitter : { 10, 60, 120 }) {
+        RefreshCadence cadence(250, 2000);
+        cadence.Reset(0);
+        Counts counts = Run(cadence, 0, 600000, 250, jitter, random);
+        CHECK(counts.full == 300);
+        CHECK(counts.volatileOnly == 2400 - 300);
+        CHECK(counts.none == 0);
+    }
+
+    // A timer faster than the cadence: extra ticks are idle
+    {
+        RefreshCadence cadence(250, 2000);
+        cadence.Reset(0);
+        Counts counts = Run(cadence, 0, 60000, 50, 0, random);
+        CHECK(counts.full == 30);
+        CHECK(counts.volatileOnly == 240 - 30);
+        CHECK(counts.none == 1200 - 240);
+    }
+
+    // A stall over several deadlines gives one refresh, not a burst, and the
+    // later deadlines keep their phase
+    {
+        RefreshCadence cadence(250, 2000);
+        cadence.Reset(0);
+        CHECK(cadence.Poll(250) == REFRESH_VOLATILE);
+        CHECK(cadence.Poll(9100) == REFRESH_FULL);
+        CHECK(cadence.Poll(9110) == REFRESH_NONE);
+        CHECK(cadence.Poll(9250) == REFRESH_VOLATILE);
+        CHECK(cadence.Poll(9500) == REFRESH_VOLATILE);
+        CHECK(cadence.Poll(9750) == REFRESH_VOLATILE);
+        CHECK(cadence.Poll(10000) == REFRESH_FULL);
+
+        // A stall that misses volatile deadlines only
+        CHECK(cadence.Poll(10900) == REFRESH_VOLATILE);
+        CHECK(cadence.Poll(10950) == REFRESH_NONE);
+        CHECK(cadence.Poll(11100) == REFRESH_NONE);
+        CHECK(cadence.Poll(11250) == REFRESH_VOLATILE);
+    }
+
+    // Changing the intervals applies from the next Reset
+    {
+        RefreshCadence cadence(250, 2000);
+        cadence.Reset(0);
+        cadence.SetIntervals(100, 1000);
+        cadence.Reset(500);
+        Counts counts = Run(cadence, 500, 500 + 10000, 100, 0, random);
+        CHECK(counts.full == 10);
+        CHECK(counts.volatileOnly == 90);
+        CHECK(counts.none == 0);
+    }
+
+    std::printf("RefreshCadenceTest passed\n");
+    return 0;
+}
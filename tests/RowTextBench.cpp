@@ -0,0 +1,128 @@
+// Main list cell text: swprintf for every cell of every row, which the list
+// did before owner-data mode, against RowTextProvider formatting rows cold,
+// re-reading them unchanged, and serving a scrolled viewport per refresh.
+// The provider's text is checked against swprintf.
+
+#include "TestHarness.h"
+#include "RowText.h"
+#include "WindowSort.h"
+#include <cwchar>
+
+static const int NUMERIC_COLUMNS[] = { COLUMN_HWND, COLUMN_PID, COLUMN_POSITION, COLUMN_SIZE };
+
+static void PrintfCell(wchar_t* out, size_t size, const WindowInfo& win, int column) {
+    switch (column) {
+    case COLUMN_HWND:
+        std::swprintf(out, size, L"%llX", static_cast<unsigned long long>(reinterpret_cast<uintptr_t>(win.hwnd)));
+        break;
+    case COLUMN_PID:
+        std::swprintf(out, size, L"%u", static_cast<unsigned>(win.processId));
+        break;
+    case COLUMN_POSITION:
+        std::swprintf(out, size, L"%d, %d", static_cast<int>(win.rect.left), static_cast<int>(win.rect.top));
+        break;
+    case COLUMN_SIZE:
+        std::swprintf(out, size, L"%d x %d", static_cast<int>(win.rect.right - win.rect.left),
+            static_cast<int>(win.rect.bottom - win.rect.top));
+        break;
+    }
+}
+
+int main(int argc, char** argv) {
+    size_t count = BenchSize(argc, argv, 100000);
+    SyntheticWindows synthetic(29);
+    std::vector<WindowInfo> windows = synthetic.MakeMany(count);
+    for (size_t i = 0; i < count; i++) {
+        windows[i].exposed = static_cast<int>(i % 10001);
+        windows[i].monitor = static_cast<int>(i % 3);
+        windows[i].logicalRect = windows[i].rect;
+    }
+
+    // Every numeric cell matches what swprintf printed
+    RowTextProvider provider;
+    provider.BeginSnapshot();
+    wchar_t expected[64];
+    for (const WindowInfo& win : windows) {
+        for (int column : NUMERIC_COLUMNS) {
+            PrintfCell(expected, 64, win, column);
+            CHECK(std::wcscmp(provider.GetText(win, column), expected) == 0);
+        }
+    }
+    WindowInfo partial = windows[0];
+    partial.exposed = 1234;
+    CHECK(std::wcscmp(provider.GetText(partial, COLUMN_EXPOSED), L"12.3%") == 0);
+    partial.monitor = 1;
+    partial.logicalRect.left = -5;
+    partial.logicalRect.top = 7;
+    CHECK(std::wcscmp(provider.GetText(partial, COLUMN_MONITOR), L"2: -5, 7") == 0);
+
+    size_t cells = count * COLUMN_COUNT;
+    std::printf("%zu windows, %zu cells\n", count, cells);
+
+    // Whole list through swprintf
+    Stopwatch watch;
+    size_t checksum = 0;
+    wchar_t buffer[64];
+    for (const WindowInfo& win : windows) {
+        for (int column : NUMERIC_COLUMNS) {
+            PrintfCell(buffer, 64, win, column);
+            checksum += buffer[0];
+        }
+    }
+    double printfMs = watch.Ms();
+
+    // Whole list through a fresh provider, then again with nothing changed
+    RowTextProvider cold;
+    cold.BeginSnapshot();
+    watch.Restart();
+    for (const WindowInfo& win : windows) {
+        for (int column = 0; column < COLUMN_COUNT; column++) {
+            checksum += cold.GetText(win, column)[0];
+        }
+    }
+    double coldMs = watch.Ms();
+    uint64_t coldFormats = cold.FormatCount();
+
+    cold.BeginSnapshot();
+    watch.Restart();
+    for (const WindowInfo& win : windows) {
+        for (int column = 0; column < COLUMN_COUNT; column++) {
+            checksum += cold.GetText(win, column)[0];
+        }
+    }
+    double warmMs = watch.Ms();
+    uint64_t warmFormats = cold.FormatCount() - coldFormats;
+
+    std::printf("%-34s %10.1f ms %8.1f ns/cell\n", "swprintf, 4 numeric columns", printfMs,
+        printfMs * 1e6 / (count * 4));
+    std::printf("%-34s %10.1f ms %8.1f ns/cell %10llu formats\n", "provider, all columns, cold", coldMs,
+        coldMs * 1e6 / cells, static_cast<unsigned long long>(coldFormats));
+    std::printf("%-34s %10.1f ms %8.1f ns/cell %10llu formats\n", "provider, all columns, unchanged", warmMs,
+        warmMs * 1e6 / cells, static_cast<unsigned long long>(warmFormats));
+    CHECK(warmFormats == 0);
+
+    // Owner-data refreshes: a 60-row viewport scrolling a few rows each time,
+    // while one window in a hundred moves
+    const size_t viewport = 60;
+    const int refreshes = 2000;
+    RowTextProvider scrolled;
+    size_t top = 0;
+    watch.Restart();
+    for (int refresh = 0; refresh < refreshes; refresh++) {
+        scrolled.BeginSnapshot();
+        for (size_t moved = 0; moved < count / 100; moved++) {
+            windows[synthetic.Next(static_cast<uint32_t>(count))].rect.left++;
+        }
+        top = (top + synthetic.Next(8)) % count;
+        for (size_t row = top; row < top + viewport && row < count; row++) {
+            for (int column = 0; column < COLUMN_COUNT; column++) {
+                checksum += scrolled.GetText(windows[row], column)[0];
+            }
+        }
+    }
+    double viewMs = watch.Ms();
+    std::printf("%-34s %10.3f ms/refresh %6.1f%% formatted\n", "provider, scrolled viewport", viewMs / refreshes,
+        scrolled.LookupCount() ? 100.0 * scrolled.FormatCount() / scrolled.LookupCount() : 0.0);
+    std::printf("checksum %zu\n", checksum);
+    return 0;
+}
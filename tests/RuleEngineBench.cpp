@@ -0,0 +1,307 @@
+// RuleEngine with thousands of rules over a changing desktop. Checks that the
+// rules fired on each update are exactly those a full evaluation of every
+// rule against every window says newly matched, with changes to every input
+// a query field reads, then times the incremental update against that full
+// evaluation.
+
+#include "TestHarness.h"
+#include "WindowRules.h"
+#include <algorithm>
+#include <unordered_map>
+
+static const wchar_t* const CLASSES[] = {
+    L"Notepad", L"Chrome_WidgetWin_1", L"CabinetWClass", L"Shell_TrayWnd", L"#32770",
+    L"ApplicationFrameWindow", L"Button", L"tooltips_class32", L"OpusApp", L"WorkerW"
+};
+static const wchar_t* const FLAGS[] = {
+    L"visible", L"enabled", L"minimized", L"maximized", L"topmost", L"layered", L"cloaked", L"hung", L"uwp",
+    L"hidden", L"system"
+};
+
+// A rule over one or two random terms, covering every query field; its one
+// action names it so the fired rules can be read back from the effects. A
+// keyed rule starts the way most rules files do, with an exact class,
+// process, pid or handle, mostly of programs that are not running. Without
+// zOrder no rule reads z:, so raising a window, which renumbers every window
+// below it, has none of them tested again.
+static std::wstring RandomRule(SyntheticWindows& random, size_t index, bool keyed, bool zOrder) {
+    std::wstring rule;
+    if (keyed) {
+        bool running = random.Next(10) == 0;
+        switch (random.Next(4)) {
+        case 0:
+            rule += running ? std::wstring(L"class:") + CLASSES[random.Next(10)] :
+                L"class:AppWindow" + std::to_wstring(random.Next(2000));
+            break;
+        case 1:
+            rule += running ? L"process:notepad.exe" : L"process:app" + std::to_wstring(random.Next(2000)) + L".exe";
+            break;
+        case 2: rule += L"pid:" + std::to_wstring(1000 + random.Next(2000) * 4); break;
+        default: rule += L"hwnd:" + std::to_wstring(10000 + random.Next(20000) * 4); break;
+        }
+        rule += L" ";
+    }
+    size_t terms = keyed ? random.Next(2) : 1 + random.Next(2);
+    for (size_t i = 0; i < terms; i++) {
+        if (random.Next(8) == 0) rule += L"-";
+        uint32_t field = random.Next(11);
+        if (!zOrder && field == 7) field = 9;
+        switch (field) {
+        case 0: rule += std::wstring(L"class:") + CLASSES[random.Next(10)]; break;
+        case 1: rule += random.Next(2) ? L"process:chrome.exe|code.exe" : L"process:notepad.exe"; break;
+        case 2: rule += random.Next(2) ? L"title:\"*word*\"" : L"title:\"doc *\""; break;
+        case 3: rule += L"path:\"c:\\program files\\e*\""; break;
+        case 4: rule += random.Next(2) ? L"inbox" : L"note"; break;
+        case 5: rule += L"pid:<=" + std::to_wstring(1000 + random.Next(64) * 4); break;
+        case 6: rule += L"tid:>" + std::to_wstring(16000 + random.Next(64) * 64); break;
+        case 7: rule += L"z:<" + std::to_wstring(random.Next(200)); break;
+        case 8: rule += L"hwnd:" + std::to_wstring(10000 + random.Next(400) * 4); break;
+        default:
+            rule += std::wstring(FLAGS[random.Next(11)]) + (random.Next(2) ? L":yes" : L":no");
+            break;
+        }
+        rule += L" ";
+    }
+    return rule + L"=> title=" + std::to_wstring(index);
+}
+
+// One change to a random window, to an input some query field reads, or not
+static void Change(SyntheticWindows& random, std::vector<WindowInfo>& windows, uint32_t& created) {
+    size_t row = random.Next(static_cast<uint32_t>(windows.size()));
+    WindowInfo& win = windows[row];
+    switch (random.Next(14)) {
+    case 0: win.title = win.title.empty() ? L"Doc " + std::to_wstring(random.Next(100)) : L""; break;
+    case 1: win.title = random.Next(2) ? L"Word count" : L"Inbox"; break;
+    case 2: win.isVisible = !win.isVisible; break;
+    case 3: win.isCloaked = !win.isCloaked; break;
+    case 4: win.isUWP = !win.isUWP; break;
+    case 5: win.exStyle ^= WS_EX_TOOLWINDOW; break;
+    case 6: win.isMinimized = !win.isMinimized; win.isHung = !win.isHung; break;
+    case 7: win.isTopMost = !win.isTopMost; win.isLayered = !win.isLayered; break;
+    case 8: win.threadId += 64; break;
+    case 9: {
+        // Raised to the top, renumbering the z-order
+        WindowInfo raised = win;
+        windows.erase(windows.begin() + row);
+        windows.insert(windows.begin(), raised);
+        break;
+    }
+    case 10:
+        // The handle recycled by another process
+        win.processId = 1000 + random.Next(64) * 4;
+        win.className = CLASSES[random.Next(10)];
+        break;
+    case 11: windows.insert(windows.begin() + row, random.Make(created++)); break;
+    case 12:
+        if (windows.size() > 10) windows.erase(windows.begin() + row);
+        break;
+    default:
+        // Read by no rule
+        win.rect.left += 5;
+        win.rect.right += 5;
+        break;
+    }
+    for (size_t i = 0; i < windows.size(); i++) {
+        windows[i].zOrder = static_cast<int>(i);
+    }
+}
+
+// A full evaluation: for each window, the rules it matches now and did not
+// match on the last update, as (window, rule) in window then rule order
+class FullEvaluation {
+public:
+    explicit FullEvaluation(const std::vector<WindowRule>& rules) : m_rules(rules) {}
+
+    std::vector<std::pair<HWND, int>> Update(const std::vector<WindowInfo>& windows) {
+        std::vector<std::pair<HWND, int>> fired;
+        std::unordered_map<HWND, State> next;
+        for (const WindowInfo& win : windows) {
+            State& state = next[win.hwnd];
+            state.processId = win.processId;
+            state.className = win.className;
+            const State* before = nullptr;
+            auto found = m_windows.find(win.hwnd);
+            if (found != m_windows.end() && found->second.processId == win.processId &&
+                found->second.className == win.className) {
+                before = &found->second;
+            }
+            for (size_t rule = 0; rule < m_rules.size(); rule++) {
+                if (m_rules[rule].query.Matches(win)) {
+                    state.matched.push_back(static_cast<int>(rule));
+                    if (!before || !std::binary_search(before->matched.begin(), before->matched.end(),
+                            static_cast<int>(rule))) {
+                        fired.push_back({ win.hwnd, static_cast<int>(rule) });
+                    }
+                }
+            }
+        }
+        m_windows.swap(next);
+        return fired;
+    }
+
+private:
+    struct State {
+        DWORD processId;
+        std::wstring className;
+        std::vector<int> matched;
+    };
+
+    const std::vector<WindowRule>& m_rules;
+    std::unordered_map<HWND, State> m_windows;
+};
+
+static std::vector<std::pair<HWND, int>> Fired(const RuleEffects& effects) {
+    std::vector<std::pair<HWND, int>> fired;
+    for (const RuleEffects::Action& action : effects.actions) {
+        fired.push_back({ action.hwnd, std::stoi(action.action->text) });
+    }
+    return fired;
+}
+
+// Keyed rules but for one in twenty, or none
+static std::vector<WindowRule> MakeRules(uint32_t seed, size_t count, bool keyed, bool zOrder) {
+    SyntheticWindows random(seed);
+    std::wstring text;
+    for (size_t i = 0; i < count; i++) {
+        text += RandomRule(random, i, keyed && random.Next(20) != 0, zOrder) + L"\n";
+    }
+    std::vector<WindowRule> rules;
+    std::wstring error;
+    CHECK(RuleParser::ParseRules(text, rules, error));
+    CHECK(rules.size() == count);
+    return rules;
+}
+
+static std::vector<WindowInfo> MakeWindows(SyntheticWindows& random, size_t count, uint32_t& created) {
+    std::vector<WindowInfo> windows;
+    for (; created < count; created++) {
+        windows.push_back(random.Make(created));
+        windows.back().processPath = L"C:\\Program Files\\" + windows.back().processName;
+    }
+    return windows;
+}
+
+int main(int argc, char** argv) {
+    size_t ruleCount = BenchSize(argc, argv, 5000);
+    std::printf("%zu rules\n", ruleCount);
+
+    // A window losing its title becomes a system window when it is a tool
+    // window; only the inputs a rule reads make a window worth testing again
+    {
+        std::vector<WindowRule> rules;
+        std::wstring error;
+        CHECK(RuleParser::ParseRules(L"system:yes => hide\nhidden:yes => title=hidden", rules, error));
+        RuleEngine engine;
+        engine.SetRules(rules);
+        WindowInfo win = {};
+        win.hwnd = MakeHandle(0x100);
+        win.className = L"Palette";
+        win.title = L"Tools";
+        win.exStyle = WS_EX_TOOLWINDOW;
+        win.isVisible = true;
+        std::vector<WindowInfo> windows = { win };
+
+        RuleEffects effects;
+        engine.Update(windows, effects);
+        CHECK(effects.evaluated == 1 && effects.fired == 0);
+        windows[0].title.clear();
+        effects.Clear();
+        engine.Update(windows, effects);
+        CHECK(effects.evaluated == 1 && effects.fired == 1 && effects.actions[0].action->type == RULE_HIDE);
+
+        windows[0].isCloaked = true;
+        effects.Clear();
+        engine.Update(windows, effects);
+        CHECK(effects.evaluated == 1 && effects.fired == 1 && effects.actions[0].action->type == RULE_TITLE);
+
+        // Not read by either rule
+        windows[0].rect = { 10, 10, 200, 200 };
+        windows[0].isTopMost = true;
+        windows[0].style = WS_POPUP;
+        windows[0].threadId = 7;
+        effects.Clear();
+        engine.Update(windows, effects);
+        CHECK(effects.evaluated == 0);
+    }
+
+    // Every update against a full evaluation
+    {
+        std::vector<WindowRule> rules = MakeRules(44, 2000, false, true);
+        SyntheticWindows random(45);
+        uint32_t created = 0;
+        std::vector<WindowInfo> windows = MakeWindows(random, 400, created);
+        RuleEngine engine;
+        engine.SetRules(rules);
+        FullEvaluation full(rules);
+        size_t fired = 0;
+        size_t evaluated = 0;
+        for (size_t step = 0; step < 300; step++) {
+            RuleEffects effects;
+            engine.Update(windows, effects);
+            std::vector<std::pair<HWND, int>> expected = full.Update(windows);
+            CHECK(effects.placement.Entries().empty());
+            CHECK(Fired(effects) == expected);
+            fired += effects.fired;
+            evaluated += effects.evaluated;
+            for (size_t change = 0; change < 8; change++) {
+                Change(random, windows, created);
+            }
+        }
+        std::printf("300 updates of 2000 rules over ~400 windows match a full evaluation: %zu windows tested, "
+            "%zu rules fired\n", evaluated, fired);
+    }
+
+    // Throughput, with keyed rules but for one in twenty, with and without
+    // rules on the z-order
+    std::printf("%8s %8s %8s %12s %12s %14s %12s\n", "z rules", "windows", "changes", "us/update", "tested",
+        "rule tests", "full us");
+    for (bool zOrder : { false, true }) {
+        std::vector<WindowRule> rules = MakeRules(46, ruleCount, true, zOrder);
+        for (size_t windowCount : { 500, 2000 }) {
+            for (size_t changes : { 0, 10, 100 }) {
+                SyntheticWindows random(47);
+                uint32_t created = 0;
+                std::vector<std::vector<WindowInfo>> frames = { MakeWindows(random, windowCount, created) };
+                const size_t updates = 100;
+                for (size_t update = 1; update < updates; update++) {
+                    frames.push_back(frames.back());
+                    for (size_t change = 0; change < changes; change++) {
+                        Change(random, frames.back(), created);
+                    }
+                }
+
+                RuleEngine engine;
+                engine.SetRules(rules);
+                RuleEffects effects;
+                engine.Update(frames[0], effects);
+                size_t tested = 0;
+                size_t ruleTests = 0;
+                Stopwatch watch;
+                for (size_t update = 1; update < updates; update++) {
+                    effects.Clear();
+                    engine.Update(frames[update], effects);
+                    tested += effects.evaluated;
+                    ruleTests += effects.candidates;
+                }
+                double ms = watch.Ms();
+                CHECK(changes != 0 || tested == 0);
+
+                // Every rule against every window of one snapshot
+                watch.Restart();
+                size_t matches = 0;
+                for (const WindowInfo& win : frames.back()) {
+                    for (const WindowRule& rule : rules) {
+                        matches += rule.query.Matches(win) ? 1 : 0;
+                    }
+                }
+                double fullMs = watch.Ms();
+                CHECK(matches > 0);
+
+                std::printf("%8s %8zu %8zu %12.1f %12.1f %14.1f %12.0f\n", zOrder ? "yes" : "no", windowCount,
+                    changes, ms * 1000.0 / (updates - 1), static_cast<double>(tested) / (updates - 1),
+                    static_cast<double>(ruleTests) / (updates - 1), fullMs * 1000.0);
+            }
+        }
+    }
+    return 0;
+}
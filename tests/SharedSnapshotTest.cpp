@@ -0,0 +1,215 @@
+// SharedSnapshot under concurrent readers. The writer publishes a run of
+// snapshots whose every field is derived from the publish sequence, as fast
+// as it can, while reader processes (forked; threads on Windows) read each
+// newest snapshot in place with Begin/Validate and copy it out with Read.
+// A read that validates must be one whole snapshot: every row agrees with
+// the sequence it was published under. Also checks a view goes stale once
+// its slot is reused, and the overflow report for a snapshot too big for
+// a slot.
+
+#include "TestHarness.h"
+#include "SharedSnapshot.h"
+#include <string>
+
+#ifdef _WIN32
+#include <thread>
+#else
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+static const size_t PUBLISHES = 3000;
+static const int READERS = 4;
+
+static size_t RowCount(uint64_t sequence) {
+    return 50 + static_cast<size_t>(sequence * 37 % 300);
+}
+
+static std::wstring Title(uint64_t sequence, size_t row) {
+    // Lengths vary so string offsets move between snapshots
+    return L"snapshot " + std::to_wstring(sequence) + std::wstring(row % 7, L'.') + L" row " + std::to_wstring(row);
+}
+
+static std::vector<WindowInfo> MakeSnapshot(uint64_t sequence) {
+    std::vector<WindowInfo> windows(RowCount(sequence));
+    for (size_t row = 0; row < windows.size(); row++) {
+        WindowInfo& win = windows[row];
+        win.hwnd = MakeHandle(static_cast<uint32_t>(0x10000 + row * 4));
+        win.processId = static_cast<DWORD>(sequence);
+        win.threadId = static_cast<DWORD>(row);
+        win.title = Title(sequence, row);
+        win.rect = { static_cast<LONG>(sequence), static_cast<LONG>(row), static_cast<LONG>(sequence + row), 0 };
+        win.zOrder = static_cast<int>(row);
+    }
+    return windows;
+}
+
+// Whether a view holds all of the snapshot published as sequence
+static bool IsWhole(const SnapshotFileReader& view, uint64_t sequence) {
+    if (view.RowCount() != RowCount(sequence) || view.CaptureTime() != sequence * 10) {
+        return false;
+    }
+    for (size_t row = 0; row < view.RowCount(); row++) {
+        SnapshotRect rect = view.Rect(row);
+        if (view.ProcessId(row) != sequence || view.ThreadId(row) != row || view.ZOrder(row) != static_cast<int>(row) ||
+            rect.left != static_cast<int32_t>(sequence) || rect.right != static_cast<int32_t>(sequence + row) ||
+            SnapshotFileReader::ToWide(view.Title(row)) != Title(sequence, row)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+struct ReaderStats {
+    size_t whole = 0;      // reads that validated, all checked
+    size_t stale = 0;      // reads that failed validation and were dropped
+    size_t copies = 0;     // Read() copies, all checked
+    bool ok = true;
+};
+
+// Reads until the last publish has been seen. Returns false on a validated
+// read that was not one whole snapshot, or a sequence going backwards.
+static ReaderStats ReadUntilDone(const std::wstring& name) {
+    ReaderStats stats;
+    SharedSnapshotReader reader;
+    if (!reader.Open(name)) {
+        stats.ok = false;
+        return stats;
+    }
+
+    SnapshotFileReader view;
+    uint64_t last = 0;
+    for (size_t pass = 0; last < PUBLISHES; pass++) {
+        uint64_t sequence;
+        if (!reader.Begin(view, sequence)) {
+            continue;
+        }
+        if (sequence < last) {
+            stats.ok = false;
+            return stats;
+        }
+        last = sequence;
+        bool whole = IsWhole(view, sequence);
+        if (!reader.Validate(sequence)) {
+            stats.stale++;
+            continue;
+        }
+        if (!whole) {
+            stats.ok = false;
+            return stats;
+        }
+        stats.whole++;
+
+        if (pass % 8 == 0) {
+            std::vector<WindowInfo> windows;
+            uint64_t captureTime;
+            if (reader.Read(windows, captureTime, sequence)) {
+                if (captureTime != sequence * 10 || !SameWindows(windows, MakeSnapshot(sequence))) {
+                    stats.ok = false;
+                    return stats;
+                }
+                stats.copies++;
+            }
+        }
+    }
+    return stats;
+}
+
+int main() {
+#ifdef _WIN32
+    std::wstring name = L"Local\\WinLister_SharedSnapshotTest";
+#else
+    std::wstring name = L"/winlister-shared-snapshot-test-" + std::to_wstring(getpid());
+#endif
+
+    // A view goes stale once its slot is reused two publishes later
+    {
+        SharedSnapshotWriter writer;
+        CHECK(writer.Open(name, 256 * 1024));
+        SharedSnapshotReader reader;
+        CHECK(reader.Open(name));
+        SnapshotFileReader view;
+        uint64_t sequence;
+        CHECK(reader.Sequence() == 0 && !reader.Begin(view, sequence));
+
+        CHECK(writer.Publish(MakeSnapshot(1), 10));
+        CHECK(reader.Begin(view, sequence) && sequence == 1 && IsWhole(view, 1));
+        CHECK(writer.Publish(MakeSnapshot(2), 20));
+        CHECK(reader.Validate(1) && IsWhole(view, 1));
+        CHECK(writer.Publish(MakeSnapshot(3), 30));
+        CHECK(!reader.Validate(1));
+        CHECK(reader.Begin(view, sequence) && sequence == 3 && IsWhole(view, 3));
+
+        // Too big for a slot: not published, and the size needed is reported
+        SyntheticWindows synthetic(42);
+        CHECK(!writer.Publish(synthetic.MakeMany(20000), 40));
+        CHECK(reader.OverflowSize() > 256 * 1024);
+        CHECK(reader.Sequence() == 3);
+        CHECK(writer.Publish(MakeSnapshot(4), 40));
+        CHECK(reader.OverflowSize() == 0 && reader.Sequence() == 4);
+    }
+
+    // Readers racing a writer
+    SharedSnapshotWriter writer;
+    CHECK(writer.Open(name, 256 * 1024));
+#ifdef _WIN32
+    std::vector<ReaderStats> stats(READERS);
+    std::vector<std::thread> readers;
+    for (int i = 0; i < READERS; i++) {
+        readers.emplace_back([&, i]() { stats[i] = ReadUntilDone(name); });
+    }
+#else
+    std::vector<pid_t> readers;
+    std::vector<int> pipes;
+    for (int i = 0; i < READERS; i++) {
+        int fds[2];
+        CHECK(pipe(fds) == 0);
+        pid_t child = fork();
+        CHECK(child >= 0);
+        if (child == 0) {
+            close(fds[0]);
+            ReaderStats stats = ReadUntilDone(name);
+            bool sent = write(fds[1], &stats, sizeof(stats)) == static_cast<ssize_t>(sizeof(stats));
+            _exit(stats.ok && sent ? 0 : 1);
+        }
+        close(fds[1]);
+        readers.push_back(child);
+        pipes.push_back(fds[0]);
+    }
+#endif
+
+    for (uint64_t sequence = 1; sequence <= PUBLISHES; sequence++) {
+        CHECK(writer.Publish(MakeSnapshot(sequence), sequence * 10));
+        CHECK(writer.Sequence() == sequence);
+    }
+
+    ReaderStats total;
+#ifdef _WIN32
+    for (int i = 0; i < READERS; i++) {
+        readers[i].join();
+        CHECK(stats[i].ok);
+        total.whole += stats[i].whole;
+        total.stale += stats[i].stale;
+        total.copies += stats[i].copies;
+    }
+#else
+    for (int i = 0; i < READERS; i++) {
+        ReaderStats stats;
+        CHECK(read(pipes[i], &stats, sizeof(stats)) == static_cast<ssize_t>(sizeof(stats)));
+        close(pipes[i]);
+        int status = 0;
+        CHECK(waitpid(readers[i], &status, 0) == readers[i]);
+        CHECK(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+        total.whole += stats.whole;
+        total.stale += stats.stale;
+        total.copies += stats.copies;
+    }
+#endif
+    writer.Close();
+
+    // Each reader sees at least the last snapshot whole
+    CHECK(total.whole >= static_cast<size_t>(READERS));
+    std::printf("SharedSnapshotTest passed: %zu publishes, %d readers, %zu whole reads, %zu stale, %zu copies\n",
+        PUBLISHES, READERS, total.whole, total.stale, total.copies);
+    return 0;
+}
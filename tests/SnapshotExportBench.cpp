@@ -0,0 +1,78 @@
+// SnapshotExporter throughput in rows/s and bytes/s per format, into a sink
+// that only counts and into an in-memory string. Also checks format names
+// parse case-insensitively and that each format has one record per window.
+
+#include "TestHarness.h"
+#include "SnapshotExport.h"
+#include <algorithm>
+
+// Counts bytes and line feeds, so the writer's cost is measured alone
+class CountingSink : public ByteSink {
+public:
+    bool Write(const char* data, size_t length) override {
+        m_bytes += length;
+        m_lines += static_cast<size_t>(std::count(data, data + length, '\n'));
+        return true;
+    }
+
+    size_t Bytes() const { return m_bytes; }
+    size_t Lines() const { return m_lines; }
+
+private:
+    size_t m_bytes = 0;
+    size_t m_lines = 0;
+};
+
+int main(int argc, char** argv) {
+    size_t count = BenchSize(argc, argv, 1000000);
+
+    SnapshotFormat format = SNAPSHOT_CSV;
+    CHECK(SnapshotExporter::ParseFormat(L"json", format) && format == SNAPSHOT_JSON);
+    CHECK(SnapshotExporter::ParseFormat(L"CSV", format) && format == SNAPSHOT_CSV);
+    CHECK(SnapshotExporter::ParseFormat(L"NdJson", format) && format == SNAPSHOT_NDJSON);
+    CHECK(!SnapshotExporter::ParseFormat(L"jso", format));
+    CHECK(!SnapshotExporter::ParseFormat(L"jsonl", format));
+    CHECK(!SnapshotExporter::ParseFormat(L"", format));
+    for (SnapshotFormat each : { SNAPSHOT_CSV, SNAPSHOT_JSON, SNAPSHOT_NDJSON }) {
+        CHECK(SnapshotExporter::ParseFormat(SnapshotExporter::FileExtension(each), format) && format == each);
+    }
+
+    // Titles with separators, quotes and non-ASCII text to escape and encode
+    SyntheticWindows synthetic(36);
+    std::vector<WindowInfo> windows = synthetic.MakeMany(count);
+    for (size_t i = 0; i < count; i += 7) {
+        windows[i].title += L", \"quoted\" é中";
+    }
+
+    std::printf("%zu windows\n", count);
+    std::printf("%-8s %-8s %12s %10s %12s %10s\n", "format", "sink", "bytes", "ms", "rows/s", "MB/s");
+    const wchar_t* const names[] = { L"csv", L"json", L"ndjson" };
+    for (SnapshotFormat each : { SNAPSHOT_CSV, SNAPSHOT_JSON, SNAPSHOT_NDJSON }) {
+        CountingSink counter;
+        Stopwatch watch;
+        CHECK(SnapshotExporter::Write(windows, each, counter));
+        double countMs = watch.Ms();
+
+        // A line per object, plus CSV's header or JSON's brackets
+        size_t expectedLines = count + (each == SNAPSHOT_CSV ? 1 : each == SNAPSHOT_JSON ? 2 : 0);
+        CHECK(counter.Lines() == expectedLines);
+
+        std::string text;
+        text.reserve(counter.Bytes());
+        StringSink stringSink(text);
+        watch.Restart();
+        CHECK(SnapshotExporter::Write(windows, each, stringSink));
+        double stringMs = watch.Ms();
+        CHECK(text.size() == counter.Bytes());
+        if (each == SNAPSHOT_JSON) {
+            CHECK(text.front() == '[' && text.find_last_not_of("\r\n") == text.find_last_of(']'));
+        }
+
+        for (int sink = 0; sink < 2; sink++) {
+            double ms = sink == 0 ? countMs : stringMs;
+            std::printf("%-8ls %-8s %12zu %10.1f %12.0f %10.1f\n", names[each], sink == 0 ? "count" : "string",
+                counter.Bytes(), ms, count / (ms / 1000.0), counter.Bytes() / (ms * 1000.0));
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,118 @@
+// SnapshotFileWriter to SnapshotFileReader round trip: every field of every
+// row comes back as written, and the filter and query select the same rows
+// on the reader's columns as on the original WindowInfo values.
+
+#include "TestHarness.h"
+#include "SnapshotFile.h"
+#include "BufferedWriter.h"
+#include "WindowFilter.h"
+#include "WindowQuery.h"
+#include <cstring>
+
+int main() {
+    // Vary the flags the synthetic windows leave fixed, and give some rows
+    // parents, owners, paths and negative z-orders
+    SyntheticWindows synthetic(37);
+    std::vector<WindowInfo> windows = synthetic.MakeMany(3000);
+    for (size_t i = 0; i < windows.size(); i++) {
+        WindowInfo& win = windows[i];
+        win.isEnabled = synthetic.Next(8) != 0;
+        win.isMaximized = synthetic.Next(12) == 0;
+        win.isLayered = synthetic.Next(6) == 0;
+        win.isTransparent = win.isLayered && synthetic.Next(2) == 0;
+        win.isCloaked = synthetic.Next(9) == 0;
+        win.isUWP = synthetic.Next(5) == 0;
+        win.isHung = synthetic.Next(40) == 0;
+        win.alpha = static_cast<BYTE>(synthetic.Next(256));
+        if (i % 3 == 0) {
+            win.hwndParent = windows[i / 2].hwnd;
+        }
+        if (i % 5 == 0) {
+            win.hwndOwner = windows[i / 3].hwnd;
+        }
+        if (i % 4 != 0) {
+            win.processPath = L"C:\\Program Files\\App\\" + win.processName;
+        }
+        if (i % 11 == 0) {
+            win.zOrder = -static_cast<int>(i);
+        }
+        if (i % 7 == 0) {
+            win.hasDwmFrame = true;
+            win.dwmExtendedFrame = { win.rect.left - 7, win.rect.top, win.rect.right + 7, win.rect.bottom + 7 };
+        }
+    }
+
+    std::string bytes;
+    StringSink sink(bytes);
+    CHECK(SnapshotFileWriter::Write(windows, 1700000000123ULL, sink));
+
+    // Attach wants an 8-byte aligned buffer
+    std::vector<uint64_t> aligned((bytes.size() + 7) / 8);
+    std::memcpy(aligned.data(), bytes.data(), bytes.size());
+
+    SnapshotFileReader reader;
+    CHECK(reader.Attach(aligned.data(), bytes.size()));
+    CHECK(reader.Version() == SnapshotFileWriter::VERSION);
+    CHECK(reader.CaptureTime() == 1700000000123ULL);
+    CHECK(reader.RowCount() == windows.size());
+
+    std::vector<WindowInfo> materialized;
+    reader.Materialize(materialized);
+    CHECK(materialized.size() == windows.size());
+    for (size_t i = 0; i < windows.size(); i++) {
+        CHECK(SameWindow(reader.Row(i), windows[i]));
+        CHECK(SameWindow(materialized[i], windows[i]));
+    }
+
+    // A truncated file is refused rather than read past its end
+    SnapshotFileReader truncated;
+    CHECK(!truncated.Attach(aligned.data(), bytes.size() / 2));
+
+    // Filters on the reader select exactly what they select on WindowInfo
+    const wchar_t* const searches[] = { L"", L"notepad", L"ÉTÉ", L"chrome_widget", L"EXE", L"zz t", L"nothing" };
+    for (int options = 0; options < 4; options++) {
+        for (const wchar_t* search : searches) {
+            WindowFilterOptions filterOptions;
+            filterOptions.hideHidden = (options & 1) != 0;
+            filterOptions.hideSystem = (options & 2) != 0;
+            filterOptions.search = search;
+            WindowFilter filter(filterOptions);
+            CHECK(!filter.NeedsAnalysis());
+            size_t matches = 0;
+            for (size_t i = 0; i < windows.size(); i++) {
+                bool expected = filter.Matches(windows[i]);
+                CHECK(filter.Matches(reader, i) == expected);
+                matches += expected;
+            }
+            CHECK(matches <= windows.size());
+        }
+    }
+
+    // Queries on the reader, over every kind of term
+    const wchar_t* const queries[] = {
+        L"", L"notepad", L"-notepad", L"title:*word", L"title:\"untitled - *\"", L"class:button|worker?",
+        L"process:CHROME.EXE", L"path:c:\\program*", L"-path:*", L"pid:1004", L"pid:>=1100", L"tid:<16100",
+        L"hwnd:10010", L"hwnd:0x10010", L"z:<0", L"z:>=2990", L"visible:yes", L"enabled:no",
+        L"minimized:1", L"maximized:true", L"topmost:yes", L"layered:yes", L"cloaked:yes", L"hung:yes",
+        L"uwp:yes", L"hidden:yes", L"hidden:no", L"system:yes", L"system:no -uwp:yes title:*",
+        L"été visible:yes pid:<1200",
+    };
+    size_t selective = 0;
+    for (const wchar_t* text : queries) {
+        WindowQuery query;
+        std::wstring error;
+        CHECK(WindowQuery::Parse(text, query, error));
+        size_t matches = 0;
+        for (size_t i = 0; i < windows.size(); i++) {
+            bool expected = query.Matches(windows[i]);
+            CHECK(query.Matches(reader, i) == expected);
+            matches += expected;
+        }
+        selective += matches > 0 && matches < windows.size();
+    }
+    // Most queries split the rows, so the comparison is not vacuous
+    CHECK(selective >= 20);
+
+    std::printf("SnapshotFileTest passed\n");
+    return 0;
+}
@@ -0,0 +1,99 @@
+// SnapshotDeltaEncoder, SnapshotDeltaDecoder and SnapshotReplay seeking over a
+// synthetic multi-hour trace (one frame a second, 400 windows): encode time
+// and bytes per frame, sequential decode, and random seeks by time. Every
+// decoded frame is checked against the trace.
+
+#include "TestHarness.h"
+#include "SnapshotRecording.h"
+#include "BufferedWriter.h"
+#include <algorithm>
+#include <cstring>
+#include <map>
+
+static const uint64_t START_TIME = 1700000000000ULL;
+
+// A segment header as SnapshotRecorder writes it
+static std::string SegmentHeader() {
+    std::string header("WLREC\0\0\0", 8);
+    uint32_t version = SnapshotRecorder::VERSION;
+    uint32_t reserved = 0;
+    header.append(reinterpret_cast<const char*>(&version), sizeof(version));
+    header.append(reinterpret_cast<const char*>(&reserved), sizeof(reserved));
+    return header;
+}
+
+int main(int argc, char** argv) {
+    size_t frames = BenchSize(argc, argv, 8 * 3600);
+    const size_t windowCount = 400;
+
+    // Frames to seek to, kept from the trace as it is encoded
+    SyntheticWindows random(38);
+    std::map<size_t, std::vector<WindowInfo>> targets;
+    for (int i = 0; i < 200; i++) {
+        targets[random.Next(static_cast<uint32_t>(frames))];
+    }
+
+    std::string segment = SegmentHeader();
+    SnapshotDeltaEncoder encoder;
+    SyntheticTrace trace(38, windowCount);
+    double encodeMs = 0;
+    for (size_t frame = 0; frame < frames; frame++) {
+        const std::vector<WindowInfo>& windows = trace.Step();
+        auto target = targets.find(frame);
+        if (target != targets.end()) {
+            target->second = windows;
+        }
+        Stopwatch watch;
+        encoder.Encode(windows, START_TIME + frame * 1000, false, segment);
+        encodeMs += watch.Ms();
+    }
+
+    std::string snapshot;
+    StringSink sink(snapshot);
+    CHECK(SnapshotFileWriter::Write(trace.Windows(), START_TIME, sink));
+    std::printf("%zu frames (%.1f h at 1 Hz), %zu windows\n", frames, frames / 3600.0, windowCount);
+    std::printf("encode: %.1f ms, %.1f us/frame, %zu bytes, %.1f bytes/frame (snapshot file %zu bytes, %.0fx)\n",
+        encodeMs, encodeMs * 1000.0 / frames, segment.size(), static_cast<double>(segment.size()) / frames,
+        snapshot.size(), static_cast<double>(snapshot.size()) * frames / segment.size());
+
+    SnapshotReplay replay;
+    Stopwatch watch;
+    CHECK(replay.Attach(segment.data(), segment.size()));
+    std::printf("index: %.2f ms\n", watch.Ms());
+    CHECK(replay.FrameCount() == frames);
+    CHECK(replay.IsKeyframe(0));
+    CHECK(replay.FindFrame(0) == 0 && replay.FindFrame(UINT64_MAX) == frames - 1);
+
+    // Sequential decode, frame by frame, checked against the trace replayed
+    SyntheticTrace expected(38, windowCount);
+    double decodeMs = 0;
+    for (size_t frame = 0; frame < frames; frame++) {
+        const std::vector<WindowInfo>& windows = expected.Step();
+        watch.Restart();
+        CHECK(replay.SeekFrame(frame));
+        decodeMs += watch.Ms();
+        CHECK(SameWindows(replay.Windows(), windows));
+    }
+    std::printf("sequential decode: %.1f ms, %.1f us/frame\n", decodeMs, decodeMs * 1000.0 / frames);
+
+    // Random seeks by time, each landing between two frames
+    std::vector<size_t> order;
+    for (const auto& target : targets) {
+        order.push_back(target.first);
+    }
+    std::shuffle(order.begin(), order.end(), random.Rng());
+    double seekMs = 0;
+    double worstMs = 0;
+    for (size_t frame : order) {
+        watch.Restart();
+        CHECK(replay.SeekTime(START_TIME + frame * 1000 + 500));
+        double ms = watch.Ms();
+        seekMs += ms;
+        worstMs = std::max(worstMs, ms);
+        CHECK(replay.CurrentFrame() == frame);
+        CHECK(SameWindows(replay.Windows(), targets[frame]));
+    }
+    std::printf("random seek: %zu seeks, %.3f ms average, %.3f ms worst\n", order.size(), seekMs / order.size(),
+        worstMs);
+    return 0;
+}
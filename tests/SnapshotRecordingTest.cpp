@@ -0,0 +1,159 @@
+// SnapshotReplay on damaged segments. A segment cut at any byte replays the
+// frames written whole before the cut, exactly; a segment with bits flipped
+// may refuse frames but never reads outside its buffer (run it under ASan).
+// Also checks seeking backwards and across keyframes, recording over an
+// earlier recording that rolled off its first segments, and the decoder on
+// random payloads.
+
+#include "TestHarness.h"
+#include "SnapshotRecording.h"
+
+static std::string SegmentHeader() {
+    std::string header("WLREC\0\0\0", 8);
+    uint32_t version = SnapshotRecorder::VERSION;
+    uint32_t reserved = 0;
+    header.append(reinterpret_cast<const char*>(&version), sizeof(version));
+    header.append(reinterpret_cast<const char*>(&reserved), sizeof(reserved));
+    return header;
+}
+
+int main() {
+    // A short trace with a keyframe every 20 frames; the end of each frame is
+    // kept so cuts can be checked against what was whole before them
+    const size_t frames = 120;
+    SyntheticTrace trace(39, 40);
+    std::vector<std::vector<WindowInfo>> expected;
+    std::vector<size_t> frameEnds;
+    std::string segment = SegmentHeader();
+    SnapshotDeltaEncoder encoder;
+    encoder.SetKeyframeInterval(20);
+    for (size_t frame = 0; frame < frames; frame++) {
+        expected.push_back(trace.Step());
+        encoder.Encode(expected.back(), 1000 + frame * 10, false, segment);
+        frameEnds.push_back(segment.size());
+    }
+
+    SnapshotReplay replay;
+    CHECK(replay.Attach(segment.data(), segment.size()));
+    CHECK(replay.FrameCount() == frames);
+    CHECK(replay.IsKeyframe(0) && replay.IsKeyframe(20) && !replay.IsKeyframe(21));
+
+    // Backwards, across keyframes, and in place
+    for (size_t frame : { 119, 0, 45, 44, 20, 19, 100, 100, 61, 3 }) {
+        CHECK(replay.SeekFrame(frame));
+        CHECK(replay.CurrentFrame() == frame);
+        CHECK(SameWindows(replay.Windows(), expected[frame]));
+    }
+    CHECK(replay.FindFrame(0) == 0 && replay.FindFrame(1005) == 0 && replay.FindFrame(1010) == 1);
+    CHECK(replay.FindFrame(UINT64_MAX) == frames - 1);
+
+    // Cut at every byte: the frames that ended before the cut replay exactly,
+    // and nothing past the cut is read
+    size_t whole = 0;
+    for (size_t cut = 0; cut <= segment.size(); cut++) {
+        while (whole < frames && frameEnds[whole] <= cut) {
+            whole++;
+        }
+        std::vector<char> truncated(segment.begin(), segment.begin() + cut);
+        SnapshotReplay cutReplay;
+        bool opened = cutReplay.Attach(truncated.data(), truncated.size());
+        CHECK(opened == (whole > 0));
+        CHECK(cutReplay.FrameCount() == whole);
+        if (whole > 0) {
+            CHECK(cutReplay.SeekFrame(whole - 1));
+            CHECK(SameWindows(cutReplay.Windows(), expected[whole - 1]));
+        }
+    }
+
+    // Bit flips past the header: any seek may fail, none may crash, and a
+    // frame that decodes has a window for each row it claims
+    SyntheticWindows random(39);
+    size_t accepted = 0;
+    size_t refused = 0;
+    for (int round = 0; round < 2000; round++) {
+        std::vector<char> damaged(segment.begin(), segment.end());
+        for (int flip = 0; flip <= round % 8; flip++) {
+            size_t at = 16 + random.Next(static_cast<uint32_t>(damaged.size() - 16));
+            damaged[at] = static_cast<char>(damaged[at] ^ (1 << random.Next(8)));
+        }
+        SnapshotReplay damagedReplay;
+        if (!damagedReplay.Attach(damaged.data(), damaged.size())) {
+            refused++;
+            continue;
+        }
+        for (size_t frame = round % 7; frame < damagedReplay.FrameCount(); frame += 7) {
+            if (damagedReplay.SeekFrame(frame)) {
+                accepted++;
+                for (const WindowInfo& win : damagedReplay.Windows()) {
+                    CHECK(win.title.size() < segment.size());
+                }
+            } else {
+                refused++;
+            }
+        }
+    }
+    CHECK(accepted > 0 && refused > 0);
+
+    // Recording again under a name whose earlier recording rolled past
+    // maxSegments: none of its segments, which no longer start at 1, may be
+    // joined onto the new one once it reaches their numbers
+    {
+        const wchar_t* const path = L"SnapshotRecordingTest.wlr";
+        RecordingOptions options;
+        options.keyframeInterval = 20;
+        options.segmentBytes = 2048;
+        options.maxSegments = 4;
+        SyntheticTrace earlier(41, 40);
+        SnapshotRecorder recorder;
+        CHECK(recorder.Start(path, options));
+        for (uint64_t frame = 0; frame < 200; frame++) {
+            CHECK(recorder.Record(earlier.Step(), 5000000 + frame * 1000));
+        }
+        recorder.Stop();
+        uint32_t first = 1;
+        while (first < 1000 && !FileIO::Exists(SnapshotRecorder::SegmentPath(path, first))) {
+            first++;
+        }
+        uint32_t last = first + 3;
+        CHECK(first >= 5 && FileIO::Exists(SnapshotRecorder::SegmentPath(path, last)));
+        CHECK(!FileIO::Exists(SnapshotRecorder::SegmentPath(path, last + 1)));
+
+        SyntheticTrace later(43, 40);
+        CHECK(recorder.Start(path, options));
+        CHECK(!FileIO::Exists(SnapshotRecorder::SegmentPath(path, last)));
+        uint64_t time = 0;
+        while (!FileIO::Exists(SnapshotRecorder::SegmentPath(path, last - 4)) && time < 200000) {
+            time += 1000;
+            CHECK(recorder.Record(later.Step(), time));
+        }
+        recorder.Stop();
+
+        SnapshotReplay recording;
+        CHECK(recording.Open(SnapshotRecorder::SegmentPath(path, last - 4)));
+        for (size_t frame = 0; frame < recording.FrameCount(); frame++) {
+            CHECK(recording.FrameTime(frame) <= time);
+            CHECK(frame == 0 || recording.FrameTime(frame) >= recording.FrameTime(frame - 1));
+        }
+        CHECK(recording.FrameTime(recording.FrameCount() - 1) == time);
+        recording.Close();
+        for (uint32_t sequence = 1; sequence <= last; sequence++) {
+            FileIO::Remove(SnapshotRecorder::SegmentPath(path, sequence));
+        }
+    }
+
+    // Random payloads straight into the decoder
+    SnapshotDeltaDecoder decoder;
+    for (int round = 0; round < 20000; round++) {
+        std::vector<uint8_t> payload(random.Next(64));
+        for (uint8_t& byte : payload) {
+            byte = static_cast<uint8_t>(random.Next(256));
+        }
+        uint8_t kind = random.Next(4) == 0 ? RECFRAME_DELTA : RECFRAME_KEY;
+        if (decoder.Apply(kind, payload.data(), payload.size())) {
+            CHECK(decoder.IsValid());
+        }
+    }
+
+    std::printf("SnapshotRecordingTest passed: %zu fuzzed seeks decoded, %zu refused\n", accepted, refused);
+    return 0;
+}
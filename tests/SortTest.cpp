@@ -0,0 +1,128 @@
+// Differential test of WindowSorter against the comparator the list used
+// before sort keys: std::sort over a switch on the column, with strings
+// compared case-insensitively. WindowSorter is stable where std::sort was
+// not, so the reference is the same comparator under std::stable_sort.
+
+#include "TestHarness.h"
+#include "WindowSort.h"
+#include <algorithm>
+
+static int LegacyCompareText(const std::wstring& a, const std::wstring& b) {
+    const wchar_t* x = a.c_str();
+    const wchar_t* y = b.c_str();
+    for (;; x++, y++) {
+        wint_t cx = towlower(*x);
+        wint_t cy = towlower(*y);
+        if (cx != cy) return cx < cy ? -1 : 1;
+        if (cx == 0) return 0;
+    }
+}
+
+template <typename T>
+static int Three(T a, T b) {
+    return a < b ? -1 : a > b ? 1 : 0;
+}
+
+// The old list comparator. Size was an int product there; it is taken
+// as 64-bit here, which is what the sort key orders by.
+static int LegacyCompare(const WindowInfo& a, const WindowInfo& b, int column) {
+    switch (column) {
+    case COLUMN_HWND:
+        return Three(reinterpret_cast<uintptr_t>(a.hwnd), reinterpret_cast<uintptr_t>(b.hwnd));
+    case COLUMN_TITLE:
+        return LegacyCompareText(a.title, b.title);
+    case COLUMN_CLASS:
+        return LegacyCompareText(a.className, b.className);
+    case COLUMN_PROCESS:
+        return LegacyCompareText(a.processName, b.processName);
+    case COLUMN_PID:
+        return Three(a.processId, b.processId);
+    case COLUMN_VISIBLE:
+        return a.isVisible == b.isVisible ? 0 : a.isVisible ? -1 : 1;
+    case COLUMN_POSITION: {
+        int cmp = Three(a.rect.left, b.rect.left);
+        return cmp ? cmp : Three(a.rect.top, b.rect.top);
+    }
+    case COLUMN_SIZE: {
+        int64_t sizeA = static_cast<int64_t>(a.rect.right - a.rect.left) * (a.rect.bottom - a.rect.top);
+        int64_t sizeB = static_cast<int64_t>(b.rect.right - b.rect.left) * (b.rect.bottom - b.rect.top);
+        return Three(sizeA, sizeB);
+    }
+    }
+    return 0;
+}
+
+static std::vector<WindowInfo> LegacySort(std::vector<WindowInfo> windows, const SortSpec& spec) {
+    std::stable_sort(windows.begin(), windows.end(), [&spec](const WindowInfo& a, const WindowInfo& b) {
+        for (const SortKey& key : spec.keys) {
+            int cmp = LegacyCompare(a, b, key.column);
+            if (cmp != 0) {
+                return key.ascending ? cmp < 0 : cmp > 0;
+            }
+        }
+        return false;
+    });
+    return windows;
+}
+
+static void CheckSameOrder(const std::vector<WindowInfo>& actual, const std::vector<WindowInfo>& expected) {
+    CHECK(actual.size() == expected.size());
+    for (size_t i = 0; i < actual.size(); i++) {
+        CHECK(actual[i].hwnd == expected[i].hwnd);
+    }
+}
+
+int main() {
+    SyntheticWindows synthetic(26);
+
+    // Strings whose folded prefixes tie, so the full compare decides
+    {
+        std::vector<WindowInfo> windows = synthetic.MakeMany(8);
+        const wchar_t* const titles[] = { L"abcdeF", L"ABCDEf", L"abcdeg", L"abcd", L"ABCD", L"", L"b", L"abcde" };
+        for (size_t i = 0; i < windows.size(); i++) {
+            windows[i].title = titles[i];
+        }
+        SortSpec spec;
+        spec.keys.push_back({ COLUMN_TITLE, true });
+        std::vector<WindowInfo> sorted = windows;
+        WindowSorter::Sort(sorted, spec);
+        CheckSameOrder(sorted, LegacySort(windows, spec));
+        CHECK(sorted[0].title.empty() && sorted[1].title == L"abcd" && sorted[2].title == L"ABCD");
+        CHECK(WindowSorter::CompareFolded(L"Abc", L"aBC") == 0);
+        CHECK(WindowSorter::CompareFolded(L"abc", L"abcd") < 0);
+        CHECK(WindowSorter::CompareFolded(L"B", L"a") > 0);
+    }
+
+    // Every old column, both directions, on both sides of the radix threshold
+    for (size_t count : { 5, 63, 64, 500, 5000 }) {
+        for (int column = COLUMN_HWND; column <= COLUMN_SIZE; column++) {
+            for (bool ascending : { true, false }) {
+                std::vector<WindowInfo> windows = synthetic.MakeMany(count);
+                SortSpec spec;
+                spec.keys.push_back({ column, ascending });
+                std::vector<WindowInfo> sorted = windows;
+                WindowSorter::Sort(sorted, spec);
+                CheckSameOrder(sorted, LegacySort(windows, spec));
+            }
+        }
+    }
+
+    // Multi-key specs against the comparator chain
+    for (int round = 0; round < 300; round++) {
+        std::vector<WindowInfo> windows = synthetic.MakeMany(1 + synthetic.Next(3000));
+        SortSpec spec;
+        size_t keys = 1 + synthetic.Next(3);
+        while (spec.keys.size() < keys) {
+            int column = static_cast<int>(synthetic.Next(COLUMN_SIZE + 1));
+            if (!spec.Find(column)) {
+                spec.keys.push_back({ column, synthetic.Next(2) == 0 });
+            }
+        }
+        std::vector<WindowInfo> sorted = windows;
+        WindowSorter::Sort(sorted, spec);
+        CheckSameOrder(sorted, LegacySort(windows, spec));
+    }
+
+    std::printf("SortTest passed\n");
+    return 0;
+}
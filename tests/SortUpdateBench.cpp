@@ -0,0 +1,83 @@
+// WindowSorter::Update against a full re-sort as a share of the rows
+// changes between snapshots. Each update is checked against Sort.
+
+#include "TestHarness.h"
+#include "WindowSort.h"
+
+// The next snapshot: some windows close, some open, some are retitled or
+// move, and the rest are unchanged; z-order is the incoming order
+static std::vector<WindowInfo> Churn(SyntheticWindows& synthetic, const std::vector<WindowInfo>& current,
+    double rate, uint32_t& nextIndex) {
+    std::vector<WindowInfo> fresh;
+    fresh.reserve(current.size());
+    uint32_t threshold = static_cast<uint32_t>(rate * 1000000);
+    for (const WindowInfo& win : current) {
+        if (synthetic.Next(1000000) >= threshold) {
+            fresh.push_back(win);
+            continue;
+        }
+        switch (synthetic.Next(4)) {
+        case 0:
+            break;  // closed
+        case 1:
+            fresh.push_back(win);
+            fresh.push_back(synthetic.Make(nextIndex++));
+            break;
+        case 2:
+            fresh.push_back(win);
+            fresh.back().title = synthetic.Make(0).title;
+            break;
+        default:
+            fresh.push_back(win);
+            fresh.back().rect.left += static_cast<LONG>(synthetic.Next(200)) - 100;
+            break;
+        }
+    }
+    for (size_t i = 0; i < fresh.size(); i++) {
+        fresh[i].zOrder = static_cast<int>(i);
+    }
+    return fresh;
+}
+
+int main(int argc, char** argv) {
+    size_t count = BenchSize(argc, argv, 100000);
+    SyntheticWindows synthetic(27);
+    std::printf("%zu windows\n", count);
+    std::printf("%-24s %8s %12s %12s %9s\n", "spec", "churn", "re-sort ms", "update ms", "speedup");
+
+    for (const wchar_t* text : { L"title", L"process,-size", L"position" }) {
+        SortSpec spec;
+        CHECK(SortSpec::Parse(text, spec));
+        for (double rate : { 0.0, 0.001, 0.01, 0.1, 0.5 }) {
+            uint32_t nextIndex = static_cast<uint32_t>(count);
+            std::vector<WindowInfo> snapshot = synthetic.MakeMany(count);
+            std::vector<WindowInfo> sorted = snapshot;
+            WindowSorter::Sort(sorted, spec);
+
+            const int rounds = 3;
+            double sortMs = 0;
+            double updateMs = 0;
+            for (int round = 0; round < rounds; round++) {
+                snapshot = Churn(synthetic, snapshot, rate, nextIndex);
+
+                std::vector<WindowInfo> expected = snapshot;
+                Stopwatch watch;
+                WindowSorter::Sort(expected, spec);
+                sortMs += watch.Ms();
+
+                std::vector<WindowInfo> fresh = snapshot;
+                watch.Restart();
+                WindowSorter::Update(sorted, std::move(fresh), spec);
+                updateMs += watch.Ms();
+
+                CHECK(sorted.size() == expected.size());
+                for (size_t i = 0; i < sorted.size(); i++) {
+                    CHECK(sorted[i].hwnd == expected[i].hwnd);
+                }
+            }
+            std::printf("%-24ls %7.1f%% %12.1f %12.1f %8.1fx\n", text, rate * 100, sortMs / rounds,
+                updateMs / rounds, updateMs > 0 ? sortMs / updateMs : 0.0);
+        }
+    }
+    return 0;
+}
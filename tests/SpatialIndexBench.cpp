@@ -0,0 +1,84 @@
+// SpatialIndex over a large pile of windows spread across a wide virtual
+// desktop: build time, and point, region and nearest query times next to a
+// scan of every window. A sample of queries is checked against the scan.
+
+#include "TestHarness.h"
+#include "WindowSpatial.h"
+#include <algorithm>
+
+static std::vector<size_t> ScanPoint(const std::vector<WindowInfo>& windows, POINT pt) {
+    std::vector<size_t> hits;
+    for (size_t i = 0; i < windows.size(); i++) {
+        RECT frame = SpatialIndex::Frame(windows[i]);
+        if (pt.x >= frame.left && pt.x < frame.right && pt.y >= frame.top && pt.y < frame.bottom) {
+            hits.push_back(i);
+        }
+    }
+    return hits;
+}
+
+int main(int argc, char** argv) {
+    size_t count = BenchSize(argc, argv, 100000);
+    const LONG width = 60000;
+    const LONG height = 33750;
+    std::vector<WindowInfo> windows = StackedFrames(46, count, width, height);
+
+    SpatialIndex index;
+    Stopwatch watch;
+    index.Build(windows);
+    double buildMs = watch.Ms();
+    CHECK(index.Size() > count * 9 / 10);
+
+    std::mt19937 rng(47);
+    std::vector<POINT> points(20000);
+    for (POINT& pt : points) {
+        pt = { static_cast<LONG>(rng() % width) - width / 8, static_cast<LONG>(rng() % height) - height / 8 };
+    }
+
+    std::vector<size_t> hits;
+    size_t pointHits = 0;
+    watch.Restart();
+    for (const POINT& pt : points) {
+        index.QueryPoint(pt, hits);
+        pointHits += hits.size();
+    }
+    double pointUs = watch.Ms() * 1000.0 / points.size();
+
+    size_t regionHits = 0;
+    watch.Restart();
+    for (const POINT& pt : points) {
+        index.QueryRegion({ pt.x, pt.y, pt.x + 500, pt.y + 400 }, hits);
+        regionHits += hits.size();
+    }
+    double regionUs = watch.Ms() * 1000.0 / points.size();
+
+    watch.Restart();
+    for (const POINT& pt : points) {
+        index.Nearest(pt, 10, hits);
+        CHECK(hits.size() == 10);
+    }
+    double nearestUs = watch.Ms() * 1000.0 / points.size();
+
+    // The scan, timed and compared on a sample
+    const size_t sample = 200;
+    watch.Restart();
+    for (size_t i = 0; i < sample; i++) {
+        hits = ScanPoint(windows, points[i]);
+    }
+    double scanUs = watch.Ms() * 1000.0 / sample;
+    for (size_t i = 0; i < sample; i++) {
+        std::vector<size_t> scanned = ScanPoint(windows, points[i]);
+        index.QueryPoint(points[i], hits);
+        std::sort(hits.begin(), hits.end());
+        CHECK(hits == scanned);
+    }
+
+    std::printf("%zu windows on %ldx%ld, index built in %.1f ms\n", count, static_cast<long>(width),
+        static_cast<long>(height), buildMs);
+    std::printf("%-16s %10s %10s\n", "query", "us", "hits");
+    std::printf("%-16s %10.2f %10.1f\n", "point", pointUs, static_cast<double>(pointHits) / points.size());
+    std::printf("%-16s %10.2f %10.1f\n", "region 500x400", regionUs, static_cast<double>(regionHits) / points.size());
+    std::printf("%-16s %10.2f %10d\n", "nearest 10", nearestUs, 10);
+    std::printf("%-16s %10.2f %10s\n", "point, scan", scanUs, "");
+    return 0;
+}
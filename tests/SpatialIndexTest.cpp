@@ -0,0 +1,154 @@
+// SpatialIndex against a brute-force scan of every window: point, region and
+// nearest queries over random piles of windows of many sizes, in both
+// scopes, with the windows in shuffled order so list position and z-order
+// differ. Also the edges: empty indexes and regions, frames touching a query
+// only at their excluded right and bottom edges, and identical stacked
+// frames.
+
+#include "TestHarness.h"
+#include "WindowSpatial.h"
+#include <algorithm>
+
+static bool InScope(const WindowInfo& win, SpatialScope scope) {
+    RECT frame = SpatialIndex::Frame(win);
+    if (frame.right <= frame.left || frame.bottom <= frame.top) {
+        return false;
+    }
+    return scope == SPATIAL_ALL || (win.isVisible && !win.isCloaked && !win.isMinimized);
+}
+
+static bool Contains(const RECT& rc, POINT pt) {
+    return pt.x >= rc.left && pt.x < rc.right && pt.y >= rc.top && pt.y < rc.bottom;
+}
+
+static bool Overlaps(const RECT& a, const RECT& b) {
+    return a.left < b.right && b.left < a.right && a.top < b.bottom && b.top < a.bottom;
+}
+
+static int64_t Distance(const RECT& rc, POINT pt) {
+    int64_t dx = std::max<int64_t>({ 0, static_cast<int64_t>(rc.left) - pt.x, static_cast<int64_t>(pt.x) - (rc.right - 1) });
+    int64_t dy = std::max<int64_t>({ 0, static_cast<int64_t>(rc.top) - pt.y, static_cast<int64_t>(pt.y) - (rc.bottom - 1) });
+    return dx * dx + dy * dy;
+}
+
+// Every window a query takes, top window first, by a scan of them all
+static std::vector<size_t> ScanPoint(const std::vector<WindowInfo>& windows, SpatialScope scope, POINT pt) {
+    std::vector<size_t> hits;
+    for (size_t i = 0; i < windows.size(); i++) {
+        if (InScope(windows[i], scope) && Contains(SpatialIndex::Frame(windows[i]), pt)) hits.push_back(i);
+    }
+    std::sort(hits.begin(), hits.end(), [&](size_t a, size_t b) { return windows[a].zOrder < windows[b].zOrder; });
+    return hits;
+}
+
+static std::vector<size_t> ScanRegion(const std::vector<WindowInfo>& windows, SpatialScope scope, const RECT& region) {
+    std::vector<size_t> hits;
+    for (size_t i = 0; i < windows.size(); i++) {
+        if (InScope(windows[i], scope) && Overlaps(SpatialIndex::Frame(windows[i]), region)) hits.push_back(i);
+    }
+    std::sort(hits.begin(), hits.end(), [&](size_t a, size_t b) { return windows[a].zOrder < windows[b].zOrder; });
+    return hits;
+}
+
+static std::vector<size_t> ScanNearest(const std::vector<WindowInfo>& windows, SpatialScope scope, POINT pt,
+    size_t count) {
+    std::vector<size_t> hits;
+    for (size_t i = 0; i < windows.size(); i++) {
+        if (InScope(windows[i], scope)) hits.push_back(i);
+    }
+    std::sort(hits.begin(), hits.end(), [&](size_t a, size_t b) {
+        int64_t da = Distance(SpatialIndex::Frame(windows[a]), pt);
+        int64_t db = Distance(SpatialIndex::Frame(windows[b]), pt);
+        return da != db ? da < db : windows[a].zOrder < windows[b].zOrder;
+    });
+    hits.resize(std::min(count, hits.size()));
+    return hits;
+}
+
+static WindowInfo MakeWindow(int z, const RECT& rect) {
+    WindowInfo win = {};
+    win.hwnd = MakeHandle(0x1000 + z * 4);
+    win.zOrder = z;
+    win.isVisible = true;
+    win.rect = rect;
+    return win;
+}
+
+int main() {
+    // Empty
+    {
+        SpatialIndex index;
+        std::vector<size_t> hits = { 1 };
+        index.Build({});
+        CHECK(index.Size() == 0);
+        index.QueryPoint({ 0, 0 }, hits);
+        CHECK(hits.empty());
+        index.QueryRegion({ -100, -100, 100, 100 }, hits);
+        CHECK(hits.empty());
+        index.Nearest({ 0, 0 }, 3, hits);
+        CHECK(hits.empty());
+    }
+
+    // Edges are half-open; identical frames come out in z-order
+    {
+        std::vector<WindowInfo> windows;
+        for (int z = 9; z >= 0; z--) {
+            windows.push_back(MakeWindow(z, { 100, 100, 200, 200 }));
+        }
+        windows.push_back(MakeWindow(10, { 200, 100, 300, 200 }));
+        SpatialIndex index;
+        index.Build(windows);
+        std::vector<size_t> hits;
+        index.QueryPoint({ 199, 199 }, hits);
+        CHECK(hits.size() == 10 && hits.front() == 9 && hits.back() == 0);
+        index.QueryPoint({ 200, 150 }, hits);
+        CHECK(hits.size() == 1 && hits[0] == 10);
+        index.QueryRegion({ 0, 0, 100, 100 }, hits);
+        CHECK(hits.empty());
+        index.QueryRegion({ 199, 199, 201, 201 }, hits);
+        CHECK(hits.size() == 11);
+        index.QueryRegion({ 150, 150, 150, 160 }, hits);
+        CHECK(hits.empty());
+        index.Nearest({ 250, 50 }, 3, hits);
+        CHECK(hits.size() == 3 && hits[0] == 10 && hits[1] == 9 && hits[2] == 8);
+        index.Nearest({ 0, 0 }, 100, hits);
+        CHECK(hits.size() == 11);
+    }
+
+    // Random piles against the scan, sizes either side of the node capacity
+    std::mt19937 rng(46);
+    size_t queries = 0;
+    for (size_t count : { 1, 5, 16, 17, 300, 5000 }) {
+        for (SpatialScope scope : { SPATIAL_ALL, SPATIAL_SHOWN }) {
+            std::vector<WindowInfo> windows = StackedFrames(static_cast<uint32_t>(count), count, 4000, 2250);
+            std::shuffle(windows.begin(), windows.end(), rng);
+            SpatialIndex index;
+            index.Build(windows, scope);
+            size_t inScope = 0;
+            for (const WindowInfo& win : windows) {
+                inScope += InScope(win, scope) ? 1 : 0;
+            }
+            CHECK(index.Size() == inScope);
+
+            std::vector<size_t> hits;
+            for (int q = 0; q < 400; q++) {
+                POINT pt = { static_cast<LONG>(rng() % 5000) - 500, static_cast<LONG>(rng() % 3000) - 400 };
+                index.QueryPoint(pt, hits);
+                CHECK(hits == ScanPoint(windows, scope, pt));
+
+                RECT region = { pt.x, pt.y, pt.x + 1 + static_cast<LONG>(rng() % 600),
+                    pt.y + 1 + static_cast<LONG>(rng() % 400) };
+                index.QueryRegion(region, hits);
+                CHECK(hits == ScanRegion(windows, scope, region));
+
+                size_t nearest = 1 + rng() % 12;
+                index.Nearest(pt, nearest, hits);
+                CHECK(hits == ScanNearest(windows, scope, pt, nearest));
+                queries += 3;
+            }
+        }
+    }
+
+    std::printf("SpatialIndexTest passed: %zu queries match a scan\n", queries);
+    return 0;
+}
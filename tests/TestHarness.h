@@ -0,0 +1,250 @@
+#pragma once
+
+// Checks, timing and synthetic windows shared by the tests and benchmarks.
+// A failed check prints where it failed and exits, so ctest reports the
+// test as failed without a test framework.
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+#include "WindowInfo.h"
+
+#define CHECK(condition)                                                            \
+    do {                                                                            \
+        if (!(condition)) {                                                         \
+            std::printf("%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #condition); \
+            std::fflush(stdout);                                                    \
+            std::exit(1);                                                           \
+        }                                                                           \
+    } while (0)
+
+class Stopwatch {
+public:
+    Stopwatch() : m_start(std::chrono::steady_clock::now()) {}
+
+    void Restart() { m_start = std::chrono::steady_clock::now(); }
+
+    double Ms() const {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - m_start).count();
+    }
+
+private:
+    std::chrono::steady_clock::time_point m_start;
+};
+
+// Benchmarks take their size from the first argument; ctest passes a small
+// one so they keep building and running
+inline size_t BenchSize(int argc, char** argv, size_t defaultSize) {
+    return argc > 1 ? static_cast<size_t>(std::strtoull(argv[1], nullptr, 10)) : defaultSize;
+}
+
+inline HWND MakeHandle(uint32_t value) {
+    return reinterpret_cast<HWND>(static_cast<uintptr_t>(value));
+}
+
+inline bool SameRect(const RECT& a, const RECT& b) {
+    return a.left == b.left && a.top == b.top && a.right == b.right && a.bottom == b.bottom;
+}
+
+// Every field a snapshot file or recording stores
+inline bool SameWindow(const WindowInfo& a, const WindowInfo& b) {
+    return a.hwnd == b.hwnd && a.hwndParent == b.hwndParent && a.hwndOwner == b.hwndOwner &&
+        a.title == b.title && a.className == b.className &&
+        a.processName == b.processName && a.processPath == b.processPath &&
+        a.processId == b.processId && a.threadId == b.threadId &&
+        SameRect(a.rect, b.rect) && SameRect(a.clientRect, b.clientRect) &&
+        a.style == b.style && a.exStyle == b.exStyle &&
+        a.isVisible == b.isVisible && a.isEnabled == b.isEnabled &&
+        a.isMinimized == b.isMinimized && a.isMaximized == b.isMaximized &&
+        a.isTopMost == b.isTopMost && a.isLayered == b.isLayered && a.isTransparent == b.isTransparent &&
+        a.isCloaked == b.isCloaked && a.isUWP == b.isUWP && a.isHung == b.isHung &&
+        a.alpha == b.alpha && a.zOrder == b.zOrder && a.hasDwmFrame == b.hasDwmFrame &&
+        (!a.hasDwmFrame || SameRect(a.dwmExtendedFrame, b.dwmExtendedFrame));
+}
+
+inline bool SameWindows(const std::vector<WindowInfo>& a, const std::vector<WindowInfo>& b) {
+    if (a.size() != b.size()) return false;
+    for (size_t i = 0; i < a.size(); i++) {
+        if (!SameWindow(a[i], b[i])) return false;
+    }
+    return true;
+}
+
+// Plausible windows: titles and classes from small pools so sorts tie and
+// share prefixes, a few processes with several threads each, rectangles
+// spread over a 4K desktop with some off it
+class SyntheticWindows {
+public:
+    explicit SyntheticWindows(uint32_t seed, uint32_t processes = 64)
+        : m_rng(seed), m_processes(processes) {}
+
+    std::mt19937& Rng() { return m_rng; }
+
+    uint32_t Next(uint32_t range) { return static_cast<uint32_t>(m_rng() % range); }
+
+    WindowInfo Make(uint32_t index) {
+        static const wchar_t* const TITLES[] = {
+            L"", L"Untitled - Notepad", L"untitled - notepad", L"Inbox", L"inbox (3)", L"Settings",
+            L"Program Manager", L"Task Switching", L"Document1 - Word", L"Document10 - Word",
+            L"Été", L"été", L"zz", L"ZZ top", L"a", L"A"
+        };
+        static const wchar_t* const CLASSES[] = {
+            L"Notepad", L"Chrome_WidgetWin_1", L"CabinetWClass", L"Shell_TrayWnd", L"#32770",
+            L"ApplicationFrameWindow", L"Button", L"tooltips_class32", L"OpusApp", L"WorkerW"
+        };
+        static const wchar_t* const PROCESSES[] = {
+            L"notepad.exe", L"chrome.exe", L"explorer.exe", L"WINWORD.EXE", L"Code.exe", L"svchost.exe"
+        };
+
+        WindowInfo win = {};
+        win.hwnd = MakeHandle(0x10000 + index * 4);
+        win.title = TITLES[Next(sizeof(TITLES) / sizeof(TITLES[0]))];
+        if (Next(4) == 0) {
+            win.title += std::to_wstring(Next(1000));
+        }
+        win.className = CLASSES[Next(sizeof(CLASSES) / sizeof(CLASSES[0]))];
+        win.processId = 1000 + Next(m_processes) * 4;
+        win.threadId = win.processId * 16 + Next(3);
+        win.processName = PROCESSES[win.processId % (sizeof(PROCESSES) / sizeof(PROCESSES[0]))];
+        LONG left = static_cast<LONG>(Next(4200)) - 300;
+        LONG top = static_cast<LONG>(Next(2500)) - 200;
+        win.rect = { left, top, left + static_cast<LONG>(Next(1600)), top + static_cast<LONG>(Next(1000)) };
+        win.clientRect = { 0, 0, win.rect.right - win.rect.left, win.rect.bottom - win.rect.top };
+        win.isVisible = Next(3) != 0;
+        win.isEnabled = true;
+        win.isMinimized = Next(20) == 0;
+        win.isTopMost = Next(30) == 0;
+        win.style = WS_CAPTION | WS_SYSMENU | (win.isVisible ? WS_VISIBLE : 0);
+        win.exStyle = Next(10) == 0 ? WS_EX_TOOLWINDOW : 0;
+        win.alpha = 255;
+        win.zOrder = static_cast<int>(index);
+        return win;
+    }
+
+    std::vector<WindowInfo> MakeMany(size_t count) {
+        std::vector<WindowInfo> windows;
+        windows.reserve(count);
+        for (size_t i = 0; i < count; i++) {
+            windows.push_back(Make(static_cast<uint32_t>(i)));
+        }
+        return windows;
+    }
+
+private:
+    std::mt19937 m_rng;
+    uint32_t m_processes;
+};
+
+// A desktop changing over time, one Step() per refresh: a few clock titles
+// tick every step, and now and then a window moves, opens, closes, comes to
+// the front, is shown or hidden, or is retitled. Rows stay in z-order, and
+// the same seed gives the same trace.
+class SyntheticTrace {
+public:
+    SyntheticTrace(uint32_t seed, size_t windows) : m_synthetic(seed) {
+        for (size_t i = 0; i < windows; i++) {
+            m_windows.push_back(NewWindow());
+        }
+        Renumber();
+    }
+
+    const std::vector<WindowInfo>& Windows() const { return m_windows; }
+
+    const std::vector<WindowInfo>& Step() {
+        m_step++;
+        for (size_t i = 0; i < 3 && i < m_windows.size(); i++) {
+            m_windows[i].title = L"Clock " + std::to_wstring(m_step + i);
+        }
+
+        uint32_t event = m_synthetic.Next(100);
+        if (event < 10) {
+            WindowInfo& win = m_windows[m_synthetic.Next(Size())];
+            LONG dx = static_cast<LONG>(m_synthetic.Next(21)) - 10;
+            win.rect.left += dx;
+            win.rect.right += dx;
+        } else if (event < 13) {
+            m_windows.insert(m_windows.begin() + m_synthetic.Next(Size()), NewWindow());
+        } else if (event < 16 && m_windows.size() > 10) {
+            m_windows.erase(m_windows.begin() + m_synthetic.Next(Size()));
+        } else if (event < 20) {
+            size_t from = m_synthetic.Next(Size());
+            WindowInfo win = m_windows[from];
+            m_windows.erase(m_windows.begin() + from);
+            m_windows.insert(m_windows.begin(), win);
+        } else if (event < 22) {
+            WindowInfo& win = m_windows[m_synthetic.Next(Size())];
+            win.isVisible = !win.isVisible;
+            win.style ^= WS_VISIBLE;
+        } else if (event < 24) {
+            m_windows[m_synthetic.Next(Size())].title = L"Doc " + std::to_wstring(m_synthetic.Next(1000)) + L" - Editor";
+        }
+        Renumber();
+        return m_windows;
+    }
+
+private:
+    uint32_t Size() const { return static_cast<uint32_t>(m_windows.size()); }
+
+    WindowInfo NewWindow() {
+        WindowInfo win = m_synthetic.Make(m_created++);
+        win.processPath = L"C:\\Program Files\\" + win.processName;
+        return win;
+    }
+
+    void Renumber() {
+        for (size_t i = 0; i < m_windows.size(); i++) {
+            m_windows[i].zOrder = static_cast<int>(i);
+        }
+    }
+
+    SyntheticWindows m_synthetic;
+    std::vector<WindowInfo> m_windows;
+    uint32_t m_created = 0;
+    size_t m_step = 0;
+};
+
+// Window frames piled up as on a busy desktop of the given size: a few
+// maximized, about half mid-sized, the rest small, half with a DWM frame
+// inside the rectangle, one in fifty empty, some hidden, cloaked or
+// minimized. Z-order follows the index.
+inline std::vector<WindowInfo> StackedFrames(uint32_t seed, size_t count, LONG width, LONG height) {
+    std::mt19937 rng(seed);
+    std::vector<WindowInfo> windows(count);
+    for (size_t i = 0; i < count; i++) {
+        WindowInfo& win = windows[i];
+        win.hwnd = MakeHandle(static_cast<uint32_t>(0x10000 + i * 4));
+        win.zOrder = static_cast<int>(i);
+        win.isVisible = rng() % 10 != 0;
+        win.isMinimized = rng() % 20 == 0;
+        win.isCloaked = rng() % 30 == 0;
+        win.alpha = 255;
+
+        uint32_t kind = rng() % 100;
+        LONG w, h;
+        if (kind < 5) {
+            w = 1920;
+            h = 1040;
+        } else if (kind < 60) {
+            w = 200 + static_cast<LONG>(rng() % 1000);
+            h = 150 + static_cast<LONG>(rng() % 800);
+        } else {
+            w = 10 + static_cast<LONG>(rng() % 120);
+            h = 10 + static_cast<LONG>(rng() % 80);
+        }
+        LONG x = static_cast<LONG>(rng() % width) - w / 2;
+        LONG y = static_cast<LONG>(rng() % height) - h / 2;
+        win.rect = { x, y, x + w, y + h };
+        if (rng() % 2) {
+            win.hasDwmFrame = true;
+            win.dwmExtendedFrame = { x + 7, y, x + w - 7, y + h - 7 };
+        }
+        if (rng() % 50 == 0) {
+            win.rect.right = win.rect.left;
+            win.dwmExtendedFrame.right = win.dwmExtendedFrame.left;
+        }
+    }
+    return windows;
+}
@@ -0,0 +1,142 @@
+// TextFormat against swprintf per call, and how often CachedText is hit when
+// the detail view's numeric fields are re-read every refresh while the
+// window sometimes moves. The formatted text is checked against swprintf.
+
+#include "TestHarness.h"
+#include "TextFormat.h"
+#include <cwchar>
+
+static std::wstring RectText(const RECT& rc) {
+    std::wstring text = L"Left: ";
+    TextFormat::AppendSigned(text, rc.left);
+    text += L", Top: ";
+    TextFormat::AppendSigned(text, rc.top);
+    text += L", Right: ";
+    TextFormat::AppendSigned(text, rc.right);
+    text += L", Bottom: ";
+    TextFormat::AppendSigned(text, rc.bottom);
+    return text;
+}
+
+// The detail view's rectangle cell
+static const std::wstring& CachedRect(CachedText& cache, const RECT& rc) {
+    return cache.Get(TextFormat::PackPair(rc.left, rc.top), TextFormat::PackPair(rc.right, rc.bottom),
+        [&rc](std::wstring& text) { text = RectText(rc); });
+}
+
+int main(int argc, char** argv) {
+    size_t count = BenchSize(argc, argv, 1000000);
+    std::mt19937_64 rng(31);
+
+    // Values of every length, both signs and the extremes
+    std::vector<uint64_t> values(count);
+    for (size_t i = 0; i < count; i++) {
+        values[i] = rng() >> (rng() % 64);
+    }
+    values[0] = 0;
+    values[1 % count] = UINT64_MAX;
+    values[2 % count] = static_cast<uint64_t>(INT64_MIN);
+
+    wchar_t ours[TextFormat::MAX_CHARS];
+    wchar_t theirs[64];
+    for (uint64_t value : values) {
+        CHECK(TextFormat::Unsigned(ours, value) == static_cast<size_t>(
+            std::swprintf(theirs, 64, L"%llu", static_cast<unsigned long long>(value))));
+        CHECK(std::wcscmp(ours, theirs) == 0);
+        TextFormat::Signed(ours, static_cast<int64_t>(value));
+        std::swprintf(theirs, 64, L"%lld", static_cast<long long>(value));
+        CHECK(std::wcscmp(ours, theirs) == 0);
+        TextFormat::Hex(ours, value, 8);
+        std::swprintf(theirs, 64, L"%08llX", static_cast<unsigned long long>(value));
+        CHECK(std::wcscmp(ours, theirs) == 0);
+    }
+
+    // Rectangles whose mixed 64-bit source used to collide get their own text
+    {
+        const uint64_t mix = 0x9E3779B97F4A7C15ULL;
+        RECT first = { 10, 20, 810, 620 };
+        RECT second = { 0, 0, -5, 7 };
+        uint64_t mixed = TextFormat::PackPair(first.left, first.top) ^ (TextFormat::PackPair(first.right, first.bottom) * mix);
+        uint64_t topLeft = mixed ^ (TextFormat::PackPair(second.right, second.bottom) * mix);
+        second.left = static_cast<int32_t>(topLeft >> 32);
+        second.top = static_cast<int32_t>(topLeft & 0xFFFFFFFF);
+        CHECK((TextFormat::PackPair(second.left, second.top) ^
+            (TextFormat::PackPair(second.right, second.bottom) * mix)) == mixed);
+
+        CachedText cache;
+        CHECK(CachedRect(cache, first) == RectText(first));
+        CHECK(CachedRect(cache, second) == RectText(second));
+        CHECK(CachedRect(cache, second) == RectText(second));
+        CHECK(cache.FormatCount() == 2);
+    }
+
+    std::printf("%zu values\n", count);
+    std::printf("%-10s %14s %14s %9s\n", "format", "swprintf ns", "TextFormat ns", "speedup");
+    const wchar_t* const names[] = { L"unsigned", L"signed", L"hex" };
+    const wchar_t* const patterns[] = { L"%llu", L"%lld", L"%08llX" };
+    for (int kind = 0; kind < 3; kind++) {
+        size_t checksum = 0;
+        Stopwatch watch;
+        for (uint64_t value : values) {
+            checksum += std::swprintf(theirs, 64, patterns[kind], static_cast<unsigned long long>(value));
+        }
+        double printfMs = watch.Ms();
+        watch.Restart();
+        for (uint64_t value : values) {
+            switch (kind) {
+            case 0: checksum += TextFormat::Unsigned(ours, value); break;
+            case 1: checksum += TextFormat::Signed(ours, static_cast<int64_t>(value)); break;
+            default: checksum += TextFormat::Hex(ours, value, 8); break;
+            }
+        }
+        double oursMs = watch.Ms();
+        CHECK(checksum > 0);
+        std::printf("%-10ls %14.1f %14.1f %8.1fx\n", names[kind], printfMs * 1e6 / count, oursMs * 1e6 / count,
+            oursMs > 0 ? printfMs / oursMs : 0.0);
+    }
+
+    // A detail view refreshed once per tick: the rectangle, size and client
+    // cells are looked up every time and re-formatted when the window moved
+    // or was resized
+    std::printf("%-12s %10s %10s %9s %12s\n", "moves/tick", "lookups", "formats", "hit rate", "ns/lookup");
+    for (double moveRate : { 0.0, 0.01, 0.1, 0.5, 1.0 }) {
+        CachedText rectCell;
+        CachedText sizeCell;
+        CachedText clientCell;
+        RECT rc = { 100, 100, 900, 700 };
+        size_t ticks = count;
+        size_t lookups = 0;
+        size_t checksum = 0;
+        std::uniform_real_distribution<double> chance(0.0, 1.0);
+        Stopwatch watch;
+        for (size_t tick = 0; tick < ticks; tick++) {
+            if (chance(rng) < moveRate) {
+                LONG dx = static_cast<LONG>(rng() % 21) - 10;
+                rc.left += dx;
+                rc.right += dx + static_cast<LONG>(rng() % 2);
+            }
+            int32_t width = rc.right - rc.left;
+            int32_t height = rc.bottom - rc.top;
+            checksum += CachedRect(rectCell, rc).size();
+            checksum += sizeCell.Get(TextFormat::PackPair(width, height), [&](std::wstring& text) {
+                TextFormat::AppendSigned(text, width);
+                text += L" x ";
+                TextFormat::AppendSigned(text, height);
+            }).size();
+            checksum += clientCell.Get(TextFormat::PackPair(width - 16, height - 39), [&](std::wstring& text) {
+                text += L"Width: ";
+                TextFormat::AppendSigned(text, width - 16);
+                text += L", Height: ";
+                TextFormat::AppendSigned(text, height - 39);
+            }).size();
+            lookups += 3;
+        }
+        double ms = watch.Ms();
+        CHECK(CachedRect(rectCell, rc) == RectText(rc));
+        uint64_t formats = rectCell.FormatCount() + sizeCell.FormatCount() + clientCell.FormatCount();
+        std::printf("%-12.2f %10zu %10llu %8.1f%% %12.1f\n", moveRate, lookups, static_cast<unsigned long long>(formats),
+            100.0 * (lookups - formats) / lookups, ms * 1e6 / lookups);
+        CHECK(checksum > 0);
+    }
+    return 0;
+}
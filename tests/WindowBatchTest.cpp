@@ -0,0 +1,375 @@
+// PlacementPlanner and PlacementTransaction against a recording fake backend
+// that also keeps a model desktop: positions and stacking as SetWindowPos and
+// deferred batches would leave them. Checks tile and cascade geometry, the
+// stacking after z-order operations, grouping into batches, and the retry
+// of each entry alone when a batch fails.
+
+#include "TestHarness.h"
+#include "WindowBatch.h"
+#include <algorithm>
+#include <set>
+
+enum CallKind {
+    CALL_BEGIN,
+    CALL_DEFER,
+    CALL_END,
+    CALL_SET,
+    CALL_RESTORE
+};
+
+struct Call {
+    CallKind kind;
+    HWND hwnd;
+};
+
+class RecordingBackend : public PlacementBackend {
+public:
+    explicit RecordingBackend(const std::vector<WindowInfo>& windows) {
+        for (const WindowInfo& win : windows) {
+            m_stack.push_back(win.hwnd);
+            m_rects[win.hwnd] = win.rect;
+        }
+    }
+
+    // Windows that have gone away: refused by Defer and SetPosition
+    std::set<HWND> closed;
+    bool failBegin = false;
+    bool failEnd = false;
+    std::vector<Call> calls;
+
+    void* BeginBatch(int count) override {
+        calls.push_back({ CALL_BEGIN, nullptr });
+        if (failBegin || count <= 0) return nullptr;
+        m_deferred.clear();
+        return &m_deferred;
+    }
+
+    void* Defer(void* batch, const PlacementEntry& entry) override {
+        calls.push_back({ CALL_DEFER, entry.hwnd });
+        if (batch != &m_deferred || closed.count(entry.hwnd)) {
+            m_deferred.clear();
+            return nullptr;
+        }
+        m_deferred.push_back(entry);
+        return batch;
+    }
+
+    bool EndBatch(void* batch) override {
+        calls.push_back({ CALL_END, nullptr });
+        if (batch != &m_deferred || failEnd) return false;
+        for (const PlacementEntry& entry : m_deferred) {
+            Place(entry);
+        }
+        m_deferred.clear();
+        return true;
+    }
+
+    bool SetPosition(const PlacementEntry& entry) override {
+        calls.push_back({ CALL_SET, entry.hwnd });
+        if (closed.count(entry.hwnd)) return false;
+        Place(entry);
+        return true;
+    }
+
+    void Restore(const PlacementEntry& entry) override {
+        calls.push_back({ CALL_RESTORE, entry.hwnd });
+    }
+
+    // Top window first
+    const std::vector<HWND>& Stack() const { return m_stack; }
+    const RECT& Rect(HWND hwnd) { return m_rects[hwnd]; }
+    bool IsTopmost(HWND hwnd) const { return m_topmost.count(hwnd) != 0; }
+
+    size_t Count(CallKind kind) const {
+        return static_cast<size_t>(std::count_if(calls.begin(), calls.end(),
+            [kind](const Call& call) { return call.kind == kind; }));
+    }
+
+private:
+    void Place(const PlacementEntry& entry) {
+        RECT& rect = m_rects[entry.hwnd];
+        if (!(entry.flags & SWP_NOMOVE)) {
+            rect = { entry.x, entry.y, entry.x + (rect.right - rect.left), entry.y + (rect.bottom - rect.top) };
+        }
+        if (!(entry.flags & SWP_NOSIZE)) {
+            rect.right = rect.left + entry.cx;
+            rect.bottom = rect.top + entry.cy;
+        }
+        if (!(entry.flags & SWP_NOZORDER)) {
+            Restack(entry.hwnd, entry.insertAfter);
+        }
+    }
+
+    // Topmost windows stay above the rest, as the window manager keeps them
+    void Restack(HWND hwnd, HWND insertAfter) {
+        m_stack.erase(std::find(m_stack.begin(), m_stack.end(), hwnd));
+        size_t topmostEnd = 0;
+        while (topmostEnd < m_stack.size() && IsTopmost(m_stack[topmostEnd])) {
+            topmostEnd++;
+        }
+
+        size_t at;
+        if (insertAfter == HWND_TOPMOST) {
+            m_topmost.insert(hwnd);
+            at = 0;
+        } else if (insertAfter == HWND_NOTOPMOST) {
+            m_topmost.erase(hwnd);
+            at = topmostEnd;
+        } else if (insertAfter == HWND_TOP) {
+            at = IsTopmost(hwnd) ? 0 : topmostEnd;
+        } else if (insertAfter == HWND_BOTTOM) {
+            m_topmost.erase(hwnd);
+            at = m_stack.size();
+        } else {
+            at = std::find(m_stack.begin(), m_stack.end(), insertAfter) - m_stack.begin() + 1;
+        }
+        m_stack.insert(m_stack.begin() + at, hwnd);
+    }
+
+    std::vector<HWND> m_stack;
+    std::unordered_map<HWND, RECT> m_rects;
+    std::set<HWND> m_topmost;
+    std::vector<PlacementEntry> m_deferred;
+};
+
+static std::vector<WindowInfo> MakeWindows(size_t count) {
+    SyntheticWindows synthetic(43);
+    std::vector<WindowInfo> windows = synthetic.MakeMany(count);
+    for (WindowInfo& win : windows) {
+        win.isMinimized = false;
+        win.isMaximized = false;
+        win.isHung = false;
+        win.hasDwmFrame = false;
+        win.style &= ~WS_CHILD;
+    }
+    return windows;
+}
+
+static std::vector<HWND> Handles(const std::vector<WindowInfo>& windows, std::initializer_list<size_t> rows) {
+    std::vector<HWND> handles;
+    for (size_t row : rows) {
+        handles.push_back(windows[row].hwnd);
+    }
+    return handles;
+}
+
+static std::vector<WindowInfo> Pick(const std::vector<WindowInfo>& windows, std::initializer_list<size_t> rows) {
+    std::vector<WindowInfo> picked;
+    for (size_t row : rows) {
+        picked.push_back(windows[row]);
+    }
+    return picked;
+}
+
+int main() {
+    // Tile: seven windows make three rows of three, three and one, the last
+    // spread over the full width, filled in z-order. A DWM frame's invisible
+    // borders are added so the visible frame fills the cell.
+    {
+        std::vector<WindowInfo> windows = MakeWindows(7);
+        windows[3].hasDwmFrame = true;
+        windows[3].dwmExtendedFrame = { windows[3].rect.left + 7, windows[3].rect.top,
+            windows[3].rect.right - 7, windows[3].rect.bottom - 7 };
+        // Selection order does not matter, z-order does
+        std::vector<WindowInfo> selection(windows.rbegin(), windows.rend());
+        RECT area = { 0, 0, 1200, 900 };
+        PlacementPlan plan;
+        PlacementPlanner::Tile(selection, area, plan);
+        RecordingBackend backend(windows);
+        PlacementResult result;
+        PlacementTransaction::Apply(plan, backend, result);
+        CHECK(result.batches == 1 && result.batched == 7 && result.failed.empty());
+
+        const RECT cells[7] = {
+            { 0, 0, 400, 300 }, { 400, 0, 800, 300 }, { 800, 0, 1200, 300 },
+            { 0, 300, 400, 600 }, { 400, 300, 800, 600 }, { 800, 300, 1200, 600 },
+            { 0, 600, 1200, 900 },
+        };
+        for (size_t i = 0; i < 7; i++) {
+            RECT expected = cells[i];
+            if (i == 3) {
+                expected = { expected.left - 7, expected.top, expected.right + 7, expected.bottom + 7 };
+            }
+            CHECK(SameRect(backend.Rect(windows[i].hwnd), expected));
+        }
+        // Tiling leaves the stacking alone
+        CHECK(backend.Stack() == Handles(windows, { 0, 1, 2, 3, 4, 5, 6 }));
+    }
+
+    // Cascade: two-thirds size steps from the top-left, back window first so
+    // the top one lands in front; the steps wrap where the area runs out
+    {
+        std::vector<WindowInfo> windows = MakeWindows(12);
+        RECT area = { 100, 50, 1060, 770 };
+        PlacementPlan plan;
+        PlacementPlanner::Cascade(windows, area, plan);
+        RecordingBackend backend(windows);
+        PlacementResult result;
+        PlacementTransaction::Apply(plan, backend, result);
+        CHECK(result.batches == 1 && result.batched == 12);
+
+        // 640x480 windows; min(320 / 32, 240 / 32) + 1 = 8 steps
+        for (size_t i = 0; i < 12; i++) {
+            LONG offset = static_cast<LONG>((11 - i) % 8) * PlacementPlanner::CASCADE_STEP;
+            RECT expected = { 100 + offset, 50 + offset, 100 + offset + 640, 50 + offset + 480 };
+            CHECK(SameRect(backend.Rect(windows[i].hwnd), expected));
+        }
+        CHECK(plan.Entries().front().hwnd == windows[11].hwnd && plan.Entries().back().hwnd == windows[0].hwnd);
+
+        // An area too small for a step still places every window
+        PlacementPlan small;
+        PlacementPlanner::Cascade(windows, RECT{ 0, 0, 60, 60 }, small);
+        CHECK(small.Entries().size() == 12);
+        for (const PlacementEntry& entry : small.Entries()) {
+            CHECK(entry.x == 0 && entry.y == 0 && entry.cx == 40 && entry.cy == 40);
+        }
+    }
+
+    // Z-order: the selection moves as a block and keeps its own stacking
+    {
+        std::vector<WindowInfo> windows = MakeWindows(10);
+        std::vector<WindowInfo> selection = Pick(windows, { 7, 2, 5 });
+
+        PlacementPlan plan;
+        PlacementPlanner::BringToFront(selection, plan);
+        RecordingBackend front(windows);
+        PlacementResult result;
+        PlacementTransaction::Apply(plan, front, result);
+        CHECK(front.Stack() == Handles(windows, { 2, 5, 7, 0, 1, 3, 4, 6, 8, 9 }));
+
+        plan.Clear();
+        PlacementPlanner::SendToBack(selection, plan);
+        RecordingBackend back(windows);
+        PlacementTransaction::Apply(plan, back, result);
+        CHECK(back.Stack() == Handles(windows, { 0, 1, 3, 4, 6, 8, 9, 2, 5, 7 }));
+
+        // Topmost windows stay above a later bring-to-front, until released
+        plan.Clear();
+        PlacementPlanner::SetTopmost(Pick(windows, { 4, 8 }), true, plan);
+        RecordingBackend topmost(windows);
+        PlacementTransaction::Apply(plan, topmost, result);
+        CHECK(topmost.Stack() == Handles(windows, { 4, 8, 0, 1, 2, 3, 5, 6, 7, 9 }));
+        CHECK(topmost.IsTopmost(windows[4].hwnd) && topmost.IsTopmost(windows[8].hwnd));
+        plan.Clear();
+        PlacementPlanner::BringToFront(Pick(windows, { 9 }), plan);
+        PlacementTransaction::Apply(plan, topmost, result);
+        CHECK(topmost.Stack() == Handles(windows, { 4, 8, 9, 0, 1, 2, 3, 5, 6, 7 }));
+        plan.Clear();
+        PlacementPlanner::SetTopmost(Pick(windows, { 4, 8 }), false, plan);
+        PlacementTransaction::Apply(plan, topmost, result);
+        CHECK(!topmost.IsTopmost(windows[4].hwnd) && !topmost.IsTopmost(windows[8].hwnd));
+        CHECK(topmost.Stack() == Handles(windows, { 4, 8, 9, 0, 1, 2, 3, 5, 6, 7 }));
+    }
+
+    // Plan entries merge per window; a z-order change moves the entry last
+    {
+        std::vector<WindowInfo> windows = MakeWindows(3);
+        PlacementPlan plan;
+        plan.Move(windows[0], 10, 20);
+        plan.Resize(windows[1], 300, 200);
+        plan.SetZOrder(windows[0], HWND_BOTTOM);
+        plan.Resize(windows[0], 50, 60);
+        CHECK(plan.Entries().size() == 2);
+        const PlacementEntry& moved = plan.Entries()[1];
+        CHECK(moved.hwnd == windows[0].hwnd && moved.x == 10 && moved.y == 20 && moved.cx == 50 && moved.cy == 60);
+        CHECK(moved.insertAfter == HWND_BOTTOM);
+        CHECK((moved.flags & (SWP_NOMOVE | SWP_NOSIZE | SWP_NOZORDER)) == 0 && (moved.flags & SWP_NOACTIVATE));
+        const PlacementEntry& resized = plan.Entries()[0];
+        CHECK((resized.flags & SWP_NOMOVE) && !(resized.flags & SWP_NOSIZE) && (resized.flags & SWP_NOZORDER));
+    }
+
+    // Batching: one batch per parent, single entries and hung windows alone,
+    // minimized and maximized windows restored first
+    {
+        std::vector<WindowInfo> windows = MakeWindows(8);
+        for (size_t i = 4; i < 7; i++) {
+            windows[i].style |= WS_CHILD;
+            windows[i].hwndParent = windows[0].hwnd;
+        }
+        windows[7].style |= WS_CHILD;
+        windows[7].hwndParent = windows[1].hwnd;
+        windows[2].isHung = true;
+        windows[3].isMinimized = true;
+        windows[5].isMaximized = true;
+
+        PlacementPlan plan;
+        for (const WindowInfo& win : windows) {
+            plan.Move(win, 0, 0);
+        }
+        RecordingBackend backend(windows);
+        PlacementResult result;
+        PlacementTransaction::Apply(plan, backend, result);
+        // Top level 0, 1, 3; children of 0: 4, 5, 6; child of 1: 7; hung: 2
+        CHECK(result.batches == 2 && result.batched == 6);
+        CHECK(result.direct == 2 && result.fallbacks == 0 && result.failed.empty());
+        CHECK(backend.Count(CALL_RESTORE) == 2);
+        for (const Call& call : backend.calls) {
+            CHECK(call.kind != CALL_DEFER || call.hwnd != windows[2].hwnd);
+        }
+        // Restores come before the window is placed
+        auto restore = std::find_if(backend.calls.begin(), backend.calls.end(),
+            [&](const Call& call) { return call.kind == CALL_RESTORE && call.hwnd == windows[3].hwnd; });
+        auto deferred = std::find_if(backend.calls.begin(), backend.calls.end(),
+            [&](const Call& call) { return call.kind == CALL_DEFER && call.hwnd == windows[3].hwnd; });
+        CHECK(restore < deferred);
+    }
+
+    // Fallback: a window that closed refuses its entry, the batch is dropped
+    // and each entry is retried alone; only the closed one fails
+    {
+        std::vector<WindowInfo> windows = MakeWindows(6);
+        PlacementPlan plan;
+        PlacementPlanner::Tile(windows, RECT{ 0, 0, 600, 400 }, plan);
+
+        RecordingBackend backend(windows);
+        backend.closed.insert(windows[2].hwnd);
+        PlacementResult result;
+        PlacementTransaction::Apply(plan, backend, result);
+        CHECK(result.batches == 0 && result.batched == 0);
+        CHECK(result.fallbacks == 6);
+        CHECK(result.failed.size() == 1 && result.failed[0] == windows[2].hwnd);
+        CHECK(backend.Count(CALL_DEFER) == 3 && backend.Count(CALL_END) == 0 && backend.Count(CALL_SET) == 6);
+        CHECK(SameRect(backend.Rect(windows[5].hwnd), RECT{ 400, 200, 600, 400 }));
+        CHECK(SameRect(backend.Rect(windows[2].hwnd), windows[2].rect));
+
+        // A batch that fails to commit, or to start, falls back the same way
+        RecordingBackend failedEnd(windows);
+        failedEnd.failEnd = true;
+        PlacementResult endResult;
+        PlacementTransaction::Apply(plan, failedEnd, endResult);
+        CHECK(endResult.batches == 0 && endResult.fallbacks == 6 && endResult.failed.empty());
+        CHECK(SameRect(failedEnd.Rect(windows[5].hwnd), RECT{ 400, 200, 600, 400 }));
+
+        RecordingBackend failedBegin(windows);
+        failedBegin.failBegin = true;
+        PlacementResult beginResult;
+        PlacementTransaction::Apply(plan, failedBegin, beginResult);
+        CHECK(beginResult.fallbacks == 6 && failedBegin.Count(CALL_DEFER) == 0 && beginResult.failed.empty());
+
+        // A hung window that closed fails on its own
+        windows[4].isHung = true;
+        PlacementPlan hungPlan;
+        PlacementPlanner::BringToFront(windows, hungPlan);
+        RecordingBackend hung(windows);
+        hung.closed.insert(windows[4].hwnd);
+        PlacementResult hungResult;
+        PlacementTransaction::Apply(hungPlan, hung, hungResult);
+        CHECK(hungResult.batches == 1 && hungResult.batched == 5 && hungResult.direct == 0);
+        CHECK(hungResult.failed.size() == 1 && hungResult.failed[0] == windows[4].hwnd);
+    }
+
+    // Nothing selected, nothing called
+    {
+        PlacementPlan plan;
+        PlacementPlanner::Tile({}, RECT{ 0, 0, 100, 100 }, plan);
+        PlacementPlanner::Cascade({}, RECT{ 0, 0, 100, 100 }, plan);
+        CHECK(plan.Empty());
+        RecordingBackend backend({});
+        PlacementResult result;
+        PlacementTransaction::Apply(plan, backend, result);
+        CHECK(backend.calls.empty());
+    }
+
+    std::printf("WindowBatchTest passed\n");
+    return 0;
+}
@@ -0,0 +1,249 @@
+// WindowGroups on a million windows: the first Build, then updates from the
+// handle matching ZOrderTracker does on each refresh, for the same snapshot,
+// one with a few thousand changes and a reshuffled one, next to a Build of
+// the changed snapshot, and Layout with every group collapsed and every group
+// expanded, for few and many processes. First, small snapshots put through
+// random churn (windows added, closed, restyled, reordered, and handles
+// reused by another process) are updated into one WindowGroups and checked
+// against totals summed from scratch and against a Build of the same
+// snapshot, and Layout against the list it should give.
+
+#include "TestHarness.h"
+#include "WindowGroups.h"
+#include "WindowZOrder.h"
+#include <algorithm>
+#include <map>
+
+struct Totals {
+    uint32_t windows = 0;
+    uint32_t visible = 0;
+    uint64_t area = 0;
+};
+
+static void CheckTotals(const WindowGroups& groups, const std::vector<WindowInfo>& windows) {
+    std::map<uint64_t, Totals> expected;
+    for (const WindowInfo& win : windows) {
+        Totals& totals = expected[groups.KeyOf(win)];
+        int64_t width = win.rect.right - win.rect.left;
+        int64_t height = win.rect.bottom - win.rect.top;
+        totals.windows++;
+        totals.visible += win.isVisible ? 1 : 0;
+        totals.area += width > 0 && height > 0 ? static_cast<uint64_t>(width * height) : 0;
+    }
+    CHECK(groups.Groups().size() == expected.size());
+    for (const WindowGroup& group : groups.Groups()) {
+        auto it = expected.find(group.key);
+        CHECK(it != expected.end());
+        CHECK(group.windows == it->second.windows && group.visible == it->second.visible &&
+            group.area == it->second.area);
+        CHECK(group.processId == static_cast<DWORD>(group.key >> 32));
+    }
+    for (const WindowInfo& win : windows) {
+        uint32_t group = groups.Find(win);
+        CHECK(group != WindowGroups::NO_GROUP && groups.Groups()[group].key == groups.KeyOf(win));
+    }
+}
+
+// The same groups and totals as a full build gives
+static void CheckBuilt(const WindowGroups& groups, const std::vector<WindowInfo>& windows) {
+    WindowGroups built(groups.ByThread());
+    built.Build(windows);
+    CHECK(groups.Groups().size() == built.Groups().size());
+    for (const WindowInfo& win : windows) {
+        uint32_t group = groups.Find(win);
+        uint32_t expected = built.Find(win);
+        CHECK(group != WindowGroups::NO_GROUP && expected != WindowGroups::NO_GROUP);
+        const WindowGroup& a = groups.Groups()[group];
+        const WindowGroup& b = built.Groups()[expected];
+        CHECK(a.key == b.key && a.processId == b.processId && a.threadId == b.threadId &&
+            a.windows == b.windows && a.visible == b.visible && a.area == b.area);
+    }
+}
+
+// Headers in order of each group's first window, each followed by its
+// windows in list order when expanded
+static void CheckLayout(const WindowGroups& groups, const std::vector<WindowInfo>& windows,
+    const std::unordered_set<uint64_t>& expanded) {
+    std::vector<uint64_t> order;
+    for (const WindowInfo& win : windows) {
+        if (std::find(order.begin(), order.end(), groups.KeyOf(win)) == order.end()) {
+            order.push_back(groups.KeyOf(win));
+        }
+    }
+    std::vector<GroupRow> rows;
+    groups.Layout(windows, expanded, rows);
+    size_t at = 0;
+    for (uint64_t key : order) {
+        CHECK(at < rows.size() && rows[at].window == GroupRow::HEADER && groups.Groups()[rows[at].group].key == key);
+        uint32_t group = rows[at].group;
+        at++;
+        if (!expanded.count(key)) continue;
+        for (size_t i = 0; i < windows.size(); i++) {
+            if (groups.KeyOf(windows[i]) != key) continue;
+            CHECK(at < rows.size() && rows[at].group == group && rows[at].window == i);
+            at++;
+        }
+    }
+    CHECK(at == rows.size());
+}
+
+static void Churn(SyntheticWindows& synthetic, std::vector<WindowInfo>& windows, uint32_t& created) {
+    std::mt19937& rng = synthetic.Rng();
+    switch (rng() % 8) {
+    case 0:
+        if (!windows.empty()) windows.erase(windows.begin() + rng() % windows.size());
+        break;
+    case 1:
+        windows.insert(windows.begin() + (windows.empty() ? 0 : rng() % windows.size()), synthetic.Make(created++));
+        break;
+    case 2:
+        if (!windows.empty()) {
+            WindowInfo& win = windows[rng() % windows.size()];
+            win.isVisible = !win.isVisible;
+        }
+        break;
+    case 3:
+        if (!windows.empty()) windows[rng() % windows.size()].rect.right += 1 + rng() % 50;
+        break;
+    case 4:
+        std::shuffle(windows.begin(), windows.end(), rng);
+        break;
+    case 5:
+        // A closed window's handle reused by another process
+        if (!windows.empty()) {
+            WindowInfo& win = windows[rng() % windows.size()];
+            HWND hwnd = win.hwnd;
+            win = synthetic.Make(created++);
+            win.hwnd = hwnd;
+        }
+        break;
+    case 6:
+        if (windows.size() > 1) std::swap(windows[rng() % windows.size()], windows[rng() % windows.size()]);
+        break;
+    case 7:
+        if (!windows.empty()) windows.erase(windows.begin(), windows.begin() + rng() % windows.size());
+        break;
+    }
+}
+
+int main(int argc, char** argv) {
+    size_t count = BenchSize(argc, argv, 1000000);
+
+    size_t updates = 0;
+    for (bool byThread : { false, true }) {
+        for (int trial = 0; trial < 200; trial++) {
+            SyntheticWindows synthetic(static_cast<uint32_t>(trial), 1 + trial % 40);
+            uint32_t created = static_cast<uint32_t>(trial % 300);
+            std::vector<WindowInfo> windows = synthetic.MakeMany(created);
+            ZOrderTracker tracker;
+            tracker.Update(windows, 0);
+            WindowGroups groups(byThread);
+            groups.Build(windows);
+            CheckTotals(groups, windows);
+            for (int step = 0; step < 20; step++) {
+                // Several changes between most snapshots
+                for (int change = synthetic.Next(2) ? 1 : 6; change > 0; change--) {
+                    Churn(synthetic, windows, created);
+                }
+                // Now and then the tracker starts over, as on switching to a
+                // snapshot file, and the update has to build
+                if (synthetic.Next(10) == 0) {
+                    tracker.Reset();
+                }
+                tracker.Update(windows, step + 1);
+                groups.Update(windows, tracker.PreviousRows(), tracker.PreviousCount());
+                CheckTotals(groups, windows);
+                CheckBuilt(groups, windows);
+                updates++;
+            }
+
+            std::unordered_set<uint64_t> expanded;
+            CheckLayout(groups, windows, expanded);
+            for (const WindowGroup& group : groups.Groups()) {
+                if (synthetic.Next(2)) expanded.insert(group.key);
+            }
+            CheckLayout(groups, windows, expanded);
+
+            groups.Build({});
+            CHECK(groups.Groups().empty());
+        }
+    }
+    std::printf("%zu updates match totals from scratch and a full build\n", updates);
+
+    std::printf("%zu windows\n", count);
+    std::printf("%-8s %8s %8s %10s %10s %10s %10s %10s %10s   (ms)\n", "by", "groups", "first", "same",
+        "2000 chg", "reordered", "rebuild", "collapsed", "expanded");
+    for (uint32_t processes : { 50u, 5000u }) {
+        SyntheticWindows synthetic(50, processes);
+        std::vector<WindowInfo> windows = synthetic.MakeMany(count);
+        uint32_t created = static_cast<uint32_t>(count);
+        // Reused, so freeing a million strings is not charged to the next
+        // case's first build
+        std::vector<WindowInfo> changed;
+        for (bool byThread : { false, true }) {
+            // The tracker's matching is part of every refresh already, so it
+            // is not timed here
+            ZOrderTracker tracker;
+            tracker.Update(windows, 0);
+            WindowGroups groups(byThread);
+            Stopwatch watch;
+            groups.Build(windows);
+            double first = watch.Ms();
+
+            tracker.Update(windows, 1);
+            watch.Restart();
+            groups.Update(windows, tracker.PreviousRows(), tracker.PreviousCount());
+            double same = watch.Ms();
+
+            changed = windows;
+            for (int i = 0; i < 1000; i++) {
+                WindowInfo& win = changed[synthetic.Next(static_cast<uint32_t>(changed.size()))];
+                win.isVisible = !win.isVisible;
+            }
+            for (int i = 0; i < 500; i++) {
+                changed.erase(changed.begin() + synthetic.Next(static_cast<uint32_t>(changed.size())));
+            }
+            for (int i = 0; i < 500; i++) {
+                changed.push_back(synthetic.Make(created++));
+            }
+            tracker.Update(changed, 2);
+            watch.Restart();
+            groups.Update(changed, tracker.PreviousRows(), tracker.PreviousCount());
+            double churned = watch.Ms();
+            CheckTotals(groups, changed);
+
+            std::shuffle(changed.begin(), changed.end(), synthetic.Rng());
+            tracker.Update(changed, 3);
+            watch.Restart();
+            groups.Update(changed, tracker.PreviousRows(), tracker.PreviousCount());
+            double reordered = watch.Ms();
+            CheckTotals(groups, changed);
+
+            WindowGroups built(byThread);
+            built.Build(windows);
+            watch.Restart();
+            built.Build(changed);
+            double rebuild = watch.Ms();
+            CheckBuilt(groups, changed);
+
+            std::unordered_set<uint64_t> expanded;
+            std::vector<GroupRow> rows;
+            watch.Restart();
+            groups.Layout(changed, expanded, rows);
+            double collapsed = watch.Ms();
+            CHECK(rows.size() == groups.Groups().size());
+            for (const WindowGroup& group : groups.Groups()) {
+                expanded.insert(group.key);
+            }
+            watch.Restart();
+            groups.Layout(changed, expanded, rows);
+            double all = watch.Ms();
+            CHECK(rows.size() == groups.Groups().size() + changed.size());
+
+            std::printf("%-8s %8zu %8.1f %10.1f %10.1f %10.1f %10.1f %10.1f %10.1f\n",
+                byThread ? "thread" : "process", groups.Groups().size(), first, same, churned, reordered, rebuild,
+                collapsed, all);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,232 @@
+// WindowWatcher event throughput at several churn rates, writing through the
+// batched writer into a sink that only counts. Also checks that the feed has
+// exactly the events a direct comparison of the snapshots predicts, and that
+// a watch over a recording of the snapshots writes the same feed as the
+// live watch did.
+
+#include "TestHarness.h"
+#include "HeadlessMode.h"
+#include "WindowWatch.h"
+#include "SnapshotRecording.h"
+#include "FileIO.h"
+#include <algorithm>
+#include <map>
+#include <unordered_map>
+
+static const wchar_t* const RECORDING_PATH = L"WindowWatchBench.wlr";
+
+class CountingSink : public ByteSink {
+public:
+    bool Write(const char*, size_t length) override {
+        m_bytes += length;
+        m_writes++;
+        return true;
+    }
+
+    size_t Bytes() const { return m_bytes; }
+    size_t Writes() const { return m_writes; }
+
+private:
+    size_t m_bytes = 0;
+    size_t m_writes = 0;
+};
+
+// A desktop where a set number of changes land each tick: moves, retitles,
+// state flips, new and closed windows, and new owners
+class Churn {
+public:
+    Churn(uint32_t seed, size_t windows) : m_synthetic(seed) {
+        for (size_t i = 0; i < windows; i++) {
+            m_windows.push_back(m_synthetic.Make(m_created++));
+        }
+        Renumber();
+    }
+
+    const std::vector<WindowInfo>& Windows() const { return m_windows; }
+
+    const std::vector<WindowInfo>& Step(size_t changes) {
+        for (size_t change = 0; change < changes; change++) {
+            size_t row = m_synthetic.Next(static_cast<uint32_t>(m_windows.size()));
+            WindowInfo& win = m_windows[row];
+            uint32_t kind = m_synthetic.Next(10);
+            if (kind < 4) {
+                win.rect.left += 5;
+                win.rect.right += 5;
+            } else if (kind < 6) {
+                win.title += L"*";
+            } else if (kind < 7) {
+                win.isMinimized = !win.isMinimized;
+                win.style ^= WS_MINIMIZE;
+            } else if (kind < 8) {
+                m_windows.insert(m_windows.begin() + row, m_synthetic.Make(m_created++));
+            } else if (kind < 9 && m_windows.size() > 10) {
+                m_windows.erase(m_windows.begin() + row);
+            } else {
+                win.hwndOwner = MakeHandle(m_synthetic.Next(3) * 4);
+            }
+        }
+        Renumber();
+        return m_windows;
+    }
+
+private:
+    void Renumber() {
+        for (size_t i = 0; i < m_windows.size(); i++) {
+            m_windows[i].zOrder = static_cast<int>(i);
+        }
+    }
+
+    SyntheticWindows m_synthetic;
+    std::vector<WindowInfo> m_windows;
+    uint32_t m_created = 0;
+};
+
+// Hands the headless watch a prepared series of snapshots
+class FrameSource : public WindowSource {
+public:
+    explicit FrameSource(const std::vector<std::vector<WindowInfo>>& frames) : m_frames(frames) {}
+
+    bool Load(std::vector<WindowInfo>& windows, std::wstring&) override {
+        windows = m_frames[m_next];
+        return true;
+    }
+    bool WaitForChange(uint32_t) override { return ++m_next < m_frames.size(); }
+
+private:
+    const std::vector<std::vector<WindowInfo>>& m_frames;
+    size_t m_next = 0;
+};
+
+// Event counts predicted by comparing each snapshot with the one before
+static std::map<std::string, size_t> PredictEvents(const std::vector<std::vector<WindowInfo>>& frames) {
+    std::map<std::string, size_t> counts;
+    for (size_t frame = 1; frame < frames.size(); frame++) {
+        std::unordered_map<HWND, const WindowInfo*> previous;
+        for (const WindowInfo& win : frames[frame - 1]) {
+            previous[win.hwnd] = &win;
+        }
+        size_t kept = 0;
+        for (const WindowInfo& win : frames[frame]) {
+            auto found = previous.find(win.hwnd);
+            if (found == previous.end()) {
+                counts["created"]++;
+                continue;
+            }
+            kept++;
+            const WindowInfo& before = *found->second;
+            if (!SameRect(before.rect, win.rect)) counts["moved"]++;
+            if (before.title != win.title) counts["retitled"]++;
+            if (before.isMinimized != win.isMinimized) counts["state"]++;
+            if (before.hwndOwner != win.hwndOwner) counts["reparented"]++;
+        }
+        counts["destroyed"] += frames[frame - 1].size() - kept;
+    }
+    return counts;
+}
+
+static std::map<std::string, size_t> CountEvents(const std::string& feed) {
+    std::map<std::string, size_t> counts;
+    for (size_t at = feed.find("\"event\":\""); at != std::string::npos; at = feed.find("\"event\":\"", at)) {
+        at += 9;
+        counts[feed.substr(at, feed.find('"', at) - at)]++;
+    }
+    return counts;
+}
+
+// The feed with every "time" value dropped
+static std::string WithoutTimes(const std::string& feed) {
+    std::string stripped;
+    size_t at = 0;
+    for (size_t time = feed.find("{\"time\":"); time != std::string::npos; time = feed.find("{\"time\":", at)) {
+        stripped.append(feed, at, time - at + 1);
+        at = feed.find(',', time) + 1;
+    }
+    stripped.append(feed, at, std::string::npos);
+    return stripped;
+}
+
+int main(int argc, char** argv) {
+    size_t ticks = BenchSize(argc, argv, 2000);
+    const size_t windowCount = 400;
+
+    // The feed against a direct comparison of the snapshots; restacking is
+    // left out, as it names only the windows that moved in the z-order
+    {
+        Churn churn(40, windowCount);
+        std::vector<std::vector<WindowInfo>> frames = { churn.Windows() };
+        for (size_t tick = 1; tick < 200; tick++) {
+            frames.push_back(churn.Step(20));
+        }
+
+        std::string feed;
+        std::string errors;
+        StringSink out(feed);
+        StringSink err(errors);
+        FrameSource live(frames);
+        CHECK(HeadlessRunner::Run({ L"--watch", L"--fields", L"all,-zorder" }, &live, out, err) ==
+            HeadlessRunner::EXIT_OK);
+        CHECK(errors.empty());
+
+        std::map<std::string, size_t> predicted = PredictEvents(frames);
+        std::map<std::string, size_t> written = CountEvents(feed);
+        CHECK(written == predicted);
+        size_t events = 0;
+        for (const auto& count : written) {
+            events += count.second;
+        }
+        CHECK(static_cast<size_t>(std::count(feed.begin(), feed.end(), '\n')) == events);
+
+        // The same snapshots recorded and watched from the file
+        SnapshotRecorder recorder;
+        CHECK(recorder.Start(RECORDING_PATH));
+        for (size_t frame = 0; frame < frames.size(); frame++) {
+            CHECK(recorder.Record(frames[frame], 1000 + frame));
+        }
+        recorder.Stop();
+        std::wstring segment = SnapshotRecorder::SegmentPath(RECORDING_PATH, 1);
+        std::string replayed;
+        StringSink replayOut(replayed);
+        CHECK(HeadlessRunner::Run({ L"--watch", L"--fields", L"all,-zorder", L"--input", segment }, nullptr,
+            replayOut, err) == HeadlessRunner::EXIT_OK);
+        FileIO::Remove(segment);
+        CHECK(replayed.find("{\"time\":1001,") != std::string::npos);
+        CHECK(WithoutTimes(replayed) == WithoutTimes(feed));
+        std::printf("%zu events over %zu snapshots match the prediction and the recording\n", events, frames.size());
+    }
+
+    // Throughput: the time to copy each snapshot in is measured and taken off
+    std::printf("%zu windows, %zu ticks\n", windowCount, ticks);
+    std::printf("%8s %12s %12s %12s %10s %10s\n", "changes", "us/tick", "events", "Mevents/s", "MB/s", "writes");
+    for (size_t changes : { 0, 10, 100, 1000 }) {
+        Churn churn(41, windowCount);
+        std::vector<std::vector<WindowInfo>> frames = { churn.Windows() };
+        for (size_t tick = 1; tick <= ticks; tick++) {
+            frames.push_back(churn.Step(changes));
+        }
+
+        WindowWatcher watcher(WindowWatcher::DEFAULT_FIELDS, WindowFilter(WindowFilterOptions()), WindowQuery());
+        CountingSink sink;
+        BufferedWriter writer(sink);
+        std::vector<WindowInfo> windows = frames[0];
+        watcher.Update(windows, 0, writer);
+
+        Stopwatch watch;
+        for (size_t tick = 1; tick <= ticks; tick++) {
+            windows = frames[tick];
+        }
+        double copyMs = watch.Ms();
+        watch.Restart();
+        for (size_t tick = 1; tick <= ticks; tick++) {
+            windows = frames[tick];
+            watcher.Update(windows, tick, writer);
+            writer.Flush();
+        }
+        double ms = watch.Ms() - copyMs;
+        if (ms <= 0) ms = 0.001;
+        std::printf("%8zu %12.1f %12llu %12.2f %10.1f %10zu\n", changes, ms * 1000.0 / ticks,
+            static_cast<unsigned long long>(watcher.EventCount()), watcher.EventCount() / (ms * 1000.0),
+            sink.Bytes() / (ms * 1000.0), sink.Writes());
+        CHECK(changes == 0 ? watcher.EventCount() == 0 : watcher.EventCount() > 0);
+    }
+    return 0;
+}
@@ -0,0 +1,221 @@
+// ZOrderDelta on permutations of 100k windows: one window raised, a hundred
+// raised, scattered swaps, new windows, a full shuffle and a reversal. Each
+// result is checked in full before it is timed: the stable windows are a
+// longest run that kept its order (against a separate patience sort), the
+// moves are all the rest and so the fewest, raised matches the stable
+// windows above before and after, and applying the moves to the previous
+// order rebuilds the new one. Small random cases are also checked against
+// an O(n^2) longest-run search, and ZOrderTracker is timed end to end.
+
+#include "TestHarness.h"
+#include "WindowZOrder.h"
+#include <algorithm>
+#include <list>
+
+static const uint32_t NEW_WINDOW = ZOrderDelta::NEW_WINDOW;
+
+// Length of the longest increasing run of positions, new windows skipped
+static size_t LongestRun(const std::vector<uint32_t>& previous) {
+    std::vector<uint32_t> tails;
+    for (uint32_t position : previous) {
+        if (position == NEW_WINDOW) continue;
+        auto it = std::lower_bound(tails.begin(), tails.end(), position);
+        if (it == tails.end()) {
+            tails.push_back(position);
+        } else {
+            *it = position;
+        }
+    }
+    return tails.size();
+}
+
+static size_t LongestRunSlow(const std::vector<uint32_t>& previous) {
+    std::vector<uint32_t> positions;
+    for (uint32_t position : previous) {
+        if (position != NEW_WINDOW) positions.push_back(position);
+    }
+    std::vector<size_t> runs(positions.size(), 1);
+    size_t longest = 0;
+    for (size_t i = 0; i < positions.size(); i++) {
+        for (size_t j = 0; j < i; j++) {
+            if (positions[j] < positions[i]) runs[i] = std::max(runs[i], runs[j] + 1);
+        }
+        longest = std::max(longest, runs[i]);
+    }
+    return longest;
+}
+
+static void Verify(const std::vector<uint32_t>& previous, size_t previousCount, const ZOrderDelta& delta) {
+    size_t count = previous.size();
+    const std::vector<ZOrderMove>& moves = delta.Moves();
+    std::vector<uint8_t> moved(count, 0);
+    size_t survivors = 0;
+    for (uint32_t position : previous) {
+        survivors += position != NEW_WINDOW ? 1 : 0;
+    }
+
+    // Moves in new z-order, each a surviving window
+    for (size_t i = 0; i < moves.size(); i++) {
+        const ZOrderMove& move = moves[i];
+        CHECK(move.row < count && previous[move.row] == move.previous && move.previous != NEW_WINDOW);
+        CHECK(i == 0 || move.row > moves[i - 1].row);
+        moved[move.row] = 1;
+    }
+
+    // The rest kept their order, and no longer run exists
+    uint32_t last = 0;
+    bool first = true;
+    for (size_t row = 0; row < count; row++) {
+        if (previous[row] == NEW_WINDOW || moved[row]) continue;
+        CHECK(first || previous[row] > last);
+        last = previous[row];
+        first = false;
+    }
+    CHECK(delta.StableCount() + moves.size() == survivors);
+    CHECK(delta.StableCount() == LongestRun(previous));
+
+    // Raised: fewer stable windows above it now than before
+    std::vector<uint32_t> stableAboveRow(count + 1, 0);
+    std::vector<uint32_t> stableAbovePosition(previousCount + 1, 0);
+    for (size_t row = 0; row < count; row++) {
+        bool stable = previous[row] != NEW_WINDOW && !moved[row];
+        stableAboveRow[row + 1] = stableAboveRow[row] + (stable ? 1 : 0);
+        if (stable) stableAbovePosition[previous[row] + 1] = 1;
+    }
+    for (size_t position = 0; position < previousCount; position++) {
+        stableAbovePosition[position + 1] += stableAbovePosition[position];
+    }
+    for (const ZOrderMove& move : moves) {
+        uint32_t now = stableAboveRow[move.row];
+        uint32_t before = stableAbovePosition[move.previous];
+        CHECK(now != before && move.raised == (now < before));
+    }
+
+    // The previous order without the moved windows, then each move placed
+    // directly below the surviving window now above it
+    std::vector<uint32_t> rowAt(previousCount, NEW_WINDOW);
+    for (size_t row = 0; row < count; row++) {
+        if (previous[row] != NEW_WINDOW) rowAt[previous[row]] = static_cast<uint32_t>(row);
+    }
+    std::list<uint32_t> order;
+    std::vector<std::list<uint32_t>::iterator> where(count, order.end());
+    for (uint32_t row : rowAt) {
+        if (row != NEW_WINDOW && !moved[row]) where[row] = order.insert(order.end(), row);
+    }
+    std::vector<uint32_t> survivorAbove(count, NEW_WINDOW);
+    for (size_t row = 1; row < count; row++) {
+        survivorAbove[row] = previous[row - 1] != NEW_WINDOW ? static_cast<uint32_t>(row - 1) : survivorAbove[row - 1];
+    }
+    for (const ZOrderMove& move : moves) {
+        uint32_t above = survivorAbove[move.row];
+        auto at = above == NEW_WINDOW ? order.begin() : std::next(where[above]);
+        where[move.row] = order.insert(at, move.row);
+    }
+    size_t row = 0;
+    for (uint32_t placed : order) {
+        while (previous[row] == NEW_WINDOW) row++;
+        CHECK(placed == row);
+        row++;
+    }
+    CHECK(order.size() == survivors);
+}
+
+static WindowInfo MakeWindow(size_t index) {
+    WindowInfo win = {};
+    win.hwnd = MakeHandle(static_cast<uint32_t>(0x10000 + index * 4));
+    win.processId = static_cast<DWORD>(1000 + index % 97);
+    win.zOrder = static_cast<int>(index);
+    return win;
+}
+
+int main(int argc, char** argv) {
+    size_t count = BenchSize(argc, argv, 100000);
+    std::mt19937 rng(48);
+    ZOrderDelta delta;
+
+    // Small cases: mostly ordered or shuffled, with some windows new and
+    // some gone
+    for (int trial = 0; trial < 100000; trial++) {
+        size_t previousCount = rng() % 14;
+        std::vector<uint32_t> positions(previousCount);
+        for (size_t i = 0; i < previousCount; i++) positions[i] = static_cast<uint32_t>(i);
+        std::shuffle(positions.begin(), positions.end(), rng);
+        size_t kept = previousCount ? rng() % (previousCount + 1) : 0;
+        std::vector<uint32_t> previous(positions.begin(), positions.begin() + kept);
+        if (rng() % 2) {
+            std::sort(previous.begin(), previous.end());
+            for (int swaps = rng() % 3; swaps > 0 && previous.size() > 1; swaps--) {
+                std::swap(previous[rng() % previous.size()], previous[rng() % previous.size()]);
+            }
+        }
+        for (int added = rng() % 4; added > 0; added--) {
+            previous.insert(previous.begin() + rng() % (previous.size() + 1), NEW_WINDOW);
+        }
+        delta.Compute(previous, previousCount);
+        Verify(previous, previousCount, delta);
+        CHECK(delta.StableCount() == LongestRunSlow(previous));
+    }
+    std::printf("100000 small z-orders match a full search\n");
+
+    std::vector<uint32_t> unchanged(count);
+    for (size_t i = 0; i < count; i++) unchanged[i] = static_cast<uint32_t>(i);
+    struct Case {
+        const char* name;
+        std::vector<uint32_t> previous;
+    };
+    std::vector<Case> cases = { { "unchanged", unchanged } };
+    cases.push_back({ "one raised", unchanged });
+    std::rotate(cases.back().previous.begin(), cases.back().previous.begin() + count / 2,
+        cases.back().previous.begin() + count / 2 + 1);
+    cases.push_back({ "100 raised", unchanged });
+    for (int i = 0; i < 100; i++) {
+        size_t row = rng() % count;
+        std::rotate(cases.back().previous.begin(), cases.back().previous.begin() + row,
+            cases.back().previous.begin() + row + 1);
+    }
+    cases.push_back({ "1000 swaps", unchanged });
+    for (int i = 0; i < 1000; i++) {
+        std::swap(cases.back().previous[rng() % count], cases.back().previous[rng() % count]);
+    }
+    cases.push_back({ "5% new", unchanged });
+    for (uint32_t& position : cases.back().previous) {
+        if (rng() % 20 == 0) position = NEW_WINDOW;
+    }
+    cases.push_back({ "shuffled", unchanged });
+    std::shuffle(cases.back().previous.begin(), cases.back().previous.end(), rng);
+    cases.push_back({ "reversed", unchanged });
+    std::reverse(cases.back().previous.begin(), cases.back().previous.end());
+
+    std::printf("%zu windows\n", count);
+    std::printf("%-12s %10s %10s %10s\n", "z-order", "ms", "moves", "stable");
+    for (const Case& test : cases) {
+        delta.Compute(test.previous, count);
+        Verify(test.previous, count, delta);
+        const int repeats = 20;
+        Stopwatch watch;
+        for (int i = 0; i < repeats; i++) {
+            delta.Compute(test.previous, count);
+        }
+        std::printf("%-12s %10.2f %10zu %10zu\n", test.name, watch.Ms() / repeats, delta.Moves().size(),
+            delta.StableCount());
+    }
+
+    // The tracker, matching windows by handle, with one raised per refresh
+    std::vector<WindowInfo> windows;
+    for (size_t i = 0; i < count; i++) windows.push_back(MakeWindow(i));
+    ZOrderTracker tracker;
+    tracker.Update(windows, 1);
+    const int updates = 20;
+    double ms = 0;
+    for (int update = 0; update < updates; update++) {
+        size_t row = 1 + rng() % (count - 1);
+        std::rotate(windows.begin(), windows.begin() + row, windows.begin() + row + 1);
+        Stopwatch watch;
+        tracker.Update(windows, 2 + update);
+        ms += watch.Ms();
+        CHECK(tracker.Moves().size() == 1 && tracker.Moves()[0].row == 0 && tracker.Moves()[0].raised);
+        CHECK(windows[0].raisedAt == static_cast<uint64_t>(2 + update));
+    }
+    std::printf("tracker, one raised per refresh: %.2f ms per update\n", ms / updates);
+    return 0;
+}
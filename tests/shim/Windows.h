@@ -0,0 +1,93 @@
+#pragma once
+
+// The Win32 types and constants the portable units use, so they build and
+// are tested on other platforms. Values match the Windows SDK.
+
+#include <cstdint>
+#include <cwchar>
+#include <cwctype>
+
+typedef struct HWND__* HWND;
+typedef struct HICON__* HICON;
+typedef void* HANDLE;
+typedef unsigned long DWORD;
+typedef unsigned short WORD;
+typedef unsigned char BYTE;
+typedef unsigned int UINT;
+typedef int BOOL;
+typedef long LONG;
+typedef long long LONGLONG;
+typedef unsigned long long ULONGLONG;
+typedef intptr_t LPARAM;
+typedef uintptr_t WPARAM;
+
+struct RECT {
+    LONG left;
+    LONG top;
+    LONG right;
+    LONG bottom;
+};
+
+struct POINT {
+    LONG x;
+    LONG y;
+};
+
+#define CALLBACK
+#define WINAPI
+#define TRUE 1
+#define FALSE 0
+
+// Window styles
+#define WS_POPUP            0x80000000L
+#define WS_CHILD            0x40000000L
+#define WS_MINIMIZE         0x20000000L
+#define WS_VISIBLE          0x10000000L
+#define WS_DISABLED         0x08000000L
+#define WS_CLIPSIBLINGS     0x04000000L
+#define WS_CLIPCHILDREN     0x02000000L
+#define WS_MAXIMIZE         0x01000000L
+#define WS_CAPTION          0x00C00000L
+#define WS_BORDER           0x00800000L
+#define WS_DLGFRAME         0x00400000L
+#define WS_VSCROLL          0x00200000L
+#define WS_HSCROLL          0x00100000L
+#define WS_SYSMENU          0x00080000L
+#define WS_THICKFRAME       0x00040000L
+#define WS_MINIMIZEBOX      0x00020000L
+#define WS_MAXIMIZEBOX      0x00010000L
+
+// Extended window styles
+#define WS_EX_DLGMODALFRAME     0x00000001L
+#define WS_EX_NOPARENTNOTIFY    0x00000004L
+#define WS_EX_TOPMOST           0x00000008L
+#define WS_EX_ACCEPTFILES       0x00000010L
+#define WS_EX_TRANSPARENT       0x00000020L
+#define WS_EX_MDICHILD          0x00000040L
+#define WS_EX_TOOLWINDOW        0x00000080L
+#define WS_EX_WINDOWEDGE        0x00000100L
+#define WS_EX_CLIENTEDGE        0x00000200L
+#define WS_EX_CONTEXTHELP       0x00000400L
+#define WS_EX_RIGHT             0x00001000L
+#define WS_EX_RTLREADING        0x00002000L
+#define WS_EX_LEFTSCROLLBAR     0x00004000L
+#define WS_EX_CONTROLPARENT     0x00010000L
+#define WS_EX_STATICEDGE        0x00020000L
+#define WS_EX_APPWINDOW         0x00040000L
+#define WS_EX_LAYERED           0x00080000L
+#define WS_EX_NOINHERITLAYOUT   0x00100000L
+#define WS_EX_NOREDIRECTIONBITMAP 0x00200000L
+#define WS_EX_LAYOUTRTL         0x00400000L
+#define WS_EX_COMPOSITED        0x02000000L
+#define WS_EX_NOACTIVATE        0x08000000L
+
+// SetWindowPos
+#define SWP_NOSIZE          0x0001
+#define SWP_NOMOVE          0x0002
+#define SWP_NOZORDER        0x0004
+#define SWP_NOACTIVATE      0x0010
+#define SWP_ASYNCWINDOWPOS  0x4000
+#define HWND_TOP        ((HWND)0)
+#define HWND_BOTTOM     ((HWND)1)
+#define HWND_TOPMOST    ((HWND)-1)
+#define HWND_NOTOPMOST  ((HWND)-2)
@@ -0,0 +1,3 @@
+#pragma once
+
+// Nothing from dwmapi.h is used outside Win32-only code